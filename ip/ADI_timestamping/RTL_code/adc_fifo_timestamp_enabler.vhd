@@ -51,7 +51,12 @@ entity adc_fifo_timestamp_enabler is
     PARAM_TWO_ANTENNA_SUPPORT : boolean := false;   
     --! Defines whether the baseband FPGA clock (ADCxN_clk) has an actual x1 ratio to the sampling clock (true) or not 
     --! (false [default]); in the first case, forwarded outputs will be @ADCxN_clk, otherwise @s_axi_aclk
-    PARAM_x1_FPGA_SAMPLING_RATIO : boolean := false 
+    PARAM_x1_FPGA_SAMPLING_RATIO : boolean := false;
+    --! Defines whether the I/Q samples of antenna 1 are forwarded packed as 'sc12' (true), i.e., four samples in three
+    --! 32-bit words (see 'adc_sc12_packer'), or as 16-bit I & Q values (false [default]); the I/Q frames then always
+    --! start on a group boundary and their length (excluding the header) needs to be a multiple of three words
+    --! [not implemented for the two-antenna configuration].
+    PARAM_SC12_PACKING : boolean := false
   );
   port (
     -- *************************************************************************
@@ -331,8 +336,56 @@ architecture arch_adc_fifo_timestamp_enabler_RTL_impl of adc_fifo_timestamp_enab
   signal adc_valid_3_AXI : std_logic := '0';
   signal fwd_adc_overflow_BBclk_s : std_logic := '0';
 
+  -- sc12 packing related signals; 'in_adc_X' are the inputs of antenna 1 once packed, if enabled
+  signal sc12_valid : std_logic;
+  signal sc12_data_0 : std_logic_vector(15 downto 0);
+  signal sc12_data_1 : std_logic_vector(15 downto 0);
+  signal sc12_group_start : std_logic;
+  signal in_adc_valid_0 : std_logic;
+  signal in_adc_data_0 : std_logic_vector(15 downto 0);
+  signal in_adc_valid_1 : std_logic;
+  signal in_adc_data_1 : std_logic_vector(15 downto 0);
+  signal in_adc_group_start : std_logic;
+  signal adc_group_start_i_i_x1path : std_logic := '0';
+  signal adc_group_start_i_x1path : std_logic := '0';
+  signal adc_group_start_AXI : std_logic := '1';
+
 begin
 
+  -- ***********************************************************
+  -- sc12 packing of the antenna 1 inputs [@ADCxN_clk]
+  -- ***********************************************************
+
+  SC12_packer_inst: if PARAM_SC12_PACKING generate
+    adc_sc12_packer_ins : entity work.adc_sc12_packer
+      port map (
+        ADCxN_clk => ADCxN_clk,
+        ADCxN_reset => ADCxN_reset,
+        adc_valid_0 => adc_valid_0,
+        adc_data_0 => adc_data_0,
+        adc_data_1 => adc_data_1,
+        sc12_valid => sc12_valid,
+        sc12_data_0 => sc12_data_0,
+        sc12_data_1 => sc12_data_1,
+        sc12_group_start => sc12_group_start
+      );
+
+    -- both halves of a packed word are valid at once
+    in_adc_valid_0 <= sc12_valid;
+    in_adc_data_0 <= sc12_data_0;
+    in_adc_valid_1 <= sc12_valid;
+    in_adc_data_1 <= sc12_data_1;
+    in_adc_group_start <= sc12_group_start;
+  end generate SC12_packer_inst;
+
+  SC12_packer_bypass: if not PARAM_SC12_PACKING generate
+    in_adc_valid_0 <= adc_valid_0;
+    in_adc_data_0 <= adc_data_0;
+    in_adc_valid_1 <= adc_valid_1;
+    in_adc_data_1 <= adc_data_1;
+    in_adc_group_start <= '1';
+  end generate SC12_packer_bypass;
+
   -- ***********************************************************
   -- management of the util_ad9361_adc_fifo inputs [@ADCxN_clk]
   -- ***********************************************************
@@ -412,11 +465,11 @@ default_output_processing : if (not PARAM_x1_FPGA_SAMPLING_RATIO) generate
       adc_data_0_i_i <= adc_data_0_i;
       adc_valid_1_i_i <= adc_valid_1_i;
       adc_data_1_i_i <= adc_data_1_i;
-      adc_valid_0_i <= adc_valid_0;
+      adc_valid_0_i <= in_adc_valid_0;
 
       -- ** DEBUGGING-MODE-ONLY CODE **
       if PARAM_DEBUG then
-        if adc_valid_0 = '1' then
+        if in_adc_valid_0 = '1' then
           if adc_data_value_I = cnt_32640_16b then
             adc_data_0_i <= cnt_1_16b;
             adc_data_value_I <= cnt_1_16b;
@@ -426,11 +479,11 @@ default_output_processing : if (not PARAM_x1_FPGA_SAMPLING_RATIO) generate
           end if;
         end if;
       else
-        adc_data_0_i <= adc_data_0;
+        adc_data_0_i <= in_adc_data_0;
       end if;
 
-      adc_valid_1_i <= adc_valid_1;
-      adc_data_1_i <= adc_data_1;
+      adc_valid_1_i <= in_adc_valid_1;
+      adc_data_1_i <= in_adc_data_1;
 
       -- ** TWO-ANTENNA-ONLY CODE **
       if PARAM_TWO_ANTENNA_SUPPORT then
@@ -533,13 +586,19 @@ default_output_processing : if (not PARAM_x1_FPGA_SAMPLING_RATIO) generate
         --  + I/Q data: N-8 32-bit words [16-bit I & 16-bit Q]
 
         -- 1st synchronization header sample insertion; we will start the packetization procedure when there is new adc data to be forwarded and a valid 'x_length' configuration has been passed to the DMA
-        if (adc_valid_0 = '1' or adc_valid_1 = '1') and num_samples_count = cnt_0_16b and (DMA_x_length_valid_int = '1' or DMA_x_length_valid_count > cnt_0_5b) then
+        if (in_adc_valid_0 = '1' or in_adc_valid_1 = '1') and in_adc_group_start = '1' and num_samples_count = cnt_0_16b and (DMA_x_length_valid_int = '1' or DMA_x_length_valid_count > cnt_0_5b) then
           -- we will now convert the DMA's 'x_length' parameter to the current number of samples comprising the I/Q frame + one 64-bit timestamp (+2 32-bit values), as follows:
           --
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = (M+1)/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples (incl. timestamp) = (x_length + 1)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples <= DMA_x_length_plus1(17 downto 2); -- @TO_BE_TESTED: validate we are always obtaining a meaningful value
+          --  + in the two-antenna configuration each sample comprises the I & Q values of both antennas (i.e., 8 bytes),
+          --    hence num_samples (incl. timestamp) = (x_length + 1)/8
+          if PARAM_TWO_ANTENNA_SUPPORT then
+            current_num_samples <= DMA_x_length_plus1(18 downto 3);
+          else
+            current_num_samples <= DMA_x_length_plus1(17 downto 2); -- @TO_BE_TESTED: validate we are always obtaining a meaningful value
+          end if;
 
           r0_sync <= '1';
 
@@ -972,10 +1031,12 @@ CDC_output_processing : if PARAM_x1_FPGA_SAMPLING_RATIO generate
       adc_data_0_i_i_x1path <= adc_data_0_i_x1path;
       adc_valid_1_i_i_x1path <= adc_valid_1_i_x1path;
       adc_data_1_i_i_x1path <= adc_data_1_i_x1path;
-      adc_valid_0_i_x1path <= adc_valid_0;
-      adc_data_0_i_x1path <= adc_data_0;
-      adc_valid_1_i_x1path <= adc_valid_1;
-      adc_data_1_i_x1path <= adc_data_1;
+      adc_group_start_i_i_x1path <= adc_group_start_i_x1path;
+      adc_valid_0_i_x1path <= in_adc_valid_0;
+      adc_data_0_i_x1path <= in_adc_data_0;
+      adc_valid_1_i_x1path <= in_adc_valid_1;
+      adc_data_1_i_x1path <= in_adc_data_1;
+      adc_group_start_i_x1path <= in_adc_group_start;
 
       -- ** TWO-ANTENNA-ONLY CODE **
       if PARAM_TWO_ANTENNA_SUPPORT then
@@ -1034,13 +1095,19 @@ CDC_output_processing : if PARAM_x1_FPGA_SAMPLING_RATIO generate
 
         -- 1st synchronization header sample insertion; we will start the packetization procedure when there is new adc data to be forwarded and a valid 'x_length' configuration has been passed to the DMA
         --if (adc_valid_0_AXI = '1' or adc_valid_1_AXI = '1') and num_samples_count = cnt_0_16b and (DMA_x_length_valid_int_AXI = '1' or DMA_x_length_valid_count_AXI > cnt_0_5b) then
-        if adc_valid_0_AXI = '1' and num_samples_count = cnt_0_16b and (DMA_x_length_valid_int_AXI = '1' or DMA_x_length_valid_count_AXI > cnt_0_5b) then
+        if adc_valid_0_AXI = '1' and adc_group_start_AXI = '1' and num_samples_count = cnt_0_16b and (DMA_x_length_valid_int_AXI = '1' or DMA_x_length_valid_count_AXI > cnt_0_5b) then
           -- we will now convert the DMA's 'x_length' parameter to the current number of samples comprising the I/Q frame + one 64-bit timestamp (+2 32-bit values), as follows:
           --
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = (M+1)/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples (incl. timestamp) = (x_length + 1)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples <= DMA_x_length_plus1(17 downto 2); -- @TO_BE_TESTED: validate we are always obtaining a meaningful value
+          --  + in the two-antenna configuration each sample comprises the I & Q values of both antennas (i.e., 8 bytes),
+          --    hence num_samples (incl. timestamp) = (x_length + 1)/8
+          if PARAM_TWO_ANTENNA_SUPPORT then
+            current_num_samples <= DMA_x_length_plus1(18 downto 3);
+          else
+            current_num_samples <= DMA_x_length_plus1(17 downto 2); -- @TO_BE_TESTED: validate we are always obtaining a meaningful value
+          end if;
 
           -- the first IQ-frame sample will be the 1st synchronization word (MSBs on ADC channel 1, LSBs on ADC channel 0)
           fwd_adc_data_0_s <= cnt_1st_synchronization_word(15 downto 0);
@@ -1351,6 +1418,27 @@ CDC_output_processing : if PARAM_x1_FPGA_SAMPLING_RATIO generate
       dst_data_valid => open --adc_valid_1_AXI
     );
 
+  SC12_FIFO_inst: if PARAM_SC12_PACKING generate
+    -- cross-clock domain sharing of 'adc_group_start_i_i_x1path'; it goes along with the data of port 0
+    synchronizer_adc_group_start_i_i_x1path_ins : entity work.multibit_cross_clock_domain_fifo_synchronizer_resetless
+      generic map (
+        g_DATA_WIDTH => 1,
+        SYNCH_ACTIVE => true -- fixed value
+      )
+      port map (
+        src_clk => ADCxN_clk,
+        src_data(0) => adc_group_start_i_i_x1path,
+        src_data_valid => adc_valid_0_i_i_x1path,
+        dst_clk => s_axi_aclk,
+        dst_data(0) => adc_group_start_AXI,
+        dst_data_valid => open -- not needed
+      );
+  end generate SC12_FIFO_inst;
+
+  SC12_FIFO_bypass: if not PARAM_SC12_PACKING generate
+    adc_group_start_AXI <= '1';
+  end generate SC12_FIFO_bypass;
+
   TWO_ANTENNA_FIFO_inst: if PARAM_TWO_ANTENNA_SUPPORT generate
     -- concurrent assignment of CDC signals
     adc_enable_2_and_3 <= adc_enable_3 & adc_enable_2;
@@ -0,0 +1,98 @@
+--
+-- Copyright 2013-2020 Software Radio Systems Limited
+--
+-- By using this file, you agree to the terms and conditions set
+-- forth in the LICENSE file which can be found at the top level of
+-- the distribution.
+--
+
+library IEEE;
+use IEEE.std_logic_1164.all;
+use IEEE.numeric_std.all;
+
+--! Packs the 12-bit I/Q samples of one antenna (sign-extended to 16 bits by axi_ad9361) as 'sc12': the values are
+--! concatenated as a little-endian bit stream, so that every four I/Q samples (eight 12-bit values) take three 32-bit
+--! words instead of four:
+--!
+--!  + word 0: [11:0] I0, [23:12] Q0, [31:24] I1(7:0)
+--!  + word 1: [3:0] I1(11:8), [15:4] Q1, [27:16] I2, [31:28] Q2(3:0)
+--!  + word 2: [7:0] Q2(11:4), [19:8] I3, [31:20] Q3
+--!
+--! The outputs are combinational on the incoming sample, so that a word is forwarded in the same clock cycle as the
+--! sample completing it; no word is forwarded with the first sample of each group. 'sc12_group_start' flags the first
+--! word of each group, which 'adc_fifo_timestamp_enabler' uses to start every I/Q frame on a group boundary. Since that
+--! word is completed by the second sample of the group, the timestamp of an sc12 frame refers to its second sample.
+
+entity adc_sc12_packer is
+  port (
+    -- **********************************
+		-- clock and reset signals governing the ADC sample provision
+		-- **********************************
+    ADCxN_clk : in std_logic;                              --! ADC clock signal xN.
+    ADCxN_reset : in std_logic;                            --! ADC high-active reset signal.
+
+    -- ****************************
+		-- interface to ADI AD936x
+		-- ****************************
+    adc_valid_0 : in std_logic;                            --! Valid signal for ADC data ports 0 and 1.
+    adc_data_0 : in std_logic_vector(15 downto 0);         --! ADC parallel data port 0 [16-bit I samples, Rx antenna 1].
+    adc_data_1 : in std_logic_vector(15 downto 0);         --! ADC parallel data port 1 [16-bit Q samples, Rx antenna 1].
+
+    -- ****************************
+		-- packed outputs
+		-- ****************************
+    sc12_valid : out std_logic;                            --! Valid signal for the packed word.
+    sc12_data_0 : out std_logic_vector(15 downto 0);       --! LSBs of the packed word.
+    sc12_data_1 : out std_logic_vector(15 downto 0);       --! MSBs of the packed word.
+    sc12_group_start : out std_logic                       --! The packed word is the first of a group of three.
+  );
+end adc_sc12_packer;
+
+architecture arch_adc_sc12_packer_RTL_impl of adc_sc12_packer is
+
+  -- **********************************
+  -- internal signals
+  -- **********************************
+
+  signal phase : unsigned(1 downto 0) := (others => '0');            -- position of the incoming sample in its group
+  signal held_bits : std_logic_vector(23 downto 0) := (others => '0'); -- bits of the previous samples still to be forwarded
+  signal sc12_word : std_logic_vector(31 downto 0);
+
+begin
+
+  -- process storing the bits that do not fit in the current word [@ADCxN_clk]
+  process(ADCxN_clk)
+  begin
+    if rising_edge(ADCxN_clk) then
+      if ADCxN_reset = '1' then -- synchronous high-active reset: initialization of signals
+        phase <= (others => '0');
+        held_bits <= (others => '0');
+      elsif adc_valid_0 = '1' then
+        case phase is
+          when "00" =>
+            held_bits <= adc_data_1(11 downto 0) & adc_data_0(11 downto 0);
+          when "01" =>
+            held_bits(15 downto 0) <= adc_data_1(11 downto 0) & adc_data_0(11 downto 8);
+          when "10" =>
+            held_bits(7 downto 0) <= adc_data_1(11 downto 4);
+          when others =>
+            null;
+        end case;
+        phase <= phase + 1;
+      end if; -- end of reset
+    end if; -- end of clk
+  end process;
+
+  -- concurrent composition of the packed word
+  with phase select sc12_word <=
+    adc_data_0(7 downto 0) & held_bits(23 downto 0) when "01",
+    adc_data_1(3 downto 0) & adc_data_0(11 downto 0) & held_bits(15 downto 0) when "10",
+    adc_data_1(11 downto 0) & adc_data_0(11 downto 0) & held_bits(7 downto 0) when others;
+
+  -- mapping of the internal signals to the corresponding output ports
+  sc12_valid <= adc_valid_0 when phase /= "00" else '0';
+  sc12_data_0 <= sc12_word(15 downto 0);
+  sc12_data_1 <= sc12_word(31 downto 16);
+  sc12_group_start <= '1' when phase = "01" else '0';
+
+end arch_adc_sc12_packer_RTL_impl;
@@ -15,7 +15,8 @@ use ieee.std_logic_textio.all;
 entity adc_timestamp_enabler_packetizer is
   generic (
     c_AXI_ADDR_WIDTH    : integer := 16;
-    c_AXIS_NOF_CHANNELS : integer := 1
+    c_AXIS_NOF_CHANNELS : integer := 1;
+    c_INBAND_STATUS     : boolean := false                           --! When true, the 6th synchronization word is replaced by a status word (see 'status_word' below)
   );
   port (
     -- **********************************
@@ -46,6 +47,13 @@ entity adc_timestamp_enabler_packetizer is
 
     nof_adc_dma_channels : out std_logic_vector(1 downto 0);         --! Number of ADC channels forwarded to a DMA IP
 
+    -- **********************************
+    -- in-band status ports (only used when c_INBAND_STATUS = true)
+    -- **********************************
+    DAC_late_flag : in std_logic := '0';                             --! Late flag provided by the DAC timestamp enabler [@ADCxN_clk, same clock as DACxN_clk]
+    DAC_new_late  : in std_logic := '0';                             --! Valid signal for 'DAC_late_flag'
+    fifo_wr_data_count : in std_logic_vector(31 downto 0) := (others => '0'); --! Fill level of the downstream AXI4-stream data FIFO [@ADCxN_clk]
+
     -- ************************************
     -- AXI4-Lite configuration interface
     -- ************************************
@@ -103,6 +111,8 @@ architecture adc_timestamp_enabler_packetizer_RTL_impl of adc_timestamp_enabler_
   constant cnt_4th_synchronization_word : std_logic_vector(31 downto 0):=x"abcddcba";
   constant cnt_5th_synchronization_word : std_logic_vector(31 downto 0):=x"fedccdef";
   constant cnt_6th_synchronization_word : std_logic_vector(31 downto 0):=x"dfcbaefd";
+  -- marker identifying a status word in place of the 6th synchronization word (c_INBAND_STATUS = true)
+  constant cnt_status_word_marker       : std_logic_vector(7 downto 0):=x"5A";
 
   -- AXI related
   constant AXI_OKAY                     : std_logic_vector(1 downto 0) := "00";
@@ -233,6 +243,14 @@ architecture adc_timestamp_enabler_packetizer_RTL_impl of adc_timestamp_enabler_
   signal pending_forwarding_enable_val    : std_logic;
 
   signal ongoing_packet_generation : std_logic;
+
+  -- in-band status related signals
+  signal late_count : std_logic_vector(7 downto 0) := (others => '0');
+  signal overflow_since_header : std_logic := '0';
+  signal fifo_level_sat : std_logic_vector(14 downto 0);
+  signal status_word : std_logic_vector(31 downto 0);
+  signal status_word_insertion : std_logic;
+  signal sixth_header_word : std_logic_vector(31 downto 0);
   signal last_packet_sample : std_logic;
 
   --signal word_iq_sample_index : unsigned(2 downto 0);
@@ -573,6 +591,38 @@ begin
     end if; -- end of clk
   end process;
 
+  -- process tracking the status reported in-band to the PS: a wrapping count of late DAC bursts and a
+  -- sticky flag set whenever forwarded data is lost because the downstream FIFO cannot accept it (i.e.,
+  -- 'm_axis_tready' low), which is cleared each time it is carried in a packet header
+  process(ADCxN_clk, ADCxN_reset)
+  begin
+    if rising_edge(ADCxN_clk) then
+      if ADCxN_reset = '1' then -- synchronous high-active reset: initialization of signals
+        late_count <= (others => '0');
+        overflow_since_header <= '0';
+      else
+        if DAC_new_late = '1' and DAC_late_flag = '1' then
+          late_count <= std_logic_vector(unsigned(late_count) + 1);
+        end if;
+        -- * NOTE: a data loss event in the same clock cycle as the header insertion is kept for the next packet
+        if status_word_insertion = '1' then
+          overflow_since_header <= '0';
+        end if;
+        if m_axis_tready = '0' and (fwd_adc_valid_0_s = '1' or fwd_adc_valid_2_s = '1') then
+          overflow_since_header <= '1';
+        end if;
+      end if; -- end of reset
+    end if; -- end of clk
+  end process;
+
+  -- the FIFO level is saturated to the 15 bits available in the status word
+  fifo_level_sat <= (others => '1') when unsigned(fifo_wr_data_count) > 32767 else fifo_wr_data_count(14 downto 0);
+  -- status word format: [31:24] marker (0x5A), [23:16] late count, [15] overflow since the previous header, [14:0] FIFO level
+  status_word <= cnt_status_word_marker & late_count & overflow_since_header & fifo_level_sat;
+  status_word_insertion <= '1' when (c_AXIS_NOF_CHANNELS = 2 and num_samples_count = cnt_2_16b) or
+                                    (c_AXIS_NOF_CHANNELS = 1 and num_samples_count = cnt_5_16b) else '0';
+  sixth_header_word <= status_word when c_INBAND_STATUS else cnt_6th_synchronization_word;
+
   current_num_samples <= current_dma_packet_size_ADCclk(15 downto 0);
   -- concurrent calculation of the control-index
   current_num_samples_minus1 <= current_num_samples - cnt_1_16b;
@@ -661,9 +711,9 @@ begin
             fwd_adc_valid_0_s <= '1';
             fwd_adc_data_1_s <= cnt_5th_synchronization_word(31 downto 16);
             fwd_adc_valid_1_s <= '1';
-            fwd_adc_data_2_s <= cnt_6th_synchronization_word(15 downto 0);
+            fwd_adc_data_2_s <= sixth_header_word(15 downto 0);
             fwd_adc_valid_2_s <= '1';
-            fwd_adc_data_3_s <= cnt_6th_synchronization_word(31 downto 16);
+            fwd_adc_data_3_s <= sixth_header_word(31 downto 16);
             fwd_adc_valid_3_s <= '1';
           else
             -- the third IQ-frame sample will be the 3rd synchronization word (MSBs on ADC channel 1, LSBs on ADC channel 0)
@@ -738,9 +788,9 @@ begin
             fwd_adc_valid_3_s <= adc_valid_3_i_i_i;
           else
             -- the sixth IQ-frame sample will be the 6th synchronization word (MSBs on ADC channel 1, LSBs on ADC channel 0)
-            fwd_adc_data_0_s <= cnt_6th_synchronization_word(15 downto 0);
+            fwd_adc_data_0_s <= sixth_header_word(15 downto 0);
             fwd_adc_valid_0_s <= '1';
-            fwd_adc_data_1_s <= cnt_6th_synchronization_word(31 downto 16);
+            fwd_adc_data_1_s <= sixth_header_word(31 downto 16);
             fwd_adc_valid_1_s <= '1';
             fwd_adc_valid_2_s <= '0'; -- @TO_BE_TESTED: during header instertion we want to make sure that data on channel 3 is not accounted as valid
             fwd_adc_valid_3_s <= '0'; -- @TO_BE_TESTED: during header insertion we want to make sure that data on channel 4 is not accounted as valid
@@ -709,6 +709,7 @@ architecture arch_dac_fifo_timestamp_enabler_RTL_impl of dac_fifo_timestamp_enab
   -- x_length related signals
   signal DMA_x_length_int : std_logic_vector(PARAM_DMA_LENGTH_WIDTH-1 downto 0):=(others => '0');
   signal DMA_x_length_minus31 : std_logic_vector(PARAM_DMA_LENGTH_WIDTH-1 downto 0);
+  signal DMA_x_length_num_samples : std_logic_vector(C_NUM_ADDRESS_BITS-1 downto 0);
   signal DMA_x_length_valid_int : std_logic;
   signal DMA_x_length_valid_count : std_logic_vector(4 downto 0):=(others => '0');
   signal DMA_x_length_applied : std_logic:='0';
@@ -899,6 +900,11 @@ begin
   -- concurrent calculation of the 'DMA_x_length_minus31' operand
   DMA_x_length_minus31 <= DMA_x_length_int - cnt_31_DMA_LENGTH_WIDTHbits;
 
+  -- concurrent calculation of the number of samples comprising the I/Q frame: (x_length - 31)/4, or (x_length - 31)/8
+  -- in the two-antenna configuration, where each sample comprises the I & Q values of both antennas (i.e., 8 bytes)
+  DMA_x_length_num_samples <= DMA_x_length_minus31((C_NUM_ADDRESS_BITS+2) downto 3) when PARAM_TWO_ANTENNA_SUPPORT else
+                              DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2);
+
   -- concurrent calculation of the control index values
   current_num_samples_mem0_minus1 <= current_num_samples_mem0 - cnt_1;
   current_num_samples_mem1_minus1 <= current_num_samples_mem1 - cnt_1;
@@ -1272,7 +1278,7 @@ end generate num_samp_min1_10mem;
           timestamp_header_value_mem9(31 downto 0) <= dac_data_1 & dac_data_0; -- LSBs of the first PS value (64-bit timestamp)
         end if;
       -- [state 6b - frame processing]: with the second value of a new I/Q sampel-frame, we will extract the last 32 bits of the associated timestamp and store the remaining values
-      elsif frame_storing_state = cnt_frame_storing_state_PROCESS_FRAME and dac_valid_0 = '1' and dac_valid_1 = '1' and currentframe_processing_started = '0' and first_timestamp_half = '0' and DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2) > cnt_0_C_NUM_ADDRESS_BITS then -- let's make sure that we got a meaningful value in 'DMA_x_length_minus31'
+      elsif frame_storing_state = cnt_frame_storing_state_PROCESS_FRAME and dac_valid_0 = '1' and dac_valid_1 = '1' and currentframe_processing_started = '0' and first_timestamp_half = '0' and DMA_x_length_num_samples > cnt_0_C_NUM_ADDRESS_BITS then -- let's make sure that we got a meaningful value in 'DMA_x_length_minus31'
         currentframe_processing_started <= '1';
         first_timestamp_half <= '1'; -- we do restore the initial value so it will be ready for the next frame
 
@@ -1286,7 +1292,7 @@ end generate num_samp_min1_10mem;
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = M/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples = (x_length - 31)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples_mem0 <= DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2);
+          current_num_samples_mem0 <= DMA_x_length_num_samples;
         elsif current_write_memory = cnt_memory_1 then -- we will write to memory_1
           timestamp_header_value_mem1(63 downto 32) <= dac_data_1 & dac_data_0; -- MSBs of the first PS value (64-bit timestamp)
           PS_DAC_data_RAMB_write_index_memory1 <= (others => '0');
@@ -1296,7 +1302,7 @@ end generate num_samp_min1_10mem;
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = M/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples = (x_length - 31)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples_mem1 <= DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2);
+          current_num_samples_mem1 <= DMA_x_length_num_samples;
         elsif current_write_memory = cnt_memory_2 then -- we will write to memory_2
           timestamp_header_value_mem2(63 downto 32) <= dac_data_1 & dac_data_0; -- MSBs of the first PS value (64-bit timestamp)
           PS_DAC_data_RAMB_write_index_memory2 <= (others => '0');
@@ -1306,7 +1312,7 @@ end generate num_samp_min1_10mem;
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = M/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples = (x_length - 31)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples_mem2 <= DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2);
+          current_num_samples_mem2 <= DMA_x_length_num_samples;
         elsif current_write_memory = cnt_memory_3 then -- we will write to memory_3
           timestamp_header_value_mem3(63 downto 32) <= dac_data_1 & dac_data_0; -- MSBs of the first PS value (64-bit timestamp)
           PS_DAC_data_RAMB_write_index_memory3 <= (others => '0');
@@ -1316,7 +1322,7 @@ end generate num_samp_min1_10mem;
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = M/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples = (x_length - 31)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples_mem3 <= DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2);
+          current_num_samples_mem3 <= DMA_x_length_num_samples;
         elsif current_write_memory = cnt_memory_4 and PARAM_BUFFER_LENGTH >= 5 then -- we will write to memory_4
           timestamp_header_value_mem4(63 downto 32) <= dac_data_1 & dac_data_0; -- MSBs of the first PS value (64-bit timestamp)
           PS_DAC_data_RAMB_write_index_memory4 <= (others => '0');
@@ -1326,7 +1332,7 @@ end generate num_samp_min1_10mem;
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = M/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples = (x_length - 31)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples_mem4 <= DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2);
+          current_num_samples_mem4 <= DMA_x_length_num_samples;
         elsif current_write_memory = cnt_memory_5 and PARAM_BUFFER_LENGTH >= 6 then -- we will write to memory_5
           timestamp_header_value_mem5(63 downto 32) <= dac_data_1 & dac_data_0; -- MSBs of the first PS value (64-bit timestamp)
           PS_DAC_data_RAMB_write_index_memory5 <= (others => '0');
@@ -1336,7 +1342,7 @@ end generate num_samp_min1_10mem;
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = M/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples = (x_length - 31)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples_mem5 <= DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2);
+          current_num_samples_mem5 <= DMA_x_length_num_samples;
         elsif current_write_memory = cnt_memory_6 and PARAM_BUFFER_LENGTH >= 7 then -- we will write to memory_6
           timestamp_header_value_mem6(63 downto 32) <= dac_data_1 & dac_data_0; -- MSBs of the first PS value (64-bit timestamp)
           PS_DAC_data_RAMB_write_index_memory6 <= (others => '0');
@@ -1346,7 +1352,7 @@ end generate num_samp_min1_10mem;
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = M/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples = (x_length - 31)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples_mem6 <= DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2);
+          current_num_samples_mem6 <= DMA_x_length_num_samples;
         elsif current_write_memory = cnt_memory_7 and PARAM_BUFFER_LENGTH >= 8 then -- we will write to memory_7
           timestamp_header_value_mem7(63 downto 32) <= dac_data_1 & dac_data_0; -- MSBs of the first PS value (64-bit timestamp)
           PS_DAC_data_RAMB_write_index_memory7 <= (others => '0');
@@ -1356,7 +1362,7 @@ end generate num_samp_min1_10mem;
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = M/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples = (x_length - 31)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples_mem7 <= DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2);
+          current_num_samples_mem7 <= DMA_x_length_num_samples;
         elsif current_write_memory = cnt_memory_8 and PARAM_BUFFER_LENGTH >= 9 then -- we will write to memory_8
           timestamp_header_value_mem8(63 downto 32) <= dac_data_1 & dac_data_0; -- MSBs of the first PS value (64-bit timestamp)
           PS_DAC_data_RAMB_write_index_memory8 <= (others => '0');
@@ -1366,7 +1372,7 @@ end generate num_samp_min1_10mem;
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = M/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples = (x_length - 31)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples_mem8 <= DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2);
+          current_num_samples_mem8 <= DMA_x_length_num_samples;
         elsif PARAM_BUFFER_LENGTH >= 10 then                                        -- we will write to memory_9
           timestamp_header_value_mem9(63 downto 32) <= dac_data_1 & dac_data_0; -- MSBs of the first PS value (64-bit timestamp)
           PS_DAC_data_RAMB_write_index_memory9 <= (others => '0');
@@ -1376,7 +1382,7 @@ end generate num_samp_min1_10mem;
           --  + x_length = N, where N = M-1 + 32 = M + 31, where M is the number of I/Q-data bytes being forwarded by the DMA
           --  + num_samples = M/4, since each sample comprises one 16-bit I value and one 16-bit Q value (i.e., 4 bytes)
           --  + num_samples = (x_length - 31)/4, where the division is implemented as a 2-position shift to the right
-          current_num_samples_mem9 <= DMA_x_length_minus31((C_NUM_ADDRESS_BITS+1) downto 2);
+          current_num_samples_mem9 <= DMA_x_length_num_samples;
         end if;
       -- [state 6c - frame processing]: storing of the actual I/Q samples received from PS
       elsif frame_storing_state = cnt_frame_storing_state_PROCESS_FRAME and currentframe_processing_started = '1' then
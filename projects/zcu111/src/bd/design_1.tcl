@@ -258,6 +258,9 @@ proc create_root_design { parentCell } {
 
   # Create instance: adc_timestamp_enable_0, and set properties
   set adc_timestamp_enable_0 [ create_bd_cell -type ip -vlnv softwareradiosystems.com:user:adc_timestamp_enabler_packetizer:1.0 adc_timestamp_enable_0 ]
+  set_property -dict [ list \
+   CONFIG.c_INBAND_STATUS {true} \
+ ] $adc_timestamp_enable_0
 
   # Create instance: axi_dma_0, and set properties
   set axi_dma_0 [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_dma:7.1 axi_dma_0 ]
@@ -300,6 +303,7 @@ proc create_root_design { parentCell } {
   set axis_data_fifo_0 [ create_bd_cell -type ip -vlnv xilinx.com:ip:axis_data_fifo:2.0 axis_data_fifo_0 ]
   set_property -dict [ list \
    CONFIG.FIFO_DEPTH {2048} \
+   CONFIG.HAS_WR_DATA_COUNT {1} \
    CONFIG.IS_ACLK_ASYNC {1} \
  ] $axis_data_fifo_0
 
@@ -627,6 +631,13 @@ proc create_root_design { parentCell } {
    CONFIG.NUM_PORTS {8} \
  ] $xlconcat_1
 
+  # Create instance: xlconcat_fifo_count, and set properties
+  set xlconcat_fifo_count [ create_bd_cell -type ip -vlnv xilinx.com:ip:xlconcat:2.1 xlconcat_fifo_count ]
+  set_property -dict [ list \
+   CONFIG.IN0_WIDTH {12} \
+   CONFIG.IN1_WIDTH {20} \
+ ] $xlconcat_fifo_count
+
   # Create instance: xlconstant_0, and set properties
   set xlconstant_0 [ create_bd_cell -type ip -vlnv xilinx.com:ip:xlconstant:1.1 xlconstant_0 ]
 
@@ -674,6 +685,13 @@ proc create_root_design { parentCell } {
    CONFIG.CONST_WIDTH {3} \
  ] $xlconstant_axprot
 
+  # Create instance: xlconstant_fifo_count_msbs, and set properties
+  set xlconstant_fifo_count_msbs [ create_bd_cell -type ip -vlnv xilinx.com:ip:xlconstant:1.1 xlconstant_fifo_count_msbs ]
+  set_property -dict [ list \
+   CONFIG.CONST_VAL {0} \
+   CONFIG.CONST_WIDTH {20} \
+ ] $xlconstant_fifo_count_msbs
+
   # Create instance: zynq_ultra_ps_e_0, and set properties
   set zynq_ultra_ps_e_0 [ create_bd_cell -type ip -vlnv xilinx.com:ip:zynq_ultra_ps_e:3.3 zynq_ultra_ps_e_0 ]
   set_property -dict [ list \
@@ -1400,9 +1418,12 @@ proc create_root_design { parentCell } {
   connect_bd_net -net axi_quad_spi_0_io0_o [get_bd_pins axi_quad_spi_0/io0_o] [get_bd_pins qorvo_spi_ip_0/SPI_MOSI_in]
   connect_bd_net -net axi_quad_spi_0_ip2intc_irpt [get_bd_pins axi_quad_spi_0/ip2intc_irpt] [get_bd_pins xlconcat_0/In3]
   connect_bd_net -net axi_quad_spi_0_sck_o [get_bd_pins axi_quad_spi_0/sck_i] [get_bd_pins axi_quad_spi_0/sck_o] [get_bd_pins qorvo_spi_ip_0/SPI_CLK_in]
+  connect_bd_net -net axis_data_fifo_0_axis_wr_data_count [get_bd_pins axis_data_fifo_0/axis_wr_data_count] [get_bd_pins xlconcat_fifo_count/In0]
   connect_bd_net -net clk_wiz_0_locked [get_bd_pins clk_wiz_0/locked] [get_bd_pins proc_sys_reset_0/dcm_locked] [get_bd_pins proc_sys_reset_1/dcm_locked]
   connect_bd_net -net clk_wiz_0_rfdc_clk [get_bd_pins clk_wiz_0/rfdc_clk] [get_bd_pins proc_sys_reset_1/slowest_sync_clk] [get_bd_pins rfdc_adc_data_decim_0/adc0_axis_mul2_aclk] [get_bd_pins rfdc_dac_data_interp_0/dac0_axis_aclk] [get_bd_pins usp_rf_data_converter_0_i/s1_axis_aclk]
   connect_bd_net -net clk_wiz_0_rfdc_div2_clk [get_bd_pins clk_wiz_0/rfdc_div2_clk] [get_bd_pins proc_sys_reset_0/slowest_sync_clk] [get_bd_pins rfdc_adc_data_decim_0/adc0_axis_aclk] [get_bd_pins usp_rf_data_converter_0_i/m0_axis_aclk]
+  connect_bd_net -net dac_fifo_timestamp_e_0_DAC_late_flag [get_bd_pins adc_timestamp_enable_0/DAC_late_flag] [get_bd_pins dac_fifo_timestamp_e_0/DAC_late_flag]
+  connect_bd_net -net dac_fifo_timestamp_e_0_DAC_new_late [get_bd_pins adc_timestamp_enable_0/DAC_new_late] [get_bd_pins dac_fifo_timestamp_e_0/DAC_new_late]
   connect_bd_net -net dac_fifo_timestamp_e_0_DAC_FSM_new_status [get_bd_pins dac_fifo_timestamp_e_0/DAC_FSM_new_status] [get_bd_pins srs_axi_control_un_0/DAC_FSM_new_status]
   connect_bd_net -net dac_fifo_timestamp_e_0_DAC_FSM_status [get_bd_pins dac_fifo_timestamp_e_0/DAC_FSM_status] [get_bd_pins srs_axi_control_un_0/DAC_FSM_status]
   connect_bd_net -net dac_fifo_timestamp_e_0_fwd_dac_data_0 [get_bd_pins dac_fifo_timestamp_e_0/fwd_dac_data_0] [get_bd_pins rfdc_dac_data_interp_0/dac_data_0]
@@ -1486,6 +1507,7 @@ proc create_root_design { parentCell } {
   connect_bd_net -net util_vector_logic_1_Res [get_bd_pins axis_data_fifo_0/s_axis_aresetn] [get_bd_pins util_vector_logic_1/Res]
   connect_bd_net -net xlconcat_0_dout [get_bd_pins xlconcat_0/dout] [get_bd_pins zynq_ultra_ps_e_0/pl_ps_irq0]
   connect_bd_net -net xlconcat_1_dout [get_bd_pins xlconcat_1/dout] [get_bd_pins zynq_ultra_ps_e_0/pl_ps_irq1]
+  connect_bd_net -net xlconcat_fifo_count_dout [get_bd_pins adc_timestamp_enable_0/fifo_wr_data_count] [get_bd_pins xlconcat_fifo_count/dout]
   connect_bd_net -net xlconstant_0_dout [get_bd_pins adc_timestamp_enable_0/ADC_clk_division] [get_bd_pins dac_fifo_timestamp_e_0/DAC_clk_division] [get_bd_pins timestamp_unit_lclk_0/ADC_clk_division] [get_bd_pins xlconstant_0/dout]
   connect_bd_net -net xlconstant_1_dout [get_bd_pins adc_timestamp_enable_0/adc_data_2] [get_bd_pins adc_timestamp_enable_0/adc_data_3] [get_bd_pins adc_timestamp_enable_0/adc_valid_2] [get_bd_pins adc_timestamp_enable_0/adc_valid_3] [get_bd_pins xlconstant_1/dout]
   connect_bd_net -net xlconstant_2_dout [get_bd_pins dac_fifo_timestamp_e_0/DMA_x_length] [get_bd_pins dac_fifo_timestamp_e_0/DMA_x_length_valid] [get_bd_pins dac_fifo_timestamp_e_0/dac_data_2] [get_bd_pins dac_fifo_timestamp_e_0/dac_data_3] [get_bd_pins dac_fifo_timestamp_e_0/dac_enable_2] [get_bd_pins dac_fifo_timestamp_e_0/dac_enable_3] [get_bd_pins dac_fifo_timestamp_e_0/dac_fifo_unf] [get_bd_pins dac_fifo_timestamp_e_0/dac_valid_2] [get_bd_pins dac_fifo_timestamp_e_0/dac_valid_3] [get_bd_pins xlconstant_2/dout]
@@ -1494,6 +1516,7 @@ proc create_root_design { parentCell } {
   connect_bd_net -net xlconstant_8_dout [get_bd_pins dac_fifo_timestamp_e_0/dac_enable_0] [get_bd_pins dac_fifo_timestamp_e_0/dac_enable_1] [get_bd_pins xlconstant_8/dout]
   connect_bd_net -net xlconstant_axcache_dout [get_bd_pins axi_smc/S00_AXI_awcache] [get_bd_pins xlconstant_axcache/dout]
   connect_bd_net -net xlconstant_axprot_dout [get_bd_pins axi_smc/S00_AXI_awprot] [get_bd_pins xlconstant_axprot/dout]
+  connect_bd_net -net xlconstant_fifo_count_msbs_dout [get_bd_pins xlconcat_fifo_count/In1] [get_bd_pins xlconstant_fifo_count_msbs/dout]
   connect_bd_net -net zynq_ultra_ps_e_0_emio_uart1_txd [get_bd_ports emio_uart1_txd_0] [get_bd_pins zynq_ultra_ps_e_0/emio_uart1_txd]
   connect_bd_net -net zynq_ultra_ps_e_0_pl_clk0 [get_bd_pins adc_timestamp_enable_0/axi_aclk] [get_bd_pins axi_dma_0/m_axi_s2mm_aclk] [get_bd_pins axi_dma_0/s_axi_lite_aclk] [get_bd_pins axi_dma_1/m_axi_mm2s_aclk] [get_bd_pins axi_dma_1/s_axi_lite_aclk] [get_bd_pins axi_quad_spi_0/ext_spi_clk] [get_bd_pins axi_quad_spi_0/s_axi_aclk] [get_bd_pins axi_smc/aclk] [get_bd_pins axi_smc_1/aclk] [get_bd_pins axis_data_fifo_0/m_axis_aclk] [get_bd_pins dac_fifo_timestamp_e_0/s00_axi_aclk] [get_bd_pins dac_fifo_timestamp_e_0/s_axi_aclk] [get_bd_pins dma_depack_channels_0/s_axi_aclk] [get_bd_pins proc_sys_reset_ADC/slowest_sync_clk] [get_bd_pins proc_sys_reset_DAC/slowest_sync_clk] [get_bd_pins proc_sys_reset_sw/slowest_sync_clk] [get_bd_pins ps8_0_axi_periph/ACLK] [get_bd_pins ps8_0_axi_periph/M00_ACLK] [get_bd_pins ps8_0_axi_periph/M01_ACLK] [get_bd_pins ps8_0_axi_periph/M02_ACLK] [get_bd_pins ps8_0_axi_periph/M03_ACLK] [get_bd_pins ps8_0_axi_periph/M04_ACLK] [get_bd_pins ps8_0_axi_periph/M05_ACLK] [get_bd_pins ps8_0_axi_periph/S00_ACLK] [get_bd_pins qorvo_spi_ip_0/clk_in] [get_bd_pins rfdc_adc_data_decim_0/s_axi_aclk] [get_bd_pins rfdc_dac_data_interp_0/s_axi_aclk] [get_bd_pins rst_zynq_ultra_ps_e_0_99M/slowest_sync_clk] [get_bd_pins smartconnect_0/aclk] [get_bd_pins srs_axi_control_un_0/s00_axi_aclk] [get_bd_pins usp_rf_data_converter_0_i/s_axi_aclk] [get_bd_pins zynq_ultra_ps_e_0/maxihpm0_fpd_aclk] [get_bd_pins zynq_ultra_ps_e_0/maxihpm0_lpd_aclk] [get_bd_pins zynq_ultra_ps_e_0/pl_clk0] [get_bd_pins zynq_ultra_ps_e_0/saxihp0_fpd_aclk] [get_bd_pins zynq_ultra_ps_e_0/saxihpc0_fpd_aclk]
   connect_bd_net -net zynq_ultra_ps_e_0_pl_clk2 [get_bd_pins proc_sys_reset_400M/slowest_sync_clk] [get_bd_pins srs_axi_control_un_0/FFT_clk] [get_bd_pins zynq_ultra_ps_e_0/pl_clk2]
@@ -63,6 +63,59 @@ typedef struct {
 
 typedef void (*srsran_rf_error_handler_t)(void* arg, srsran_rf_error_t error);
 
+/* Radio settings that can be scheduled at a given time with srsran_rf_queue_cmd_timed() */
+typedef struct {
+  enum { SRSRAN_RF_CMD_RX_FREQ, SRSRAN_RF_CMD_TX_FREQ, SRSRAN_RF_CMD_RX_GAIN, SRSRAN_RF_CMD_TX_GAIN } type;
+  uint32_t ch;
+  double   value; // frequency in Hz or gain in dB
+} srsran_rf_cmd_t;
+
+/* RX streaming request for srsran_rf_issue_stream_cmd() */
+typedef struct {
+  enum {
+    SRSRAN_RF_STREAM_MODE_START_CONTINUOUS,
+    SRSRAN_RF_STREAM_MODE_NUM_SAMPS_AND_DONE,
+    SRSRAN_RF_STREAM_MODE_STOP
+  } mode;
+  uint64_t nof_samples;   // capture length for SRSRAN_RF_STREAM_MODE_NUM_SAMPS_AND_DONE
+  bool     has_time_spec; // if false, the command takes effect immediately
+  time_t   secs;
+  double   frac_secs;
+} srsran_rf_stream_cmd_t;
+
+/* TX file playback request for srsran_rf_start_playback() */
+typedef struct {
+  const char* file;          // interleaved I/Q samples of channel 0
+  bool        cf32;          // samples are cf32 instead of the native sc16
+  const char* schedule;      // optional burst schedule, NULL to play the whole file as a single burst
+  bool        loop;          // repeat until srsran_rf_stop_playback()
+  double      loop_period;   // seconds between repetitions, 0 to repeat right after the last sample
+  bool        has_time_spec; // if false, the samples are sent untimed
+  time_t      secs;          // radio time of the first sample
+  double      frac_secs;
+} srsran_rf_playback_cfg_t;
+
+/* Signal statistics of the last receive or send call, measured during the sample format conversion */
+typedef struct {
+  uint32_t nof_samples; // samples per channel
+  uint32_t nof_clipped; // I or Q values at full scale on RX, saturated by the conversion on TX, all channels
+  float    power_dbfs;  // mean power relative to full scale (I = 1.0, Q = 0)
+  float    dc_i;        // mean I, full scale is 1.0
+  float    dc_q;        // mean Q
+} srsran_rf_stats_t;
+
+/* What happens to the samples a secondary RX consumer falls behind on, see srsran_rf_open_rx_consumer() */
+typedef enum {
+  SRSRAN_RF_CONSUMER_SKIP = 0, // the consumer skips ahead to the newest samples, the primary stream never waits for it
+  SRSRAN_RF_CONSUMER_HOLD,     // the samples are kept as for the primary stream, a full buffer drops packets for both
+} srsran_rf_consumer_policy_t;
+
+typedef struct {
+  uint64_t lag;          // samples buffered for the consumer
+  uint64_t nof_overruns; // times the consumer skipped ahead
+  uint64_t nof_lost;     // samples skipped
+} srsran_rf_consumer_stats_t;
+
 /* RF frontend API */
 typedef struct {
   const char* name;
@@ -120,6 +173,22 @@ typedef struct {
                                     bool   blocking,
                                     bool   is_start_of_burst,
                                     bool   is_end_of_burst);
+  int (*srsran_rf_queue_cmd_timed)(void* h, const srsran_rf_cmd_t* cmd, time_t secs, double frac_secs);
+  int (*srsran_rf_issue_stream_cmd)(void* h, const srsran_rf_stream_cmd_t* cmd);
+  int (*srsran_rf_start_playback)(void* h, const srsran_rf_playback_cfg_t* cfg);
+  int (*srsran_rf_stop_playback)(void* h);
+  int (*srsran_rf_get_rx_stats)(void* h, srsran_rf_stats_t* stats);
+  int (*srsran_rf_get_tx_stats)(void* h, srsran_rf_stats_t* stats);
+  int (*srsran_rf_recv_history)(void* h, void** data, uint32_t nsamples, time_t secs, double frac_secs);
+  int (*srsran_rf_open_rx_consumer)(void* h, srsran_rf_consumer_policy_t policy);
+  int (*srsran_rf_close_rx_consumer)(void* h, int consumer);
+  int (*srsran_rf_recv_consumer)(void*    h,
+                                 int      consumer,
+                                 void**   data,
+                                 uint32_t nsamples,
+                                 time_t*  secs,
+                                 double*  frac_secs);
+  int (*srsran_rf_get_consumer_stats)(void* h, int consumer, srsran_rf_consumer_stats_t* stats);
 } rf_dev_t;
 
 typedef struct {
@@ -158,6 +227,14 @@ SRSRAN_API int srsran_rf_start_rx_stream(srsran_rf_t* h, bool now);
 
 SRSRAN_API int srsran_rf_stop_rx_stream(srsran_rf_t* h);
 
+/**
+ * Starts, stops or limits the RX stream, optionally at a given radio time. A finite capture delivers exactly
+ * nof_samples samples starting at the requested time; once they have been read, srsran_rf_recv_with_time_multi()
+ * returns the number of samples left in the capture and the device stops streaming until the next command.
+ * Samples buffered before the command are dropped.
+ */
+SRSRAN_API int srsran_rf_issue_stream_cmd(srsran_rf_t* h, const srsran_rf_stream_cmd_t* cmd);
+
 SRSRAN_API void srsran_rf_flush_buffer(srsran_rf_t* h);
 
 SRSRAN_API bool srsran_rf_has_rssi(srsran_rf_t* h);
@@ -208,8 +285,67 @@ SRSRAN_API double srsran_rf_set_tx_freq(srsran_rf_t* h, uint32_t ch, double freq
 
 SRSRAN_API void srsran_rf_get_time(srsran_rf_t* h, time_t* secs, double* frac_secs);
 
+/**
+ * Schedules a frequency or gain change to be applied when the radio time reaches secs + frac_secs, without
+ * stopping the streams. Commands whose time has already passed are applied as soon as possible. The plugins apply them
+ * from their own thread, cmd_lead_us before their time on the hardware clock.
+ * Returns SRSRAN_ERROR if the device doesn't support timed commands or the queue is full.
+ */
+SRSRAN_API int srsran_rf_queue_cmd_timed(srsran_rf_t* h, const srsran_rf_cmd_t* cmd, time_t secs, double frac_secs);
+
 SRSRAN_API int srsran_rf_sync(srsran_rf_t* rf);
 
+/**
+ * Plays a file through the TX path at hardware timestamps from a background thread. The file is memory-mapped and
+ * sc16 samples are handed to the DMA path without any conversion, so files of any size play with constant memory.
+ * The schedule file, if any, holds one burst per line: <offset in seconds from the start time> <first sample>
+ * <number of samples, 0 up to the end of the file>; lines starting with '#' are ignored.
+ * The application must not send samples while the playback is active.
+ */
+SRSRAN_API int srsran_rf_start_playback(srsran_rf_t* h, const srsran_rf_playback_cfg_t* cfg);
+
+SRSRAN_API int srsran_rf_stop_playback(srsran_rf_t* h);
+
+/**
+ * Returns the signal statistics of the last receive (send) call. They are measured while converting the samples, so
+ * they are available at no extra cost. Returns SRSRAN_ERROR if the device doesn't measure them.
+ */
+SRSRAN_API int srsran_rf_get_rx_stats(srsran_rf_t* h, srsran_rf_stats_t* stats);
+
+SRSRAN_API int srsran_rf_get_tx_stats(srsran_rf_t* h, srsran_rf_stats_t* stats);
+
+/**
+ * Reads again nsamples samples per channel starting at the radio time secs + frac_secs from the RX history retained by
+ * the device (rx_history_ms=<ms> device argument), without affecting the stream read by
+ * srsran_rf_recv_with_time_multi(). Returns SRSRAN_ERROR_OUT_OF_BOUNDS if the samples are not, or no longer, retained
+ * and SRSRAN_ERROR if the device doesn't retain any history.
+ */
+SRSRAN_API int srsran_rf_recv_history(srsran_rf_t* h, void** data, uint32_t nsamples, time_t secs, double frac_secs);
+
+/**
+ * Opens a secondary consumer of the RX stream, e.g. a spectrum monitor running next to the modem. Every consumer reads
+ * the stream from the moment it is opened with its own cursor over the samples buffered by the device, which are only
+ * released once all the consumers have read them: the stream is not copied per consumer. With
+ * SRSRAN_RF_CONSUMER_SKIP a consumer that falls behind never stalls the primary one. Returns the consumer index or
+ * SRSRAN_ERROR if the device doesn't support more consumers.
+ */
+SRSRAN_API int srsran_rf_open_rx_consumer(srsran_rf_t* h, srsran_rf_consumer_policy_t policy);
+
+SRSRAN_API int srsran_rf_close_rx_consumer(srsran_rf_t* h, int consumer);
+
+/**
+ * Same as srsran_rf_recv_with_time_multi() (blocking) for a secondary consumer. If the consumer skipped ahead, the
+ * samples already gathered by the call are dropped and the call returns the newest ones.
+ */
+SRSRAN_API int srsran_rf_recv_consumer(srsran_rf_t* h,
+                                       int          consumer,
+                                       void**       data,
+                                       uint32_t     nsamples,
+                                       time_t*      secs,
+                                       double*      frac_secs);
+
+SRSRAN_API int srsran_rf_get_consumer_stats(srsran_rf_t* h, int consumer, srsran_rf_consumer_stats_t* stats);
+
 SRSRAN_API int srsran_rf_send(srsran_rf_t* h, void* data, uint32_t nsamples, bool blocking);
 
 SRSRAN_API int
@@ -0,0 +1,64 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+/******************************************************************************
+ *  File:         async_logger.h
+ *
+ *  Description:  Deferred logging for real-time threads. Once started, the
+ *                DEBUG/INFO/ERROR macros of debug.h no longer format nor
+ *                write anything in the calling thread: they copy the format
+ *                pointer and the arguments (strings by value) to a lock-free
+ *                ring owned by the thread, and a low-priority thread formats
+ *                the records and writes them to stdout/stderr or to the
+ *                registered phy log handler. A record that does not fit in the
+ *                ring is dropped and counted, the caller never blocks. The
+ *                ring of a thread is freed after it exits and its records
+ *                are written.
+ *
+ *  Reference:
+ *****************************************************************************/
+
+#ifndef SRSRAN_ASYNC_LOGGER_H
+#define SRSRAN_ASYNC_LOGGER_H
+
+#include "phy_logger.h"
+#include "srsran/config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+typedef enum { SRSRAN_ASYNC_LOG_STDOUT, SRSRAN_ASYNC_LOG_STDERR, SRSRAN_ASYNC_LOG_HANDLER } srsran_async_log_dest_t;
+
+// Starts the logger thread, or only counts one more user if it already runs
+SRSRAN_API int srsran_async_log_start(void);
+
+// Releases a user of the logger. The last one writes the pending records and stops the logger thread, the macros log
+// synchronously again.
+SRSRAN_API void srsran_async_log_stop(void);
+
+SRSRAN_API bool srsran_async_log_enabled(void);
+
+// Records dropped because the ring of the calling thread was full
+SRSRAN_API uint64_t srsran_async_log_nof_dropped(void);
+
+SRSRAN_API void
+srsran_async_log_push(srsran_async_log_dest_t dest, phy_logger_level_t level, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // SRSRAN_ASYNC_LOGGER_H
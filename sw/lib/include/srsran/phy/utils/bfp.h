@@ -0,0 +1,76 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+/******************************************************************************
+ *  File:         bfp.h
+ *
+ *  Description:  Block floating point compression of interleaved sc16 samples.
+ *                Every block of SRSRAN_BFP_BLOCK_LEN IQ pairs is sent as a byte
+ *                holding the shared exponent (low nibble) followed by the
+ *                mantissas of I and Q, width bits each, packed MSB first.
+ *                A sample is recovered as mantissa << exponent.
+ *
+ *  Reference:    O-RAN.WG4.CUS, Annex A.1.2 (block floating point compression)
+ *****************************************************************************/
+
+#ifndef SRSRAN_BFP_H
+#define SRSRAN_BFP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "srsran/config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SRSRAN_BFP_BLOCK_LEN 16 // IQ pairs sharing an exponent
+#define SRSRAN_BFP_MIN_WIDTH 2
+#define SRSRAN_BFP_MAX_WIDTH 16
+
+static inline bool srsran_bfp_width_valid(uint32_t width)
+{
+  return width >= SRSRAN_BFP_MIN_WIDTH && width <= SRSRAN_BFP_MAX_WIDTH;
+}
+
+// Bytes of a block: the exponent and the 2 * SRSRAN_BFP_BLOCK_LEN mantissas
+static inline uint32_t srsran_bfp_block_size(uint32_t width)
+{
+  return 1 + (2 * SRSRAN_BFP_BLOCK_LEN * width) / 8;
+}
+
+// Bytes taking nof_pairs IQ pairs, the last block is padded
+static inline uint32_t srsran_bfp_size(uint32_t width, uint32_t nof_pairs)
+{
+  return (nof_pairs + SRSRAN_BFP_BLOCK_LEN - 1) / SRSRAN_BFP_BLOCK_LEN * srsran_bfp_block_size(width);
+}
+
+// IQ pairs fitting in size bytes
+static inline uint32_t srsran_bfp_max_pairs(uint32_t width, uint32_t size)
+{
+  return size / srsran_bfp_block_size(width) * SRSRAN_BFP_BLOCK_LEN;
+}
+
+/* Compresses nof_pairs IQ pairs of x into z with width bits mantissas, rounded to the nearest. Returns the number of
+ * bytes written, srsran_bfp_size(width, nof_pairs), or SRSRAN_ERROR if the width is not supported. */
+SRSRAN_API int srsran_bfp_compress(const int16_t* x, uint32_t width, uint8_t* z, uint32_t nof_pairs);
+
+/* Expands nof_pairs IQ pairs compressed with width bits mantissas from x into z. Returns the number of bytes read, or
+ * SRSRAN_ERROR if the width is not supported. */
+SRSRAN_API int srsran_bfp_decompress(const uint8_t* x, uint32_t width, int16_t* z, uint32_t nof_pairs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SRSRAN_BFP_H
@@ -21,6 +21,7 @@
 #ifndef SRSRAN_DEBUG_H
 #define SRSRAN_DEBUG_H
 
+#include "async_logger.h"
 #include "phy_logger.h"
 #include "srsran/config.h"
 #include <stdio.h>
@@ -53,21 +54,41 @@ SRSRAN_API void set_handler_enabled(bool enable);
 #define PRINT_INFO set_srsran_verbose_level(SRSRAN_VERBOSE_INFO)
 #define PRINT_NONE set_srsran_verbose_level(SRSRAN_VERBOSE_NONE)
 
+// Log lines go through the deferred logger when it runs (see async_logger.h), the caller then neither formats nor
+// writes
+#define SRSRAN_LOG_FILE(_dest, _stream, _level, _fmt, ...)                                                             \
+  do {                                                                                                                 \
+    if (srsran_async_log_enabled()) {                                                                                  \
+      srsran_async_log_push(_dest, _level, _fmt, ##__VA_ARGS__);                                                       \
+    } else {                                                                                                           \
+      fprintf(_stream, _fmt, ##__VA_ARGS__);                                                                           \
+    }                                                                                                                  \
+  } while (0)
+
+#define SRSRAN_LOG_HANDLER(_level, _fmt, ...)                                                                          \
+  do {                                                                                                                 \
+    if (!srsran_async_log_enabled()) {                                                                                 \
+      srsran_phy_log_print(_level, _fmt, ##__VA_ARGS__);                                                               \
+    } else if (is_handler_registered()) {                                                                              \
+      srsran_async_log_push(SRSRAN_ASYNC_LOG_HANDLER, _level, _fmt, ##__VA_ARGS__);                                    \
+    }                                                                                                                  \
+  } while (0)
+
 #define DEBUG(_fmt, ...)                                                                                               \
   do {                                                                                                                 \
     if (SRSRAN_DEBUG_ENABLED && get_srsran_verbose_level() >= SRSRAN_VERBOSE_DEBUG && !is_handler_registered()) {      \
-      fprintf(stdout, "[DEBUG]: " _fmt "\n", ##__VA_ARGS__);                                                           \
+      SRSRAN_LOG_FILE(SRSRAN_ASYNC_LOG_STDOUT, stdout, LOG_LEVEL_DEBUG_S, "[DEBUG]: " _fmt "\n", ##__VA_ARGS__);       \
     } else {                                                                                                           \
-      srsran_phy_log_print(LOG_LEVEL_DEBUG_S, _fmt, ##__VA_ARGS__);                                                    \
+      SRSRAN_LOG_HANDLER(LOG_LEVEL_DEBUG_S, _fmt, ##__VA_ARGS__);                                                      \
     }                                                                                                                  \
   } while (0)
 
 #define INFO(_fmt, ...)                                                                                                \
   do {                                                                                                                 \
     if (SRSRAN_DEBUG_ENABLED && get_srsran_verbose_level() >= SRSRAN_VERBOSE_INFO && !is_handler_registered()) {       \
-      fprintf(stdout, "[INFO]: " _fmt "\n", ##__VA_ARGS__);                                                            \
+      SRSRAN_LOG_FILE(SRSRAN_ASYNC_LOG_STDOUT, stdout, LOG_LEVEL_INFO_S, "[INFO]: " _fmt "\n", ##__VA_ARGS__);         \
     } else {                                                                                                           \
-      srsran_phy_log_print(LOG_LEVEL_INFO_S, _fmt, ##__VA_ARGS__);                                                     \
+      SRSRAN_LOG_HANDLER(LOG_LEVEL_INFO_S, _fmt, ##__VA_ARGS__);                                                       \
     }                                                                                                                  \
   } while (0)
 
@@ -76,17 +97,24 @@ SRSRAN_API void set_handler_enabled(bool enable);
 #define ERROR(_fmt, ...)                                                                                               \
   do {                                                                                                                 \
     if (!is_handler_registered()) {                                                                                    \
-      fprintf(stderr, "\e[31m%s:%d: " _fmt "\e[0m\n", __FILE__, __LINE__, ##__VA_ARGS__);                              \
+      SRSRAN_LOG_FILE(SRSRAN_ASYNC_LOG_STDERR,                                                                         \
+                      stderr,                                                                                          \
+                      LOG_LEVEL_ERROR_S,                                                                               \
+                      "\e[31m%s:%d: " _fmt "\e[0m\n",                                                                  \
+                      __FILE__,                                                                                        \
+                      __LINE__,                                                                                        \
+                      ##__VA_ARGS__);                                                                                  \
     } else {                                                                                                           \
-      srsran_phy_log_print(LOG_LEVEL_ERROR_S, _fmt, ##__VA_ARGS__);                                                    \
+      SRSRAN_LOG_HANDLER(LOG_LEVEL_ERROR_S, _fmt, ##__VA_ARGS__);                                                      \
     }                                                                                                                  \
   } while (0)
 #else
 #define ERROR(_fmt, ...)                                                                                               \
   if (!is_handler_registered()) {                                                                                      \
-    fprintf(stderr, "[ERROR in %s]:" _fmt "\n", __FUNCTION__, ##__VA_ARGS__);                                          \
+    SRSRAN_LOG_FILE(                                                                                                   \
+        SRSRAN_ASYNC_LOG_STDERR, stderr, LOG_LEVEL_ERROR_S, "[ERROR in %s]:" _fmt "\n", __FUNCTION__, ##__VA_ARGS__);  \
   } else {                                                                                                             \
-    srsran_phy_log_print(LOG_LEVEL_ERROR, _fmt, ##__VA_ARGS__);                                                        \
+    SRSRAN_LOG_HANDLER(LOG_LEVEL_ERROR, _fmt, ##__VA_ARGS__);                                                          \
   }    //
 #endif /* CMAKE_BUILD_TYPE==Debug */
 
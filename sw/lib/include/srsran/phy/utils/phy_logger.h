@@ -36,6 +36,9 @@ void srsran_phy_log_register_handler(void* ctx, phy_log_handler_t handler);
 
 void srsran_phy_log_print(phy_logger_level_t log_level, const char* format, ...);
 
+// Hands an already formatted line to the registered handler, if any
+void srsran_phy_log_write(phy_logger_level_t log_level, char* str);
+
 #ifdef __cplusplus
 }
 #endif // C++
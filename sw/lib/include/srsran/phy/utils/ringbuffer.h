@@ -18,18 +18,45 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#define SRSRAN_RINGBUFFER_MAX_TAPS 4
+
+// What happens when the writer needs the bytes a tap has not read yet
+typedef enum {
+  SRSRAN_RINGBUFFER_TAP_SKIP = 0, // the tap skips ahead to the write pointer, the writer never waits for it
+  SRSRAN_RINGBUFFER_TAP_HOLD,     // the bytes are kept as for the main reader, the writer waits or drops
+} srsran_ringbuffer_tap_policy_t;
+
+// Secondary read cursor over the bytes of the main reader, see srsran_ringbuffer_tap_open()
+typedef struct {
+  bool                           active;
+  srsran_ringbuffer_tap_policy_t policy;
+  int                            rpm;
+  int                            count;        // bytes written and not yet read through the tap
+  bool                           resync;       // the tap skipped ahead, reported by the next read
+  uint64_t                       nof_overruns; // times the tap skipped ahead
+  uint64_t                       nof_lost;     // bytes skipped
+} srsran_ringbuffer_tap_t;
+
 typedef struct {
-  uint8_t*        buffer;
-  bool            active;
-  int             capacity;
-  int             count;
-  int             wpm;
-  int             rpm;
-  pthread_mutex_t mutex;
-  pthread_cond_t  write_cvar;
-  pthread_cond_t  read_cvar;
+  uint8_t*                buffer;
+  bool                    active;
+  int                     capacity;
+  int                     count;
+  int                     wpm;
+  int                     rpm;
+  pthread_mutex_t         mutex;
+  pthread_cond_t          write_cvar;
+  pthread_cond_t          read_cvar;
+  uint64_t                nof_dropped; // packets rejected by srsran_ringbuffer_write_packet() since init
+  srsran_ringbuffer_tap_t taps[SRSRAN_RINGBUFFER_MAX_TAPS];
 } srsran_ringbuffer_t;
 
+// One part of a packet, a NULL ptr writes nof_bytes zeros
+typedef struct {
+  const void* ptr;
+  int         nof_bytes;
+} srsran_ringbuffer_part_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -58,6 +85,15 @@ SRSRAN_API int srsran_ringbuffer_write_timed(srsran_ringbuffer_t* q, void* ptr,
 SRSRAN_API int
 srsran_ringbuffer_write_timed_block(srsran_ringbuffer_t* q, void* ptr, int nof_bytes, int32_t timeout_ms);
 
+// write the parts of a packet (e.g. a header and its payload) as one unit, either all of them or none. A packet that
+// does not fit within timeout_ms (0 does not wait, negative waits forever) is dropped and counted in nof_dropped
+SRSRAN_API int srsran_ringbuffer_write_packet(srsran_ringbuffer_t*            q,
+                                              const srsran_ringbuffer_part_t* parts,
+                                              int                             nof_parts,
+                                              int32_t                         timeout_ms);
+
+SRSRAN_API uint64_t srsran_ringbuffer_nof_dropped(srsran_ringbuffer_t* q);
+
 // read from buffer, blocking until there is enough samples
 SRSRAN_API int srsran_ringbuffer_read(srsran_ringbuffer_t* q, void* ptr, int nof_bytes);
 
@@ -71,6 +107,26 @@ SRSRAN_API int srsran_ringbuffer_read_convert_conj(srsran_ringbuffer_t* q, cf_t*
 
 SRSRAN_API int srsran_ringbuffer_read_block(srsran_ringbuffer_t* q, void** p, int nof_bytes, int32_t timeout_ms);
 
+// drop up to nof_bytes from the read side without copying them, returns the number of bytes dropped
+SRSRAN_API int srsran_ringbuffer_discard(srsran_ringbuffer_t* q, int nof_bytes);
+
+// Opens a tap: an independent read cursor over the same bytes, starting with the next byte written. The bytes are
+// reclaimed once the main reader and all the taps holding them have read them, so that several consumers share one
+// copy of the data. Taps start and skip ahead at the write pointer, which is a packet boundary as long as the writer
+// only uses srsran_ringbuffer_write_packet(). Returns the tap index or SRSRAN_ERROR if all taps are in use
+SRSRAN_API int srsran_ringbuffer_tap_open(srsran_ringbuffer_t* q, srsran_ringbuffer_tap_policy_t policy);
+
+SRSRAN_API void srsran_ringbuffer_tap_close(srsran_ringbuffer_t* q, int tap);
+
+// read from a tap like srsran_ringbuffer_read_timed(). Returns SRSRAN_ERROR_OUT_OF_BOUNDS, without reading, once after
+// the tap skipped ahead or the buffer was reset: the reader must drop the packet it was reading and resync
+SRSRAN_API int
+srsran_ringbuffer_tap_read_timed(srsran_ringbuffer_t* q, int tap_idx, void* p, int nof_bytes, int32_t timeout_ms);
+
+// bytes waiting to be read through the tap, and the overruns and bytes lost so far
+SRSRAN_API int
+srsran_ringbuffer_tap_stats(srsran_ringbuffer_t* q, int tap, int* count, uint64_t* nof_overruns, uint64_t* nof_lost);
+
 SRSRAN_API void srsran_ringbuffer_stop(srsran_ringbuffer_t* q);
 SRSRAN_API void srsran_ringbuffer_start(srsran_ringbuffer_t* q);
 
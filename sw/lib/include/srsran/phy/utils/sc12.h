@@ -0,0 +1,60 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+/******************************************************************************
+ *  File:         sc12.h
+ *
+ *  Description:  Packed 12 bit samples, the native resolution of the AD936x.
+ *                The values are concatenated as a little endian bit stream:
+ *                value k takes bits [12k, 12k + 12), every pair of values
+ *                takes 3 bytes and four IQ pairs three 32 bit words. This is
+ *                the layout produced by the sc12 packer of the ADC chain, see
+ *                ip/ADI_timestamping/RTL_code/adc_sc12_packer.vhd.
+ *
+ *  Reference:
+ *****************************************************************************/
+
+#ifndef SRSRAN_SC12_H
+#define SRSRAN_SC12_H
+
+#include <stdint.h>
+
+#include "srsran/config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SRSRAN_SC12_MAX 2047
+#define SRSRAN_SC12_MIN (-2048)
+
+// Bytes taking nof_values (an even number) 12 bit values
+static inline uint32_t srsran_sc12_size(uint32_t nof_values)
+{
+  return nof_values / 2 * 3;
+}
+
+/* Expands nof_values (an even number) packed values of x to z, sign extended: the same int16 samples the AD936x
+ * cores deliver when the stream is not packed. */
+SRSRAN_API void srsran_sc12_unpack(const uint8_t* x, int16_t* z, uint32_t nof_values);
+
+/* Same as srsran_sc12_unpack() followed by srsran_vec_convert_if(): z = value / scale, in a single pass. */
+SRSRAN_API void srsran_sc12_unpack_f(const uint8_t* x, float scale, float* z, uint32_t nof_values);
+
+/* Packs nof_values (an even number) values of x to z, rounded from x * scale and saturated to 12 bits. */
+SRSRAN_API void srsran_sc12_pack_f(const float* x, float scale, uint8_t* z, uint32_t nof_values);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SRSRAN_SC12_H
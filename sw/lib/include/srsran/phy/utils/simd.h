@@ -1478,6 +1478,25 @@ static inline simd_s_t srsran_simd_s_zero(void)
 #endif /* LV_HAVE_AVX512 */
 }
 
+static inline simd_s_t srsran_simd_s_set1(int16_t x)
+{
+#ifdef LV_HAVE_AVX512
+  return _mm512_set1_epi16(x);
+#else /* LV_HAVE_AVX512 */
+#ifdef LV_HAVE_AVX2
+  return _mm256_set1_epi16(x);
+#else /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_SSE
+  return _mm_set1_epi16(x);
+#else /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+  return vdupq_n_s16(x);
+#endif /* HAVE_NEON */
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
+}
+
 static inline simd_s_t srsran_simd_s_mul(simd_s_t a, simd_s_t b)
 {
 #ifdef LV_HAVE_AVX512
@@ -1575,6 +1594,144 @@ static inline simd_s_t srsran_simd_s_sub(simd_s_t a, simd_s_t b)
 #endif /* LV_HAVE_AVX512 */
 }
 
+static inline simd_s_t srsran_simd_s_min(simd_s_t a, simd_s_t b)
+{
+#ifdef LV_HAVE_AVX512
+  return _mm512_min_epi16(a, b);
+#else /* LV_HAVE_AVX512 */
+#ifdef LV_HAVE_AVX2
+  return _mm256_min_epi16(a, b);
+#else /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_SSE
+  return _mm_min_epi16(a, b);
+#else /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+  return vminq_s16(a, b);
+#endif /* HAVE_NEON */
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
+}
+
+static inline simd_s_t srsran_simd_s_or(simd_s_t a, simd_s_t b)
+{
+#ifdef LV_HAVE_AVX512
+  return _mm512_or_si512(a, b);
+#else /* LV_HAVE_AVX512 */
+#ifdef LV_HAVE_AVX2
+  return _mm256_or_si256(a, b);
+#else /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_SSE
+  return _mm_or_si128(a, b);
+#else /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+  return vorrq_s16(a, b);
+#endif /* HAVE_NEON */
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
+}
+
+static inline simd_s_t srsran_simd_s_xor(simd_s_t a, simd_s_t b)
+{
+#ifdef LV_HAVE_AVX512
+  return _mm512_xor_si512(a, b);
+#else /* LV_HAVE_AVX512 */
+#ifdef LV_HAVE_AVX2
+  return _mm256_xor_si256(a, b);
+#else /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_SSE
+  return _mm_xor_si128(a, b);
+#else /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+  return veorq_s16(a, b);
+#endif /* HAVE_NEON */
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
+}
+
+static inline simd_s_t srsran_simd_s_sra(simd_s_t a, int shift)
+{
+#ifdef LV_HAVE_AVX512
+  return _mm512_sra_epi16(a, _mm_cvtsi32_si128(shift));
+#else /* LV_HAVE_AVX512 */
+#ifdef LV_HAVE_AVX2
+  return _mm256_sra_epi16(a, _mm_cvtsi32_si128(shift));
+#else /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_SSE
+  return _mm_sra_epi16(a, _mm_cvtsi32_si128(shift));
+#else /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+  return vshlq_s16(a, vdupq_n_s16((int16_t)-shift));
+#endif /* HAVE_NEON */
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
+}
+
+static inline simd_s_t srsran_simd_s_sll(simd_s_t a, int shift)
+{
+#ifdef LV_HAVE_AVX512
+  return _mm512_sll_epi16(a, _mm_cvtsi32_si128(shift));
+#else /* LV_HAVE_AVX512 */
+#ifdef LV_HAVE_AVX2
+  return _mm256_sll_epi16(a, _mm_cvtsi32_si128(shift));
+#else /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_SSE
+  return _mm_sll_epi16(a, _mm_cvtsi32_si128(shift));
+#else /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+  return vshlq_s16(a, vdupq_n_s16((int16_t)shift));
+#endif /* HAVE_NEON */
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
+}
+
+/* Gathers the even 32-bit elements of a in the first half of the register and the odd ones in the second half, e.g. the
+ * I/Q pairs of each of two interleaved channels */
+static inline simd_s_t srsran_simd_s_unzip32(simd_s_t a)
+{
+#ifdef LV_HAVE_AVX512
+  return _mm512_permutexvar_epi32(_mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15), a);
+#else /* LV_HAVE_AVX512 */
+#ifdef LV_HAVE_AVX2
+  return _mm256_permutevar8x32_epi32(a, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+#else /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_SSE
+  return _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0));
+#else /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+  int32x2x2_t t = vtrn_s32(vget_low_s32(vreinterpretq_s32_s16(a)), vget_high_s32(vreinterpretq_s32_s16(a)));
+  return vreinterpretq_s16_s32(vcombine_s32(t.val[0], t.val[1]));
+#endif /* HAVE_NEON */
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
+}
+
+/* Inverse of srsran_simd_s_unzip32(), interleaves the 32-bit elements of both halves of a */
+static inline simd_s_t srsran_simd_s_zip32(simd_s_t a)
+{
+#ifdef LV_HAVE_AVX512
+  return _mm512_permutexvar_epi32(_mm512_setr_epi32(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15), a);
+#else /* LV_HAVE_AVX512 */
+#ifdef LV_HAVE_AVX2
+  return _mm256_permutevar8x32_epi32(a, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+#else /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_SSE
+  return _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0));
+#else /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+  int32x2x2_t t = vzip_s32(vget_low_s32(vreinterpretq_s32_s16(a)), vget_high_s32(vreinterpretq_s32_s16(a)));
+  return vreinterpretq_s16_s32(vcombine_s32(t.val[0], t.val[1]));
+#endif /* HAVE_NEON */
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
+}
+
 #endif /* SRSRAN_SIMD_S_SIZE */
 
 #if SRSRAN_SIMD_C16_SIZE
@@ -1876,6 +2033,30 @@ static inline simd_s_t srsran_simd_convert_2f_s(simd_f_t a, simd_f_t b)
 #endif /* LV_HAVE_AVX512 */
 }
 
+/* Inverse of srsran_simd_convert_2f_s(), a holds the first half of the 16-bit values and b the second one */
+static inline void srsran_simd_convert_s_2f(simd_s_t x, simd_f_t* a, simd_f_t* b)
+{
+#ifdef LV_HAVE_AVX512
+  *a = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm512_castsi512_si256(x)));
+  *b = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm512_extracti64x4_epi64(x, 1)));
+#else /* LV_HAVE_AVX512 */
+#ifdef LV_HAVE_AVX2
+  *a = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(x)));
+  *b = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1)));
+#else
+#ifdef LV_HAVE_SSE
+  *a = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+  *b = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+#else
+#ifdef HAVE_NEON
+  *a = vcvtq_f32_s32(vmovl_s16(vget_low_s16(x)));
+  *b = vcvtq_f32_s32(vmovl_s16(vget_high_s16(x)));
+#endif /* HAVE_NEON */
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
+}
+
 #endif /* SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_C16_SIZE */
 
 #if SRSRAN_SIMD_B_SIZE
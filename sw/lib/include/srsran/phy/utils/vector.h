@@ -48,6 +48,29 @@ extern "C" {
 // Complex squared absolute value
 #define SRSRAN_CSQABS(X) (__real__(X) * __real__(X) + __imag__(X) * __imag__(X))
 
+/* Signal statistics of interleaved I/Q samples, see srsran_vec_convert_if_stats() */
+typedef struct {
+  uint32_t nof_samples; // complex samples
+  uint32_t nof_clipped; // I or Q values at full scale
+  float    sum_power;   // sum of I^2 + Q^2
+  float    sum_i;
+  float    sum_q;
+  float    sum_qq; // sum of Q^2, the I part is sum_power - sum_qq
+  float    sum_iq; // sum of I * Q
+} srsran_vec_stats_t;
+
+/* DC offset and IQ imbalance correction applied by srsran_vec_convert_if_corr():
+ *   I' = m_ii * (I - dc_i) + m_iq * (Q - dc_q)
+ *   Q' = m_qi * (I - dc_i) + m_qq * (Q - dc_q) */
+typedef struct {
+  float dc_i;
+  float dc_q;
+  float m_ii;
+  float m_iq;
+  float m_qi;
+  float m_qq;
+} srsran_vec_iq_corr_t;
+
 // Cumulative moving average
 #define SRSRAN_VEC_CMA(data, average, n) ((average) + ((data) - (average)) / ((n) + 1))
 
@@ -176,6 +199,46 @@ SRSRAN_API void srsran_vec_convert_conj_cs(const cf_t* x, const float scale, int
 SRSRAN_API void srsran_vec_convert_if(const int16_t* x, const float scale, float* z, const uint32_t len);
 SRSRAN_API void srsran_vec_convert_fb(const float* x, const float scale, int8_t* z, const uint32_t len);
 
+/* Conversions between interleaved I/Q int16 and float that accumulate signal statistics in the same pass. Values at
+ * full scale (|x| >= 32767 on RX, saturated to int16 on TX) count as clipped; power and DC are measured on the float
+ * side. len is the number of int16/float values, the statistics are added to those already in stats. */
+SRSRAN_API void srsran_vec_convert_if_stats(const int16_t*      x,
+                                            const float         scale,
+                                            float*              z,
+                                            const uint32_t      len,
+                                            srsran_vec_stats_t* stats);
+SRSRAN_API void srsran_vec_convert_fi_stats(const float*        x,
+                                            const float         scale,
+                                            int16_t*            z,
+                                            const uint32_t      len,
+                                            srsran_vec_stats_t* stats);
+
+/* Same as srsran_vec_convert_if_stats() and srsran_vec_convert_fi_stats() for nof_channels channels whose I/Q pairs are
+ * interleaved in x (RX) or z (TX), one pair of each channel per sample time, as streamed by the multichannel DMAs. The
+ * channels are split or merged in the same pass as the conversion, z[ch] or x[ch] holds nof_samples pairs. The
+ * statistics cover all the channels. Vectorized for 2, 4 and (AVX2 and up) 8 channels, other counts are scalar. */
+SRSRAN_API void srsran_vec_convert_if_deinterleave_stats(const int16_t*      x,
+                                                         const float         scale,
+                                                         float**             z,
+                                                         const uint32_t      nof_channels,
+                                                         const uint32_t      nof_samples,
+                                                         srsran_vec_stats_t* stats);
+SRSRAN_API void srsran_vec_convert_fi_interleave_stats(float* const*       x,
+                                                       const float         scale,
+                                                       int16_t*            z,
+                                                       const uint32_t      nof_channels,
+                                                       const uint32_t      nof_samples,
+                                                       srsran_vec_stats_t* stats);
+
+/* Same as srsran_vec_convert_if_stats() followed by the correction in corr. The statistics are taken before the
+ * correction, so that the estimates derived from them do not depend on the correction in use. len must be even. */
+SRSRAN_API void srsran_vec_convert_if_corr(const int16_t*              x,
+                                           const float                 scale,
+                                           const srsran_vec_iq_corr_t* corr,
+                                           float*                      z,
+                                           const uint32_t              len,
+                                           srsran_vec_stats_t*         stats);
+
 SRSRAN_API void srsran_vec_lut_sss(const short* x, const unsigned short* lut, short* y, const uint32_t len);
 SRSRAN_API void srsran_vec_lut_bbb(const int8_t* x, const unsigned short* lut, int8_t* y, const uint32_t len);
 SRSRAN_API void srsran_vec_lut_sis(const short* x, const unsigned int* lut, short* y, const uint32_t len);
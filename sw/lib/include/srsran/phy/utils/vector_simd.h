@@ -18,6 +18,7 @@ extern "C" {
 #endif
 
 #include "srsran/config.h"
+#include "srsran/phy/utils/vector.h"
 #include <stdint.h>
 #include <stdio.h>
 
@@ -115,6 +116,39 @@ SRSRAN_API void srsran_vec_convert_if_simd(const int16_t* x, float* z, const flo
 
 SRSRAN_API void srsran_vec_convert_fi_simd(const float* x, int16_t* z, const float scale, const int len);
 
+SRSRAN_API void srsran_vec_convert_if_stats_simd(const int16_t*      x,
+                                                 float*              z,
+                                                 const float         scale,
+                                                 const int           len,
+                                                 srsran_vec_stats_t* stats);
+
+SRSRAN_API void srsran_vec_convert_fi_stats_simd(const float*        x,
+                                                 int16_t*            z,
+                                                 const float         scale,
+                                                 const int           len,
+                                                 srsran_vec_stats_t* stats);
+
+SRSRAN_API void srsran_vec_convert_if_deinterleave_stats_simd(const int16_t*      x,
+                                                              float**             z,
+                                                              const float         scale,
+                                                              const int           nof_channels,
+                                                              const int           nof_samples,
+                                                              srsran_vec_stats_t* stats);
+
+SRSRAN_API void srsran_vec_convert_fi_interleave_stats_simd(float* const*       x,
+                                                            int16_t*            z,
+                                                            const float         scale,
+                                                            const int           nof_channels,
+                                                            const int           nof_samples,
+                                                            srsran_vec_stats_t* stats);
+
+SRSRAN_API void srsran_vec_convert_if_corr_simd(const int16_t*              x,
+                                                float*                      z,
+                                                const float                 scale,
+                                                const srsran_vec_iq_corr_t* corr,
+                                                const int                   len,
+                                                srsran_vec_stats_t*         stats);
+
 SRSRAN_API void srsran_vec_convert_conj_cs_simd(const cf_t* x, int16_t* z, const float scale, const int len);
 
 SRSRAN_API void srsran_vec_convert_fb_simd(const float* x, int8_t* z, const float scale, const int len);
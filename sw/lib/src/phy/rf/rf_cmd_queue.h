@@ -0,0 +1,190 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_CMD_QUEUE_H_
+#define SRSRAN_RF_CMD_QUEUE_H_
+
+// Queue of radio commands waiting for the hardware clock to reach their timestamp, shared by the RF plugins
+
+#include "srsran/config.h"
+#include "srsran/phy/rf/rf.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define RF_CMD_QUEUE_LEN 32
+#define RF_CMD_MAX_WAIT_US 10000 // the command threads look at the HW clock at least this often
+
+typedef struct {
+  srsran_rf_cmd_t cmd;
+  uint64_t        tick;   // hardware timestamp at which the command must take effect
+  bool            staged; // the plugin already prepared the command, only the trigger is left
+} rf_timed_cmd_t;
+
+typedef struct {
+  rf_timed_cmd_t  cmds[RF_CMD_QUEUE_LEN]; // sorted by tick, oldest first
+  uint32_t        count;
+  bool            stopped;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cvar; // signalled on every push and on stop
+} rf_cmd_queue_t;
+
+static inline void rf_cmd_queue_init(rf_cmd_queue_t* q)
+{
+  q->count   = 0;
+  q->stopped = false;
+  pthread_mutex_init(&q->mutex, NULL);
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&q->cvar, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+static inline void rf_cmd_queue_free(rf_cmd_queue_t* q)
+{
+  pthread_cond_destroy(&q->cvar);
+  pthread_mutex_destroy(&q->mutex);
+}
+
+// Wakes up and terminates the command thread waiting on the queue
+static inline void rf_cmd_queue_stop(rf_cmd_queue_t* q)
+{
+  pthread_mutex_lock(&q->mutex);
+  q->stopped = true;
+  pthread_cond_broadcast(&q->cvar);
+  pthread_mutex_unlock(&q->mutex);
+}
+
+/*
+ * Called by the command thread: blocks while the queue is empty, otherwise for at most timeout_us or until a command
+ * is pushed, since it may be due before the one the thread is waiting for. Returns false once the queue is stopped.
+ */
+static inline bool rf_cmd_queue_wait(rf_cmd_queue_t* q, uint32_t timeout_us)
+{
+  pthread_mutex_lock(&q->mutex);
+  if (!q->stopped && q->count == 0) {
+    while (!q->stopped && q->count == 0) {
+      pthread_cond_wait(&q->cvar, &q->mutex);
+    }
+  } else if (!q->stopped && timeout_us > 0) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_nsec += (long)timeout_us * 1000;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000;
+    deadline.tv_nsec %= 1000000000;
+    pthread_cond_timedwait(&q->cvar, &q->mutex, &deadline);
+  }
+  bool running = !q->stopped;
+  pthread_mutex_unlock(&q->mutex);
+  return running;
+}
+
+// Tick of the oldest command, if any
+static inline bool rf_cmd_queue_next_tick(rf_cmd_queue_t* q, uint64_t* tick)
+{
+  pthread_mutex_lock(&q->mutex);
+  bool ret = q->count > 0;
+  if (ret) {
+    *tick = q->cmds[0].tick;
+  }
+  pthread_mutex_unlock(&q->mutex);
+  return ret;
+}
+
+// Time until now reaches the tick of the oldest command, bounded by RF_CMD_MAX_WAIT_US, 0 if it is due or none
+static inline uint32_t rf_cmd_queue_wait_us(rf_cmd_queue_t* q, uint64_t now, double srate)
+{
+  uint64_t tick = 0;
+  if (!rf_cmd_queue_next_tick(q, &tick) || tick <= now || srate <= 0) {
+    return 0;
+  }
+  double wait_us = (double)(tick - now) * 1e6 / srate;
+  return wait_us < RF_CMD_MAX_WAIT_US ? (uint32_t)wait_us : RF_CMD_MAX_WAIT_US;
+}
+
+static inline int rf_cmd_queue_push(rf_cmd_queue_t* q, const srsran_rf_cmd_t* cmd, uint64_t tick)
+{
+  pthread_mutex_lock(&q->mutex);
+  if (q->count == RF_CMD_QUEUE_LEN) {
+    pthread_mutex_unlock(&q->mutex);
+    return SRSRAN_ERROR;
+  }
+  // commands with the same tick keep their submission order
+  uint32_t i = q->count;
+  while (i > 0 && q->cmds[i - 1].tick > tick) {
+    i--;
+  }
+  memmove(&q->cmds[i + 1], &q->cmds[i], (q->count - i) * sizeof(rf_timed_cmd_t));
+  if (i == 0 && q->count > 0) {
+    // the new command is staged first and overwrites the settings prepared for the displaced head
+    q->cmds[1].staged = false;
+  }
+  q->cmds[i].cmd    = *cmd;
+  q->cmds[i].tick   = tick;
+  q->cmds[i].staged = false;
+  q->count++;
+  pthread_cond_signal(&q->cvar);
+  pthread_mutex_unlock(&q->mutex);
+  return SRSRAN_SUCCESS;
+}
+
+// Pops the oldest command if its tick has been reached
+static inline bool rf_cmd_queue_pop_due(rf_cmd_queue_t* q, uint64_t now, rf_timed_cmd_t* out)
+{
+  bool ret = false;
+  pthread_mutex_lock(&q->mutex);
+  if (q->count > 0 && q->cmds[0].tick <= now) {
+    *out = q->cmds[0];
+    q->count--;
+    memmove(&q->cmds[0], &q->cmds[1], q->count * sizeof(rf_timed_cmd_t));
+    ret = true;
+  }
+  pthread_mutex_unlock(&q->mutex);
+  return ret;
+}
+
+// Returns the next command to be applied, if not staged yet, and marks it as staged
+static inline bool rf_cmd_queue_stage_next(rf_cmd_queue_t* q, rf_timed_cmd_t* out)
+{
+  bool ret = false;
+  pthread_mutex_lock(&q->mutex);
+  if (q->count > 0 && !q->cmds[0].staged) {
+    q->cmds[0].staged = true;
+    *out              = q->cmds[0];
+    ret               = true;
+  }
+  pthread_mutex_unlock(&q->mutex);
+  return ret;
+}
+
+// Called when the settings were changed outside of the queue, the next command needs to be prepared again
+static inline void rf_cmd_queue_unstage(rf_cmd_queue_t* q)
+{
+  pthread_mutex_lock(&q->mutex);
+  if (q->count > 0) {
+    q->cmds[0].staged = false;
+  }
+  pthread_mutex_unlock(&q->mutex);
+}
+
+static inline uint32_t rf_cmd_queue_clear(rf_cmd_queue_t* q)
+{
+  pthread_mutex_lock(&q->mutex);
+  uint32_t count = q->count;
+  q->count       = 0;
+  pthread_mutex_unlock(&q->mutex);
+  return count;
+}
+
+#endif // SRSRAN_RF_CMD_QUEUE_H_
@@ -23,6 +23,18 @@ static srsran_rf_plugin_t plugin_iio = {"libsrsran_rf_iio.so", NULL, NULL};
 static srsran_rf_plugin_t plugin_rfdc = {"libsrsran_rf_rfdc.so", NULL, NULL};
 #endif
 
+/* Define implementation for the streams shared by another process, built into the RF library */
+#include "rf_shm_imp.h"
+static srsran_rf_plugin_t plugin_shm = {"", NULL, &srsran_rf_dev_shm};
+
+/* Define implementation for the UDP streams of a board, built into the RF library */
+#include "rf_udp_imp.h"
+static srsran_rf_plugin_t plugin_udp = {"", NULL, &srsran_rf_dev_udp};
+
+/* Define implementation for file-based RF, built into the RF library */
+#include "rf_file_imp.h"
+static srsran_rf_plugin_t plugin_file = {"", NULL, &srsran_rf_dev_file};
+
 /**
  * Collection of all currently available RF plugins
  */
@@ -33,4 +45,7 @@ static srsran_rf_plugin_t* rf_plugins[] = {
 #ifdef ENABLE_RFDC
     &plugin_rfdc,
 #endif
+    &plugin_shm,
+    &plugin_udp,
+    &plugin_file,
     NULL};
\ No newline at end of file
@@ -0,0 +1,850 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "rf_file_imp.h"
+#include "rf_helper.h"
+#include "rf_recorder.h"
+#include "srsran/phy/common/phy_common.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+#define RF_FILE_DEFAULT_SRATE 1.92e6
+#define RF_FILE_ZEROS_LEN 4096 // samples written at once to fill the gaps of the raw TX files
+
+typedef struct {
+  uint32_t nof_channels;
+  bool     realtime;
+
+  // RX source, either a SigMF data file with interleaved channels or one raw file per channel
+  FILE*                  rx_files[SRSRAN_MAX_CHANNELS];
+  uint32_t               nof_rx_files;
+  uint32_t               rx_stride;  // channels interleaved in each RX file
+  bool                   owns_files; // the RX file was opened by the device
+  rf_recorder_capture_t* captures;
+  uint32_t               nof_captures;
+  uint32_t               capture_idx;
+  uint64_t               nof_file_samples; // UINT64_MAX for raw streams
+  uint64_t               rx_sample;        // next sample to read from the RX files
+  bool                   rx_eof;
+  int16_t*               rx_buffer;
+  size_t                 rx_buffer_len; // int16 values
+  bool                   fixed_srate;   // the sampling rate comes from the recording
+
+  // HW timestamps count samples at the current rate, every rate change moves the time base to the tick at which it
+  // happened (same scheme as the RFdc plugin)
+  double   srate;
+  uint64_t tstamp_base;
+  time_t   time_base_secs;
+  double   time_base_frac;
+
+  // real-time pacing, the sample at time pace_secs + pace_frac is handed over at wall_start
+  bool            paced;
+  struct timespec wall_start;
+  time_t          pace_secs;
+  double          pace_frac;
+
+  // TX sink, either a SigMF recording or one raw file per channel
+  rf_recorder_t* tx_recorder;
+  FILE*          tx_files[SRSRAN_MAX_CHANNELS];
+  uint32_t       nof_tx_files;
+  uint64_t       tx_next_tstamp; // timestamp of the next sample of the raw TX files
+  int16_t*       tx_buffer;
+  size_t         tx_buffer_len; // int16 values
+
+  double                    rx_gain;
+  double                    tx_gain;
+  double                    rx_freq;
+  double                    tx_freq;
+  srsran_rf_info_t          info;
+  srsran_rf_error_handler_t error_handler;
+  void*                     error_handler_arg;
+} rf_file_handler_t;
+
+static void log_overflow(rf_file_handler_t* h)
+{
+  if (h->error_handler) {
+    srsran_rf_error_t error;
+    bzero(&error, sizeof(srsran_rf_error_t));
+    error.type = SRSRAN_RF_ERROR_OVERFLOW;
+    h->error_handler(h->error_handler_arg, error);
+  }
+}
+
+static void log_late(rf_file_handler_t* h)
+{
+  if (h->error_handler) {
+    srsran_rf_error_t error;
+    bzero(&error, sizeof(srsran_rf_error_t));
+    error.type = SRSRAN_RF_ERROR_LATE;
+    h->error_handler(h->error_handler_arg, error);
+  }
+}
+
+static uint64_t time_to_tstamp(rf_file_handler_t* handler, time_t secs, double frac_secs)
+{
+  secs -= handler->time_base_secs;
+  frac_secs -= handler->time_base_frac;
+  if (frac_secs < 0) {
+    frac_secs += 1.0;
+    secs--;
+  }
+  return handler->tstamp_base + (uint64_t)(handler->srate * ((double)secs)) +
+         (uint64_t)(round(handler->srate * frac_secs));
+}
+
+static void tstamp_to_time(rf_file_handler_t* handler, uint64_t tstamp, time_t* secs, double* frac_secs)
+{
+  uint64_t srate_int = (uint64_t)handler->srate;
+  uint64_t ticks     = (tstamp > handler->tstamp_base) ? tstamp - handler->tstamp_base : 0;
+  if (secs && frac_secs) {
+    *secs      = handler->time_base_secs + ticks / srate_int;
+    *frac_secs = handler->time_base_frac + (double)(ticks % srate_int) / srate_int;
+    if (*frac_secs >= 1.0) {
+      *frac_secs -= 1.0;
+      (*secs)++;
+    }
+  }
+}
+
+static void set_srate(rf_file_handler_t* handler, uint64_t tstamp, double srate)
+{
+  tstamp_to_time(handler, tstamp, &handler->time_base_secs, &handler->time_base_frac);
+  handler->tstamp_base = tstamp;
+  handler->srate       = srate;
+}
+
+// Timestamp of the next RX sample, or of the next TX sample if there is no RX file
+static uint64_t current_tstamp(rf_file_handler_t* handler)
+{
+  if (!handler->nof_rx_files) {
+    return handler->tx_next_tstamp;
+  }
+  rf_recorder_capture_t* c = &handler->captures[handler->capture_idx];
+  return c->tstamp + (handler->rx_sample - c->sample_start);
+}
+
+static bool grow_buffer(int16_t** buffer, size_t* len, size_t min_len)
+{
+  if (*len >= min_len) {
+    return true;
+  }
+  int16_t* tmp = srsran_vec_malloc(min_len * sizeof(int16_t));
+  if (!tmp) {
+    return false;
+  }
+  free(*buffer);
+  *buffer = tmp;
+  *len    = min_len;
+  return true;
+}
+
+/*
+ * SigMF metadata parsing. Only what the recorder writes is supported: flat capture objects holding numbers.
+ */
+static const char* json_find(const char* begin, const char* end, const char* key)
+{
+  char quoted[RF_PARAM_LEN];
+  snprintf(quoted, sizeof(quoted), "\"%s\"", key);
+  const char* p = strstr(begin, quoted);
+  if (!p || p >= end) {
+    return NULL;
+  }
+  p = strchr(p + strlen(quoted), ':');
+  return (p && p < end) ? p + 1 : NULL;
+}
+
+static bool json_uint64(const char* begin, const char* end, const char* key, uint64_t* value)
+{
+  const char* p = json_find(begin, end, key);
+  if (p) {
+    *value = strtoull(p, NULL, 10);
+  }
+  return p != NULL;
+}
+
+static bool json_double(const char* begin, const char* end, const char* key, double* value)
+{
+  const char* p = json_find(begin, end, key);
+  if (p) {
+    *value = strtod(p, NULL);
+  }
+  return p != NULL;
+}
+
+static int parse_captures(rf_file_handler_t* handler, const char* meta, double srate)
+{
+  const char* end = meta + strlen(meta);
+  const char* p   = json_find(meta, end, "captures");
+  const char* arr_end;
+  if (p && (p = strchr(p, '[')) && (arr_end = strchr(p, ']'))) {
+    uint32_t max_captures = 0;
+    while ((p = strchr(p, '{')) && p < arr_end) {
+      const char* obj_end = strchr(p, '}');
+      if (!obj_end) {
+        break;
+      }
+      if (handler->nof_captures == max_captures) {
+        max_captures               = max_captures ? 2 * max_captures : 64;
+        rf_recorder_capture_t* tmp = realloc(handler->captures, max_captures * sizeof(rf_recorder_capture_t));
+        if (!tmp) {
+          return SRSRAN_ERROR;
+        }
+        handler->captures = tmp;
+      }
+      rf_recorder_capture_t* c = &handler->captures[handler->nof_captures];
+      c->sample_start          = 0;
+      c->srate                 = srate;
+      c->freq                  = 0;
+      json_uint64(p, obj_end, "core:sample_start", &c->sample_start);
+      json_double(p, obj_end, "core:frequency", &c->freq);
+      json_double(p, obj_end, "srsran:sample_rate", &c->srate);
+      // recordings from other tools have no HW timestamps, their captures are contiguous
+      if (!json_uint64(p, obj_end, "srsran:hw_timestamp", &c->tstamp)) {
+        c->tstamp = handler->nof_captures ? c[-1].tstamp + (c->sample_start - c[-1].sample_start) : c->sample_start;
+      }
+      if (c->srate <= 0 || (handler->nof_captures && c->sample_start < c[-1].sample_start)) {
+        return SRSRAN_ERROR;
+      }
+      handler->nof_captures++;
+      p = obj_end;
+    }
+  }
+  if (!handler->nof_captures) {
+    // a single capture starting at timestamp 0
+    handler->captures = calloc(1, sizeof(rf_recorder_capture_t));
+    if (!handler->captures || srate <= 0) {
+      return SRSRAN_ERROR;
+    }
+    handler->captures[0].srate = srate;
+    handler->nof_captures      = 1;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+static int load_recording(rf_file_handler_t* handler, const char* base_path)
+{
+  char meta_path[RF_PARAM_LEN + 16];
+  char data_path[RF_PARAM_LEN + 16];
+  snprintf(meta_path, sizeof(meta_path), "%s.sigmf-meta", base_path);
+  snprintf(data_path, sizeof(data_path), "%s.sigmf-data", base_path);
+
+  FILE* f = fopen(meta_path, "r");
+  if (!f) {
+    ERROR("RF_FILE: could not open %s: %s\n", meta_path, strerror(errno));
+    return SRSRAN_ERROR;
+  }
+  fseek(f, 0, SEEK_END);
+  long  len  = ftell(f);
+  char* meta = (len > 0) ? malloc((size_t)len + 1) : NULL;
+  fseek(f, 0, SEEK_SET);
+  if (!meta || fread(meta, 1, (size_t)len, f) != (size_t)len) {
+    ERROR("RF_FILE: could not read %s\n", meta_path);
+    free(meta);
+    fclose(f);
+    return SRSRAN_ERROR;
+  }
+  meta[len] = '\0';
+  fclose(f);
+
+  const char* end          = meta + len;
+  const char* datatype     = json_find(meta, end, "core:datatype");
+  uint64_t    nof_channels = 1;
+  double      srate        = 0;
+  json_uint64(meta, end, "core:num_channels", &nof_channels);
+  json_double(meta, end, "core:sample_rate", &srate);
+  if (!datatype || strncmp(datatype + strspn(datatype, " \t"), "\"ci16_le\"", 9) != 0) {
+    ERROR("RF_FILE: %s is not a ci16_le recording\n", meta_path);
+    free(meta);
+    return SRSRAN_ERROR;
+  }
+  if (nof_channels < handler->nof_channels) {
+    ERROR("RF_FILE: %s has %" PRIu64 " channels, %u requested\n", meta_path, nof_channels, handler->nof_channels);
+    free(meta);
+    return SRSRAN_ERROR;
+  }
+  int ret = parse_captures(handler, meta, srate);
+  free(meta);
+  if (ret < SRSRAN_SUCCESS) {
+    ERROR("RF_FILE: invalid captures in %s\n", meta_path);
+    return SRSRAN_ERROR;
+  }
+
+  handler->rx_files[0] = fopen(data_path, "rb");
+  struct stat st;
+  if (!handler->rx_files[0] || fstat(fileno(handler->rx_files[0]), &st) < 0) {
+    ERROR("RF_FILE: could not open %s: %s\n", data_path, strerror(errno));
+    return SRSRAN_ERROR;
+  }
+  handler->nof_rx_files     = 1;
+  handler->rx_stride        = (uint32_t)nof_channels;
+  handler->owns_files       = true;
+  handler->nof_file_samples = (uint64_t)st.st_size / (2 * sizeof(int16_t) * nof_channels);
+  handler->fixed_srate      = true;
+  handler->srate            = handler->captures[0].srate;
+  handler->rx_freq          = handler->captures[0].freq;
+
+  printf("RF_FILE: replaying %s, %" PRIu64 " samples in %u captures at %.2f MHz\n",
+         data_path,
+         handler->nof_file_samples,
+         handler->nof_captures,
+         handler->srate / 1e6);
+  return SRSRAN_SUCCESS;
+}
+
+static rf_file_handler_t* alloc_handler(uint32_t nof_channels)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)malloc(sizeof(rf_file_handler_t));
+  if (!handler) {
+    perror("malloc");
+    return NULL;
+  }
+  bzero(handler, sizeof(rf_file_handler_t));
+  handler->nof_channels     = nof_channels ? nof_channels : 1;
+  handler->rx_stride        = 1;
+  handler->srate            = RF_FILE_DEFAULT_SRATE;
+  handler->info.min_rx_gain = 0.0;
+  handler->info.max_rx_gain = 90.0;
+  handler->info.min_tx_gain = 0.0;
+  handler->info.max_tx_gain = 90.0;
+  return handler;
+}
+
+const char* rf_file_devname(void* h)
+{
+  return "file";
+}
+
+int rf_file_open(char* args, void** h)
+{
+  return rf_file_open_multi(args, h, 1);
+}
+
+int rf_file_open_multi(char* args, void** h, uint32_t nof_channels)
+{
+  *h = NULL;
+
+  char replay_path[RF_PARAM_LEN] = "";
+  char sink_path[RF_PARAM_LEN]   = "";
+  char clock[RF_PARAM_LEN]       = "afap";
+  parse_string(args, "replay", 0, replay_path);
+  parse_string(args, "sink", 0, sink_path);
+  parse_string(args, "clock", 0, clock);
+  if (replay_path[0] == '\0' && sink_path[0] == '\0') {
+    fprintf(stderr, "RF_FILE: no replay= or sink= argument given\n");
+    return SRSRAN_ERROR;
+  }
+  if (nof_channels > SRSRAN_MAX_CHANNELS) {
+    fprintf(stderr, "RF_FILE: only up to %d channels are supported\n", SRSRAN_MAX_CHANNELS);
+    return SRSRAN_ERROR;
+  }
+  if (strcmp(clock, "afap") != 0 && strcmp(clock, "realtime") != 0) {
+    fprintf(stderr, "RF_FILE: unknown clock mode %s, use afap or realtime\n", clock);
+    return SRSRAN_ERROR;
+  }
+
+  rf_file_handler_t* handler = alloc_handler(nof_channels);
+  if (!handler) {
+    return SRSRAN_ERROR;
+  }
+  *h                = handler;
+  handler->realtime = strcmp(clock, "realtime") == 0;
+
+  if (replay_path[0] != '\0' && load_recording(handler, replay_path) < SRSRAN_SUCCESS) {
+    rf_file_close(handler);
+    *h = NULL;
+    return SRSRAN_ERROR;
+  }
+  if (sink_path[0] != '\0') {
+    handler->tx_recorder = (rf_recorder_t*)malloc(sizeof(rf_recorder_t));
+    if (!handler->tx_recorder || rf_recorder_init(handler->tx_recorder, sink_path, handler->nof_channels) < 0) {
+      free(handler->tx_recorder);
+      handler->tx_recorder = NULL;
+      rf_file_close(handler);
+      *h = NULL;
+      return SRSRAN_ERROR;
+    }
+  }
+  printf("RF_FILE: %s clock\n", handler->realtime ? "real-time" : "as fast as possible");
+  return SRSRAN_SUCCESS;
+}
+
+int rf_file_open_file(void** h, FILE** rx_files, FILE** tx_files, uint32_t nof_channels, uint32_t base_srate)
+{
+  *h = NULL;
+
+  if (nof_channels > SRSRAN_MAX_CHANNELS || base_srate == 0) {
+    fprintf(stderr, "RF_FILE: invalid arguments (nof_channels=%u, base_srate=%u)\n", nof_channels, base_srate);
+    return SRSRAN_ERROR;
+  }
+  rf_file_handler_t* handler = alloc_handler(nof_channels);
+  if (!handler) {
+    return SRSRAN_ERROR;
+  }
+  *h             = handler;
+  handler->srate = base_srate;
+
+  // raw streams have no timestamps, they make a single capture starting at timestamp 0
+  if (rx_files) {
+    handler->captures = calloc(1, sizeof(rf_recorder_capture_t));
+    if (!handler->captures) {
+      rf_file_close(handler);
+      *h = NULL;
+      return SRSRAN_ERROR;
+    }
+    handler->captures[0].srate = base_srate;
+    handler->nof_captures      = 1;
+    handler->nof_file_samples  = UINT64_MAX;
+    handler->nof_rx_files      = handler->nof_channels;
+    for (uint32_t i = 0; i < handler->nof_channels; i++) {
+      handler->rx_files[i] = rx_files[i];
+    }
+  }
+  if (tx_files) {
+    handler->nof_tx_files = handler->nof_channels;
+    for (uint32_t i = 0; i < handler->nof_channels; i++) {
+      handler->tx_files[i] = tx_files[i];
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int rf_file_close(void* h)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+  if (!handler) {
+    return SRSRAN_ERROR;
+  }
+  for (uint32_t i = 0; i < handler->nof_rx_files; i++) {
+    if (handler->owns_files && handler->rx_files[i]) {
+      fclose(handler->rx_files[i]);
+    }
+  }
+  for (uint32_t i = 0; i < handler->nof_tx_files; i++) {
+    if (handler->tx_files[i]) {
+      fflush(handler->tx_files[i]);
+    }
+  }
+  if (handler->tx_recorder) {
+    rf_recorder_free(handler->tx_recorder);
+    free(handler->tx_recorder);
+  }
+  free(handler->captures);
+  free(handler->rx_buffer);
+  free(handler->tx_buffer);
+  free(handler);
+  return SRSRAN_SUCCESS;
+}
+
+int rf_file_start_rx_stream(void* h, bool now)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+  // the real-time clock starts with the first sample received
+  handler->paced = false;
+  return SRSRAN_SUCCESS;
+}
+
+int rf_file_stop_rx_stream(void* h)
+{
+  return SRSRAN_SUCCESS;
+}
+
+void rf_file_flush_buffer(void* h)
+{
+  // nothing is buffered
+}
+
+bool rf_file_has_rssi(void* h)
+{
+  return false;
+}
+
+float rf_file_get_rssi(void* h)
+{
+  return 0.0f;
+}
+
+void rf_file_suppress_stdout(void* h)
+{
+  // do nothing
+}
+
+void rf_file_register_error_handler(void* h, srsran_rf_error_handler_t error_handler, void* arg)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+  handler->error_handler     = error_handler;
+  handler->error_handler_arg = arg;
+}
+
+double rf_file_set_rx_srate(void* h, double freq)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+  if (handler->fixed_srate) {
+    if (fabs(freq - handler->srate) > 1.0) {
+      printf("RF_FILE: the recording runs at %.2f MHz, ignoring %.2f MHz\n", handler->srate / 1e6, freq / 1e6);
+    }
+  } else if (freq > 0 && freq != handler->srate) {
+    set_srate(handler, current_tstamp(handler), freq);
+    if (handler->nof_captures) {
+      handler->captures[0].srate = freq;
+    }
+  }
+  return handler->srate;
+}
+
+double rf_file_set_tx_srate(void* h, double freq)
+{
+  // RX and TX share the timeline
+  return rf_file_set_rx_srate(h, freq);
+}
+
+int rf_file_set_rx_gain(void* h, double gain)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+  handler->rx_gain           = gain;
+  return SRSRAN_SUCCESS;
+}
+
+int rf_file_set_tx_gain(void* h, double gain)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+  handler->tx_gain           = gain;
+  return SRSRAN_SUCCESS;
+}
+
+double rf_file_get_rx_gain(void* h)
+{
+  return ((rf_file_handler_t*)h)->rx_gain;
+}
+
+double rf_file_get_tx_gain(void* h)
+{
+  return ((rf_file_handler_t*)h)->tx_gain;
+}
+
+srsran_rf_info_t* rf_file_get_info(void* h)
+{
+  return &((rf_file_handler_t*)h)->info;
+}
+
+double rf_file_set_rx_freq(void* h, uint32_t ch, double freq)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+  handler->rx_freq           = freq;
+  return freq;
+}
+
+double rf_file_set_tx_freq(void* h, uint32_t ch, double freq)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+  handler->tx_freq           = freq;
+  if (handler->tx_recorder) {
+    rf_recorder_set_freq(handler->tx_recorder, freq, RF_RECORDER_NO_TSTAMP);
+  }
+  return freq;
+}
+
+static double elapsed_secs(time_t secs, double frac_secs, time_t ref_secs, double ref_frac_secs)
+{
+  return (double)(secs - ref_secs) + (frac_secs - ref_frac_secs);
+}
+
+void rf_file_get_time(void* h, time_t* secs, double* frac_secs)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+  if (handler->realtime && handler->paced) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = (double)(now.tv_sec - handler->wall_start.tv_sec) +
+                     (double)(now.tv_nsec - handler->wall_start.tv_nsec) * 1e-9 + handler->pace_frac;
+    *secs      = handler->pace_secs + (time_t)floor(elapsed);
+    *frac_secs = elapsed - floor(elapsed);
+  } else {
+    tstamp_to_time(handler, current_tstamp(handler), secs, frac_secs);
+  }
+}
+
+// Waits until the sample at tstamp is due on the recorded timeline
+static void pace(rf_file_handler_t* handler, uint64_t tstamp)
+{
+  time_t secs;
+  double frac_secs;
+  tstamp_to_time(handler, tstamp, &secs, &frac_secs);
+  if (!handler->paced) {
+    clock_gettime(CLOCK_MONOTONIC, &handler->wall_start);
+    handler->pace_secs = secs;
+    handler->pace_frac = frac_secs;
+    handler->paced     = true;
+    return;
+  }
+  double          elapsed  = elapsed_secs(secs, frac_secs, handler->pace_secs, handler->pace_frac);
+  struct timespec deadline = handler->wall_start;
+  deadline.tv_sec += (time_t)floor(elapsed);
+  deadline.tv_nsec += (long)((elapsed - floor(elapsed)) * 1e9);
+  if (deadline.tv_nsec >= 1000000000L) {
+    deadline.tv_nsec -= 1000000000L;
+    deadline.tv_sec++;
+  }
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+}
+
+static void enter_capture(rf_file_handler_t* handler, uint32_t idx)
+{
+  rf_recorder_capture_t* prev     = &handler->captures[idx - 1];
+  rf_recorder_capture_t* c        = &handler->captures[idx];
+  uint64_t               expected = prev->tstamp + (c->sample_start - prev->sample_start);
+
+  handler->capture_idx = idx;
+  if (c->srate != handler->srate) {
+    // the new rate took effect with the first sample of the capture
+    set_srate(handler, c->tstamp, c->srate);
+    printf("RF_FILE: sampling rate changes to %.2f MHz\n", c->srate / 1e6);
+  }
+  if (c->tstamp != expected) {
+    // the live device lost these samples, report it the same way
+    log_overflow(handler);
+  }
+}
+
+// Reads n samples of every channel into data at offset, returns the number of samples read
+static size_t read_samples(rf_file_handler_t* handler, cf_t** data, uint32_t offset, uint32_t n)
+{
+  uint32_t stride = handler->rx_stride;
+  if (!grow_buffer(&handler->rx_buffer, &handler->rx_buffer_len, 2 * (size_t)n * stride)) {
+    return 0;
+  }
+  size_t nof_read = n;
+  for (uint32_t f = 0; f < handler->nof_rx_files; f++) {
+    size_t r = fread(handler->rx_buffer, 2 * sizeof(int16_t) * stride, n, handler->rx_files[f]);
+    nof_read = SRSRAN_MIN(nof_read, r);
+    for (uint32_t c = 0; c < stride; c++) {
+      uint32_t ch = f * stride + c;
+      if (ch >= handler->nof_channels || !data[ch]) {
+        continue;
+      }
+      float* dst = (float*)&data[ch][offset];
+      if (stride == 1) {
+        srsran_vec_convert_if(handler->rx_buffer, 32768, dst, 2 * r);
+      } else {
+        for (size_t i = 0; i < r; i++) {
+          dst[2 * i]     = (float)handler->rx_buffer[2 * (i * stride + c)] / 32768;
+          dst[2 * i + 1] = (float)handler->rx_buffer[2 * (i * stride + c) + 1] / 32768;
+        }
+      }
+    }
+  }
+  return nof_read;
+}
+
+int rf_file_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  return rf_file_recv_with_time_multi(h, &data, nsamples, blocking, secs, frac_secs);
+}
+
+int rf_file_recv_with_time_multi(void*    h,
+                                 void**   data,
+                                 uint32_t nsamples,
+                                 bool     blocking,
+                                 time_t*  secs,
+                                 double*  frac_secs)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+
+  if (!handler->nof_rx_files || handler->rx_eof) {
+    return SRSRAN_ERROR;
+  }
+
+  // like the live devices, a read may span a gap, the timestamp is the one of the first sample
+  uint64_t tstamp = 0;
+  uint32_t total  = 0;
+  while (total < nsamples) {
+    uint32_t idx     = handler->capture_idx;
+    uint64_t cap_end = (idx + 1 < handler->nof_captures) ? handler->captures[idx + 1].sample_start
+                                                         : handler->nof_file_samples;
+    if (handler->rx_sample >= cap_end) {
+      if (idx + 1 >= handler->nof_captures) {
+        handler->rx_eof = true;
+        break;
+      }
+      enter_capture(handler, idx + 1);
+      continue;
+    }
+    uint32_t n = (uint32_t)SRSRAN_MIN(nsamples - total, cap_end - handler->rx_sample);
+    if (!total) {
+      tstamp = current_tstamp(handler);
+      if (handler->realtime && !handler->paced) {
+        pace(handler, tstamp);
+      }
+    }
+    size_t nof_read = read_samples(handler, (cf_t**)data, total, n);
+    handler->rx_sample += nof_read;
+    total += nof_read;
+    if (nof_read < n) {
+      handler->rx_eof = true;
+      break;
+    }
+  }
+  if (handler->rx_eof) {
+    printf("RF_FILE: end of the recording after %" PRIu64 " samples\n", handler->rx_sample);
+  }
+  if (!total) {
+    return SRSRAN_ERROR;
+  }
+  if (handler->realtime) {
+    pace(handler, current_tstamp(handler));
+  }
+  tstamp_to_time(handler, tstamp, secs, frac_secs);
+  return (int)total;
+}
+
+int rf_file_send_timed(void*  h,
+                       void*  data,
+                       int    nsamples,
+                       time_t secs,
+                       double frac_secs,
+                       bool   has_time_spec,
+                       bool   blocking,
+                       bool   is_start_of_burst,
+                       bool   is_end_of_burst)
+{
+  void* _data[SRSRAN_MAX_CHANNELS] = {data};
+  return rf_file_send_timed_multi(
+      h, _data, nsamples, secs, frac_secs, has_time_spec, blocking, is_start_of_burst, is_end_of_burst);
+}
+
+// Appends n samples to the raw TX files, zero-filling the files up to tstamp
+static void write_raw(rf_file_handler_t* handler, cf_t** data, uint32_t n, uint64_t tstamp)
+{
+  uint64_t nof_zeros = tstamp - handler->tx_next_tstamp;
+  if (!grow_buffer(&handler->tx_buffer, &handler->tx_buffer_len, 2 * (size_t)SRSRAN_MAX(n, RF_FILE_ZEROS_LEN))) {
+    return;
+  }
+  for (uint32_t ch = 0; ch < handler->nof_tx_files; ch++) {
+    FILE* f = handler->tx_files[ch];
+    if (!f) {
+      continue;
+    }
+    bzero(handler->tx_buffer, 2 * sizeof(int16_t) * RF_FILE_ZEROS_LEN);
+    for (uint64_t i = 0; i < nof_zeros; i += RF_FILE_ZEROS_LEN) {
+      fwrite(handler->tx_buffer, 2 * sizeof(int16_t), (size_t)SRSRAN_MIN(RF_FILE_ZEROS_LEN, nof_zeros - i), f);
+    }
+    if (data[ch]) {
+      srsran_vec_convert_fi((const float*)data[ch], 32767.999f, handler->tx_buffer, 2 * n);
+    } else {
+      bzero(handler->tx_buffer, 2 * sizeof(int16_t) * n);
+    }
+    fwrite(handler->tx_buffer, 2 * sizeof(int16_t), n, f);
+  }
+  handler->tx_next_tstamp = tstamp + n;
+}
+
+// Stores n samples in the SigMF sink, interleaving the channels
+static void write_recorder(rf_file_handler_t* handler, cf_t** data, uint32_t n, uint64_t tstamp)
+{
+  uint32_t nof_channels = handler->nof_channels;
+  size_t   len          = 2 * (size_t)n * nof_channels;
+  if (!grow_buffer(&handler->tx_buffer, &handler->tx_buffer_len, nof_channels > 1 ? len + 2 * (size_t)n : len)) {
+    return;
+  }
+  int16_t* tmp = &handler->tx_buffer[len];
+  for (uint32_t ch = 0; ch < nof_channels; ch++) {
+    int16_t* dst = (nof_channels > 1) ? tmp : handler->tx_buffer;
+    if (data[ch]) {
+      srsran_vec_convert_fi((const float*)data[ch], 32767.999f, dst, 2 * n);
+    } else {
+      bzero(dst, 2 * sizeof(int16_t) * n);
+    }
+    for (uint32_t i = 0; nof_channels > 1 && i < n; i++) {
+      handler->tx_buffer[2 * (i * nof_channels + ch)]     = tmp[2 * i];
+      handler->tx_buffer[2 * (i * nof_channels + ch) + 1] = tmp[2 * i + 1];
+    }
+  }
+  rf_recorder_push(handler->tx_recorder, tstamp, handler->srate, handler->tx_buffer, n);
+}
+
+int rf_file_send_timed_multi(void*  h,
+                             void** data,
+                             int    nsamples,
+                             time_t secs,
+                             double frac_secs,
+                             bool   has_time_spec,
+                             bool   blocking,
+                             bool   is_start_of_burst,
+                             bool   is_end_of_burst)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+
+  if (nsamples <= 0 || (!handler->tx_recorder && !handler->nof_tx_files)) {
+    // no sink, the samples are discarded
+    return nsamples;
+  }
+
+  uint64_t tstamp = has_time_spec ? time_to_tstamp(handler, secs, frac_secs) : RF_RECORDER_NO_TSTAMP;
+  if (has_time_spec && handler->nof_rx_files && tstamp < current_tstamp(handler)) {
+    // the application is behind the replayed timeline, a live device would drop the burst too
+    log_late(handler);
+    return nsamples;
+  }
+
+  if (handler->tx_recorder) {
+    write_recorder(handler, (cf_t**)data, (uint32_t)nsamples, tstamp);
+  } else {
+    if (tstamp == RF_RECORDER_NO_TSTAMP) {
+      tstamp = handler->tx_next_tstamp;
+    }
+    if (tstamp < handler->tx_next_tstamp) {
+      // overlaps the previous burst
+      log_late(handler);
+      return nsamples;
+    }
+    write_raw(handler, (cf_t**)data, (uint32_t)nsamples, tstamp);
+  }
+  return nsamples;
+}
+
+rf_dev_t srsran_rf_dev_file = {"file",
+                               rf_file_devname,
+                               rf_file_start_rx_stream,
+                               rf_file_stop_rx_stream,
+                               rf_file_flush_buffer,
+                               rf_file_has_rssi,
+                               rf_file_get_rssi,
+                               rf_file_suppress_stdout,
+                               rf_file_register_error_handler,
+                               rf_file_open,
+                               rf_file_open_multi,
+                               rf_file_close,
+                               rf_file_set_rx_srate,
+                               rf_file_set_rx_gain,
+                               NULL,
+                               rf_file_set_tx_gain,
+                               NULL,
+                               rf_file_get_rx_gain,
+                               rf_file_get_tx_gain,
+                               rf_file_get_info,
+                               rf_file_set_rx_freq,
+                               rf_file_set_tx_srate,
+                               rf_file_set_tx_freq,
+                               rf_file_get_time,
+                               NULL,
+                               rf_file_recv_with_time,
+                               rf_file_recv_with_time_multi,
+                               rf_file_send_timed,
+                               .srsran_rf_send_timed_multi = rf_file_send_timed_multi};
@@ -0,0 +1,105 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_FILE_IMP_H_
+#define SRSRAN_RF_FILE_IMP_H_
+
+// File-based RF device, built into the RF library. RX samples are replayed from a recording made with the record=
+// argument of the RF plugins (or any ci16_le SigMF recording), keeping the original HW timestamps and the gaps between
+// captures, and TX samples are stored in a sink file with their timestamps. Device arguments:
+//   replay=<base path>  RX recording, <base path>.sigmf-data and <base path>.sigmf-meta
+//   sink=<base path>    TX sink, written as a SigMF recording
+//   clock=afap|realtime afap (default) hands the samples over as fast as the application reads them, realtime paces
+//                       them to the recorded timeline
+// srsran_rf_open_file() takes raw sc16 streams instead, one per channel and without timestamps.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "srsran/config.h"
+#include "srsran/phy/rf/rf.h"
+#include "time.h"
+
+extern rf_dev_t srsran_rf_dev_file;
+
+SRSRAN_API int rf_file_open(char* args, void** handler);
+
+SRSRAN_API int rf_file_open_multi(char* args, void** handler, uint32_t nof_channels);
+
+SRSRAN_API int
+rf_file_open_file(void** handler, FILE** rx_files, FILE** tx_files, uint32_t nof_channels, uint32_t base_srate);
+
+SRSRAN_API const char* rf_file_devname(void* h);
+
+SRSRAN_API int rf_file_close(void* h);
+
+SRSRAN_API int rf_file_start_rx_stream(void* h, bool now);
+
+SRSRAN_API int rf_file_stop_rx_stream(void* h);
+
+SRSRAN_API void rf_file_flush_buffer(void* h);
+
+SRSRAN_API bool rf_file_has_rssi(void* h);
+
+SRSRAN_API float rf_file_get_rssi(void* h);
+
+SRSRAN_API void rf_file_suppress_stdout(void* h);
+
+SRSRAN_API void rf_file_register_error_handler(void* h, srsran_rf_error_handler_t error_handler, void* arg);
+
+SRSRAN_API double rf_file_set_rx_srate(void* h, double freq);
+
+SRSRAN_API int rf_file_set_rx_gain(void* h, double gain);
+
+SRSRAN_API double rf_file_get_rx_gain(void* h);
+
+SRSRAN_API int rf_file_set_tx_gain(void* h, double gain);
+
+SRSRAN_API double rf_file_get_tx_gain(void* h);
+
+SRSRAN_API srsran_rf_info_t* rf_file_get_info(void* h);
+
+SRSRAN_API double rf_file_set_rx_freq(void* h, uint32_t ch, double freq);
+
+SRSRAN_API double rf_file_set_tx_srate(void* h, double freq);
+
+SRSRAN_API double rf_file_set_tx_freq(void* h, uint32_t ch, double freq);
+
+SRSRAN_API void rf_file_get_time(void* h, time_t* secs, double* frac_secs);
+
+SRSRAN_API int
+rf_file_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs);
+
+SRSRAN_API int
+rf_file_recv_with_time_multi(void* h, void** data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs);
+
+SRSRAN_API int rf_file_send_timed(void*  h,
+                                  void*  data,
+                                  int    nsamples,
+                                  time_t secs,
+                                  double frac_secs,
+                                  bool   has_time_spec,
+                                  bool   blocking,
+                                  bool   is_start_of_burst,
+                                  bool   is_end_of_burst);
+
+SRSRAN_API int rf_file_send_timed_multi(void*  h,
+                                        void** data,
+                                        int    nsamples,
+                                        time_t secs,
+                                        double frac_secs,
+                                        bool   has_time_spec,
+                                        bool   blocking,
+                                        bool   is_start_of_burst,
+                                        bool   is_end_of_burst);
+
+#endif // SRSRAN_RF_FILE_IMP_H_
@@ -16,6 +16,7 @@
 
 #include "srsran/config.h"
 #include "srsran/phy/rf/rf.h"
+#include "srsran/phy/utils/vector.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -131,4 +132,14 @@ static inline int parse_int32(char* args, const char* config_arg_base, int chann
   return ret;
 }
 
+// Derives the statistics reported by srsran_rf_get_rx_stats() from the ones accumulated by the conversion functions
+static inline void rf_stats_from_vec(const srsran_vec_stats_t* v, uint32_t nof_channels, srsran_rf_stats_t* stats)
+{
+  stats->nof_samples = nof_channels ? v->nof_samples / nof_channels : 0;
+  stats->nof_clipped = v->nof_clipped;
+  stats->power_dbfs  = v->nof_samples ? srsran_convert_power_to_dB(v->sum_power / v->nof_samples) : -INFINITY;
+  stats->dc_i        = v->nof_samples ? v->sum_i / v->nof_samples : 0.0f;
+  stats->dc_q        = v->nof_samples ? v->sum_q / v->nof_samples : 0.0f;
+}
+
 #endif /* SRSRAN_RF_HELPER_H_ */
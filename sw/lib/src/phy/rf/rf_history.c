@@ -0,0 +1,150 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rf_history.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+// The window moves as a whole: readers that overlap with the move see an odd or a different sequence number
+static void window_move_begin(rf_history_t* h)
+{
+  __atomic_store_n(&h->seq, h->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void window_move_end(rf_history_t* h)
+{
+  __atomic_store_n(&h->seq, h->seq + 1, __ATOMIC_RELEASE);
+}
+
+void rf_history_init(rf_history_t* h, uint32_t history_ms, uint32_t sample_size)
+{
+  memset(h, 0, sizeof(rf_history_t));
+  pthread_mutex_init(&h->mutex, NULL);
+  h->history_ms  = history_ms;
+  h->sample_size = sample_size;
+}
+
+void rf_history_free(rf_history_t* h)
+{
+  pthread_mutex_lock(&h->mutex);
+  free(h->buffer);
+  h->buffer   = NULL;
+  h->capacity = 0;
+  pthread_mutex_unlock(&h->mutex);
+  pthread_mutex_destroy(&h->mutex);
+}
+
+int rf_history_set_srate(rf_history_t* h, double srate)
+{
+  if (!rf_history_enabled(h)) {
+    return SRSRAN_SUCCESS;
+  }
+  uint32_t capacity = (uint32_t)ceil(h->history_ms * srate / 1000.0);
+  if (capacity == h->capacity) {
+    rf_history_reset(h);
+    return SRSRAN_SUCCESS;
+  }
+
+  int ret = SRSRAN_SUCCESS;
+  pthread_mutex_lock(&h->mutex);
+  window_move_begin(h);
+  free(h->buffer);
+  h->buffer   = malloc((size_t)capacity * h->sample_size);
+  h->capacity = h->buffer ? capacity : 0;
+  h->start    = 0;
+  h->end      = 0;
+  window_move_end(h);
+  pthread_mutex_unlock(&h->mutex);
+  if (h->buffer == NULL) {
+    ERROR("RF history: failed to allocate %u samples", capacity);
+    ret = SRSRAN_ERROR;
+  }
+  return ret;
+}
+
+void rf_history_reset(rf_history_t* h)
+{
+  window_move_begin(h);
+  __atomic_store_n(&h->start, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&h->end, 0, __ATOMIC_RELAXED);
+  window_move_end(h);
+}
+
+void rf_history_push(rf_history_t* h, uint64_t tstamp, const void* samples, uint32_t nof_samples)
+{
+  if (h->capacity == 0 || nof_samples == 0) {
+    return;
+  }
+  const uint8_t* src = (const uint8_t*)samples;
+  if (nof_samples > h->capacity) {
+    // only the newest samples fit
+    src += (size_t)(nof_samples - h->capacity) * h->sample_size;
+    tstamp += nof_samples - h->capacity;
+    nof_samples = h->capacity;
+  }
+  if (tstamp != h->end || h->start == h->end) {
+    // the timeline restarts, the retained samples no longer belong to it
+    window_move_begin(h);
+    __atomic_store_n(&h->start, tstamp, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->end, tstamp, __ATOMIC_RELAXED);
+    window_move_end(h);
+  }
+
+  // the oldest samples are given up before their slots are overwritten
+  uint64_t end = tstamp + nof_samples;
+  if (end - h->start > h->capacity) {
+    __atomic_store_n(&h->start, end - h->capacity, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+  }
+  uint32_t pos   = (uint32_t)(tstamp % h->capacity);
+  uint32_t first = SRSRAN_MIN(nof_samples, h->capacity - pos);
+  memcpy(&h->buffer[(size_t)pos * h->sample_size], src, (size_t)first * h->sample_size);
+  memcpy(h->buffer, &src[(size_t)first * h->sample_size], (size_t)(nof_samples - first) * h->sample_size);
+  __atomic_store_n(&h->end, end, __ATOMIC_RELEASE);
+}
+
+int rf_history_read(rf_history_t* h, uint64_t tstamp, void* dst, uint32_t nof_samples)
+{
+  int ret = SRSRAN_ERROR_OUT_OF_BOUNDS;
+
+  pthread_mutex_lock(&h->mutex);
+  uint32_t seq = __atomic_load_n(&h->seq, __ATOMIC_ACQUIRE);
+  if (h->capacity == 0 || nof_samples > h->capacity || (seq & 1)) {
+    goto exit;
+  }
+  uint64_t end   = __atomic_load_n(&h->end, __ATOMIC_ACQUIRE);
+  uint64_t start = __atomic_load_n(&h->start, __ATOMIC_ACQUIRE);
+  if (tstamp < start || tstamp + nof_samples > end) {
+    goto exit;
+  }
+
+  uint8_t* out   = (uint8_t*)dst;
+  uint32_t pos   = (uint32_t)(tstamp % h->capacity);
+  uint32_t first = SRSRAN_MIN(nof_samples, h->capacity - pos);
+  memcpy(out, &h->buffer[(size_t)pos * h->sample_size], (size_t)first * h->sample_size);
+  memcpy(&out[(size_t)first * h->sample_size], h->buffer, (size_t)(nof_samples - first) * h->sample_size);
+
+  // the copy is only valid if the reader thread did not reuse the slots meanwhile
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (__atomic_load_n(&h->seq, __ATOMIC_RELAXED) == seq && tstamp >= __atomic_load_n(&h->start, __ATOMIC_RELAXED)) {
+    ret = SRSRAN_SUCCESS;
+  }
+
+exit:
+  pthread_mutex_unlock(&h->mutex);
+  return ret;
+}
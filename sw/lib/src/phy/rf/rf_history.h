@@ -0,0 +1,63 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_HISTORY_H_
+#define SRSRAN_RF_HISTORY_H_
+
+// Retained RX history shared by the RF plugins, enabled with the rx_history_ms=<ms> device argument. The reader thread
+// copies the native payload of every packet into a ring indexed by HW tick, keeping the last samples of a contiguous
+// timeline (a gap or a restart of the timeline drops the older ones). Any thread can copy back the samples of a tick
+// range as long as they are retained, e.g. to look again at a PRACH occasion, without duplicating the whole stream.
+//
+// The reader thread never blocks on the readers: it publishes the oldest retained tick before overwriting a slot and
+// readers check it again once they are done copying. Discontinuities and resizes, which move the whole window, are
+// additionally covered by a sequence counter and, for the reallocation, by a mutex.
+
+#include "srsran/config.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  pthread_mutex_t mutex;       // held by readers and by the (rare) reallocation
+  uint8_t*        buffer;
+  uint32_t        capacity;    // samples
+  uint32_t        sample_size; // bytes per sample time, all channels
+  uint32_t        history_ms;  // retained duration, the capacity follows the sampling rate
+  uint64_t        start;       // oldest retained tick
+  uint64_t        end;         // tick following the newest retained sample
+  uint32_t        seq;         // odd while the window is moved as a whole
+} rf_history_t;
+
+// Disabled history if history_ms is 0
+SRSRAN_API void rf_history_init(rf_history_t* h, uint32_t history_ms, uint32_t sample_size);
+
+SRSRAN_API void rf_history_free(rf_history_t* h);
+
+static inline bool rf_history_enabled(const rf_history_t* h)
+{
+  return h->history_ms != 0;
+}
+
+// Reader thread only. Sizes the ring for the sampling rate and drops the retained samples.
+SRSRAN_API int rf_history_set_srate(rf_history_t* h, double srate);
+
+// Reader thread only. Drops the retained samples, e.g. when the timeline restarts.
+SRSRAN_API void rf_history_reset(rf_history_t* h);
+
+// Reader thread only. Appends the samples of [tstamp, tstamp + nof_samples).
+SRSRAN_API void rf_history_push(rf_history_t* h, uint64_t tstamp, const void* samples, uint32_t nof_samples);
+
+// Copies the samples of [tstamp, tstamp + nof_samples) to dst. Returns SRSRAN_ERROR_OUT_OF_BOUNDS if they are not, or
+// no longer, retained.
+SRSRAN_API int rf_history_read(rf_history_t* h, uint64_t tstamp, void* dst, uint32_t nof_samples);
+
+#endif // SRSRAN_RF_HISTORY_H_
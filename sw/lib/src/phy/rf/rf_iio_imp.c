@@ -11,15 +11,27 @@
  */
 
 #include <errno.h>
+#include <inttypes.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/time.h>
 #include <unistd.h>
 
+#include "rf_cmd_queue.h"
 #include "rf_helper.h"
+#include "rf_history.h"
+#include "rf_inband_status.h"
 #include "rf_iio_imp.h"
+#include "rf_iq_corr.h"
+#include "rf_player.h"
+#include "rf_recorder.h"
+#include "rf_rx_window.h"
+#include "rf_shm_server.h"
+#include "rf_timeline.h"
+#include "rf_udp_server.h"
 #include "rf_plugin.h"
+#include "srsran/phy/utils/sc12.h"
 #include "srsran/srsran.h"
 #include <ad9361.h>
 #include <fcntl.h>
@@ -37,14 +49,26 @@
 #define METADATA_NSAMPLES        8
 #define CONVERT_BUFFER_SIZE      1048576
 #define PKT_HEADER_MAGIC         0x12345678
+#define SC12_TSTAMP_DELAY        1 // sc12 frames are timestamped at their second sample, see adc_sc12_packer.vhd
 #define DEVNAME_IIO              "iio"
+#define TX_GAIN_OFFSET_DB        89 // TX gain reported to srsRAN is 89 dB + hardwaregain (i.e. minus the attenuation)
+#define IIO_DEFAULT_CMD_LEAD_US  1000 // covers an attribute write on the local IIO context
+
+// AD9361 registers used by the direct gain path, see UG-570
+#define AD9361_REG_TX1_ATTEN_0   0x073 // TX1 attenuation [7:0], 0.25 dB steps
+#define AD9361_REG_TX1_ATTEN_1   0x074 // TX1 attenuation [8]
+#define AD9361_REG_TX2_ATTEN_0   0x075 // TX2 attenuation [7:0]
+#define AD9361_REG_TX2_ATTEN_1   0x076 // TX2 attenuation [8]
+#define AD9361_REG_RX1_GAIN      0x109 // RX1 full gain table index [6:0], 1 dB steps
+#define AD9361_REG_RX2_GAIN      0x10c // RX2 full gain table index [6:0]
+#define AD9361_RX_GAIN_IDX_MASK  0x7f
 //#define PRINT_TIMESTAMPS         1
 
-cf_t zero_mem[64 * 1024] = {0};
-int  rx_data_buffer_size = IIO_MIN_DATA_BUFFER_SIZE;
-int  tx_data_buffer_size = IIO_MIN_DATA_BUFFER_SIZE;
-int  lates               = 0;
-int  firstGo             = 0;
+#define MM_REG_SIZE              0x1000
+#define MM_REG_ADDR              0x0050000000
+
+// read-only, shared by all the devices
+static const cf_t zero_mem[64 * 1024] = {0};
 
 typedef struct {
   uint64_t magic;
@@ -53,6 +77,13 @@ typedef struct {
   bool     end_of_burst;
 } tx_header_t;
 
+// Secondary RX consumer, reading the ring buffer through the tap of the same index
+typedef struct {
+  tx_header_t header;     // packet being read, nof_samples left in it
+  int16_t*    buffer;     // native samples of the current receive call
+  uint32_t    buffer_len; // in samples
+} rx_consumer_t;
+
 typedef struct {
   long long           _bw_hz; // Analog banwidth in Hz
   long long           _fs_hz; // Baseband sample rate in Hz
@@ -71,32 +102,87 @@ typedef struct {
   int                 items_in_buffer;
   pthread_t           thread;
   bool                thread_completed;
+  bool                closing; // the device is being closed, the thread must exit
   uint64_t            current_tstamp;
   float               secs;
   float               frac_secs;
   int                 metadata_samples;
   int                 preamble_location;
+  bool                srate_switch_pending; // set by the API, cleared by the reader thread once the new rate is applied
+  long long           pending_fs_hz;
+  bool                srate_rebase_pending; // new rate written, the time base moves at the first buffer captured at it
+  long long           stale_fs_hz;          // rate of the buffers in flight during a switch
+  int                 nof_stale_buffers; // buffers captured before a rate switch or a pause, still to be discarded
+  rf_rx_window_t      window;            // ticks requested by the last stream command
+  rf_timeline_t       timeline;          // continuity of the RX packets written to the ring buffer
+  uint32_t            max_backlog_ms;    // RX backlog bound, 0 if unbounded
+  uint32_t            max_backlog;       // in samples, takes precedence over max_backlog_ms
+  uint64_t            nof_backlog_drops; // samples dropped to honour the bound
+  rf_history_t        history;           // RX samples retained for srsran_rf_recv_history()
+  rx_consumer_t       consumers[SRSRAN_RINGBUFFER_MAX_TAPS];
+  bool                sc12;         // payload packed by the bitstream, 4 samples in 3 words, see sc12.h
+  int16_t*            sc12_buf;     // DMA buffer with the payload unpacked to sc16
+  uint32_t            sc12_buf_len; // in samples
+  uint32_t            head_samples; // payload samples before the metadata
+  uint32_t            nof_channels; // antennas streamed, their I/Q pairs are interleaved in each DMA item
 } rf_iio_streamer;
 
 typedef struct {
   struct iio_device*        dev;
   struct iio_context*       ctx;
   bool                      use_timestamps;
+  bool                      async_log; // holds a reference on the async logger, released on close
   rf_iio_streamer           tx_streamer;
   rf_iio_streamer           rx_streamer;
   srsran_rf_error_handler_t iio_error_handler;
   void*                     iio_error_handler_arg;
   volatile unsigned int*    memory_map_ptr;
   srsran_rf_info_t          info;
+  int                       nof_kernel_buffers;
+  rf_cmd_queue_t            cmd_queue;      // commands waiting for their timestamp
+  pthread_t                 cmd_thread;     // applies the queued commands, see cmd_thread()
+  uint32_t                  cmd_lead_us;    // commands are applied this long before their tick
+  pthread_mutex_t           clock_mutex;    // HW clock model fitted by the reader thread, see hw_clock_update()
+  pthread_mutex_t           cfg_mutex;      // gain and LO updates of the application and command threads
+  bool                      clock_valid;
+  double                    clock_offset;      // tick minus rate times CLOCK_MONOTONIC, bound of the current window
+  double                    clock_offset_prev; // same bound over the previous window
+  double                    clock_window_start;
+  rf_inband_status_t        rx_status;      // status reported by the RX metadata headers
+  rf_recorder_t*            recorder;       // NULL unless the record device argument is given
+  rf_player_t*              player;         // TX file playback, NULL if not active
+  rf_shm_server_t           shm;            // streams shared with other processes, see rf_shm.h
+  rf_udp_server_t           udp;            // streams sent to a host over the network, see rf_udp.h
+  srsran_vec_stats_t        rx_stats;       // signal statistics of the last receive call
+  srsran_vec_stats_t        tx_stats;       // signal statistics of the last send call
+  rf_iq_corr_t              rx_corr[SRSRAN_MAX_PORTS]; // RX DC and IQ imbalance correction of each channel
+  struct iio_channel*       rx_lo;          // cached PHY channels, looked up once when the device is opened
+  struct iio_channel*       tx_lo;
+  struct iio_channel*       rx_phy2;        // PHY channels of the second antenna, NULL with a single one
+  struct iio_channel*       tx_phy2;
+  bool                      gain_reg_path;  // gains are written to the AD9361 registers instead of hardwaregain
+  int                       rx_gain_offset; // full gain table index minus the gain in dB, depends on the band
+  bool                      rx_gain_valid;  // rx_gain holds the gain last written
+  bool                      tx_gain_valid;
+  long long                 rx_gain;        // hardwaregain in dB
+  long long                 tx_gain;
+  uint64_t                  tstamp_base;    // tick at which the current sampling rate took effect
+  time_t                    time_base_secs; // time corresponding to tstamp_base
+  double                    time_base_frac;
+  int                       nof_ts_prints; // timestamps printed so far, PRINT_TIMESTAMPS only
 } rf_iio_handler_t;
 
-static char tmpstr[64];
-
 /* helper function generating channel names */
-static char* get_ch_name(const char* type, int id)
+static char* get_ch_name(char name[RF_PARAM_LEN], const char* type, int id)
+{
+  snprintf(name, RF_PARAM_LEN, "%s%d", type, id);
+  return name;
+}
+
+// Bytes per DMA item, i.e. per sample time: an sc16 I/Q pair of each channel
+static size_t streamer_sample_size(const rf_iio_streamer* streamer)
 {
-  snprintf(tmpstr, sizeof(tmpstr), "%s%d", type, id);
-  return tmpstr;
+  return 2 * sizeof(int16_t) * streamer->nof_channels;
 }
 
 int refill_buffer(rf_iio_streamer* streamer, ssize_t* items_in_buffer, int* byte_offset)
@@ -113,17 +199,20 @@ int refill_buffer(rf_iio_streamer* streamer, ssize_t* items_in_buffer, int* byte
 /*memory map interface functions*/
 int open_mem_register(void* h)
 {
-  rf_iio_handler_t* handler  = (rf_iio_handler_t*)h;
-  unsigned int      reg_size = 0x1000;
-  off_t             reg_addr = 0x0050000000;
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
   int               mm_reg_d;
   // Map the MM-reg address into user space getting a virtual address for it
   if ((mm_reg_d = open("/dev/mem", O_RDWR | O_SYNC)) == -1) {
     fprintf(stderr, "Error accessing the memory-maped register\n");
     return SRSRAN_ERROR;
-  } else {
-    handler->memory_map_ptr = (uint32_t*)mmap(NULL, reg_size, PROT_READ | PROT_WRITE, MAP_SHARED, mm_reg_d, reg_addr);
   }
+  void* ptr = mmap(NULL, MM_REG_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, mm_reg_d, MM_REG_ADDR);
+  close(mm_reg_d);
+  if (ptr == MAP_FAILED) {
+    fprintf(stderr, "Error mapping the memory-maped register\n");
+    return SRSRAN_ERROR;
+  }
+  handler->memory_map_ptr = (volatile unsigned int*)ptr;
   return SRSRAN_SUCCESS;
 }
 
@@ -138,11 +227,16 @@ void check_late_register(void* h, uint32_t* late_reg_value)
   }
 }
 
+static bool  buffer_initialized(rf_iio_streamer* streamer);
 static void* reader_thread(void* arg);
 static void* writer_thread(void* arg);
+static void  client_tx(void* h, uint64_t tstamp, const int16_t* sc16, uint32_t nof_samples, bool end_of_burst);
 
 static void log_overflow(rf_iio_handler_t* h)
 {
+  if (h->recorder) {
+    rf_recorder_annotate(h->recorder, "overflow");
+  }
   if (h->iio_error_handler) {
     srsran_rf_error_t error;
     bzero(&error, sizeof(srsran_rf_error_t));
@@ -151,6 +245,18 @@ static void log_overflow(rf_iio_handler_t* h)
   }
 }
 
+static void log_gap(rf_iio_handler_t* h, uint64_t nof_lost)
+{
+  if (h->iio_error_handler) {
+    srsran_rf_error_t error;
+    bzero(&error, sizeof(srsran_rf_error_t));
+    error.type = SRSRAN_RF_ERROR_OVERFLOW;
+    error.opt  = (int)SRSRAN_MIN(nof_lost, INT32_MAX);
+    error.msg  = "RX timeline gap";
+    h->iio_error_handler(h->iio_error_handler_arg, error);
+  }
+}
+
 static void log_late(rf_iio_handler_t* h, bool is_rx)
 {
   if (h->iio_error_handler) {
@@ -186,6 +292,8 @@ int rf_iio_start_rx_stream(void* h, bool now)
   pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
   handler->rx_streamer.items_in_buffer = 0;
   handler->rx_streamer.stream_active   = true;
+  // stream continuously, this also resumes a reader thread paused at the end of a finite capture
+  rf_rx_window_reset(&handler->rx_streamer.window);
 
   if (handler->rx_streamer.thread_completed) {
     // if rx thread was stopped before - restart it
@@ -193,7 +301,7 @@ int rf_iio_start_rx_stream(void* h, bool now)
     srsran_ringbuffer_start(&handler->rx_streamer.ring_buffer);
     pthread_create(&handler->rx_streamer.thread, NULL, reader_thread, handler);
   }
-  pthread_cond_signal(&handler->rx_streamer.stream_cvar);
+  pthread_cond_broadcast(&handler->rx_streamer.stream_cvar);
   pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
 
   // make sure thread has been started
@@ -210,6 +318,8 @@ static void stop_rx_stream(rf_iio_handler_t* handler)
 {
   pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
   handler->rx_streamer.stream_active = false;
+  // wake up the reader thread if it's paused at the end of a finite capture
+  pthread_cond_broadcast(&handler->rx_streamer.stream_cvar);
 
   if (handler->rx_streamer._buf) {
     iio_buffer_cancel(handler->rx_streamer._buf);
@@ -219,6 +329,7 @@ static void stop_rx_stream(rf_iio_handler_t* handler)
   }
   pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
   pthread_join(handler->rx_streamer.thread, NULL);
+  handler->rx_streamer.thread = 0;
 
   if (handler->rx_streamer._buf) {
     iio_buffer_destroy(handler->rx_streamer._buf);
@@ -237,22 +348,46 @@ int rf_iio_stop_rx_stream(void* h)
   return 0;
 }
 
+/*
+ * Timestamps count samples at the current sampling rate. Every live rate switch moves the time base to the tick at
+ * which the new rate took effect, so that the time scale stays continuous across switches.
+ */
 uint64_t time_to_tstamp_iio(rf_iio_handler_t* handler, time_t secs, double frac_secs)
 {
-  return (uint64_t)(handler->tx_streamer._fs_hz * ((double)secs)) +
+  secs -= handler->time_base_secs;
+  frac_secs -= handler->time_base_frac;
+  if (frac_secs < 0) {
+    frac_secs += 1.0;
+    secs--;
+  }
+  // times before the last rate switch have no tick at the current rate, they map to the switch itself
+  if (secs < 0) {
+    return handler->tstamp_base;
+  }
+  return handler->tstamp_base + (uint64_t)(handler->tx_streamer._fs_hz * ((double)secs)) +
          (uint64_t)(round((double)handler->tx_streamer._fs_hz * frac_secs));
 }
 
-void tstamp_to_time_iio(rf_iio_handler_t* handler, uint64_t tstamp, time_t* secs, double* frac_secs)
+static void
+tstamp_to_time_at_rate(rf_iio_handler_t* handler, uint64_t tstamp, uint64_t srate_int, time_t* secs, double* frac_secs)
 {
-  uint64_t srate_int = (uint64_t)handler->rx_streamer._fs_hz;
+  uint64_t ticks = (tstamp > handler->tstamp_base) ? tstamp - handler->tstamp_base : 0;
   if (secs && frac_secs) {
-    *secs              = tstamp / srate_int;
-    uint64_t remainder = tstamp % srate_int;
-    *frac_secs         = (double)remainder / srate_int;
+    *secs              = handler->time_base_secs + ticks / srate_int;
+    uint64_t remainder = ticks % srate_int;
+    *frac_secs         = handler->time_base_frac + (double)remainder / srate_int;
+    if (*frac_secs >= 1.0) {
+      *frac_secs -= 1.0;
+      (*secs)++;
+    }
   }
 }
 
+void tstamp_to_time_iio(rf_iio_handler_t* handler, uint64_t tstamp, time_t* secs, double* frac_secs)
+{
+  tstamp_to_time_at_rate(handler, tstamp, (uint64_t)handler->rx_streamer._fs_hz, secs, frac_secs);
+}
+
 int rf_iio_start_tx_stream(void* h)
 {
   rf_iio_handler_t* handler            = (rf_iio_handler_t*)h;
@@ -272,6 +407,7 @@ int rf_iio_stop_tx_stream(void* h)
   pthread_mutex_unlock(&handler->tx_streamer.stream_mutex);
 
   pthread_join(handler->tx_streamer.thread, NULL);
+  handler->tx_streamer.thread = 0;
 
   if (handler->tx_streamer._buf) {
     iio_buffer_cancel(handler->tx_streamer._buf);
@@ -291,13 +427,29 @@ void rf_iio_flush_buffer(void* h)
 
 bool rf_iio_has_rssi(void* h)
 {
-  // noop
-  return false;
+  return true;
 }
 
+// Power of the last received samples relative to full scale, it is not calibrated to the antenna input
 float rf_iio_get_rssi(void* h)
 {
-  return 0.0;
+  srsran_rf_stats_t stats;
+  rf_iio_get_rx_stats(h, &stats);
+  return stats.power_dbfs;
+}
+
+int rf_iio_get_rx_stats(void* h, srsran_rf_stats_t* stats)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+  rf_stats_from_vec(&handler->rx_stats, handler->rx_streamer.nof_channels, stats);
+  return SRSRAN_SUCCESS;
+}
+
+int rf_iio_get_tx_stats(void* h, srsran_rf_stats_t* stats)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+  rf_stats_from_vec(&handler->tx_stats, handler->tx_streamer.nof_channels, stats);
+  return SRSRAN_SUCCESS;
 }
 
 void rf_iio_set_master_clock_rate(void* h, double rate)
@@ -310,30 +462,66 @@ bool rf_iio_is_master_clock_dynamic(void* h)
   return false;
 }
 
-double rf_iio_set_rx_srate(void* h, double rate)
+/*
+ * The IIO path has no access to the FPGA timestamp counter, so the live tick is modelled from the RX buffers: a buffer
+ * is handed over by the kernel at the earliest when its last sample has been captured, so tick - rate * t at that
+ * moment is an upper bound of the offset between the HW clock and CLOCK_MONOTONIC, reached by the buffers that
+ * arrive while the reader thread is waiting for them. The bound is kept over one second windows, to follow the drift
+ * between both clocks.
+ */
+#define HW_CLOCK_WINDOW_S 1.0
+
+static double monotonic_secs(void)
 {
-  rf_iio_handler_t* handler              = (rf_iio_handler_t*)h;
-  bool              stream_needs_restart = false;
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
 
-  if (rate == (double)handler->rx_streamer._fs_hz) {
-    return rate;
-  }
+static void hw_clock_reset(rf_iio_handler_t* handler)
+{
+  pthread_mutex_lock(&handler->clock_mutex);
+  handler->clock_valid = false;
+  pthread_mutex_unlock(&handler->clock_mutex);
+}
 
-  if (handler->rx_streamer.stream_active) {
-    stream_needs_restart = true;
-    // stop receiving samples while reconfiguring RF frontend
-    stop_rx_stream(handler);
-    // clear ringbuffers and invalidate any partially read data packet
-    srsran_ringbuffer_stop(&handler->rx_streamer.ring_buffer);
-    srsran_ringbuffer_reset(&handler->rx_streamer.ring_buffer);
-    handler->rx_streamer.prev_header.nof_samples = 0;
-    srsran_ringbuffer_start(&handler->rx_streamer.ring_buffer);
-  }
-  INFO("RF_IIO: changing srate, RX stream paused\n");
+// Called by the reader thread with the tick following the last sample of the buffer just received
+static void hw_clock_update(rf_iio_handler_t* handler, uint64_t end_tick)
+{
+  double t      = monotonic_secs();
+  double offset = (double)end_tick - (double)handler->rx_streamer._fs_hz * t;
+  pthread_mutex_lock(&handler->clock_mutex);
+  if (!handler->clock_valid || t - handler->clock_window_start > HW_CLOCK_WINDOW_S) {
+    handler->clock_offset_prev  = handler->clock_valid ? handler->clock_offset : offset;
+    handler->clock_offset       = offset;
+    handler->clock_window_start = t;
+    handler->clock_valid        = true;
+  } else if (offset > handler->clock_offset) {
+    handler->clock_offset = offset;
+  }
+  pthread_mutex_unlock(&handler->clock_mutex);
+}
+
+static bool hw_clock_now(rf_iio_handler_t* handler, uint64_t* now)
+{
+  double t = monotonic_secs();
+  pthread_mutex_lock(&handler->clock_mutex);
+  bool valid = handler->clock_valid;
+  if (valid) {
+    double offset = handler->clock_offset > handler->clock_offset_prev ? handler->clock_offset
+                                                                        : handler->clock_offset_prev;
+    *now          = (uint64_t)((double)handler->rx_streamer._fs_hz * t + offset);
+  }
+  pthread_mutex_unlock(&handler->clock_mutex);
+  return valid;
+}
 
+static void write_srate(rf_iio_handler_t* handler, double rate)
+{
   long long samplerate        = (long long)rate;
   handler->rx_streamer._fs_hz = rate;
   handler->tx_streamer._fs_hz = rate;
+  hw_clock_reset(handler);
 
   bool decimation = false;
   if (samplerate < (25e6 / 48)) {
@@ -364,6 +552,106 @@ double rf_iio_set_rx_srate(void* h, double rate)
     INFO("RF_IIO: Unable to set BB rate");
   }
 #endif
+}
+
+/*
+ * Live sampling rate switch, executed by the reader thread between two refills. The IIO buffer and the thread stay
+ * alive; the buffers already queued in the kernel hold samples of the previous rate and are discarded as they arrive.
+ * The switch completes in finish_rx_srate_switch() with the first buffer captured at the new rate.
+ */
+static void switch_rx_srate(rf_iio_handler_t* handler)
+{
+  rf_iio_streamer* streamer = &handler->rx_streamer;
+
+  streamer->stale_fs_hz = streamer->_fs_hz;
+  write_srate(handler, streamer->pending_fs_hz);
+  srsran_ringbuffer_reset(&streamer->ring_buffer);
+  rf_timeline_reset(&streamer->timeline);
+  streamer->nof_stale_buffers    = handler->nof_kernel_buffers;
+  streamer->srate_rebase_pending = true;
+}
+
+/*
+ * The ticks of the buffers that were in flight during the switch elapsed at the previous rate, so the time base moves
+ * to the first tick of the first buffer captured at the new rate, timed at the previous rate.
+ */
+static void finish_rx_srate_switch(rf_iio_handler_t* handler, uint64_t first_tstamp)
+{
+  rf_iio_streamer* streamer = &handler->rx_streamer;
+
+  if (handler->use_timestamps) {
+    tstamp_to_time_at_rate(
+        handler, first_tstamp, (uint64_t)streamer->stale_fs_hz, &handler->time_base_secs, &handler->time_base_frac);
+    handler->tstamp_base = first_tstamp;
+  }
+  rf_history_set_srate(&streamer->history, streamer->_fs_hz);
+  if (rf_shm_server_enabled(&handler->shm)) {
+    rf_shm_server_set_time(
+        &handler->shm, streamer->_fs_hz, handler->tstamp_base, handler->time_base_secs, handler->time_base_frac);
+  }
+  if (rf_udp_server_enabled(&handler->udp)) {
+    rf_udp_server_set_time(
+        &handler->udp, streamer->_fs_hz, handler->tstamp_base, handler->time_base_secs, handler->time_base_frac);
+  }
+
+  // pending timed commands refer to the old time scale
+  uint32_t nof_dropped_cmds = rf_cmd_queue_clear(&handler->cmd_queue);
+  if (nof_dropped_cmds) {
+    INFO("RF_IIO: %u timed commands dropped by the srate switch\n", nof_dropped_cmds);
+  }
+
+  pthread_mutex_lock(&streamer->stream_mutex);
+  streamer->srate_rebase_pending = false;
+  streamer->srate_switch_pending = false;
+  pthread_cond_broadcast(&streamer->stream_cvar);
+  pthread_mutex_unlock(&streamer->stream_mutex);
+  INFO("RF_IIO: RX srate switched to %.2f MHz\n", streamer->_fs_hz / 1e6);
+}
+
+double rf_iio_set_rx_srate(void* h, double rate)
+{
+  rf_iio_handler_t* handler              = (rf_iio_handler_t*)h;
+  bool              stream_needs_restart = false;
+
+  if (rate == (double)handler->rx_streamer._fs_hz) {
+    return rate;
+  }
+
+  // while streaming, let the reader thread switch the rate at a packet boundary without tearing the stream down
+  pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
+  if (handler->rx_streamer.stream_active && !handler->rx_streamer.thread_completed &&
+      buffer_initialized(&handler->rx_streamer)) {
+    handler->rx_streamer.pending_fs_hz        = (long long)rate;
+    handler->rx_streamer.srate_switch_pending = true;
+    while (handler->rx_streamer.srate_switch_pending && !handler->rx_streamer.thread_completed) {
+      pthread_cond_wait(&handler->rx_streamer.stream_cvar, &handler->rx_streamer.stream_mutex);
+    }
+    bool switched = !handler->rx_streamer.srate_switch_pending;
+    handler->rx_streamer.srate_switch_pending = false;
+    pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
+    if (switched) {
+      // invalidate any partially read data packet
+      handler->rx_streamer.prev_header.nof_samples = 0;
+      return rate;
+    }
+  } else {
+    pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
+  }
+
+  if (handler->rx_streamer.stream_active) {
+    stream_needs_restart = true;
+    // stop receiving samples while reconfiguring RF frontend
+    stop_rx_stream(handler);
+    // clear ringbuffers and invalidate any partially read data packet
+    srsran_ringbuffer_stop(&handler->rx_streamer.ring_buffer);
+    srsran_ringbuffer_reset(&handler->rx_streamer.ring_buffer);
+    handler->rx_streamer.prev_header.nof_samples = 0;
+    srsran_ringbuffer_start(&handler->rx_streamer.ring_buffer);
+  }
+  INFO("RF_IIO: changing srate, RX stream paused\n");
+
+  write_srate(handler, rate);
+
   if (stream_needs_restart) {
     // restart the RX stream
     rf_iio_start_rx_stream(handler, true);
@@ -382,31 +670,158 @@ double rf_iio_set_tx_srate(void* h, double rate)
   return rate;
 }
 
+// The hardwaregain attributes go through the driver gain table lookup and a sysfs (or network) round trip on every
+// write. With gain_path=reg and the AD9361 in manual gain control with the full gain table, the gains are written
+// straight to the gain index and TX attenuation registers instead, which takes a single SPI write.
+static int iio_gain_reg_calibrate(rf_iio_handler_t* handler)
+{
+  long long gain  = 0;
+  uint32_t  index = 0;
+  if (iio_channel_attr_read_longlong(handler->rx_streamer._channel, "hardwaregain", &gain) < 0 ||
+      iio_device_reg_read(handler->dev, AD9361_REG_RX1_GAIN, &index) < 0) {
+    return SRSRAN_ERROR;
+  }
+  handler->rx_gain_offset = (int)(index & AD9361_RX_GAIN_IDX_MASK) - (int)gain;
+  handler->rx_gain              = gain;
+  handler->rx_gain_valid        = true;
+  return SRSRAN_SUCCESS;
+}
+
+static void iio_gain_init(rf_iio_handler_t* handler, const char* gain_path)
+{
+  handler->gain_reg_path = false;
+  handler->rx_gain_valid = false;
+  handler->tx_gain_valid = false;
+  if (strcmp(gain_path, "reg") != 0) {
+    return;
+  }
+
+  char mode[32]  = "";
+  char split[32] = "0";
+  iio_channel_attr_read(handler->rx_streamer._channel, "gain_control_mode", mode, sizeof(mode));
+  iio_device_debug_attr_read(handler->dev, "adi,split-gain-table-mode-enable", split, sizeof(split));
+  if (strncmp(mode, "manual", strlen("manual")) != 0 || split[0] != '0') {
+    fprintf(stderr,
+            "RF_IIO: gain_path=reg needs manual gain control and the full gain table (mode=%s, split=%s), using "
+            "hardwaregain\n",
+            mode,
+            split);
+    return;
+  }
+  if (iio_gain_reg_calibrate(handler) < SRSRAN_SUCCESS) {
+    fprintf(stderr, "RF_IIO: could not access the AD9361 gain registers, using hardwaregain\n");
+    return;
+  }
+  handler->gain_reg_path = true;
+  INFO("RF_IIO: direct gain path enabled, RX gain index offset %d\n", handler->rx_gain_offset);
+}
+
+// Called with cfg_mutex held
+static int iio_set_rx_gain(rf_iio_handler_t* handler, double gain)
+{
+  long long gain1 = (long long)gain;
+  if (handler->rx_gain_valid && gain1 == handler->rx_gain) {
+    return SRSRAN_SUCCESS;
+  }
+
+  int ret;
+  if (handler->gain_reg_path) {
+    int index = (int)gain1 + handler->rx_gain_offset;
+    if (index < 0 || index > AD9361_RX_GAIN_IDX_MASK) {
+      ERROR("RF_IIO: RX gain %lld dB out of the gain table\n", gain1);
+      return SRSRAN_ERROR;
+    }
+    ret = iio_device_reg_write(handler->dev, AD9361_REG_RX1_GAIN, (uint32_t)index);
+    if (ret >= 0 && handler->rx_phy2) {
+      ret = iio_device_reg_write(handler->dev, AD9361_REG_RX2_GAIN, (uint32_t)index);
+    }
+  } else {
+    ret = iio_channel_attr_write_longlong(handler->rx_streamer._channel, "hardwaregain", gain1);
+    if (ret >= 0 && handler->rx_phy2) {
+      ret = iio_channel_attr_write_longlong(handler->rx_phy2, "hardwaregain", gain1);
+    }
+  }
+  if (ret < 0) {
+    handler->rx_gain_valid = false;
+    return SRSRAN_ERROR;
+  }
+  handler->rx_gain       = gain1;
+  handler->rx_gain_valid = true;
+  return SRSRAN_SUCCESS;
+}
+
 int rf_iio_set_rx_gain(void* h, double gain)
 {
   rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
-  long long         gain1   = (long long)gain;
-  iio_channel_attr_write_longlong(iio_device_find_channel(handler->dev, "voltage0", false), "hardwaregain", gain1);
+  pthread_mutex_lock(&handler->cfg_mutex);
+  int ret = iio_set_rx_gain(handler, gain);
+  pthread_mutex_unlock(&handler->cfg_mutex);
+  return ret;
+}
+
+// Called with cfg_mutex held
+static int iio_set_tx_gain(rf_iio_handler_t* handler, double gain)
+{
+  long long gain1 = (long long)gain - TX_GAIN_OFFSET_DB;
+  if (handler->tx_gain_valid && gain1 == handler->tx_gain) {
+    return SRSRAN_SUCCESS;
+  }
+
+  int ret;
+  if (handler->gain_reg_path) {
+    // attenuation in 0.25 dB steps, the low byte is written last as the driver does
+    uint32_t atten = (uint32_t)(-gain1 * 4);
+    if (gain1 > 0 || atten > 0x1ff) {
+      ERROR("RF_IIO: TX gain %lld dB out of range\n", gain1 + TX_GAIN_OFFSET_DB);
+      return SRSRAN_ERROR;
+    }
+    ret = iio_device_reg_write(handler->dev, AD9361_REG_TX1_ATTEN_1, atten >> 8);
+    if (ret >= 0) {
+      ret = iio_device_reg_write(handler->dev, AD9361_REG_TX1_ATTEN_0, atten & 0xff);
+    }
+    if (ret >= 0 && handler->tx_phy2) {
+      ret = iio_device_reg_write(handler->dev, AD9361_REG_TX2_ATTEN_1, atten >> 8);
+    }
+    if (ret >= 0 && handler->tx_phy2) {
+      ret = iio_device_reg_write(handler->dev, AD9361_REG_TX2_ATTEN_0, atten & 0xff);
+    }
+  } else {
+    ret = iio_channel_attr_write_longlong(handler->tx_streamer._channel, "hardwaregain", gain1);
+    if (ret >= 0 && handler->tx_phy2) {
+      ret = iio_channel_attr_write_longlong(handler->tx_phy2, "hardwaregain", gain1);
+    }
+  }
+  if (ret < 0) {
+    handler->tx_gain_valid = false;
+    return SRSRAN_ERROR;
+  }
+  handler->tx_gain       = gain1;
+  handler->tx_gain_valid = true;
   return SRSRAN_SUCCESS;
 }
 
 int rf_iio_set_tx_gain(void* h, double gain)
 {
   rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
-  long long         gain1   = (long long)gain;
-  gain1                     = gain1 - 89;
-  iio_channel_attr_write_longlong(iio_device_find_channel(handler->dev, "voltage0", true), "hardwaregain", gain1);
-
-  return SRSRAN_SUCCESS;
+  pthread_mutex_lock(&handler->cfg_mutex);
+  int ret = iio_set_tx_gain(handler, gain);
+  pthread_mutex_unlock(&handler->cfg_mutex);
+  return ret;
 }
 
 double rf_iio_get_rx_gain(void* h)
 {
   long long         gain;
   rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
-  gain                      = 0;
-  if (iio_channel_attr_read_longlong(iio_device_find_channel(handler->dev, "voltage0", false), "hardwaregain", &gain) !=
-      0) {
+  pthread_mutex_lock(&handler->cfg_mutex);
+  bool valid = handler->rx_gain_valid;
+  gain       = handler->rx_gain;
+  pthread_mutex_unlock(&handler->cfg_mutex);
+  if (valid) {
+    return (double)gain;
+  }
+  gain = 0;
+  if (iio_channel_attr_read_longlong(handler->rx_streamer._channel, "hardwaregain", &gain) != 0) {
     return 0;
   }
   return (double)gain;
@@ -416,12 +831,18 @@ double rf_iio_get_tx_gain(void* h)
 {
   long long         gain;
   rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
-  gain                      = 0;
-  if (iio_channel_attr_read_longlong(iio_device_find_channel(handler->dev, "voltage0", true), "hardwaregain", &gain) !=
-      0) {
+  pthread_mutex_lock(&handler->cfg_mutex);
+  bool valid = handler->tx_gain_valid;
+  gain       = handler->tx_gain;
+  pthread_mutex_unlock(&handler->cfg_mutex);
+  if (valid) {
+    return (double)(gain + TX_GAIN_OFFSET_DB);
+  }
+  gain = 0;
+  if (iio_channel_attr_read_longlong(handler->tx_streamer._channel, "hardwaregain", &gain) != 0) {
     return 0;
   }
-  gain = gain + 89;
+  gain = gain + TX_GAIN_OFFSET_DB;
   return (double)gain;
 }
 
@@ -435,26 +856,55 @@ srsran_rf_info_t* rf_iio_get_info(void* h)
   return info;
 }
 
+// Items of the RX DMA buffer, the payload takes 3 words per 4 samples in sc12
+static long rx_buffer_items(const rf_iio_streamer* streamer)
+{
+  long payload = streamer->sc12 ? streamer->buffer_size / 4 * 3 : streamer->buffer_size;
+  return payload + streamer->metadata_samples;
+}
+
 size_t rf_iio_set_rx_buffer_size(void* h, size_t buffer_size)
 {
   rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+  if (handler->rx_streamer.sc12) {
+    // sc12 frames (3/4 of the samples plus the metadata) must remain a whole number of 64 bit DMA beats
+    buffer_size -= buffer_size % 32;
+  }
   if (buffer_size != handler->rx_streamer.buffer_size) {
     if (handler->rx_streamer._buf) {
       iio_buffer_destroy(handler->rx_streamer._buf);
     }
     handler->rx_streamer.buffer_size = buffer_size;
-    handler->rx_streamer._buf        = iio_device_create_buffer(
-        handler->rx_streamer._device, handler->rx_streamer.buffer_size + handler->rx_streamer.metadata_samples, false);
+    handler->rx_streamer._buf =
+        iio_device_create_buffer(handler->rx_streamer._device, rx_buffer_items(&handler->rx_streamer), false);
   }
   printf("(TODO)set Rx buffer size to %d\n", (int)buffer_size);
   return buffer_size;
 }
 
+// Tunes the RX LO, the recorder is told separately when the new frequency takes effect
+static void iio_set_rx_lo(rf_iio_handler_t* handler, double frequency)
+{
+  pthread_mutex_lock(&handler->cfg_mutex);
+  iio_channel_attr_write_longlong(handler->rx_lo, "frequency", (long long)frequency);
+  if (handler->gain_reg_path) {
+    // the gain table, and with it the index offset, depends on the band
+    if (iio_gain_reg_calibrate(handler) < SRSRAN_SUCCESS) {
+      ERROR("RF_IIO: could not read the RX gain index, using hardwaregain\n");
+      handler->gain_reg_path = false;
+      handler->rx_gain_valid = false;
+    }
+  }
+  pthread_mutex_unlock(&handler->cfg_mutex);
+}
+
 double rf_iio_set_rx_freq(void* h, uint32_t ch, double frequency)
 {
   rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
-  long long         freq    = (long long)frequency;
-  iio_channel_attr_write_longlong(iio_device_find_channel(handler->dev, "altvoltage0", true), "frequency", freq);
+  iio_set_rx_lo(handler, frequency);
+  if (handler->recorder) {
+    rf_recorder_set_freq(handler->recorder, frequency, RF_RECORDER_NO_TSTAMP);
+  }
   return frequency;
 }
 
@@ -462,7 +912,9 @@ double rf_iio_set_tx_freq(void* h, uint32_t ch, double frequency)
 {
   rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
   long long         freq    = (long long)frequency;
-  iio_channel_attr_write_longlong(iio_device_find_channel(handler->dev, "altvoltage1", true), "frequency", freq);
+  pthread_mutex_lock(&handler->cfg_mutex);
+  iio_channel_attr_write_longlong(handler->tx_lo, "frequency", freq);
+  pthread_mutex_unlock(&handler->cfg_mutex);
   return frequency;
 }
 
@@ -471,6 +923,82 @@ void rf_iio_get_time(void* h, time_t* secs, double* frac_secs)
   // noop
 }
 
+// Applies a command, tick is the HW timestamp it takes effect at or RF_RECORDER_NO_TSTAMP if applied immediately
+static int apply_cmd(rf_iio_handler_t* handler, const srsran_rf_cmd_t* cmd, uint64_t tick)
+{
+  switch (cmd->type) {
+    case SRSRAN_RF_CMD_RX_FREQ:
+      iio_set_rx_lo(handler, cmd->value);
+      if (handler->recorder) {
+        rf_recorder_set_freq(handler->recorder, cmd->value, tick);
+      }
+      break;
+    case SRSRAN_RF_CMD_TX_FREQ:
+      rf_iio_set_tx_freq(handler, cmd->ch, cmd->value);
+      break;
+    case SRSRAN_RF_CMD_RX_GAIN:
+      rf_iio_set_rx_gain(handler, cmd->value);
+      break;
+    case SRSRAN_RF_CMD_TX_GAIN:
+      rf_iio_set_tx_gain(handler, cmd->value);
+      break;
+    default:
+      return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int rf_iio_queue_cmd_timed(void* h, const srsran_rf_cmd_t* cmd, time_t secs, double frac_secs)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+
+  // the HW clock is modelled from the RX buffers, without a running RX stream there is no time reference
+  if (!handler->use_timestamps || !handler->rx_streamer.stream_active) {
+    INFO("RF_IIO: no RX time reference, applying command immediately\n");
+    return apply_cmd(handler, cmd, RF_RECORDER_NO_TSTAMP);
+  }
+  if (rf_cmd_queue_push(&handler->cmd_queue, cmd, time_to_tstamp_iio(handler, secs, frac_secs)) < SRSRAN_SUCCESS) {
+    ERROR("RF_IIO: timed command queue is full\n");
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+// Applies the commands whose tick is reached by now plus the lead time
+static void apply_timed_cmds(rf_iio_handler_t* handler, uint64_t now)
+{
+  rf_timed_cmd_t tc;
+  while (rf_cmd_queue_pop_due(&handler->cmd_queue, now, &tc)) {
+    apply_cmd(handler, &tc.cmd, tc.tick);
+    DEBUG("RF_IIO: timed command applied at tick %" PRIu64 " (scheduled %" PRIu64 ")\n", now, tc.tick);
+  }
+}
+
+/*
+ * The attribute writes of the commands may block, so they are issued from their own thread instead of the RX reader
+ * thread. The commands are applied cmd_lead_us before their tick on the modelled HW clock, the lead time covering the
+ * attribute write itself.
+ */
+static void* cmd_thread(void* arg)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)arg;
+  uint32_t          wait_us = 0;
+
+  while (rf_cmd_queue_wait(&handler->cmd_queue, wait_us)) {
+    uint64_t now = 0;
+    if (!hw_clock_now(handler, &now)) {
+      // no RX buffer received at the current rate yet
+      wait_us = RF_CMD_MAX_WAIT_US;
+      continue;
+    }
+    double srate = (double)handler->rx_streamer._fs_hz;
+    now += (uint64_t)(srate * handler->cmd_lead_us / 1e6);
+    apply_timed_cmds(handler, now);
+    wait_us = rf_cmd_queue_wait_us(&handler->cmd_queue, now, srate);
+  }
+  return NULL;
+}
+
 static void rf_iio_use_timestamping(void* h, int nof_prbs)
 {
   bool              skip_rx_buf_reconfig = false;
@@ -481,6 +1009,7 @@ static void rf_iio_use_timestamping(void* h, int nof_prbs)
   handler->rx_streamer.metadata_samples = (handler->use_timestamps) ? (METADATA_NSAMPLES) : 0;
   handler->tx_streamer.metadata_samples = (handler->use_timestamps) ? (METADATA_NSAMPLES) : 0;
 
+  long rx_data_buffer_size;
   if (nof_prbs <= 6) {
     rx_data_buffer_size = IIO_MIN_DATA_BUFFER_SIZE;
   } else if (nof_prbs > 6 && nof_prbs <= 15) {
@@ -489,7 +1018,7 @@ static void rf_iio_use_timestamping(void* h, int nof_prbs)
     // 25 prbs and higher
     rx_data_buffer_size = 7680;
   }
-  tx_data_buffer_size = rx_data_buffer_size;
+  long tx_data_buffer_size = rx_data_buffer_size;
 
   long total_tx_buffer_size = tx_data_buffer_size + handler->tx_streamer.metadata_samples;
 
@@ -553,12 +1082,34 @@ int rf_iio_open_multi(char* args, void** h, uint32_t nof_rx_antennas)
 {
   *h = NULL;
 
-  rf_iio_handler_t* handler = (rf_iio_handler_t*)malloc(sizeof(rf_iio_handler_t));
+  if (nof_rx_antennas == 0) {
+    INFO("Warning: setting nof_channels to 1 by default (argument nof_channels=%u)\n", nof_rx_antennas);
+    nof_rx_antennas = 1;
+  }
+  if (nof_rx_antennas > 2) {
+    fprintf(stderr, "only 1 or 2 RF channels are supported (argument nof_channels=%u)\n", nof_rx_antennas);
+    return -1;
+  }
+
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)calloc(1, sizeof(rf_iio_handler_t));
   if (!handler) {
-    perror("malloc");
+    perror("calloc");
     return -1;
   }
   *h = handler;
+  // both antennas are streamed in each direction, the AD9361 has to be in 2R2T mode
+  handler->rx_streamer.nof_channels = nof_rx_antennas;
+  handler->tx_streamer.nof_channels = nof_rx_antennas;
+  // what rf_iio_close() releases is set up first, so that every failure below can go through it
+  pthread_mutex_init(&handler->rx_streamer.stream_mutex, NULL);
+  pthread_cond_init(&handler->rx_streamer.stream_cvar, NULL);
+  srsran_ringbuffer_init(&handler->rx_streamer.ring_buffer, 1500 * 1920 * nof_rx_antennas);
+  pthread_mutex_init(&handler->tx_streamer.stream_mutex, NULL);
+  pthread_cond_init(&handler->tx_streamer.stream_cvar, NULL);
+  srsran_ringbuffer_init(&handler->tx_streamer.ring_buffer, 200 * 1920 * nof_rx_antennas);
+  rf_cmd_queue_init(&handler->cmd_queue);
+  pthread_mutex_init(&handler->clock_mutex, NULL);
+  pthread_mutex_init(&handler->cfg_mutex, NULL);
 
   /// handle rf args
   uint32_t n_prb = 0;
@@ -567,6 +1118,52 @@ int rf_iio_open_multi(char* args, void** h, uint32_t nof_rx_antennas)
     n_prb = 6;
   }
 
+  // record=<base path> streams the RX samples to <base path>.sigmf-data
+  char record_path[RF_PARAM_LEN] = "";
+  parse_string(args, "record", 0, record_path);
+  // rx_dc_corr, rx_iq_corr and rx_corr_alpha configure the RX correction, see rf_iq_corr.h
+  rf_iq_corr_init_args(handler->rx_corr, nof_rx_antennas, args);
+  // async_log=1 hands the log lines of all the threads to a low-priority thread, see async_logger.h
+  uint32_t async_log = 0;
+  parse_uint32(args, "async_log", 0, &async_log);
+  if (async_log) {
+    handler->async_log = srsran_async_log_start() == SRSRAN_SUCCESS;
+  }
+  // rx_zero_fill=<samples> fills RX timeline gaps up to that length with zeros, see rf_timeline.h
+  uint32_t rx_zero_fill = 0;
+  parse_uint32(args, "rx_zero_fill", 0, &rx_zero_fill);
+  rf_timeline_init(&handler->rx_streamer.timeline, rx_zero_fill);
+  // rx_max_latency_ms=<ms> or rx_max_latency_samples=<samples> bound the RX backlog, the oldest packets are dropped
+  parse_uint32(args, "rx_max_latency_ms", 0, &handler->rx_streamer.max_backlog_ms);
+  parse_uint32(args, "rx_max_latency_samples", 0, &handler->rx_streamer.max_backlog);
+  // rx_history_ms=<ms> retains the last RX samples for srsran_rf_recv_history(), see rf_history.h
+  uint32_t rx_history_ms = 0;
+  parse_uint32(args, "rx_history_ms", 0, &rx_history_ms);
+  rf_history_init(&handler->rx_streamer.history, rx_history_ms, streamer_sample_size(&handler->rx_streamer));
+  // cmd_lead_us=<us> applies the timed commands that long before their time, to cover the attribute writes
+  handler->cmd_lead_us = IIO_DEFAULT_CMD_LEAD_US;
+  parse_uint32(args, "cmd_lead_us", 0, &handler->cmd_lead_us);
+  handler->clock_valid = false;
+  // rx_sc12=1 for bitstreams built with PARAM_SC12_PACKING, sending the RX samples packed, see sc12.h
+  uint32_t rx_sc12 = 0;
+  parse_uint32(args, "rx_sc12", 0, &rx_sc12);
+  handler->rx_streamer.sc12 = rx_sc12 != 0;
+  if (handler->rx_streamer.sc12 && nof_rx_antennas > 1) {
+    fprintf(stderr, "rx_sc12 only supports a single RF channel (argument nof_channels=%u)\n", nof_rx_antennas);
+    goto out_error;
+  }
+  // shm_server=<name> shares the RX and TX streams with other processes, see rf_shm_imp.h
+  char shm_name[RF_PARAM_LEN] = "";
+  parse_string(args, "shm_server", 0, shm_name);
+  // udp_server=<port> streams to a host over UDP from the ARM of the board, see rf_udp_server.h
+  uint32_t udp_port    = 0;
+  uint32_t udp_payload = 0;
+  parse_uint32(args, "udp_server", 0, &udp_port);
+  parse_uint32(args, "udp_payload", 0, &udp_payload);
+  // gain_path=reg writes the gains to the AD9361 registers, bypassing the hardwaregain attributes
+  char gain_path[RF_PARAM_LEN] = "attr";
+  parse_string(args, "gain_path", 0, gain_path);
+
   char ctx_addr[RF_PARAM_LEN] = "default";
   bool is_lowspeed_context    = false;
   parse_string(args, "context", 0, ctx_addr);
@@ -578,7 +1175,7 @@ int rf_iio_open_multi(char* args, void** h, uint32_t nof_rx_antennas)
   }
   if (!handler->ctx) {
     fprintf(stderr, "failed to create iio device context\n");
-    return -1;
+    goto out_error;
   }
   if (iio_context_get_devices_count(handler->ctx) <= 0) {
     fprintf(stderr, "Could not find iio devices in context\n");
@@ -604,17 +1201,34 @@ int rf_iio_open_multi(char* args, void** h, uint32_t nof_rx_antennas)
     goto out_error;
   }
 
+  char ch_name[RF_PARAM_LEN];
+
   // Get pointers to PHY device channels responsible for RF parameters configuration
-  handler->rx_streamer._channel = iio_device_find_channel(handler->dev, get_ch_name("voltage", 0), false);
+  handler->rx_streamer._channel = iio_device_find_channel(handler->dev, get_ch_name(ch_name, "voltage", 0), false);
   if (!handler->rx_streamer._channel) {
     fprintf(stderr, "could not set rx phy channel\n");
     goto out_error;
   }
-  handler->tx_streamer._channel = iio_device_find_channel(handler->dev, get_ch_name("voltage", 0), true);
-  if (!handler->rx_streamer._channel) {
+  handler->tx_streamer._channel = iio_device_find_channel(handler->dev, get_ch_name(ch_name, "voltage", 0), true);
+  if (!handler->tx_streamer._channel) {
     fprintf(stderr, "could not set tx phy channel\n");
     goto out_error;
   }
+  if (nof_rx_antennas > 1) {
+    handler->rx_phy2 = iio_device_find_channel(handler->dev, get_ch_name(ch_name, "voltage", 1), false);
+    handler->tx_phy2 = iio_device_find_channel(handler->dev, get_ch_name(ch_name, "voltage", 1), true);
+    if (!handler->rx_phy2 || !handler->tx_phy2) {
+      fprintf(stderr, "could not find the phy channels of the second antenna\n");
+      goto out_error;
+    }
+  }
+  handler->rx_lo = iio_device_find_channel(handler->dev, get_ch_name(ch_name, "altvoltage", 0), true);
+  handler->tx_lo = iio_device_find_channel(handler->dev, get_ch_name(ch_name, "altvoltage", 1), true);
+  if (!handler->rx_lo || !handler->tx_lo) {
+    fprintf(stderr, "could not find the LO channels\n");
+    goto out_error;
+  }
+  iio_gain_init(handler, gain_path);
 
   if (iio_channel_attr_write(handler->rx_streamer._channel, "rf_port_select", "A_BALANCED") <= 0) {
     fprintf(stderr, "failed to create the rf_port with rx = A_BALANCED\n");
@@ -624,21 +1238,28 @@ int rf_iio_open_multi(char* args, void** h, uint32_t nof_rx_antennas)
     fprintf(stderr, "failed to create the rf_port with tx = A\n");
   }
 
-  // Find and enable streaming channels
-  struct iio_channel* tmp_chn[4];
-  for (int ii = 0; ii < 4; ++ii) {
-    struct iio_device* device;
-    device      = (ii < 2) ? handler->rx_streamer._device : handler->tx_streamer._device;
-    tmp_chn[ii] = iio_device_find_channel(device, get_ch_name("voltage", ii % 2), (ii < 2) ? false : true);
-    if (!tmp_chn[ii]) {
-      tmp_chn[ii] = iio_device_find_channel(device, get_ch_name("altvoltage", ii % 2), (ii < 2) ? false : true);
+  // Find and enable streaming channels, I and Q of each antenna: the DMA items interleave the antennas
+  for (uint32_t ii = 0; ii < 4 * nof_rx_antennas; ++ii) {
+    bool                is_tx  = ii >= 2 * nof_rx_antennas;
+    uint32_t            id     = ii % (2 * nof_rx_antennas);
+    struct iio_device*  device = is_tx ? handler->tx_streamer._device : handler->rx_streamer._device;
+    struct iio_channel* chn    = iio_device_find_channel(device, get_ch_name(ch_name, "voltage", id), is_tx);
+    if (!chn) {
+      chn = iio_device_find_channel(device, get_ch_name(ch_name, "altvoltage", id), is_tx);
+    }
+    if (!chn) {
+      fprintf(stderr, "could not find %s streaming channel %u\n", is_tx ? "tx" : "rx", id);
+      goto out_error;
     }
-    iio_channel_enable(tmp_chn[ii]);
+    iio_channel_enable(chn);
   }
 
+  // libiio default
+  handler->nof_kernel_buffers = 4;
   if (is_lowspeed_context) {
     // if USB/Network context is being created, increase number of allocated IIO buffers
-    iio_device_set_kernel_buffers_count(handler->rx_streamer._device, 32);
+    handler->nof_kernel_buffers = 32;
+    iio_device_set_kernel_buffers_count(handler->rx_streamer._device, handler->nof_kernel_buffers);
   }
 
   // in fully embedded setup, we can access registers storing some rx/tx statistics
@@ -656,15 +1277,9 @@ int rf_iio_open_multi(char* args, void** h, uint32_t nof_rx_antennas)
                                  &handler->rx_streamer._fs_hz);
   handler->tx_streamer._fs_hz = handler->rx_streamer._fs_hz;
 
-  pthread_mutex_init(&handler->rx_streamer.stream_mutex, NULL);
-  pthread_cond_init(&handler->rx_streamer.stream_cvar, NULL);
-  srsran_ringbuffer_init(&handler->rx_streamer.ring_buffer, 1500 * 1920);
   handler->rx_streamer.thread_completed = false;
   pthread_create(&handler->rx_streamer.thread, NULL, reader_thread, handler);
 
-  pthread_mutex_init(&handler->tx_streamer.stream_mutex, NULL);
-  pthread_cond_init(&handler->tx_streamer.stream_cvar, NULL);
-  srsran_ringbuffer_init(&handler->tx_streamer.ring_buffer, 200 * 1920);
   handler->tx_streamer.thread_completed = false;
   pthread_create(&handler->tx_streamer.thread, NULL, writer_thread, handler);
 
@@ -674,12 +1289,44 @@ int rf_iio_open_multi(char* args, void** h, uint32_t nof_rx_antennas)
   handler->rx_streamer.preamble_location = 0;
   handler->tx_streamer.preamble_location = 0;
 
+  handler->rx_streamer.srate_switch_pending = false;
+  handler->rx_streamer.srate_rebase_pending = false;
+  handler->rx_streamer.nof_stale_buffers    = 0;
+  rf_rx_window_reset(&handler->rx_streamer.window);
+  pthread_create(&handler->cmd_thread, NULL, cmd_thread, handler);
+  rf_inband_status_reset(&handler->rx_status);
+  bzero(&handler->rx_stats, sizeof(srsran_vec_stats_t));
+  bzero(&handler->tx_stats, sizeof(srsran_vec_stats_t));
+  handler->player   = NULL;
+  handler->recorder = NULL;
+  if (record_path[0]) {
+    handler->recorder = (rf_recorder_t*)malloc(sizeof(rf_recorder_t));
+    if (!handler->recorder || rf_recorder_init(handler->recorder, record_path, nof_rx_antennas) < SRSRAN_SUCCESS) {
+      free(handler->recorder);
+      handler->recorder = NULL;
+      goto out_error;
+    }
+  }
+  if (shm_name[0] &&
+      rf_shm_server_init(&handler->shm, shm_name, nof_rx_antennas, handler, client_tx) < SRSRAN_SUCCESS) {
+    goto out_error;
+  }
+  if (udp_port &&
+      rf_udp_server_init(&handler->udp, (uint16_t)udp_port, udp_payload, nof_rx_antennas, handler, client_tx) <
+          SRSRAN_SUCCESS) {
+    goto out_error;
+  }
+  handler->tstamp_base                      = 0;
+  handler->time_base_secs                   = 0;
+  handler->time_base_frac                   = 0;
+
   rf_iio_use_timestamping(handler, n_prb);
 
   return 0;
 
 out_error:
-  iio_context_destroy(handler->ctx);
+  rf_iio_close(handler);
+  *h = NULL;
   return -1;
 }
 
@@ -693,15 +1340,67 @@ int rf_iio_open(char* args, void** h)
   return rf_iio_open_multi(args, h, 1);
 }
 
+// The thread is woken up wherever it waits and joined, cancelling it could leave a ring buffer or logger lock held
+static void close_streamer(rf_iio_streamer* streamer)
+{
+  if (streamer->thread) {
+    pthread_mutex_lock(&streamer->stream_mutex);
+    streamer->closing       = true;
+    streamer->stream_active = false;
+    pthread_cond_broadcast(&streamer->stream_cvar);
+    pthread_mutex_unlock(&streamer->stream_mutex);
+    srsran_ringbuffer_stop(&streamer->ring_buffer);
+    if (streamer->_buf) {
+      iio_buffer_cancel(streamer->_buf);
+    }
+    pthread_join(streamer->thread, NULL);
+    streamer->thread = 0;
+  }
+  if (streamer->_buf) {
+    iio_buffer_destroy(streamer->_buf);
+    streamer->_buf = NULL;
+  }
+  srsran_ringbuffer_free(&streamer->ring_buffer);
+  pthread_mutex_destroy(&streamer->stream_mutex);
+  pthread_cond_destroy(&streamer->stream_cvar);
+}
+
 int rf_iio_close(void* h)
 {
   rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
 
-  if (handler->tx_streamer.thread && !handler->tx_streamer.thread_completed) {
-    pthread_cancel(handler->tx_streamer.thread);
-  }
-  if (handler->rx_streamer.thread && !handler->rx_streamer.thread_completed) {
-    pthread_cancel(handler->rx_streamer.thread);
+  if (handler->player) {
+    // unblock the playback thread, the TX thread is about to be stopped
+    srsran_ringbuffer_stop(&handler->tx_streamer.ring_buffer);
+    rf_iio_stop_playback(h);
+  }
+  // the clients see the server going away, its TX thread may be blocked on the TX ring buffer as well
+  if (rf_shm_server_enabled(&handler->shm)) {
+    srsran_ringbuffer_stop(&handler->tx_streamer.ring_buffer);
+    rf_shm_server_free(&handler->shm);
+  }
+  if (rf_udp_server_enabled(&handler->udp)) {
+    srsran_ringbuffer_stop(&handler->tx_streamer.ring_buffer);
+    rf_udp_server_free(&handler->udp);
+  }
+  // the threads must be gone before the handler is freed
+  close_streamer(&handler->tx_streamer);
+  close_streamer(&handler->rx_streamer);
+  rf_timeline_t* timeline = &handler->rx_streamer.timeline;
+  uint64_t nof_dropped = srsran_ringbuffer_nof_dropped(&handler->rx_streamer.ring_buffer);
+  if (handler->rx_streamer.nof_backlog_drops) {
+    INFO("RF_IIO: %lu RX samples dropped to bound the latency\n",
+         (unsigned long)handler->rx_streamer.nof_backlog_drops);
+  }
+  if (nof_dropped) {
+    INFO("RF_IIO: %lu RX packets dropped on a full ring buffer\n", (unsigned long)nof_dropped);
+  }
+  if (timeline->nof_gaps || timeline->nof_overlaps) {
+    INFO("RF_IIO: RX timeline had %lu gaps (%lu samples lost, %lu zero-filled) and %lu overlaps\n",
+         (unsigned long)timeline->nof_gaps,
+         (unsigned long)timeline->nof_lost,
+         (unsigned long)timeline->nof_filled,
+         (unsigned long)timeline->nof_overlaps);
   }
   // print statistics
   // if (handler->num_lates) printf("#lates=%d\n", handler->num_lates);
@@ -709,7 +1408,34 @@ int rf_iio_close(void* h)
   // if (handler->num_underflows) printf("#underflows=%d\n", handler->num_underflows);
   // if (handler->num_time_errors) printf("#time_errors=%d\n", handler->num_time_errors);
   // if (handler->num_other_errors) printf("#other_errors=%d\n", handler->num_other_errors);
-  // iio_context_destroy(handler->ctx);
+  rf_cmd_queue_stop(&handler->cmd_queue);
+  if (handler->cmd_thread) {
+    pthread_join(handler->cmd_thread, NULL);
+  }
+  rf_cmd_queue_free(&handler->cmd_queue);
+  pthread_mutex_destroy(&handler->clock_mutex);
+  pthread_mutex_destroy(&handler->cfg_mutex);
+  rf_history_free(&handler->rx_streamer.history);
+  for (int i = 0; i < SRSRAN_RINGBUFFER_MAX_TAPS; i++) {
+    free(handler->rx_streamer.consumers[i].buffer);
+  }
+  free(handler->rx_streamer.sc12_buf);
+  if (handler->recorder) {
+    rf_recorder_free(handler->recorder);
+    free(handler->recorder);
+    handler->recorder = NULL;
+  }
+  if (handler->memory_map_ptr) {
+    munmap((void*)handler->memory_map_ptr, MM_REG_SIZE);
+  }
+  if (handler->ctx) {
+    iio_context_destroy(handler->ctx);
+  }
+  // writes the lines still pending, the rings of the exited threads are freed
+  if (handler->async_log) {
+    srsran_async_log_stop();
+  }
+  free(handler);
 
   return SRSRAN_SUCCESS;
 }
@@ -728,34 +1454,159 @@ void check_overflow(void* h)
 
 enum { COMMON = 0, TIME_DOMAIN = 1, TIMESTAMP = 2 };
 
-int preamble_fsm(void* h, uint32_t* input)
+// The metadata words are carried by the first channel of the DMA items, stride words apart
+int preamble_fsm(void* h, uint32_t* input, uint32_t stride)
 {
   rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
   int               state   = COMMON;
   for (int i = 0; i < METADATA_NSAMPLES; i++) {
     switch (state) {
       case COMMON:
-        if (input[0] == common_preamble1 && input[1] == common_preamble2 && input[2] == common_preamble3) {
+        if (input[0] == common_preamble1 && input[stride] == common_preamble2 &&
+            input[2 * stride] == common_preamble3) {
           state = TIME_DOMAIN;
         } else {
           return 0;
         }
         break;
       case TIME_DOMAIN:
-        if (input[3] == time_preamble1 && input[4] == time_preamble2 && input[5] == time_preamble3) {
+        if (input[3 * stride] == time_preamble1 && input[4 * stride] == time_preamble2 &&
+            (input[5 * stride] == time_preamble3 || rf_inband_status_match(input[5 * stride]))) {
           state = TIMESTAMP;
         } else {
           return 0;
         }
         break;
       case TIMESTAMP:
-        handler->rx_streamer.current_tstamp = *((uint64_t*)(&input[6]));
+        handler->rx_streamer.current_tstamp = ((uint64_t)input[7 * stride] << 32) | input[6 * stride];
         return 1;
     }
   }
   return 0;
 }
 
+int rf_iio_issue_stream_cmd(void* h, const srsran_rf_stream_cmd_t* cmd)
+{
+  rf_iio_handler_t* handler  = (rf_iio_handler_t*)h;
+  rf_iio_streamer*  streamer = &handler->rx_streamer;
+
+  if (cmd->mode == SRSRAN_RF_STREAM_MODE_STOP && !cmd->has_time_spec) {
+    return rf_iio_stop_rx_stream(h);
+  }
+  if (cmd->has_time_spec && !handler->use_timestamps) {
+    ERROR("RF_IIO: timed stream commands require timestamping\n");
+    return SRSRAN_ERROR;
+  }
+  // an empty finite capture would otherwise arm a continuous window
+  if (cmd->mode == SRSRAN_RF_STREAM_MODE_NUM_SAMPS_AND_DONE && cmd->nof_samples == 0) {
+    ERROR("RF_IIO: a finite capture needs at least one sample\n");
+    return SRSRAN_ERROR;
+  }
+  // the requested window is enforced by the reader thread
+  if (cmd->mode != SRSRAN_RF_STREAM_MODE_STOP && (!streamer->stream_active || streamer->thread_completed)) {
+    rf_iio_start_rx_stream(h, !cmd->has_time_spec);
+  }
+  uint64_t tick = cmd->has_time_spec ? time_to_tstamp_iio(handler, cmd->secs, cmd->frac_secs) : 0;
+
+  pthread_mutex_lock(&streamer->stream_mutex);
+  rf_rx_window_arm(&streamer->window, cmd, tick);
+  pthread_cond_broadcast(&streamer->stream_cvar);
+  // wait until the reader thread dropped the samples buffered before the command
+  while (streamer->window.flush && !streamer->thread_completed) {
+    pthread_cond_wait(&streamer->stream_cvar, &streamer->stream_mutex);
+  }
+  pthread_mutex_unlock(&streamer->stream_mutex);
+  streamer->prev_header.nof_samples = 0;
+  return SRSRAN_SUCCESS;
+}
+
+/*
+ * Called by the reader thread once a finite capture is complete: signals the end of the burst to the consumer and
+ * stops refilling until a new stream command, a rate switch or the end of the stream. The buffers the kernel kept
+ * filling meanwhile are discarded on resume.
+ */
+static void finish_rx_window(rf_iio_handler_t* handler)
+{
+  rf_iio_streamer* streamer = &handler->rx_streamer;
+
+  pthread_mutex_lock(&streamer->stream_mutex);
+  if (!streamer->window.done) {
+    tx_header_t eob = {
+        .magic = PKT_HEADER_MAGIC, .timestamp = streamer->window.end, .nof_samples = 0, .end_of_burst = true};
+    srsran_ringbuffer_part_t part = {&eob, sizeof(tx_header_t)};
+    srsran_ringbuffer_write_packet(&streamer->ring_buffer, &part, 1, 0);
+    if (rf_shm_server_enabled(&handler->shm)) {
+      rf_shm_server_push_rx(&handler->shm, streamer->window.end, NULL, 0, true);
+    }
+    if (rf_udp_server_enabled(&handler->udp)) {
+      rf_udp_server_push_rx(&handler->udp, streamer->window.end, NULL, 0, true);
+    }
+    streamer->window.done = true;
+  }
+  while (streamer->stream_active && streamer->window.done && !streamer->srate_switch_pending) {
+    pthread_cond_wait(&streamer->stream_cvar, &streamer->stream_mutex);
+  }
+  streamer->nof_stale_buffers = handler->nof_kernel_buffers;
+  pthread_mutex_unlock(&streamer->stream_mutex);
+  rf_timeline_reset(&streamer->timeline);
+}
+
+// Points parts at count samples of a packet payload, skipping the first offset ones. The metadata may have been
+// received in the middle of the packet, with payload samples on both sides. Returns the number of parts.
+static int payload_parts(rf_iio_handler_t*        handler,
+                         uint16_t*                buf_ptr_tmp,
+                         uint32_t                 offset,
+                         uint32_t                 count,
+                         srsran_ringbuffer_part_t parts[2])
+{
+  rf_iio_streamer* streamer  = &handler->rx_streamer;
+  int              nof_parts = 0;
+  uint32_t         nof_words = 2 * streamer->nof_channels; // per sample time
+
+  uint32_t head_len = streamer->head_samples;
+  if (offset < head_len) {
+    uint32_t n                 = SRSRAN_MIN(head_len - offset, count);
+    parts[nof_parts].ptr       = &buf_ptr_tmp[nof_words * offset];
+    parts[nof_parts].nof_bytes = streamer_sample_size(streamer) * n;
+    nof_parts++;
+    count -= n;
+    offset = head_len;
+  }
+  if (count) {
+    parts[nof_parts].ptr       = &buf_ptr_tmp[(streamer->metadata_samples + offset) * nof_words];
+    parts[nof_parts].nof_bytes = streamer_sample_size(streamer) * count;
+    nof_parts++;
+  }
+  return nof_parts;
+}
+
+// Unpacks the sc12 payload of a DMA buffer of nof_words words (metadata excluded) to sc16 around the metadata, in the
+// layout of an sc16 buffer. Only whole groups are unpacked: when the metadata is misaligned, the words of the
+// incomplete group ending the previous frame are dropped. Returns the unpacked buffer, NULL if it cannot be allocated.
+static int16_t* unpack_sc12(rf_iio_streamer* streamer, const uint32_t* src, uint32_t nof_words, uint32_t* nof_samples)
+{
+  uint32_t loc  = (uint32_t)streamer->preamble_location;
+  uint32_t meta = (uint32_t)streamer->metadata_samples;
+  uint32_t head = loc / 3 * 4;
+  uint32_t tail = (nof_words - loc) / 3 * 4;
+  if (head + tail + meta > streamer->sc12_buf_len) {
+    free(streamer->sc12_buf);
+    streamer->sc12_buf_len = head + tail + meta;
+    streamer->sc12_buf     = srsran_vec_malloc(2 * sizeof(int16_t) * streamer->sc12_buf_len);
+    if (!streamer->sc12_buf) {
+      streamer->sc12_buf_len = 0;
+      return NULL;
+    }
+  }
+  int16_t* dst = streamer->sc12_buf;
+  srsran_sc12_unpack((const uint8_t*)&src[loc % 3], dst, 2 * head);
+  memcpy(&dst[2 * head], &src[loc], meta * sizeof(uint32_t));
+  srsran_sc12_unpack((const uint8_t*)&src[loc + meta], &dst[2 * (head + meta)], 2 * tail);
+  streamer->head_samples = head;
+  *nof_samples           = head + tail;
+  return dst;
+}
+
 static void* reader_thread(void* arg)
 {
   rf_iio_handler_t*  handler = (rf_iio_handler_t*)arg;
@@ -764,16 +1615,36 @@ static void* reader_thread(void* arg)
   pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
 
   pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
-  while (!handler->rx_streamer.stream_active) {
+  while (!handler->rx_streamer.stream_active && !handler->rx_streamer.closing) {
     pthread_cond_wait(&handler->rx_streamer.stream_cvar, &handler->rx_streamer.stream_mutex);
   }
+  if (handler->rx_streamer.closing) {
+    pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
+    goto exit;
+  }
   handler->rx_streamer.thread_completed = false;
+  rf_timeline_reset(&handler->rx_streamer.timeline);
+  rf_history_set_srate(&handler->rx_streamer.history, handler->rx_streamer._fs_hz);
+  if (rf_shm_server_enabled(&handler->shm)) {
+    rf_shm_server_set_time(&handler->shm,
+                           handler->rx_streamer._fs_hz,
+                           handler->tstamp_base,
+                           handler->time_base_secs,
+                           handler->time_base_frac);
+  }
+  if (rf_udp_server_enabled(&handler->udp)) {
+    rf_udp_server_set_time(&handler->udp,
+                           handler->rx_streamer._fs_hz,
+                           handler->tstamp_base,
+                           handler->time_base_secs,
+                           handler->time_base_frac);
+  }
   pthread_cond_signal(&handler->rx_streamer.stream_cvar);
   pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
 
   if (!buffer_initialized(&handler->rx_streamer)) {
-    handler->rx_streamer._buf = iio_device_create_buffer(
-        handler->rx_streamer._device, rx_data_buffer_size + handler->rx_streamer.metadata_samples, false);
+    handler->rx_streamer._buf =
+        iio_device_create_buffer(handler->rx_streamer._device, rx_buffer_items(&handler->rx_streamer), false);
     if (!handler->rx_streamer._buf) {
       INFO("RF_IIO: Failed to create an IIO buffer\n");
       goto exit;
@@ -782,11 +1653,29 @@ static void* reader_thread(void* arg)
     srsran_ringbuffer_reset(&handler->rx_streamer.ring_buffer);
   }
 
-  tx_header_t header = {};
+  tx_header_t    header      = {};
+  const uint32_t stride      = handler->rx_streamer.nof_channels; // words per DMA item
+  const size_t   sample_size = streamer_sample_size(&handler->rx_streamer);
 
   while (handler->rx_streamer.stream_active) {
+    if (handler->rx_streamer.srate_switch_pending && !handler->rx_streamer.srate_rebase_pending) {
+      switch_rx_srate(handler);
+    }
+    if (handler->rx_streamer.window.flush) {
+      // a new stream command was issued, drop what was buffered before it
+      pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
+      srsran_ringbuffer_reset(&handler->rx_streamer.ring_buffer);
+      rf_timeline_reset(&handler->rx_streamer.timeline);
+      handler->rx_streamer.window.flush = false;
+      pthread_cond_broadcast(&handler->rx_streamer.stream_cvar);
+      pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
+    }
     int buffer_ret =
         refill_buffer(&handler->rx_streamer, &handler->rx_streamer._buf_count, &handler->rx_streamer.byte_offset);
+    if (buffer_ret > 0 && handler->rx_streamer.nof_stale_buffers > 0) {
+      handler->rx_streamer.nof_stale_buffers--;
+      continue;
+    }
     if (buffer_ret <= 0) {
       /* If stream is not active, no need to report an error,
        * as we are just cancelling the thread (probably because of changing sample rate, or switching to FPGA
@@ -806,17 +1695,35 @@ static void* reader_thread(void* arg)
     uint32_t* start_ptr             = (uint32_t*)src_ptr;
 
     if (handler->use_timestamps) {
-      if (!preamble_fsm(handler, &start_ptr[handler->rx_streamer.preamble_location])) {
-        printf("misaligned packet received from the DMA\n");
+      if (!preamble_fsm(handler, &start_ptr[stride * handler->rx_streamer.preamble_location], stride)) {
+        ERROR("RF_IIO: misaligned packet received from the DMA\n");
         // break;
-        for (int i = 0; i < (rx_data_buffer_size - (METADATA_NSAMPLES - 1)); i++) {
-          if (preamble_fsm(handler, &start_ptr[i])) {
-            printf("realigning at index  %d\n", i);
+        for (int i = 0; i < (handler->rx_streamer._buf_count - (METADATA_NSAMPLES - 1)); i++) {
+          if (preamble_fsm(handler, &start_ptr[stride * i], stride)) {
+            INFO("RF_IIO: realigning at index %d\n", i);
             handler->rx_streamer.preamble_location = i;
           }
         }
       }
-      header.timestamp = handler->rx_streamer.current_tstamp;
+    }
+    handler->rx_streamer.head_samples = handler->rx_streamer.preamble_location;
+    if (handler->rx_streamer.sc12) {
+      int16_t* unpacked = unpack_sc12(&handler->rx_streamer, start_ptr, header.nof_samples, &header.nof_samples);
+      if (!unpacked) {
+        ERROR("RF_IIO: could not allocate the sc12 buffer\n");
+        continue;
+      }
+      src_ptr = (uintptr_t)unpacked;
+    }
+
+    if (handler->use_timestamps) {
+      header.timestamp = handler->rx_streamer.current_tstamp - (handler->rx_streamer.sc12 ? SC12_TSTAMP_DELAY : 0);
+    }
+    if (handler->rx_streamer.srate_rebase_pending) {
+      finish_rx_srate_switch(handler, header.timestamp);
+    }
+    if (handler->use_timestamps) {
+      hw_clock_update(handler, header.timestamp + header.nof_samples);
       // printf("RX timestamp = %lu \n", header.timestamp);
 #ifdef PRINT_TIMESTAMPS
       time_t secs;
@@ -825,7 +1732,7 @@ static void* reader_thread(void* arg)
 
       struct timeval time;
       gettimeofday(&time, NULL);
-      if (firstGo < 5) {
+      if (handler->nof_ts_prints < 5) {
         if (frac_secs && secs) {
           printf("rec sec %lu frac %f or %lu ticks  [%4d] [%d] \n",
                  secs,
@@ -838,42 +1745,149 @@ static void* reader_thread(void* arg)
 #endif
     }
 
-    check_overflow(handler);
-    srsran_ringbuffer_write(&handler->rx_streamer.ring_buffer, &header, sizeof(tx_header_t));
+    // bitstreams reporting the status in-band spare the register read
+    uint32_t status_word =
+        handler->use_timestamps ? start_ptr[stride * (handler->rx_streamer.preamble_location + 5)] : 0;
+    if (rf_inband_status_match(status_word)) {
+      if (rf_inband_status_parse(&handler->rx_status, status_word)) {
+        INFO("[IIO] Overflow detected");
+        log_overflow(handler);
+      }
+    } else {
+      check_overflow(handler);
+    }
 
-    uint16_t* buf_ptr_tmp = (uint16_t*)src_ptr;
-    uint16_t* buf_ptr;
+    // keep only the samples requested by the last stream command
+    uint32_t offset          = 0;
+    bool     window_finished = false;
+    if (handler->use_timestamps) {
+      uint64_t end_tstamp = header.timestamp + header.nof_samples;
+      pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
+      bool in_window  = rf_rx_window_clip(
+          &handler->rx_streamer.window, header.timestamp, header.nof_samples, &offset, &header.nof_samples);
+      window_finished = rf_rx_window_finished(&handler->rx_streamer.window, end_tstamp);
+      pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
+      if (!in_window) {
+        if (window_finished) {
+          finish_rx_window(handler);
+        }
+        continue;
+      }
+      header.timestamp += offset;
+    }
 
-    int ret1 = 0;
-    if (handler->rx_streamer.preamble_location == 0) {
-      buf_ptr = &buf_ptr_tmp[handler->rx_streamer.metadata_samples * 2];
-      ret1    = srsran_ringbuffer_write(
-          &handler->rx_streamer.ring_buffer, buf_ptr, 2 * sizeof(uint16_t) * handler->rx_streamer._buf_count);
-    } else {
-      buf_ptr = &buf_ptr_tmp[0];
-      ret1    = srsran_ringbuffer_write(
-          &handler->rx_streamer.ring_buffer, buf_ptr, 2 * sizeof(uint16_t) * handler->rx_streamer.preamble_location);
+    // header, zero fill and payload parts of the packet
+    srsran_ringbuffer_part_t parts[5] = {};
+    int nof_payload_parts = payload_parts(handler, (uint16_t*)src_ptr, offset, header.nof_samples, &parts[3]);
+    if (handler->recorder) {
+      uint64_t rec_ts = handler->use_timestamps ? header.timestamp : RF_RECORDER_NO_TSTAMP;
+      for (int i = 0; i < nof_payload_parts; i++) {
+        rf_recorder_push(handler->recorder,
+                         rec_ts,
+                         handler->rx_streamer._fs_hz,
+                         parts[3 + i].ptr,
+                         parts[3 + i].nof_bytes / sample_size);
+        rec_ts = RF_RECORDER_NO_TSTAMP;
+      }
+    }
+
+    // check the packet against the end of the previous one
+    int64_t  diff = handler->use_timestamps ? rf_timeline_check(&handler->rx_streamer.timeline, header.timestamp) : 0;
+    uint32_t fill = 0;
+    if (diff < 0) {
+      if ((uint64_t)-diff < header.nof_samples) {
+        // the start of the packet was already delivered
+        offset += (uint32_t)-diff;
+        header.timestamp += (uint64_t)-diff;
+        header.nof_samples -= (uint32_t)-diff;
+        INFO("RF_IIO: RX timeline overlap of %ld samples\n", (long)-diff);
+      } else {
+        // the timestamps went back by more than a packet, start a new timeline rather than dropping everything
+        ERROR("RF_IIO: RX timestamp went back by %ld samples\n", (long)-diff);
+        diff = 0;
+      }
+    } else if (diff > 0) {
+      INFO("RF_IIO: RX timeline gap of %ld samples\n", (long)diff);
+      uint64_t nof_unreported = rf_timeline_unreported(&handler->rx_streamer.timeline, header.timestamp, diff);
+      if (nof_unreported) {
+        log_gap(handler, nof_unreported);
+      }
+      if (diff <= handler->rx_streamer.timeline.max_fill) {
+        fill = (uint32_t)diff;
+      }
+    }
 
-      buf_ptr = &buf_ptr_tmp[(handler->rx_streamer.preamble_location + 8) * 2];
+    if (diff < 0) {
+      nof_payload_parts = payload_parts(handler, (uint16_t*)src_ptr, offset, header.nof_samples, &parts[3]);
+    }
 
-      ret1 += srsran_ringbuffer_write(&handler->rx_streamer.ring_buffer,
-                                      buf_ptr, 2 * sizeof(uint16_t) *
-                                      (handler->rx_streamer._buf_count - (handler->rx_streamer.preamble_location)));
+    // the zero fill goes with the packet as long as both fit, the space only grows until the write below
+    if (fill && (size_t)srsran_ringbuffer_space(&handler->rx_streamer.ring_buffer) <
+                    2 * sizeof(tx_header_t) + sample_size * (fill + header.nof_samples)) {
+      fill = 0;
     }
-    if (ret1 < 2 * sizeof(uint16_t) * handler->rx_streamer._buf_count) {
-      ERROR("Error writing to buffer in rx thread, ret is %d but should be %d\n",
-            ret1, (int)(2 * sizeof(uint16_t) * handler->rx_streamer._buf_count));
+    tx_header_t fill_header = {.magic = PKT_HEADER_MAGIC, .timestamp = header.timestamp - fill, .nof_samples = fill};
+    parts[0] = (srsran_ringbuffer_part_t){&fill_header, sizeof(tx_header_t)};
+    parts[1] = (srsran_ringbuffer_part_t){NULL, (int)(sample_size * fill)};
+    parts[2] = (srsran_ringbuffer_part_t){&header, sizeof(tx_header_t)};
+    if (srsran_ringbuffer_write_packet(&handler->rx_streamer.ring_buffer,
+                                       fill ? parts : &parts[2],
+                                       (fill ? 3 : 1) + nof_payload_parts,
+                                       0) < 0) {
+      // dropped whole and reported here, the timeline is not advanced so that the next packet zero-fills the samples
+      INFO("RF_IIO: RX ring buffer full, packet of %u samples dropped\n", header.nof_samples);
+      log_overflow(handler);
+      if (handler->use_timestamps) {
+        rf_timeline_drop(&handler->rx_streamer.timeline, header.timestamp, header.nof_samples);
+      }
+    } else if (handler->use_timestamps) {
+      rf_timeline_advance(&handler->rx_streamer.timeline, diff, fill, header.timestamp, header.nof_samples);
+    }
+    if (handler->use_timestamps) {
+      // the history keeps the packets the ring buffer had no room for, a gap restarts it
+      uint64_t history_ts = header.timestamp;
+      for (int i = 0; i < nof_payload_parts; i++) {
+        uint32_t nof_part_samples = parts[3 + i].nof_bytes / sample_size;
+        rf_history_push(&handler->rx_streamer.history, history_ts, parts[3 + i].ptr, nof_part_samples);
+        history_ts += nof_part_samples;
+      }
+    }
+    if (rf_shm_server_enabled(&handler->shm) || rf_udp_server_enabled(&handler->udp)) {
+      // the clients get their own copy, whatever room the ring buffer had
+      uint64_t client_ts = header.timestamp;
+      for (int i = 0; i < nof_payload_parts; i++) {
+        uint32_t nof_part_samples = parts[3 + i].nof_bytes / sample_size;
+        if (rf_shm_server_enabled(&handler->shm)) {
+          rf_shm_server_push_rx(&handler->shm, client_ts, parts[3 + i].ptr, nof_part_samples, false);
+        }
+        if (rf_udp_server_enabled(&handler->udp)) {
+          rf_udp_server_push_rx(&handler->udp, client_ts, parts[3 + i].ptr, nof_part_samples, false);
+        }
+        client_ts += nof_part_samples;
+      }
+    }
+    if (window_finished) {
+      finish_rx_window(handler);
     }
   }
 
 exit:
   pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
   handler->rx_streamer.thread_completed = true;
-  pthread_cond_signal(&handler->rx_streamer.stream_cvar);
+  pthread_cond_broadcast(&handler->rx_streamer.stream_cvar);
   pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
   return NULL;
 }
 
+// Samples the RX ring buffer may hold before the oldest packets are dropped, 0 if unbounded
+static uint64_t rx_max_backlog(const rf_iio_streamer* streamer)
+{
+  if (streamer->max_backlog) {
+    return streamer->max_backlog;
+  }
+  return (uint64_t)streamer->max_backlog_ms * (uint64_t)streamer->_fs_hz / 1000;
+}
+
 int rf_iio_recv_with_time_multi(void*    h,
                                 void*    data[SRSRAN_MAX_PORTS],
                                 uint32_t nsamples,
@@ -883,10 +1897,15 @@ int rf_iio_recv_with_time_multi(void*    h,
 {
   rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
 
-  size_t rxd_samples_total = 0;
-  int    trials            = 0;
+  size_t   rxd_samples_total = 0;
+  int      trials            = 0;
+  uint64_t first_tstamp      = handler->rx_streamer.prev_header.timestamp;
+  uint64_t max_backlog       = rx_max_backlog(&handler->rx_streamer);
+  uint64_t nof_dropped       = 0;
+  uint64_t dropped_tstamp    = 0;
+  size_t   sample_size       = streamer_sample_size(&handler->rx_streamer);
 
-  cf_t* data_ptr = data[0];
+  bool end_of_burst = false;
   while (rxd_samples_total < nsamples && trials < 100) {
     if (!handler->rx_streamer.prev_header.nof_samples) {
       if (srsran_ringbuffer_read(
@@ -899,25 +1918,54 @@ int rf_iio_recv_with_time_multi(void*    h,
         srsran_ringbuffer_reset(&handler->rx_streamer.ring_buffer);
         return 0;
       }
+      if (handler->rx_streamer.prev_header.end_of_burst) {
+        // finite capture completed, return what is left of it
+        handler->rx_streamer.prev_header.end_of_burst = false;
+        if (!rxd_samples_total) {
+          first_tstamp = handler->rx_streamer.prev_header.timestamp;
+        }
+        end_of_burst = true;
+        break;
+      }
+      // the application fell behind, drop the oldest packets to get back close to real time
+      if (max_backlog && !rxd_samples_total &&
+          srsran_ringbuffer_status(&handler->rx_streamer.ring_buffer) / sample_size > max_backlog) {
+        if (!nof_dropped) {
+          dropped_tstamp = handler->rx_streamer.prev_header.timestamp;
+        }
+        nof_dropped += handler->rx_streamer.prev_header.nof_samples;
+        srsran_ringbuffer_discard(&handler->rx_streamer.ring_buffer,
+                                  sample_size * handler->rx_streamer.prev_header.nof_samples);
+        handler->rx_streamer.prev_header.nof_samples = 0;
+        continue;
+      }
     }
 
+    if (!rxd_samples_total) {
+      first_tstamp = handler->rx_streamer.prev_header.timestamp;
+    }
     uint32_t read_samples = SRSRAN_MIN(handler->rx_streamer.prev_header.nof_samples, nsamples - rxd_samples_total);
-    if (srsran_ringbuffer_read(&handler->rx_streamer.ring_buffer,
-                               (void*)&handler->rx_streamer._conv_buffer[2 * rxd_samples_total],
-                               2 * sizeof(uint16_t) * read_samples) < 0) {
+    int16_t* dst          = &handler->rx_streamer._conv_buffer[sample_size / sizeof(int16_t) * rxd_samples_total];
+    if (srsran_ringbuffer_read(&handler->rx_streamer.ring_buffer, (void*)dst, sample_size * read_samples) < 0) {
       printf("Error reading buffer\n");
       return -1;
     }
+    // the header keeps the tick of the next sample left in the ring buffer
     handler->rx_streamer.prev_header.nof_samples -= read_samples;
-
-    if (read_samples != nsamples) {
-      handler->rx_streamer.prev_header.timestamp -= rxd_samples_total;
-    }
+    handler->rx_streamer.prev_header.timestamp += read_samples;
     rxd_samples_total += read_samples;
     trials++;
   }
+  if (nof_dropped) {
+    INFO("RF_IIO: RX backlog over %lu samples, %lu samples dropped from tick %lu\n",
+         (unsigned long)max_backlog,
+         (unsigned long)nof_dropped,
+         (unsigned long)dropped_tstamp);
+    handler->rx_streamer.nof_backlog_drops += nof_dropped;
+    log_gap(handler, nof_dropped);
+  }
 
-  tstamp_to_time_iio(handler, handler->rx_streamer.prev_header.timestamp, secs, frac_secs);
+  tstamp_to_time_iio(handler, first_tstamp, secs, frac_secs);
 #ifdef PRINT_TIMESTAMPS
   struct timeval time;
   gettimeofday(&time, NULL);
@@ -926,14 +1974,160 @@ int rf_iio_recv_with_time_multi(void*    h,
     // handler->rx_streamer.prev_header.timestamp, time.tv_usec,time.tv_sec);
     INFO("receive timestamp = %.6lf secs, or %lu ticks",
          (double)*secs + *frac_secs,
-         handler->rx_streamer.prev_header.timestamp);
+         first_tstamp);
   }
 #endif
 
-  srsran_vec_convert_if(&handler->rx_streamer._conv_buffer[0], 32768, (float*)data_ptr, 2 * rxd_samples_total);
+  // the channels are split from the interleaved DMA items by the conversion itself
+  srsran_vec_stats_t stats = {};
+  rf_iq_corr_convert_multi(handler->rx_corr,
+                           handler->rx_streamer._conv_buffer,
+                           32768,
+                           (float**)data,
+                           handler->rx_streamer.nof_channels,
+                           rxd_samples_total,
+                           &stats);
+  handler->rx_stats = stats;
   /*printf("receive timestamp = %.6lf secs, or %lu ticks\n", (double)*secs + *frac_secs,
             handler->rx_streamer.prev_header.timestamp);*/
-  return (int)nsamples;
+  return end_of_burst ? (int)rxd_samples_total : (int)nsamples;
+}
+
+int rf_iio_recv_history(void* h, void** data, uint32_t nsamples, time_t secs, double frac_secs)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+
+  if (!rf_history_enabled(&handler->rx_streamer.history) || !handler->use_timestamps) {
+    return SRSRAN_ERROR;
+  }
+  int16_t* buffer = srsran_vec_malloc(streamer_sample_size(&handler->rx_streamer) * nsamples);
+  if (!buffer) {
+    return SRSRAN_ERROR;
+  }
+  int ret =
+      rf_history_read(&handler->rx_streamer.history, time_to_tstamp_iio(handler, secs, frac_secs), buffer, nsamples);
+  if (ret == SRSRAN_SUCCESS) {
+    rf_iq_corr_apply_multi(
+        handler->rx_corr, buffer, 32768, (float**)data, handler->rx_streamer.nof_channels, nsamples);
+  }
+  free(buffer);
+  return ret;
+}
+
+// Secondary RX consumers are taps of the ring buffer, see srsran_rf_open_rx_consumer()
+int rf_iio_open_rx_consumer(void* h, srsran_rf_consumer_policy_t policy)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+
+  srsran_ringbuffer_tap_policy_t tap_policy =
+      (policy == SRSRAN_RF_CONSUMER_HOLD) ? SRSRAN_RINGBUFFER_TAP_HOLD : SRSRAN_RINGBUFFER_TAP_SKIP;
+  int consumer = srsran_ringbuffer_tap_open(&handler->rx_streamer.ring_buffer, tap_policy);
+  if (consumer < 0) {
+    ERROR("RF_IIO: all the RX consumers are in use\n");
+    return SRSRAN_ERROR;
+  }
+  handler->rx_streamer.consumers[consumer].header.nof_samples = 0;
+  return consumer;
+}
+
+// Must not be called while the consumer is reading
+int rf_iio_close_rx_consumer(void* h, int consumer)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+
+  if (consumer < 0 || consumer >= SRSRAN_RINGBUFFER_MAX_TAPS) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  srsran_ringbuffer_tap_close(&handler->rx_streamer.ring_buffer, consumer);
+  rx_consumer_t* c = &handler->rx_streamer.consumers[consumer];
+  free(c->buffer);
+  c->buffer     = NULL;
+  c->buffer_len = 0;
+  return SRSRAN_SUCCESS;
+}
+
+int rf_iio_recv_consumer(void* h, int consumer, void** data, uint32_t nsamples, time_t* secs, double* frac_secs)
+{
+  rf_iio_handler_t* handler  = (rf_iio_handler_t*)h;
+  rf_iio_streamer*  streamer = &handler->rx_streamer;
+
+  if (consumer < 0 || consumer >= SRSRAN_RINGBUFFER_MAX_TAPS) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  rx_consumer_t* c           = &streamer->consumers[consumer];
+  size_t         sample_size = streamer_sample_size(streamer);
+  if (nsamples > c->buffer_len) {
+    free(c->buffer);
+    c->buffer     = srsran_vec_malloc(sample_size * nsamples);
+    c->buffer_len = c->buffer ? nsamples : 0;
+    if (!c->buffer) {
+      return SRSRAN_ERROR;
+    }
+  }
+
+  uint32_t rxd_samples_total = 0;
+  uint64_t first_tstamp      = c->header.timestamp;
+  bool     end_of_burst      = false;
+  while (rxd_samples_total < nsamples) {
+    int ret;
+    if (!c->header.nof_samples) {
+      ret = srsran_ringbuffer_tap_read_timed(&streamer->ring_buffer, consumer, &c->header, sizeof(tx_header_t), 1000);
+      if (ret > 0 && c->header.magic != PKT_HEADER_MAGIC) {
+        ERROR("RF_IIO: invalid header read by RX consumer %d\n", consumer);
+        c->header.nof_samples = 0;
+        return SRSRAN_ERROR;
+      }
+      if (ret > 0 && c->header.end_of_burst) {
+        if (!rxd_samples_total) {
+          first_tstamp = c->header.timestamp;
+        }
+        c->header.nof_samples = 0;
+        end_of_burst          = true;
+        break;
+      }
+    } else {
+      if (!rxd_samples_total) {
+        first_tstamp = c->header.timestamp;
+      }
+      uint32_t read_samples = SRSRAN_MIN(c->header.nof_samples, nsamples - rxd_samples_total);
+      int16_t* dst          = &c->buffer[sample_size / sizeof(int16_t) * rxd_samples_total];
+
+      ret = srsran_ringbuffer_tap_read_timed(&streamer->ring_buffer, consumer, dst, sample_size * read_samples, 1000);
+      if (ret > 0) {
+        c->header.nof_samples -= read_samples;
+        c->header.timestamp += read_samples;
+        rxd_samples_total += read_samples;
+      }
+    }
+    if (ret == SRSRAN_ERROR_OUT_OF_BOUNDS) {
+      // the consumer skipped ahead, start over from the next packet
+      c->header.nof_samples = 0;
+      rxd_samples_total     = 0;
+    } else if (ret <= 0) {
+      return SRSRAN_ERROR;
+    }
+  }
+
+  tstamp_to_time_iio(handler, first_tstamp, secs, frac_secs);
+  rf_iq_corr_apply_multi(
+      handler->rx_corr, c->buffer, 32768, (float**)data, streamer->nof_channels, rxd_samples_total);
+  return end_of_burst ? (int)rxd_samples_total : (int)nsamples;
+}
+
+int rf_iio_get_consumer_stats(void* h, int consumer, srsran_rf_consumer_stats_t* stats)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+
+  int    count       = 0;
+  size_t sample_size = streamer_sample_size(&handler->rx_streamer);
+  if (srsran_ringbuffer_tap_stats(
+          &handler->rx_streamer.ring_buffer, consumer, &count, &stats->nof_overruns, &stats->nof_lost) < 0) {
+    return SRSRAN_ERROR;
+  }
+  // the packet headers are counted as well, they are small compared to the payload
+  stats->lag = (uint64_t)count / sample_size;
+  stats->nof_lost /= sample_size;
+  return SRSRAN_SUCCESS;
 }
 
 int rf_iio_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
@@ -947,8 +2141,9 @@ int send_buf(void* h)
 
   if (handler->tx_streamer.items_in_buffer < handler->tx_streamer.buffer_size) {
     ptrdiff_t buf_step = iio_buffer_step(handler->tx_streamer._buf);
-    uintptr_t buf_ptr =
-        (uintptr_t)iio_buffer_start(handler->tx_streamer._buf) + handler->tx_streamer.items_in_buffer * buf_step;
+    // the payload follows the metadata
+    uintptr_t buf_ptr = (uintptr_t)iio_buffer_start(handler->tx_streamer._buf) +
+                        (handler->tx_streamer.metadata_samples + handler->tx_streamer.items_in_buffer) * buf_step;
     uintptr_t buf_end = (uintptr_t)iio_buffer_end(handler->tx_streamer._buf);
 
     memset((void*)buf_ptr, 0, buf_end - buf_ptr);
@@ -975,29 +2170,36 @@ static void* writer_thread(void* arg)
   int      read_samples   = 0;
   uint64_t timestamp      = 0;
   bool     have_timestamp = false;
+  uint32_t nof_lates_seen = 0; // late bursts already accounted from the in-band status
+  int      lates          = 0; // late bursts not logged yet
 
   pthread_mutex_lock(&handler->tx_streamer.stream_mutex);
-  while (!handler->tx_streamer.stream_active) {
+  while (!handler->tx_streamer.stream_active && !handler->tx_streamer.closing) {
     pthread_cond_wait(&handler->tx_streamer.stream_cvar, &handler->tx_streamer.stream_mutex);
   }
   pthread_mutex_unlock(&handler->tx_streamer.stream_mutex);
 
+  const uint32_t stride      = handler->tx_streamer.nof_channels; // words per DMA item
+  const size_t   sample_size = streamer_sample_size(&handler->tx_streamer);
+
   while (handler->tx_streamer.stream_active) {
     int n = 0;
     do {
       uintptr_t dst_ptr;
       uint32_t* start_ptr;
-      uint64_t* tstamp_ptr;
-      start_ptr  = (uint32_t*)iio_buffer_start(handler->tx_streamer._buf);
-      tstamp_ptr = (uint64_t*)iio_buffer_start(handler->tx_streamer._buf);
-      dst_ptr    = (uintptr_t)iio_buffer_start(handler->tx_streamer._buf) +
-                (handler->tx_streamer.metadata_samples + handler->tx_streamer.items_in_buffer) * 2 * sizeof(int16_t);
+      start_ptr = (uint32_t*)iio_buffer_start(handler->tx_streamer._buf);
+      dst_ptr   = (uintptr_t)iio_buffer_start(handler->tx_streamer._buf) +
+                (handler->tx_streamer.metadata_samples + handler->tx_streamer.items_in_buffer) * sample_size;
 
       if (!handler->tx_streamer.prev_header.nof_samples) {
         if (srsran_ringbuffer_read(
                 &handler->tx_streamer.ring_buffer, &handler->tx_streamer.prev_header, sizeof(tx_header_t)) < 0) {
           fprintf(stderr, "Error reading buffer\n");
         }
+        if (handler->tx_streamer.closing) {
+          // the ring buffer was stopped, nothing was read
+          break;
+        }
 
         if (handler->tx_streamer.prev_header.magic != PKT_HEADER_MAGIC) {
           fprintf(stderr, "Error reading tx ringbuffer. Invalid header\n");
@@ -1016,7 +2218,7 @@ static void* writer_thread(void* arg)
                                 (handler->tx_streamer.buffer_size - handler->tx_streamer.items_in_buffer));
       if (read_samples > 0) {
         if (srsran_ringbuffer_read(
-                &handler->tx_streamer.ring_buffer, (void*)dst_ptr, 2 * sizeof(uint16_t) * read_samples) < 0) {
+                &handler->tx_streamer.ring_buffer, (void*)dst_ptr, sample_size * read_samples) < 0) {
           printf("Error reading TX buffer\n");
           return NULL;
         }
@@ -1043,26 +2245,29 @@ static void* writer_thread(void* arg)
         }
         have_timestamp = false;
 
-        // Add packet header
-        start_ptr[0] = common_preamble1;
-        start_ptr[1] = common_preamble2;
-        start_ptr[2] = common_preamble3;
+        // Add packet header, carried by the first channel of each item as the RX one
+        uint64_t tstamp = (handler->use_timestamps) ? timestamp : 0;
+        memset(start_ptr, 0, METADATA_NSAMPLES * sample_size);
+        start_ptr[0 * stride] = common_preamble1;
+        start_ptr[1 * stride] = common_preamble2;
+        start_ptr[2 * stride] = common_preamble3;
         // time domain sync words
-        start_ptr[3]  = time_preamble1;
-        start_ptr[4]  = time_preamble2;
-        start_ptr[5]  = time_preamble3;
-        tstamp_ptr[3] = (handler->use_timestamps) ? timestamp : 0;
+        start_ptr[3 * stride] = time_preamble1;
+        start_ptr[4 * stride] = time_preamble2;
+        start_ptr[5 * stride] = time_preamble3;
+        start_ptr[6 * stride] = (uint32_t)tstamp;
+        start_ptr[7 * stride] = (uint32_t)(tstamp >> 32);
 
 #if PRINT_TIMESTAMPS
         time_t         secs;
         double         frac_secs;
         struct timeval time;
         gettimeofday(&time, NULL);
-        tstamp_to_time_iio(handler, *tstamp_ptr, &secs, &frac_secs);
-        if (firstGo < 20) {
+        tstamp_to_time_iio(handler, tstamp, &secs, &frac_secs);
+        if (handler->nof_ts_prints < 20) {
           printf(
               "send sec %d frac %f or %d ticks  [%4d] [%d] \n", secs, frac_secs, timestamp, time.tv_usec, time.tv_sec);
-          firstGo++;
+          handler->nof_ts_prints++;
         }
 #endif
         // submit buffer to DMA engine managed by libiio
@@ -1075,7 +2280,14 @@ static void* writer_thread(void* arg)
         }
 
         uint32_t late_reg_value = 0;
-        check_late_register(handler, &late_reg_value);
+        if (handler->rx_status.present && handler->rx_streamer.stream_active) {
+          // late bursts are reported by the RX metadata headers, no need to poll the FPGA
+          uint32_t nof_lates = handler->rx_status.nof_lates;
+          late_reg_value     = nof_lates - nof_lates_seen;
+          nof_lates_seen     = nof_lates;
+        } else {
+          check_late_register(handler, &late_reg_value);
+        }
         if (late_reg_value) {
           lates++;
           INFO("RF_IIO: L");
@@ -1104,7 +2316,7 @@ int rf_iio_send_timed(void*  h,
                       bool   is_start_of_burst,
                       bool   is_end_of_burst)
 {
-  void* _data[SRSRAN_MAX_PORTS] = {data, zero_mem, zero_mem, zero_mem};
+  void* _data[SRSRAN_MAX_PORTS] = {data, (void*)zero_mem, (void*)zero_mem, (void*)zero_mem};
   return rf_iio_send_timed_multi(
       h, _data, nsamples, secs, frac_secs, has_time_spec, blocking, is_start_of_burst, is_end_of_burst);
 }
@@ -1132,24 +2344,37 @@ int rf_iio_send_timed_multi(void*  h,
   struct timeval time;
   gettimeofday(&time, NULL);
 #ifdef PRINT_TIMESTAMPS
-  if (firstGo < 5) {
+  if (handler->nof_ts_prints < 5) {
     printf("init send sec %d frac %f [%4d] [%d] \n", secs, frac_secs, time.tv_usec, time.tv_sec);
-    firstGo++;
+    handler->nof_ts_prints++;
   }
 #endif
+  size_t sample_size = streamer_sample_size(&handler->tx_streamer);
   do {
-    towrite             = nsamples;
-    float* samples_cf32 = (float*)&(((cf_t**)data)[0][n]);
-    srsran_vec_convert_fi(samples_cf32, 32767.999f, handler->tx_streamer._conv_buffer, 2 * towrite);
+    towrite = nsamples;
+    // the channels are interleaved in the DMA items by the conversion itself, missing ones are sent as zeros
+    float* samples_cf32[SRSRAN_MAX_PORTS] = {};
+    for (uint32_t ch = 0; ch < handler->tx_streamer.nof_channels; ch++) {
+      samples_cf32[ch] = data[ch] ? (float*)&((cf_t*)data[ch])[n] : (float*)zero_mem;
+    }
+    srsran_vec_stats_t stats = {};
+    srsran_vec_convert_fi_interleave_stats(samples_cf32,
+                                           32767.999f,
+                                           handler->tx_streamer._conv_buffer,
+                                           handler->tx_streamer.nof_channels,
+                                           towrite,
+                                           &stats);
+    handler->tx_stats = stats;
 
     header.magic        = PKT_HEADER_MAGIC;
     header.nof_samples  = towrite;
     header.timestamp    = time_to_tstamp_iio(handler, secs, frac_secs);
     header.end_of_burst = is_end_of_burst;
 
-    srsran_ringbuffer_write_block(&handler->tx_streamer.ring_buffer, &header, sizeof(tx_header_t));
-    srsran_ringbuffer_write_block(
-        &handler->tx_streamer.ring_buffer, (void*)(handler->tx_streamer._conv_buffer), sizeof(uint16_t) * 2 * towrite);
+    // the playback thread may be writing too, the header and its samples go in as one packet
+    srsran_ringbuffer_part_t parts[] = {{&header, sizeof(tx_header_t)},
+                                        {handler->tx_streamer._conv_buffer, (int)(sample_size * towrite)}};
+    srsran_ringbuffer_write_packet(&handler->tx_streamer.ring_buffer, parts, 2, -1);
     n += towrite;
     trials++;
   } while (n < nsamples && trials < 100);
@@ -1157,6 +2382,72 @@ int rf_iio_send_timed_multi(void*  h,
   return n;
 }
 
+static void playback_tx(void* h, uint64_t tstamp, const int16_t* sc16, uint32_t nof_samples, bool end_of_burst)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+  tx_header_t header = {
+      .magic = PKT_HEADER_MAGIC, .timestamp = tstamp, .nof_samples = nof_samples, .end_of_burst = end_of_burst};
+
+  // the samples are already quantized, no srsran_vec_convert_fi() on this path
+  srsran_ringbuffer_part_t parts[] = {{&header, sizeof(tx_header_t)},
+                                      {sc16, (int)(streamer_sample_size(&handler->tx_streamer) * nof_samples)}};
+  srsran_ringbuffer_write_packet(&handler->tx_streamer.ring_buffer, parts, 2, -1);
+}
+
+// TX packets of the shared memory and UDP clients, queued like the playback ones
+static void client_tx(void* h, uint64_t tstamp, const int16_t* sc16, uint32_t nof_samples, bool end_of_burst)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+
+  if (!handler->tx_streamer.stream_active) {
+    rf_iio_start_tx_stream(h);
+  }
+  playback_tx(h, tstamp, sc16, nof_samples, end_of_burst);
+}
+
+int rf_iio_start_playback(void* h, const srsran_rf_playback_cfg_t* cfg)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+
+  rf_iio_stop_playback(h);
+  if (cfg->has_time_spec && !handler->use_timestamps) {
+    ERROR("RF_IIO: timed playback requires timestamping\n");
+    return SRSRAN_ERROR;
+  }
+  // the files hold a single channel
+  if (handler->tx_streamer.nof_channels > 1) {
+    ERROR("RF_IIO: playback is only supported with a single antenna\n");
+    return SRSRAN_ERROR;
+  }
+  if (!handler->tx_streamer.stream_active) {
+    rf_iio_start_tx_stream(h);
+  }
+  handler->player = (rf_player_t*)malloc(sizeof(rf_player_t));
+  if (!handler->player) {
+    return SRSRAN_ERROR;
+  }
+  uint64_t start_tick = cfg->has_time_spec ? time_to_tstamp_iio(handler, cfg->secs, cfg->frac_secs) : 0;
+  if (rf_player_start(handler->player, cfg, start_tick, handler->tx_streamer._fs_hz, handler, playback_tx) <
+      SRSRAN_SUCCESS) {
+    free(handler->player);
+    handler->player = NULL;
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int rf_iio_stop_playback(void* h)
+{
+  rf_iio_handler_t* handler = (rf_iio_handler_t*)h;
+
+  if (handler->player) {
+    rf_player_stop(handler->player);
+    free(handler->player);
+    handler->player = NULL;
+  }
+  return SRSRAN_SUCCESS;
+}
+
 rf_dev_t srsran_rf_dev_iio = {"iio",
                               rf_iio_devname,
                               rf_iio_start_rx_stream,
@@ -1185,7 +2476,18 @@ rf_dev_t srsran_rf_dev_iio = {"iio",
                               rf_iio_recv_with_time,
                               rf_iio_recv_with_time_multi,
                               rf_iio_send_timed,
-                              .srsran_rf_send_timed_multi = rf_iio_send_timed_multi};
+                              .srsran_rf_send_timed_multi   = rf_iio_send_timed_multi,
+                              .srsran_rf_queue_cmd_timed    = rf_iio_queue_cmd_timed,
+                              .srsran_rf_issue_stream_cmd   = rf_iio_issue_stream_cmd,
+                              .srsran_rf_start_playback     = rf_iio_start_playback,
+                              .srsran_rf_stop_playback      = rf_iio_stop_playback,
+                              .srsran_rf_get_rx_stats       = rf_iio_get_rx_stats,
+                              .srsran_rf_get_tx_stats       = rf_iio_get_tx_stats,
+                              .srsran_rf_recv_history       = rf_iio_recv_history,
+                              .srsran_rf_open_rx_consumer   = rf_iio_open_rx_consumer,
+                              .srsran_rf_close_rx_consumer  = rf_iio_close_rx_consumer,
+                              .srsran_rf_recv_consumer      = rf_iio_recv_consumer,
+                              .srsran_rf_get_consumer_stats = rf_iio_get_consumer_stats};
 
 int register_plugin(rf_dev_t** rf_api)
 {
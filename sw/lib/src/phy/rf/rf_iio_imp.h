@@ -41,6 +41,10 @@ SRSRAN_API bool rf_iio_has_rssi(void* h);
 
 SRSRAN_API float rf_iio_get_rssi(void* h);
 
+SRSRAN_API int rf_iio_get_rx_stats(void* h, srsran_rf_stats_t* stats);
+
+SRSRAN_API int rf_iio_get_tx_stats(void* h, srsran_rf_stats_t* stats);
+
 SRSRAN_API bool rf_iio_rx_wait_lo_locked(void* h);
 
 SRSRAN_API void rf_iio_set_master_clock_rate(void* h, double rate);
@@ -73,12 +77,31 @@ rf_iio_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, tim
 SRSRAN_API int
 rf_iio_recv_with_time_multi(void* h, void** data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs);
 
+SRSRAN_API int rf_iio_recv_history(void* h, void** data, uint32_t nsamples, time_t secs, double frac_secs);
+
+SRSRAN_API int rf_iio_open_rx_consumer(void* h, srsran_rf_consumer_policy_t policy);
+
+SRSRAN_API int rf_iio_close_rx_consumer(void* h, int consumer);
+
+SRSRAN_API int
+rf_iio_recv_consumer(void* h, int consumer, void** data, uint32_t nsamples, time_t* secs, double* frac_secs);
+
+SRSRAN_API int rf_iio_get_consumer_stats(void* h, int consumer, srsran_rf_consumer_stats_t* stats);
+
 SRSRAN_API double rf_iio_set_tx_srate(void* h, double rate);
 
 SRSRAN_API double rf_iio_set_tx_freq(void* h, uint32_t ch, double frequency);
 
 SRSRAN_API void rf_iio_get_time(void* h, time_t* secs, double* frac_secs);
 
+SRSRAN_API int rf_iio_queue_cmd_timed(void* h, const srsran_rf_cmd_t* cmd, time_t secs, double frac_secs);
+
+SRSRAN_API int rf_iio_issue_stream_cmd(void* h, const srsran_rf_stream_cmd_t* cmd);
+
+SRSRAN_API int rf_iio_start_playback(void* h, const srsran_rf_playback_cfg_t* cfg);
+
+SRSRAN_API int rf_iio_stop_playback(void* h);
+
 SRSRAN_API int rf_iio_send_timed(void*  h,
                                  void*  data,
                                  int    nsamples,
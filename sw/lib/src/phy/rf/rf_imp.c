@@ -157,11 +157,19 @@ int srsran_rf_open_devname(srsran_rf_t* rf, const char* devname, char* args, uin
 
 int srsran_rf_open_file(srsran_rf_t* rf, FILE** rx_files, FILE** tx_files, uint32_t nof_channels, uint32_t base_srate)
 {
-  //rf->dev = &srsran_rf_dev_file;
+  rf->thread_gain_run = false;
+
+  if (pthread_mutex_init(&rf->mutex, NULL)) {
+    return -1;
+  }
+  if (pthread_cond_init(&rf->cond, NULL)) {
+    return -1;
+  }
+
+  rf->dev = &srsran_rf_dev_file;
 
   // file abstraction has custom "open" function with file-related args
-  //return rf_file_open_file(&rf->handler, rx_files, tx_files, nof_channels, base_srate);
-  return SRSRAN_ERROR;
+  return rf_file_open_file(&rf->handler, rx_files, tx_files, nof_channels, base_srate);
 }
 
 const char* srsran_rf_name(srsran_rf_t* rf)
@@ -326,6 +334,99 @@ void srsran_rf_get_time(srsran_rf_t* rf, time_t* secs, double* frac_secs)
   return ((rf_dev_t*)rf->dev)->srsran_rf_get_time(rf->handler, secs, frac_secs);
 }
 
+int srsran_rf_issue_stream_cmd(srsran_rf_t* rf, const srsran_rf_stream_cmd_t* cmd)
+{
+  if (((rf_dev_t*)rf->dev)->srsran_rf_issue_stream_cmd) {
+    return ((rf_dev_t*)rf->dev)->srsran_rf_issue_stream_cmd(rf->handler, cmd);
+  }
+  return SRSRAN_ERROR;
+}
+
+int srsran_rf_queue_cmd_timed(srsran_rf_t* rf, const srsran_rf_cmd_t* cmd, time_t secs, double frac_secs)
+{
+  if (((rf_dev_t*)rf->dev)->srsran_rf_queue_cmd_timed) {
+    return ((rf_dev_t*)rf->dev)->srsran_rf_queue_cmd_timed(rf->handler, cmd, secs, frac_secs);
+  }
+  return SRSRAN_ERROR;
+}
+
+int srsran_rf_start_playback(srsran_rf_t* rf, const srsran_rf_playback_cfg_t* cfg)
+{
+  if (((rf_dev_t*)rf->dev)->srsran_rf_start_playback) {
+    return ((rf_dev_t*)rf->dev)->srsran_rf_start_playback(rf->handler, cfg);
+  }
+  return SRSRAN_ERROR;
+}
+
+int srsran_rf_stop_playback(srsran_rf_t* rf)
+{
+  if (((rf_dev_t*)rf->dev)->srsran_rf_stop_playback) {
+    return ((rf_dev_t*)rf->dev)->srsran_rf_stop_playback(rf->handler);
+  }
+  return SRSRAN_ERROR;
+}
+
+int srsran_rf_get_rx_stats(srsran_rf_t* rf, srsran_rf_stats_t* stats)
+{
+  if (((rf_dev_t*)rf->dev)->srsran_rf_get_rx_stats) {
+    return ((rf_dev_t*)rf->dev)->srsran_rf_get_rx_stats(rf->handler, stats);
+  }
+  return SRSRAN_ERROR;
+}
+
+int srsran_rf_get_tx_stats(srsran_rf_t* rf, srsran_rf_stats_t* stats)
+{
+  if (((rf_dev_t*)rf->dev)->srsran_rf_get_tx_stats) {
+    return ((rf_dev_t*)rf->dev)->srsran_rf_get_tx_stats(rf->handler, stats);
+  }
+  return SRSRAN_ERROR;
+}
+
+int srsran_rf_recv_history(srsran_rf_t* rf, void** data, uint32_t nsamples, time_t secs, double frac_secs)
+{
+  if (((rf_dev_t*)rf->dev)->srsran_rf_recv_history) {
+    return ((rf_dev_t*)rf->dev)->srsran_rf_recv_history(rf->handler, data, nsamples, secs, frac_secs);
+  }
+  return SRSRAN_ERROR;
+}
+
+int srsran_rf_open_rx_consumer(srsran_rf_t* rf, srsran_rf_consumer_policy_t policy)
+{
+  if (((rf_dev_t*)rf->dev)->srsran_rf_open_rx_consumer) {
+    return ((rf_dev_t*)rf->dev)->srsran_rf_open_rx_consumer(rf->handler, policy);
+  }
+  return SRSRAN_ERROR;
+}
+
+int srsran_rf_close_rx_consumer(srsran_rf_t* rf, int consumer)
+{
+  if (((rf_dev_t*)rf->dev)->srsran_rf_close_rx_consumer) {
+    return ((rf_dev_t*)rf->dev)->srsran_rf_close_rx_consumer(rf->handler, consumer);
+  }
+  return SRSRAN_ERROR;
+}
+
+int srsran_rf_recv_consumer(srsran_rf_t* rf,
+                            int          consumer,
+                            void**       data,
+                            uint32_t     nsamples,
+                            time_t*      secs,
+                            double*      frac_secs)
+{
+  if (((rf_dev_t*)rf->dev)->srsran_rf_recv_consumer) {
+    return ((rf_dev_t*)rf->dev)->srsran_rf_recv_consumer(rf->handler, consumer, data, nsamples, secs, frac_secs);
+  }
+  return SRSRAN_ERROR;
+}
+
+int srsran_rf_get_consumer_stats(srsran_rf_t* rf, int consumer, srsran_rf_consumer_stats_t* stats)
+{
+  if (((rf_dev_t*)rf->dev)->srsran_rf_get_consumer_stats) {
+    return ((rf_dev_t*)rf->dev)->srsran_rf_get_consumer_stats(rf->handler, consumer, stats);
+  }
+  return SRSRAN_ERROR;
+}
+
 int srsran_rf_sync(srsran_rf_t* rf)
 {
   int ret = SRSRAN_ERROR;
@@ -483,7 +584,8 @@ int srsran_rf_load_plugins()
 
   printf("Inactive RF plugins:");
   for (unsigned int i = 0; rf_plugins[i]; i++) {
-    if (rf_plugins[i]->dl_handle == NULL) {
+    // built-in devices have no plugin name
+    if (rf_plugins[i]->dl_handle == NULL && rf_plugins[i]->plugin_name[0] != '\0') {
       printf(" %s", rf_plugins[i]->plugin_name);
     }
   }
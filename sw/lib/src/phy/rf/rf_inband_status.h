@@ -0,0 +1,68 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_INBAND_STATUS_H_
+#define SRSRAN_RF_INBAND_STATUS_H_
+
+// Status carried by the RX metadata header when the FPGA packetizer is built with c_INBAND_STATUS. The status word
+// replaces the 6th synchronization word:
+//   [31:24] marker (0x5A), [23:16] wrapping count of late TX bursts, [15] RX data lost since the previous header,
+//   [14:0] fill level of the RX data FIFO.
+// Bitstreams without it keep sending the 6th synchronization word, in which case the plugins fall back to polling
+// the memory-mapped status registers.
+
+#include "srsran/config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RF_INBAND_STATUS_MARKER 0x5a
+
+typedef struct {
+  bool              present;       // a status word was received since the last reset
+  uint8_t           late_count;    // last late counter value reported by the FPGA
+  volatile uint32_t nof_lates;     // late bursts accumulated since the last reset, read by the TX thread
+  uint32_t          nof_overflows; // headers that reported lost RX data
+  uint32_t          fifo_level;    // RX data FIFO level reported by the last header
+} rf_inband_status_t;
+
+static inline void rf_inband_status_reset(rf_inband_status_t* s)
+{
+  s->present       = false;
+  s->late_count    = 0;
+  s->nof_lates     = 0;
+  s->nof_overflows = 0;
+  s->fifo_level    = 0;
+}
+
+static inline bool rf_inband_status_match(uint32_t word)
+{
+  return (word >> 24) == RF_INBAND_STATUS_MARKER;
+}
+
+// Parses a status word, returns true if RX data was lost since the previous header
+static inline bool rf_inband_status_parse(rf_inband_status_t* s, uint32_t word)
+{
+  uint8_t late_count = (uint8_t)(word >> 16);
+  // the first counter value seen is only a reference, it may include lates from a previous session
+  if (s->present) {
+    s->nof_lates += (uint8_t)(late_count - s->late_count);
+  }
+  s->late_count = late_count;
+  s->present    = true;
+  s->fifo_level = word & 0x7fff;
+  if (word & 0x8000) {
+    s->nof_overflows++;
+    return true;
+  }
+  return false;
+}
+
+#endif // SRSRAN_RF_INBAND_STATUS_H_
@@ -0,0 +1,228 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_IQ_CORR_H_
+#define SRSRAN_RF_IQ_CORR_H_
+
+// RX DC offset and IQ imbalance correction, applied by the int16 to float conversion of each channel. The estimates are
+// taken from the statistics accumulated by srsran_vec_convert_if_corr() on every receive call and smoothed by a
+// first-order loop, so that the correction follows the slow drift of the front-end without an extra pass over the
+// samples. The IQ imbalance is removed by Gram-Schmidt orthogonalisation: Q is decorrelated from I and scaled to the
+// power of I. Device arguments:
+//   rx_dc_corr=1        enables the DC offset removal
+//   rx_iq_corr=1        enables the IQ imbalance correction
+//   rx_corr_alpha=<a>   loop gain applied on each receive call, 0.01 by default
+
+#include "rf_helper.h"
+#include "srsran/config.h"
+#include "srsran/phy/utils/vector.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RF_IQ_CORR_DEFAULT_ALPHA 0.01f
+
+typedef struct {
+  bool                 dc_enabled;
+  bool                 iq_enabled;
+  float                alpha;       // loop gain per update
+  bool                 initialized; // the first update loads the estimates directly
+  float                mean_i;      // tracked DC offset
+  float                mean_q;
+  float                var_i; // tracked covariance of the DC-free samples
+  float                var_q;
+  float                cov_iq;
+  srsran_vec_iq_corr_t corr; // correction in use
+} rf_iq_corr_t;
+
+static inline void rf_iq_corr_init(rf_iq_corr_t* q, bool dc_enabled, bool iq_enabled, float alpha)
+{
+  q->dc_enabled  = dc_enabled;
+  q->iq_enabled  = iq_enabled;
+  q->alpha       = (alpha > 0.0f && alpha <= 1.0f) ? alpha : RF_IQ_CORR_DEFAULT_ALPHA;
+  q->initialized = false;
+  q->mean_i      = 0.0f;
+  q->mean_q      = 0.0f;
+  q->var_i       = 0.0f;
+  q->var_q       = 0.0f;
+  q->cov_iq      = 0.0f;
+  q->corr.dc_i   = 0.0f;
+  q->corr.dc_q   = 0.0f;
+  q->corr.m_ii   = 1.0f;
+  q->corr.m_iq   = 0.0f;
+  q->corr.m_qi   = 0.0f;
+  q->corr.m_qq   = 1.0f;
+}
+
+// Initialises the correction of nof_channels channels from the device arguments
+static inline void rf_iq_corr_init_args(rf_iq_corr_t* q, uint32_t nof_channels, char* args)
+{
+  uint32_t dc_enabled = 0;
+  uint32_t iq_enabled = 0;
+  double   alpha      = RF_IQ_CORR_DEFAULT_ALPHA;
+  parse_uint32(args, "rx_dc_corr", 0, &dc_enabled);
+  parse_uint32(args, "rx_iq_corr", 0, &iq_enabled);
+  parse_double(args, "rx_corr_alpha", 0, &alpha);
+  for (uint32_t ch = 0; ch < nof_channels; ch++) {
+    rf_iq_corr_init(&q[ch], dc_enabled != 0, iq_enabled != 0, (float)alpha);
+  }
+}
+
+static inline bool rf_iq_corr_enabled(const rf_iq_corr_t* q)
+{
+  return q->dc_enabled || q->iq_enabled;
+}
+
+// Updates the estimates and the correction with the statistics of one receive call
+static inline void rf_iq_corr_update(rf_iq_corr_t* q, const srsran_vec_stats_t* stats)
+{
+  if (stats->nof_samples == 0) {
+    return;
+  }
+  float n      = (float)stats->nof_samples;
+  float mean_i = stats->sum_i / n;
+  float mean_q = stats->sum_q / n;
+  float var_i  = (stats->sum_power - stats->sum_qq) / n - mean_i * mean_i;
+  float var_q  = stats->sum_qq / n - mean_q * mean_q;
+  float cov_iq = stats->sum_iq / n - mean_i * mean_q;
+
+  float a = q->initialized ? q->alpha : 1.0f;
+  q->mean_i += a * (mean_i - q->mean_i);
+  q->mean_q += a * (mean_q - q->mean_q);
+  q->var_i += a * (var_i - q->var_i);
+  q->var_q += a * (var_q - q->var_q);
+  q->cov_iq += a * (cov_iq - q->cov_iq);
+  q->initialized = true;
+
+  if (q->dc_enabled) {
+    q->corr.dc_i = q->mean_i;
+    q->corr.dc_q = q->mean_q;
+  }
+  if (q->iq_enabled && q->var_i > 1e-12f) {
+    // Q = rho * I + residual, the residual is scaled to the power of I
+    float rho      = q->cov_iq / q->var_i;
+    float residual = q->var_q - rho * q->cov_iq;
+    if (residual > 1e-6f * q->var_i) {
+      float k      = sqrtf(q->var_i / residual);
+      q->corr.m_qi = -rho * k;
+      q->corr.m_qq = k;
+    }
+  }
+}
+
+static inline void rf_iq_corr_stats_add(srsran_vec_stats_t* stats, const srsran_vec_stats_t* s)
+{
+  stats->nof_samples += s->nof_samples;
+  stats->nof_clipped += s->nof_clipped;
+  stats->sum_power += s->sum_power;
+  stats->sum_i += s->sum_i;
+  stats->sum_q += s->sum_q;
+  stats->sum_qq += s->sum_qq;
+  stats->sum_iq += s->sum_iq;
+}
+
+// Converts one channel, applying and updating the correction if enabled. The statistics are added to those in stats.
+static inline void
+rf_iq_corr_convert(rf_iq_corr_t* q, const int16_t* x, float scale, float* z, uint32_t len, srsran_vec_stats_t* stats)
+{
+  if (!rf_iq_corr_enabled(q)) {
+    srsran_vec_convert_if_stats(x, scale, z, len, stats);
+    return;
+  }
+  srsran_vec_stats_t s = {};
+  srsran_vec_convert_if_corr(x, scale, &q->corr, z, len, &s);
+  rf_iq_corr_update(q, &s);
+  rf_iq_corr_stats_add(stats, &s);
+}
+
+// Converts one channel with a snapshot of the correction in use, leaving the estimates untouched, e.g. for samples
+// read again outside of the receive calls
+static inline void rf_iq_corr_apply(const rf_iq_corr_t* q, const int16_t* x, float scale, float* z, uint32_t len)
+{
+  if (!rf_iq_corr_enabled(q)) {
+    srsran_vec_convert_if(x, scale, z, len);
+    return;
+  }
+  srsran_vec_iq_corr_t corr = q->corr;
+  srsran_vec_stats_t   s    = {};
+  srsran_vec_convert_if_corr(x, scale, &corr, z, len, &s);
+}
+
+// Pairs of one channel gathered from the interleaved stream at a time when the correction is enabled
+#define RF_IQ_CORR_CHUNK 512
+
+// Converts nof_channels channels interleaved in x, one I/Q pair of each per sample time, to z[ch]. Without correction
+// the channels are split in the same pass as the conversion; with it, each channel is gathered by chunks so that its
+// estimates are updated once per call, as with rf_iq_corr_convert().
+static inline void rf_iq_corr_convert_multi(rf_iq_corr_t*       q,
+                                            const int16_t*      x,
+                                            float               scale,
+                                            float**             z,
+                                            uint32_t            nof_channels,
+                                            uint32_t            nof_samples,
+                                            srsran_vec_stats_t* stats)
+{
+  if (nof_channels == 1) {
+    rf_iq_corr_convert(q, x, scale, z[0], 2 * nof_samples, stats);
+    return;
+  }
+  if (!rf_iq_corr_enabled(q)) {
+    srsran_vec_convert_if_deinterleave_stats(x, scale, z, nof_channels, nof_samples, stats);
+    return;
+  }
+  int16_t chunk[2 * RF_IQ_CORR_CHUNK];
+  for (uint32_t ch = 0; ch < nof_channels; ch++) {
+    srsran_vec_stats_t s = {};
+    for (uint32_t n = 0; n < nof_samples; n += RF_IQ_CORR_CHUNK) {
+      uint32_t len = SRSRAN_MIN(RF_IQ_CORR_CHUNK, nof_samples - n);
+      for (uint32_t i = 0; i < len; i++) {
+        chunk[2 * i]     = x[2 * (nof_channels * (n + i) + ch)];
+        chunk[2 * i + 1] = x[2 * (nof_channels * (n + i) + ch) + 1];
+      }
+      srsran_vec_convert_if_corr(chunk, scale, &q[ch].corr, &z[ch][2 * n], 2 * len, &s);
+    }
+    rf_iq_corr_update(&q[ch], &s);
+    rf_iq_corr_stats_add(stats, &s);
+  }
+}
+
+// Same as rf_iq_corr_apply() for nof_channels interleaved channels, see rf_iq_corr_convert_multi()
+static inline void rf_iq_corr_apply_multi(const rf_iq_corr_t* q,
+                                          const int16_t*      x,
+                                          float               scale,
+                                          float**             z,
+                                          uint32_t            nof_channels,
+                                          uint32_t            nof_samples)
+{
+  if (nof_channels == 1) {
+    rf_iq_corr_apply(q, x, scale, z[0], 2 * nof_samples);
+    return;
+  }
+  srsran_vec_stats_t s = {};
+  if (!rf_iq_corr_enabled(q)) {
+    srsran_vec_convert_if_deinterleave_stats(x, scale, z, nof_channels, nof_samples, &s);
+    return;
+  }
+  int16_t chunk[2 * RF_IQ_CORR_CHUNK];
+  for (uint32_t ch = 0; ch < nof_channels; ch++) {
+    srsran_vec_iq_corr_t corr = q[ch].corr;
+    for (uint32_t n = 0; n < nof_samples; n += RF_IQ_CORR_CHUNK) {
+      uint32_t len = SRSRAN_MIN(RF_IQ_CORR_CHUNK, nof_samples - n);
+      for (uint32_t i = 0; i < len; i++) {
+        chunk[2 * i]     = x[2 * (nof_channels * (n + i) + ch)];
+        chunk[2 * i + 1] = x[2 * (nof_channels * (n + i) + ch) + 1];
+      }
+      srsran_vec_convert_if_corr(chunk, scale, &corr, &z[ch][2 * n], 2 * len, &s);
+    }
+  }
+}
+
+#endif /* SRSRAN_RF_IQ_CORR_H_ */
@@ -0,0 +1,218 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rf_player.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+// pages already played are dropped from the page cache in windows of this size, keeping the footprint constant
+#define RF_PLAYER_RELEASE_WINDOW (16 * 1024 * 1024)
+
+static int load_schedule(rf_player_t* p, const char* path, double srate)
+{
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    ERROR("RF player: could not open %s: %s\n", path, strerror(errno));
+    return SRSRAN_ERROR;
+  }
+  char     line[256];
+  uint32_t max_bursts = 0;
+  uint32_t line_nr    = 0;
+  while (fgets(line, sizeof(line), f)) {
+    line_nr++;
+    char* ptr = line + strspn(line, " \t");
+    if (*ptr == '#' || *ptr == '\n' || *ptr == '\0') {
+      continue;
+    }
+    double             offset_secs = 0;
+    unsigned long long first = 0, count = 0;
+    if (sscanf(ptr, "%lf %llu %llu", &offset_secs, &first, &count) != 3 || offset_secs < 0 ||
+        first >= p->nof_file_samples || first + count > p->nof_file_samples) {
+      ERROR("RF player: invalid burst in %s:%u\n", path, line_nr);
+      fclose(f);
+      return SRSRAN_ERROR;
+    }
+    if (p->nof_bursts == max_bursts) {
+      max_bursts             = max_bursts ? 2 * max_bursts : 64;
+      rf_player_burst_t* tmp = realloc(p->bursts, max_bursts * sizeof(rf_player_burst_t));
+      if (!tmp) {
+        fclose(f);
+        return SRSRAN_ERROR;
+      }
+      p->bursts = tmp;
+    }
+    rf_player_burst_t* b = &p->bursts[p->nof_bursts];
+    b->offset            = (uint64_t)llround(offset_secs * srate);
+    b->first_sample      = first;
+    b->nof_samples       = count ? count : p->nof_file_samples - first;
+    if (p->nof_bursts && b->offset < p->bursts[p->nof_bursts - 1].offset + p->bursts[p->nof_bursts - 1].nof_samples) {
+      ERROR("RF player: burst in %s:%u overlaps the previous one\n", path, line_nr);
+      fclose(f);
+      return SRSRAN_ERROR;
+    }
+    p->nof_bursts++;
+  }
+  fclose(f);
+  if (!p->nof_bursts) {
+    ERROR("RF player: no bursts in %s\n", path);
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+static void* player_thread(void* arg)
+{
+  rf_player_t* p        = (rf_player_t*)arg;
+  uint64_t     base     = p->start_tick;
+  size_t       released = 0;
+
+  do {
+    for (uint32_t i = 0; i < p->nof_bursts && p->running; i++) {
+      rf_player_burst_t* b = &p->bursts[i];
+      for (uint64_t s = 0; s < b->nof_samples && p->running; s += RF_PLAYER_CHUNK) {
+        uint32_t       n   = (uint32_t)SRSRAN_MIN(RF_PLAYER_CHUNK, b->nof_samples - s);
+        const uint8_t* src = p->map + (b->first_sample + s) * p->sample_size;
+        const int16_t* sc16;
+        if (p->sample_size == sizeof(cf_t)) {
+          srsran_vec_convert_fi((const float*)src, 32767.999f, p->conv_buffer, 2 * n);
+          sc16 = p->conv_buffer;
+        } else {
+          sc16 = (const int16_t*)src;
+        }
+        bool last = (s + n == b->nof_samples);
+        p->tx(p->h, p->timed ? base + b->offset + s : 0, sc16, n, last && !(p->continuous && p->loop));
+        p->nof_sent += n;
+
+        // the pages behind the current position won't be needed until the next repetition
+        size_t pos = (size_t)(src - p->map) + (size_t)n * p->sample_size;
+        if (pos > released + RF_PLAYER_RELEASE_WINDOW) {
+          size_t from = released & ~(size_t)(getpagesize() - 1);
+          size_t to   = pos & ~(size_t)(getpagesize() - 1);
+          madvise((void*)(p->map + from), to - from, MADV_DONTNEED);
+          released = to;
+        }
+      }
+    }
+    base += p->period;
+    released = 0;
+  } while (p->loop && p->running);
+
+  p->running = false;
+  return NULL;
+}
+
+int rf_player_start(rf_player_t*                    p,
+                    const srsran_rf_playback_cfg_t* cfg,
+                    uint64_t                        start_tick,
+                    double                          srate,
+                    void*                           h,
+                    rf_player_tx_t                  tx)
+{
+  bzero(p, sizeof(rf_player_t));
+  p->h           = h;
+  p->tx          = tx;
+  p->sample_size = cfg->cf32 ? sizeof(cf_t) : 2 * sizeof(int16_t);
+  p->timed       = cfg->has_time_spec;
+  p->loop        = cfg->loop;
+  p->start_tick  = start_tick;
+
+  int fd = open(cfg->file, O_RDONLY);
+  if (fd < 0) {
+    ERROR("RF player: could not open %s: %s\n", cfg->file, strerror(errno));
+    return SRSRAN_ERROR;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size < p->sample_size) {
+    ERROR("RF player: %s is empty\n", cfg->file);
+    close(fd);
+    return SRSRAN_ERROR;
+  }
+  p->map_len          = (size_t)st.st_size;
+  p->nof_file_samples = p->map_len / p->sample_size;
+  p->map              = mmap(NULL, p->map_len, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p->map == MAP_FAILED) {
+    ERROR("RF player: could not map %s: %s\n", cfg->file, strerror(errno));
+    p->map = NULL;
+    return SRSRAN_ERROR;
+  }
+  madvise((void*)p->map, p->map_len, MADV_SEQUENTIAL);
+
+  if (cfg->schedule) {
+    if (load_schedule(p, cfg->schedule, srate) < SRSRAN_SUCCESS) {
+      rf_player_stop(p);
+      return SRSRAN_ERROR;
+    }
+  } else {
+    p->bursts = calloc(1, sizeof(rf_player_burst_t));
+    if (!p->bursts) {
+      rf_player_stop(p);
+      return SRSRAN_ERROR;
+    }
+    p->bursts[0].nof_samples = p->nof_file_samples;
+    p->nof_bursts            = 1;
+    p->continuous            = true;
+  }
+  rf_player_burst_t* last = &p->bursts[p->nof_bursts - 1];
+  p->period               = last->offset + last->nof_samples;
+  if (cfg->loop_period > 0) {
+    uint64_t period = (uint64_t)llround(cfg->loop_period * srate);
+    if (period < p->period) {
+      ERROR("RF player: loop period shorter than the schedule\n");
+      rf_player_stop(p);
+      return SRSRAN_ERROR;
+    }
+    p->period     = period;
+    p->continuous = false;
+  }
+
+  p->running = true;
+  if (pthread_create(&p->thread, NULL, player_thread, p)) {
+    p->running = false;
+    rf_player_stop(p);
+    return SRSRAN_ERROR;
+  }
+  printf("RF player: playing %s, %" PRIu64 " samples in %u bursts%s\n",
+         cfg->file,
+         p->nof_file_samples,
+         p->nof_bursts,
+         p->loop ? ", looping" : "");
+  return SRSRAN_SUCCESS;
+}
+
+void rf_player_stop(rf_player_t* p)
+{
+  if (p->thread) {
+    p->running = false;
+    pthread_join(p->thread, NULL);
+    p->thread = 0;
+  }
+  if (p->map) {
+    munmap((void*)p->map, p->map_len);
+    p->map = NULL;
+  }
+  free(p->bursts);
+  p->bursts     = NULL;
+  p->nof_bursts = 0;
+}
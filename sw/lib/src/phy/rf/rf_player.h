@@ -0,0 +1,67 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_PLAYER_H_
+#define SRSRAN_RF_PLAYER_H_
+
+// TX file playback shared by the RF plugins (see srsran_rf_start_playback()). A thread walks the memory-mapped file
+// following the burst schedule and hands chunks of sc16 samples, with their HW timestamp, to the plugin, which queues
+// them to its TX path. cf32 files are converted chunk by chunk; sc16 files are passed straight from the mapping.
+
+#include "srsran/config.h"
+#include "srsran/phy/rf/rf.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RF_PLAYER_CHUNK 7680 // samples handed to the TX path at once
+
+// Queues nof_samples sc16 samples to be transmitted at tstamp (0 if untimed), may block until there is room
+typedef void (*rf_player_tx_t)(void* h, uint64_t tstamp, const int16_t* sc16, uint32_t nof_samples, bool end_of_burst);
+
+typedef struct {
+  uint64_t offset; // ticks from the start of the schedule
+  uint64_t first_sample;
+  uint64_t nof_samples;
+} rf_player_burst_t;
+
+typedef struct {
+  void*              h;
+  rf_player_tx_t     tx;
+  const uint8_t*     map;
+  size_t             map_len;
+  uint32_t           sample_size; // bytes per sample in the file
+  uint64_t           nof_file_samples;
+  rf_player_burst_t* bursts;
+  uint32_t           nof_bursts;
+  bool               timed;
+  bool               loop;
+  bool               continuous; // no schedule, the file repeats without burst boundaries
+  uint64_t           start_tick;
+  uint64_t           period; // ticks between repetitions of the schedule
+  int16_t            conv_buffer[2 * RF_PLAYER_CHUNK];
+  volatile bool      running;
+  pthread_t          thread;
+  uint64_t           nof_sent;
+} rf_player_t;
+
+// start_tick is the HW timestamp of the first sample, ignored if cfg->has_time_spec is false
+SRSRAN_API int rf_player_start(rf_player_t*                    p,
+                               const srsran_rf_playback_cfg_t* cfg,
+                               uint64_t                        start_tick,
+                               double                          srate,
+                               void*                           h,
+                               rf_player_tx_t                  tx);
+
+// Stops the playback thread and unmaps the file. The caller must make sure a blocked tx callback can return.
+SRSRAN_API void rf_player_stop(rf_player_t* p);
+
+#endif // SRSRAN_RF_PLAYER_H_
@@ -0,0 +1,427 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "rf_recorder.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+static int write_all(int fd, const uint8_t* buf, size_t len)
+{
+  while (len) {
+    ssize_t ret = write(fd, buf, len);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return SRSRAN_ERROR;
+    }
+    buf += ret;
+    len -= (size_t)ret;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+// Writes the given captures and annotations to a temporary file which then replaces the metadata file
+static void write_metadata(rf_recorder_t*                  r,
+                           const rf_recorder_capture_t*    captures,
+                           uint32_t                        nof_captures,
+                           const rf_recorder_annotation_t* annotations,
+                           uint32_t                        nof_annotations)
+{
+  char tmp_path[RF_RECORDER_PATH_LEN + 8];
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", r->meta_path);
+  FILE* f = fopen(tmp_path, "w");
+  if (!f) {
+    ERROR("RF recorder: could not open %s: %s\n", tmp_path, strerror(errno));
+    return;
+  }
+  char      datetime[64] = "";
+  struct tm t;
+  gmtime_r(&r->t_start.tv_sec, &t);
+  size_t len = strftime(datetime, sizeof(datetime), "%Y-%m-%dT%H:%M:%S", &t);
+  snprintf(&datetime[len], sizeof(datetime) - len, ".%06ldZ", r->t_start.tv_nsec / 1000);
+
+  fprintf(f, "{\n  \"global\": {\n");
+  fprintf(f, "    \"core:datatype\": \"ci16_le\",\n");
+  fprintf(f, "    \"core:sample_rate\": %.1f,\n", nof_captures ? captures[0].srate : 0.0);
+  fprintf(f, "    \"core:num_channels\": %u,\n", r->nof_channels);
+  fprintf(f, "    \"core:version\": \"1.0.0\",\n");
+  fprintf(f, "    \"core:recorder\": \"srsRAN RF plugin\",\n");
+  fprintf(f, "    \"core:extensions\": [{\"name\": \"srsran\", \"version\": \"1.0.0\", \"optional\": true}]\n");
+  fprintf(f, "  },\n  \"captures\": [");
+  for (uint32_t i = 0; i < nof_captures; i++) {
+    const rf_recorder_capture_t* c = &captures[i];
+    fprintf(f,
+            "%s\n    {\"core:sample_start\": %" PRIu64 ", \"core:frequency\": %.1f, ",
+            i ? "," : "",
+            c->sample_start,
+            c->freq);
+    if (i == 0) {
+      fprintf(f, "\"core:datetime\": \"%s\", ", datetime);
+    }
+    fprintf(f, "\"srsran:hw_timestamp\": %" PRIu64 ", \"srsran:sample_rate\": %.1f}", c->tstamp, c->srate);
+  }
+  fprintf(f, "\n  ],\n  \"annotations\": [");
+  for (uint32_t i = 0; i < nof_annotations; i++) {
+    const rf_recorder_annotation_t* a = &annotations[i];
+    fprintf(f,
+            "%s\n    {\"core:sample_start\": %" PRIu64 ", \"core:label\": \"%s\"",
+            i ? "," : "",
+            a->sample_start,
+            a->label);
+    if (a->nof_lost) {
+      fprintf(f, ", \"srsran:lost_samples\": %" PRIu64, a->nof_lost);
+    }
+    fprintf(f, "}");
+  }
+  fprintf(f, "\n  ]\n}\n");
+  if (fclose(f) || rename(tmp_path, r->meta_path)) {
+    ERROR("RF recorder: could not write %s: %s\n", r->meta_path, strerror(errno));
+  }
+}
+
+// Called by the writer thread with the mutex held, which is released while the file is written
+static void flush_metadata(rf_recorder_t* r)
+{
+  uint32_t                  nof_captures    = r->nof_captures;
+  uint32_t                  nof_annotations = r->nof_annotations;
+  rf_recorder_capture_t*    captures        = calloc(nof_captures + 1, sizeof(rf_recorder_capture_t));
+  rf_recorder_annotation_t* annotations     = calloc(nof_annotations + 1, sizeof(rf_recorder_annotation_t));
+  if (captures && annotations) {
+    memcpy(captures, r->captures, nof_captures * sizeof(rf_recorder_capture_t));
+    memcpy(annotations, r->annotations, nof_annotations * sizeof(rf_recorder_annotation_t));
+    r->meta_dirty = false;
+    pthread_mutex_unlock(&r->mutex);
+    write_metadata(r, captures, nof_captures, annotations, nof_annotations);
+    pthread_mutex_lock(&r->mutex);
+  }
+  free(captures);
+  free(annotations);
+}
+
+static void* recorder_thread(void* arg)
+{
+  rf_recorder_t*  r         = (rf_recorder_t*)arg;
+  struct timespec next_meta = {}; // earliest update of the metadata file
+
+  pthread_mutex_lock(&r->mutex);
+  while (true) {
+    while (r->running && !r->queue_count && !r->meta_dirty) {
+      pthread_cond_wait(&r->cvar, &r->mutex);
+    }
+    if (!r->queue_count) {
+      if (!r->running) {
+        break;
+      }
+      // new captures or annotations, rewriting the metadata file at most once per period
+      struct timespec now;
+      clock_gettime(CLOCK_REALTIME, &now);
+      if (now.tv_sec < next_meta.tv_sec || (now.tv_sec == next_meta.tv_sec && now.tv_nsec < next_meta.tv_nsec)) {
+        pthread_cond_timedwait(&r->cvar, &r->mutex, &next_meta);
+        continue;
+      }
+      flush_metadata(r);
+      next_meta.tv_sec  = now.tv_sec + RF_RECORDER_META_PERIOD_MS / 1000;
+      next_meta.tv_nsec = now.tv_nsec + (RF_RECORDER_META_PERIOD_MS % 1000) * 1000000L;
+      if (next_meta.tv_nsec >= 1000000000L) {
+        next_meta.tv_sec++;
+        next_meta.tv_nsec -= 1000000000L;
+      }
+      continue;
+    }
+    uint32_t idx  = r->queue[r->queue_head];
+    r->queue_head = (r->queue_head + 1) % RF_RECORDER_NOF_BUFFERS;
+    r->queue_count--;
+    pthread_mutex_unlock(&r->mutex);
+
+    int ret = write_all(r->fd, r->buffers[idx], r->buffer_len[idx]);
+
+    pthread_mutex_lock(&r->mutex);
+    if (ret < 0 && !r->write_error) {
+      r->write_error = errno;
+    }
+    r->free_list[r->nof_free++] = idx;
+  }
+  pthread_mutex_unlock(&r->mutex);
+  return NULL;
+}
+
+static bool take_buffer(rf_recorder_t* r)
+{
+  pthread_mutex_lock(&r->mutex);
+  if (!r->nof_free) {
+    pthread_mutex_unlock(&r->mutex);
+    return false;
+  }
+  r->fill_idx = (int)r->free_list[--r->nof_free];
+  pthread_mutex_unlock(&r->mutex);
+  r->buffer_len[r->fill_idx] = 0;
+  return true;
+}
+
+static void queue_buffer(rf_recorder_t* r)
+{
+  pthread_mutex_lock(&r->mutex);
+  r->queue[(r->queue_head + r->queue_count) % RF_RECORDER_NOF_BUFFERS] = (uint32_t)r->fill_idx;
+  r->queue_count++;
+  pthread_cond_signal(&r->cvar);
+  pthread_mutex_unlock(&r->mutex);
+  r->fill_idx = -1;
+}
+
+static bool grow(void** array, uint32_t count, uint32_t* max, size_t elem_size)
+{
+  if (count < *max) {
+    return true;
+  }
+  uint32_t new_max = *max ? 2 * *max : 64;
+  void*    tmp     = realloc(*array, new_max * elem_size);
+  if (!tmp) {
+    return false;
+  }
+  *array = tmp;
+  *max   = new_max;
+  return true;
+}
+
+// The captures and annotations are appended under the mutex, the writer thread copies them to update the metadata
+static void add_capture(rf_recorder_t* r, uint64_t tstamp, double srate)
+{
+  pthread_mutex_lock(&r->mutex);
+  if (grow((void**)&r->captures, r->nof_captures, &r->max_captures, sizeof(rf_recorder_capture_t))) {
+    rf_recorder_capture_t* c = &r->captures[r->nof_captures++];
+    c->sample_start          = r->nof_samples;
+    c->tstamp                = tstamp;
+    c->srate                 = srate;
+    c->freq                  = r->freq;
+    r->meta_dirty            = true;
+    pthread_cond_signal(&r->cvar);
+  }
+  pthread_mutex_unlock(&r->mutex);
+}
+
+static void add_annotation(rf_recorder_t* r, const char* label, uint64_t nof_lost)
+{
+  pthread_mutex_lock(&r->mutex);
+  if (grow((void**)&r->annotations, r->nof_annotations, &r->max_annotations, sizeof(rf_recorder_annotation_t))) {
+    rf_recorder_annotation_t* a = &r->annotations[r->nof_annotations++];
+    a->sample_start             = r->nof_samples;
+    a->nof_lost                 = nof_lost;
+    a->label                    = label;
+    r->meta_dirty               = true;
+    pthread_cond_signal(&r->cvar);
+  }
+  pthread_mutex_unlock(&r->mutex);
+}
+
+int rf_recorder_init(rf_recorder_t* r, const char* base_path, uint32_t nof_channels)
+{
+  bzero(r, sizeof(rf_recorder_t));
+  r->fd       = -1;
+  r->fill_idx = -1;
+
+  if (snprintf(r->data_path, RF_RECORDER_PATH_LEN, "%s.sigmf-data", base_path) >= RF_RECORDER_PATH_LEN ||
+      snprintf(r->meta_path, RF_RECORDER_PATH_LEN, "%s.sigmf-meta", base_path) >= RF_RECORDER_PATH_LEN) {
+    ERROR("RF recorder: path too long %s\n", base_path);
+    return SRSRAN_ERROR;
+  }
+  r->nof_channels = nof_channels;
+  r->sample_size  = 2 * sizeof(int16_t) * nof_channels;
+
+  // O_DIRECT needs whole buffers, all of them multiple of the alignment
+  r->direct_io = (RF_RECORDER_BUFFER_SIZE % r->sample_size) == 0;
+  r->fd        = open(r->data_path, O_WRONLY | O_CREAT | O_TRUNC | (r->direct_io ? O_DIRECT : 0), 0644);
+  if (r->fd < 0 && r->direct_io && errno == EINVAL) {
+    // the file system does not support O_DIRECT (e.g. tmpfs)
+    r->direct_io = false;
+    r->fd        = open(r->data_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  }
+  if (r->fd < 0) {
+    ERROR("RF recorder: could not open %s: %s\n", r->data_path, strerror(errno));
+    return SRSRAN_ERROR;
+  }
+
+  for (uint32_t i = 0; i < RF_RECORDER_NOF_BUFFERS; i++) {
+    if (posix_memalign((void**)&r->buffers[i], RF_RECORDER_ALIGNMENT, RF_RECORDER_BUFFER_SIZE)) {
+      ERROR("RF recorder: could not allocate buffers\n");
+      for (uint32_t j = 0; j < i; j++) {
+        free(r->buffers[j]);
+      }
+      close(r->fd);
+      return SRSRAN_ERROR;
+    }
+    r->free_list[i] = i;
+  }
+  r->nof_free = RF_RECORDER_NOF_BUFFERS;
+
+  pthread_mutex_init(&r->mutex, NULL);
+  pthread_cond_init(&r->cvar, NULL);
+  r->running = true;
+  pthread_create(&r->thread, NULL, recorder_thread, r);
+
+  printf("RF recorder: writing RX samples to %s%s\n", r->data_path, r->direct_io ? " (O_DIRECT)" : "");
+  return SRSRAN_SUCCESS;
+}
+
+void rf_recorder_set_freq(rf_recorder_t* r, double freq, uint64_t tstamp)
+{
+  pthread_mutex_lock(&r->mutex);
+  if (r->nof_freq_changes == RF_RECORDER_MAX_FREQ_CHANGES) {
+    // the reader thread is not consuming them, forget the oldest
+    r->freq_head = (r->freq_head + 1) % RF_RECORDER_MAX_FREQ_CHANGES;
+    r->nof_freq_changes--;
+  }
+  rf_recorder_freq_change_t* c =
+      &r->freq_changes[(r->freq_head + r->nof_freq_changes) % RF_RECORDER_MAX_FREQ_CHANGES];
+  c->tstamp = tstamp;
+  c->freq   = freq;
+  __atomic_store_n(&r->nof_freq_changes, r->nof_freq_changes + 1, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&r->mutex);
+}
+
+// Applies the frequency changes due at tstamp, returns how many of the nof_samples precede the next one
+static uint32_t apply_freq_changes(rf_recorder_t* r, uint64_t tstamp, uint32_t nof_samples)
+{
+  uint32_t n = nof_samples;
+  pthread_mutex_lock(&r->mutex);
+  while (r->nof_freq_changes) {
+    rf_recorder_freq_change_t* c = &r->freq_changes[r->freq_head];
+    if (c->tstamp != RF_RECORDER_NO_TSTAMP && c->tstamp > tstamp) {
+      if (c->tstamp < tstamp + nof_samples) {
+        n = (uint32_t)(c->tstamp - tstamp);
+      }
+      break;
+    }
+    r->freq      = c->freq;
+    r->freq_head = (r->freq_head + 1) % RF_RECORDER_MAX_FREQ_CHANGES;
+    r->nof_freq_changes--;
+  }
+  pthread_mutex_unlock(&r->mutex);
+  return n;
+}
+
+static void push_segment(rf_recorder_t* r, uint64_t tstamp, double srate, const uint8_t* src, uint32_t nof_samples)
+{
+  // every discontinuity or change of the RF configuration opens a new capture segment
+  rf_recorder_capture_t* last = r->nof_captures ? &r->captures[r->nof_captures - 1] : NULL;
+  if (!r->started || tstamp != r->next_tstamp || !last || last->srate != srate || last->freq != r->freq) {
+    if (!r->started) {
+      clock_gettime(CLOCK_REALTIME, &r->t_start);
+    } else if (tstamp != r->next_tstamp) {
+      uint64_t nof_lost = (tstamp > r->next_tstamp) ? tstamp - r->next_tstamp : 0;
+      add_annotation(r, r->dropping ? "recorder overflow" : "gap", nof_lost);
+    }
+    add_capture(r, tstamp, srate);
+    r->started  = true;
+    r->dropping = false;
+  }
+  r->next_tstamp = tstamp;
+
+  uint32_t remaining = nof_samples;
+  while (remaining) {
+    if (r->fill_idx < 0 && !take_buffer(r)) {
+      // the disk is not keeping up, never stall the reader thread
+      r->dropping = true;
+      r->nof_dropped += remaining;
+      return;
+    }
+    uint32_t len   = r->buffer_len[r->fill_idx];
+    uint32_t space = (RF_RECORDER_BUFFER_SIZE - len) / r->sample_size;
+    uint32_t n     = SRSRAN_MIN(space, remaining);
+    memcpy(&r->buffers[r->fill_idx][len], src, (size_t)n * r->sample_size);
+    r->buffer_len[r->fill_idx] = len + n * r->sample_size;
+    src += (size_t)n * r->sample_size;
+    remaining -= n;
+    r->nof_samples += n;
+    r->next_tstamp += n;
+    if (RF_RECORDER_BUFFER_SIZE - r->buffer_len[r->fill_idx] < r->sample_size) {
+      queue_buffer(r);
+    }
+  }
+}
+
+void rf_recorder_push(rf_recorder_t* r, uint64_t tstamp, double srate, const void* payload, uint32_t nof_samples)
+{
+  if (tstamp == RF_RECORDER_NO_TSTAMP) {
+    tstamp = r->next_tstamp;
+  }
+  const uint8_t* src = (const uint8_t*)payload;
+  while (nof_samples) {
+    uint32_t n = nof_samples;
+    if (__atomic_load_n(&r->nof_freq_changes, __ATOMIC_ACQUIRE)) {
+      n = apply_freq_changes(r, tstamp, nof_samples);
+    }
+    push_segment(r, tstamp, srate, src, n);
+    src += (size_t)n * r->sample_size;
+    tstamp += n;
+    nof_samples -= n;
+  }
+}
+
+void rf_recorder_annotate(rf_recorder_t* r, const char* label)
+{
+  add_annotation(r, label, 0);
+}
+
+void rf_recorder_free(rf_recorder_t* r)
+{
+  if (r->fd < 0) {
+    return;
+  }
+  pthread_mutex_lock(&r->mutex);
+  r->running = false;
+  pthread_cond_signal(&r->cvar);
+  pthread_mutex_unlock(&r->mutex);
+  pthread_join(r->thread, NULL);
+
+  // the last buffer is partially filled, O_DIRECT would need an aligned length
+  if (r->fill_idx >= 0 && r->buffer_len[r->fill_idx]) {
+    if (r->direct_io) {
+      fcntl(r->fd, F_SETFL, fcntl(r->fd, F_GETFL) & ~O_DIRECT);
+    }
+    if (write_all(r->fd, r->buffers[r->fill_idx], r->buffer_len[r->fill_idx]) < 0 && !r->write_error) {
+      r->write_error = errno;
+    }
+  }
+  close(r->fd);
+  r->fd = -1;
+  if (r->dropping) {
+    add_annotation(r, "recorder overflow", 0);
+  }
+  write_metadata(r, r->captures, r->nof_captures, r->annotations, r->nof_annotations);
+
+  printf("RF recorder: %" PRIu64 " samples written to %s", r->nof_samples, r->data_path);
+  if (r->nof_dropped) {
+    printf(", %" PRIu64 " samples dropped", r->nof_dropped);
+  }
+  printf("\n");
+  if (r->write_error) {
+    ERROR("RF recorder: write error: %s\n", strerror(r->write_error));
+  }
+
+  for (uint32_t i = 0; i < RF_RECORDER_NOF_BUFFERS; i++) {
+    free(r->buffers[i]);
+  }
+  free(r->captures);
+  free(r->annotations);
+  pthread_mutex_destroy(&r->mutex);
+  pthread_cond_destroy(&r->cvar);
+}
@@ -0,0 +1,116 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_RECORDER_H_
+#define SRSRAN_RF_RECORDER_H_
+
+// Continuous RX recorder shared by the RF plugins, enabled with the record=<base path> device argument.
+// The reader thread hands the native sc16 payload of every packet to the recorder, which copies it into a pool of
+// aligned buffers written to <base>.sigmf-data by a dedicated thread using O_DIRECT (plain buffered I/O on file
+// systems without O_DIRECT support, e.g. tmpfs). The reader thread never blocks on the disk: if no buffer is free the
+// samples are dropped and the gap is annotated. HW timestamps, timeline gaps and overflows are stored in
+// <base>.sigmf-meta, which the writer thread replaces as they are added, so that a crash only loses the last second.
+
+#include "srsran/config.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#define RF_RECORDER_NOF_BUFFERS      16
+#define RF_RECORDER_BUFFER_SIZE      (4 * 1024 * 1024)
+#define RF_RECORDER_ALIGNMENT        4096
+#define RF_RECORDER_PATH_LEN         256
+#define RF_RECORDER_NO_TSTAMP        UINT64_MAX // the samples follow the previous ones, for streams without timestamps
+#define RF_RECORDER_MAX_FREQ_CHANGES 16
+#define RF_RECORDER_META_PERIOD_MS   1000 // minimum interval between two updates of the metadata file
+
+typedef struct {
+  uint64_t sample_start; // first sample of the segment in the data file
+  uint64_t tstamp;       // HW timestamp of that sample
+  double   srate;
+  double   freq;
+} rf_recorder_capture_t;
+
+typedef struct {
+  uint64_t    sample_start;
+  uint64_t    nof_lost; // samples missing from the timeline at sample_start
+  const char* label;
+} rf_recorder_annotation_t;
+
+typedef struct {
+  uint64_t tstamp; // HW timestamp of the first sample at the new frequency, RF_RECORDER_NO_TSTAMP for the next one
+  double   freq;
+} rf_recorder_freq_change_t;
+
+typedef struct {
+  char     data_path[RF_RECORDER_PATH_LEN];
+  char     meta_path[RF_RECORDER_PATH_LEN];
+  int      fd;
+  bool     direct_io;
+  uint32_t nof_channels;
+  uint32_t sample_size; // bytes per sample time, all channels
+
+  // buffer pool, the reader thread fills one buffer at a time and queues it to the writer thread when full
+  uint8_t*        buffers[RF_RECORDER_NOF_BUFFERS];
+  uint32_t        buffer_len[RF_RECORDER_NOF_BUFFERS];
+  int             fill_idx; // buffer being filled, -1 if none
+  uint32_t        free_list[RF_RECORDER_NOF_BUFFERS];
+  uint32_t        nof_free;
+  uint32_t        queue[RF_RECORDER_NOF_BUFFERS];
+  uint32_t        queue_head;
+  uint32_t        queue_count;
+  bool            running;
+  int             write_error;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cvar;
+  pthread_t       thread;
+
+  // frequency changes waiting for their sample, queued by rf_recorder_set_freq() under the mutex
+  rf_recorder_freq_change_t freq_changes[RF_RECORDER_MAX_FREQ_CHANGES];
+  uint32_t                  freq_head;
+  uint32_t                  nof_freq_changes;
+
+  // timeline, only accessed by the reader thread, except the captures and annotations which are appended under the
+  // mutex and read by the writer thread to update the metadata file
+  bool                      started;
+  bool                      dropping; // samples are being dropped for lack of a free buffer
+  uint64_t                  next_tstamp;
+  uint64_t                  nof_samples; // samples stored in the data file
+  uint64_t                  nof_dropped;
+  double                    freq;
+  struct timespec           t_start;
+  rf_recorder_capture_t*    captures;
+  uint32_t                  nof_captures;
+  uint32_t                  max_captures;
+  rf_recorder_annotation_t* annotations;
+  uint32_t                  nof_annotations;
+  uint32_t                  max_annotations;
+  bool                      meta_dirty; // captures or annotations not in the metadata file yet
+} rf_recorder_t;
+
+SRSRAN_API int rf_recorder_init(rf_recorder_t* r, const char* base_path, uint32_t nof_channels);
+
+// Flushes the pending samples, writes the metadata file and releases the recorder
+SRSRAN_API void rf_recorder_free(rf_recorder_t* r);
+
+// Records a change of the RX frequency taking effect at HW timestamp tstamp, or RF_RECORDER_NO_TSTAMP for the next
+// pushed sample. Can be called from any thread.
+SRSRAN_API void rf_recorder_set_freq(rf_recorder_t* r, double freq, uint64_t tstamp);
+
+// Stores nof_samples contiguous sc16 samples (interleaved channels) starting at HW timestamp tstamp
+SRSRAN_API void
+rf_recorder_push(rf_recorder_t* r, uint64_t tstamp, double srate, const void* payload, uint32_t nof_samples);
+
+// Annotates an event at the current end of the recording
+SRSRAN_API void rf_recorder_annotate(rf_recorder_t* r, const char* label);
+
+#endif // SRSRAN_RF_RECORDER_H_
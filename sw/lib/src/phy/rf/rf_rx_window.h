@@ -0,0 +1,80 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_RX_WINDOW_H_
+#define SRSRAN_RF_RX_WINDOW_H_
+
+// Tracks the span of hardware ticks requested by the last RX stream command, shared by the RF plugins.
+// Callers are expected to hold the streamer mutex.
+
+#include "srsran/config.h"
+#include "srsran/phy/rf/rf.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  uint64_t start;  // first tick delivered
+  uint64_t end;    // first tick no longer delivered, UINT64_MAX while streaming continuously
+  uint64_t length; // length of a finite capture whose first sample hasn't been received yet
+  bool     flush;  // samples buffered before the command must be dropped
+  bool     done;   // finite capture completed, waiting for the next command
+} rf_rx_window_t;
+
+static inline void rf_rx_window_reset(rf_rx_window_t* w)
+{
+  w->start  = 0;
+  w->end    = UINT64_MAX;
+  w->length = 0;
+  w->flush  = false;
+  w->done   = false;
+}
+
+// tick is the time of the command converted to hardware ticks, 0 if it has to be applied immediately. The plugins
+// reject NUM_SAMPS_AND_DONE commands of 0 samples, whose length would read as continuous streaming.
+static inline void rf_rx_window_arm(rf_rx_window_t* w, const srsran_rf_stream_cmd_t* cmd, uint64_t tick)
+{
+  if (cmd->mode == SRSRAN_RF_STREAM_MODE_STOP) {
+    w->end    = tick;
+    w->length = 0;
+    return;
+  }
+  w->start  = tick;
+  w->end    = UINT64_MAX;
+  w->length = (cmd->mode == SRSRAN_RF_STREAM_MODE_NUM_SAMPS_AND_DONE) ? cmd->nof_samples : 0;
+  w->flush  = true;
+  w->done   = false;
+}
+
+// Computes which samples of a packet fall in the window, returns false if none does
+static inline bool
+rf_rx_window_clip(rf_rx_window_t* w, uint64_t tstamp, uint32_t nof_samples, uint32_t* offset, uint32_t* count)
+{
+  if (tstamp + nof_samples <= w->start || tstamp >= w->end) {
+    return false;
+  }
+  uint64_t first = (tstamp > w->start) ? tstamp : w->start;
+  if (w->length) {
+    w->end    = first + w->length;
+    w->length = 0;
+  }
+  uint64_t last = (tstamp + nof_samples < w->end) ? tstamp + nof_samples : w->end;
+  *offset       = (uint32_t)(first - tstamp);
+  *count        = (uint32_t)(last - first);
+  return true;
+}
+
+// True once a packet starting at tstamp lies past the end of a finite window
+static inline bool rf_rx_window_finished(const rf_rx_window_t* w, uint64_t tstamp)
+{
+  return w->end != UINT64_MAX && tstamp >= w->end;
+}
+
+#endif // SRSRAN_RF_RX_WINDOW_H_
@@ -0,0 +1,124 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_SHM_H_
+#define SRSRAN_RF_SHM_H_
+
+// Layout of the POSIX shared memory through which a process owning the radio (the server, any application opening an
+// RF plugin with shm_server=<name>) shares its streams with other processes (the shm device, rf_shm_imp.c).
+//
+// RX: the server publishes every packet it reads from the DMA, native sc16 samples and HW timestamp, to a ring of
+// slots that clients read in place, each with its own cursor. The server never waits for a client; a client that falls
+// more than a ring behind loses packets, which it detects with the sequence number of the slot (odd while written).
+// TX: clients claim slots of a submission queue, convert their samples straight into them and commit them; a thread of
+// the server hands the committed packets, in claim order, to its TX path. A slot left claimed by a client that died
+// is skipped after RF_SHM_TX_ABANDON_MS; the commit and the skip are both a compare-and-swap of the slot sequence, so
+// a client that comes back late learns that its slot was dropped. Both streams carry an item of every channel
+// of the server per sample, the clients send zeros on the channels they did not open.
+// Waiting on both sides uses futexes on counters of the shared memory, woken only when someone sleeps on them.
+
+#include "rf_time_base.h"
+#include "srsran/config.h"
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RF_SHM_MAGIC 0x4d48534652535253ULL // "SRSRFSHM"
+#define RF_SHM_VERSION 2
+#define RF_SHM_RX_SLOTS 256
+#define RF_SHM_TX_SLOTS 64
+#define RF_SHM_SLOT_SAMPLES 7680 // samples (per channel) of a slot, longer packets take several slots
+#define RF_SHM_FLAG_EOB 1        // RX: end of a finite capture, TX: end of burst
+#define RF_SHM_WAIT_MS 100       // futex waits are bounded to notice a server going away
+#define RF_SHM_TX_ABANDON_MS 1000 // a TX slot claimed but not committed for that long is skipped by the server
+#define RF_SHM_SEQ_ABANDONED (1ULL << 63) // TX: set with index + 1 by the server on a skipped slot
+
+typedef struct {
+  uint64_t seq;         // RX: 2 * (index + 1) once written, odd while written. TX: index + 1 once committed
+  uint64_t tstamp;      // HW tick of the first sample
+  uint32_t nof_samples;
+  uint32_t flags;
+  uint64_t reserved[5]; // the samples start on a cache line
+} rf_shm_slot_t;
+
+typedef struct {
+  uint64_t magic; // written last by the server
+  uint32_t version;
+  uint32_t nof_channels;
+  uint32_t rx_nof_slots;
+  uint32_t tx_nof_slots;
+  uint32_t slot_samples;
+  uint32_t slot_size; // bytes, header included
+  uint64_t rx_offset; // bytes from the start of the mapping
+  uint64_t tx_offset;
+  uint64_t size;
+  uint32_t alive;     // cleared by the server before it goes away
+  int32_t  owner_pid; // process of the server, a new server only replaces the segment once it is gone
+
+  uint32_t      time_seq; // odd while the time base is updated
+  rf_time_base_t time;
+
+  uint64_t rx_head __attribute__((aligned(64))); // packets published
+  uint32_t rx_futex;                             // bumped with rx_head
+  uint32_t rx_waiters;
+
+  uint64_t tx_claim __attribute__((aligned(64))); // slots claimed by the clients
+  uint32_t tx_space_futex;                        // bumped with tx_tail
+  uint32_t tx_space_waiters;
+  uint64_t tx_tail __attribute__((aligned(64))); // slots handed to the TX path by the server
+  uint32_t tx_futex;                             // bumped on every commit
+  uint32_t tx_waiters;
+} rf_shm_ctrl_t;
+
+static inline uint8_t* rf_shm_rx_slot(rf_shm_ctrl_t* c, uint64_t idx)
+{
+  return (uint8_t*)c + c->rx_offset + (idx % c->rx_nof_slots) * c->slot_size;
+}
+
+static inline uint8_t* rf_shm_tx_slot(rf_shm_ctrl_t* c, uint64_t idx)
+{
+  return (uint8_t*)c + c->tx_offset + (idx % c->tx_nof_slots) * c->slot_size;
+}
+
+// Bumps a futex word and wakes its sleepers, if any
+static inline void rf_shm_wake(uint32_t* word, uint32_t* waiters)
+{
+  __atomic_add_fetch(word, 1, __ATOMIC_RELEASE);
+  if (__atomic_load_n(waiters, __ATOMIC_ACQUIRE)) {
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+  }
+}
+
+// Sleeps until the futex word moves from val, or for timeout_ms. The caller read val before checking its condition.
+static inline void rf_shm_wait(uint32_t* word, uint32_t* waiters, uint32_t val, int timeout_ms)
+{
+  struct timespec ts = {timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+  __atomic_add_fetch(waiters, 1, __ATOMIC_SEQ_CST);
+  syscall(SYS_futex, word, FUTEX_WAIT, val, &ts, NULL, 0);
+  __atomic_sub_fetch(waiters, 1, __ATOMIC_RELEASE);
+}
+
+// Consistent copy of the time base published by the server
+static inline void rf_shm_read_time(rf_shm_ctrl_t* c, rf_time_base_t* t)
+{
+  uint32_t seq;
+  do {
+    seq = __atomic_load_n(&c->time_seq, __ATOMIC_ACQUIRE);
+    *t  = c->time;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((seq & 1) || seq != __atomic_load_n(&c->time_seq, __ATOMIC_RELAXED));
+}
+
+#endif // SRSRAN_RF_SHM_H_
@@ -0,0 +1,516 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rf_helper.h"
+#include "rf_shm.h"
+#include "rf_shm_imp.h"
+#include "srsran/phy/common/phy_common.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+typedef struct {
+  rf_shm_ctrl_t* ctrl;
+  size_t         size;
+  uint32_t       nof_channels; // channels used by the application, the server may share more
+  uint32_t       sample_size;  // bytes per sample time in the slots, all the channels of the server
+  float*         tx_zeros;     // samples of the server channels not opened, a slot long
+
+  // RX cursor, the next sample to read is at rx_offset in the packet of slot rx_cursor
+  uint64_t rx_cursor;
+  uint32_t rx_offset;
+  uint64_t rx_tstamp; // tick following the last sample received
+  int16_t* rx_buffer; // samples gathered from the slots, validated before they are converted
+  size_t   rx_buffer_len;
+
+  double                    rx_gain;
+  double                    tx_gain;
+  double                    rx_freq;
+  double                    tx_freq;
+  srsran_rf_info_t          info;
+  srsran_rf_error_handler_t error_handler;
+  void*                     error_handler_arg;
+} rf_shm_handler_t;
+
+static void log_overflow(rf_shm_handler_t* h)
+{
+  if (h->error_handler) {
+    srsran_rf_error_t error;
+    bzero(&error, sizeof(srsran_rf_error_t));
+    error.type = SRSRAN_RF_ERROR_OVERFLOW;
+    h->error_handler(h->error_handler_arg, error);
+  }
+}
+
+static bool server_alive(rf_shm_handler_t* handler)
+{
+  return __atomic_load_n(&handler->ctrl->alive, __ATOMIC_ACQUIRE) != 0;
+}
+
+int rf_shm_open(char* args, void** h)
+{
+  return rf_shm_open_multi(args, h, 1);
+}
+
+int rf_shm_open_multi(char* args, void** h, uint32_t nof_channels)
+{
+  *h = NULL;
+
+  char name[RF_PARAM_LEN] = "";
+  parse_string(args, "shm", 0, name);
+  if (name[0] == '\0') {
+    fprintf(stderr, "RF_SHM: no shm= argument given\n");
+    return SRSRAN_ERROR;
+  }
+  char path[RF_PARAM_LEN + 1];
+  snprintf(path, sizeof(path), "%s%s", name[0] == '/' ? "" : "/", name);
+
+  int fd = shm_open(path, O_RDWR, 0);
+  if (fd < 0) {
+    fprintf(stderr, "RF_SHM: could not open %s: %s, is the server running?\n", path, strerror(errno));
+    return SRSRAN_ERROR;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(rf_shm_ctrl_t)) {
+    fprintf(stderr, "RF_SHM: %s is not initialised\n", path);
+    close(fd);
+    return SRSRAN_ERROR;
+  }
+  void* map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    fprintf(stderr, "RF_SHM: could not map %s: %s\n", path, strerror(errno));
+    return SRSRAN_ERROR;
+  }
+  rf_shm_ctrl_t* c = (rf_shm_ctrl_t*)map;
+  if (__atomic_load_n(&c->magic, __ATOMIC_ACQUIRE) != RF_SHM_MAGIC || c->version != RF_SHM_VERSION ||
+      c->size != (uint64_t)st.st_size || !c->alive) {
+    fprintf(stderr, "RF_SHM: %s is not shared by a running server of this version\n", path);
+    munmap(map, (size_t)st.st_size);
+    return SRSRAN_ERROR;
+  }
+  if (nof_channels == 0) {
+    nof_channels = 1;
+  }
+  if (nof_channels > c->nof_channels) {
+    fprintf(stderr, "RF_SHM: the server shares %u channels, %u requested\n", c->nof_channels, nof_channels);
+    munmap(map, (size_t)st.st_size);
+    return SRSRAN_ERROR;
+  }
+  // the slots hold an item of every channel of the server per sample, the TX path writes them whole
+  if (c->nof_channels > SRSRAN_MAX_CHANNELS ||
+      c->slot_size < sizeof(rf_shm_slot_t) + (uint64_t)c->slot_samples * 2 * sizeof(int16_t) * c->nof_channels) {
+    fprintf(stderr, "RF_SHM: %s has slots too small for %u channels\n", path, c->nof_channels);
+    munmap(map, (size_t)st.st_size);
+    return SRSRAN_ERROR;
+  }
+
+  rf_shm_handler_t* handler = calloc(1, sizeof(rf_shm_handler_t));
+  if (!handler) {
+    munmap(map, (size_t)st.st_size);
+    return SRSRAN_ERROR;
+  }
+  handler->ctrl         = c;
+  handler->size         = (size_t)st.st_size;
+  handler->nof_channels = nof_channels;
+  handler->sample_size  = 2 * sizeof(int16_t) * c->nof_channels;
+  handler->rx_cursor    = __atomic_load_n(&c->rx_head, __ATOMIC_ACQUIRE);
+  handler->tx_zeros     = srsran_vec_f_malloc(2 * c->slot_samples);
+  if (!handler->tx_zeros) {
+    rf_shm_close(handler);
+    return SRSRAN_ERROR;
+  }
+  srsran_vec_f_zero(handler->tx_zeros, 2 * c->slot_samples);
+
+  handler->info.min_rx_gain = 0.0;
+  handler->info.max_rx_gain = 90.0;
+  handler->info.min_tx_gain = 0.0;
+  handler->info.max_tx_gain = 90.0;
+  *h                        = handler;
+  printf("RF_SHM: attached to %s, %u of %u channels\n", path, nof_channels, c->nof_channels);
+  return SRSRAN_SUCCESS;
+}
+
+const char* rf_shm_devname(void* h)
+{
+  return "shm";
+}
+
+int rf_shm_close(void* h)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+  if (!handler) {
+    return SRSRAN_ERROR;
+  }
+  munmap(handler->ctrl, handler->size);
+  free(handler->rx_buffer);
+  free(handler->tx_zeros);
+  free(handler);
+  return SRSRAN_SUCCESS;
+}
+
+int rf_shm_start_rx_stream(void* h, bool now)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+  // the stream runs in the server, the client starts with the next packet published
+  handler->rx_cursor = __atomic_load_n(&handler->ctrl->rx_head, __ATOMIC_ACQUIRE);
+  handler->rx_offset = 0;
+  return SRSRAN_SUCCESS;
+}
+
+int rf_shm_stop_rx_stream(void* h)
+{
+  return SRSRAN_SUCCESS;
+}
+
+void rf_shm_flush_buffer(void* h)
+{
+  rf_shm_start_rx_stream(h, true);
+}
+
+bool rf_shm_has_rssi(void* h)
+{
+  return false;
+}
+
+float rf_shm_get_rssi(void* h)
+{
+  return 0.0f;
+}
+
+void rf_shm_suppress_stdout(void* h)
+{
+  // do nothing
+}
+
+void rf_shm_register_error_handler(void* h, srsran_rf_error_handler_t error_handler, void* arg)
+{
+  rf_shm_handler_t* handler  = (rf_shm_handler_t*)h;
+  handler->error_handler     = error_handler;
+  handler->error_handler_arg = arg;
+}
+
+double rf_shm_set_rx_srate(void* h, double freq)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+  rf_time_base_t     t;
+  rf_shm_read_time(handler->ctrl, &t);
+  if (t.srate == 0) {
+    // the server has not started streaming yet
+    return freq;
+  }
+  if (fabs(freq - t.srate) > 1.0) {
+    printf("RF_SHM: the server runs at %.2f MHz, ignoring %.2f MHz\n", t.srate / 1e6, freq / 1e6);
+  }
+  return t.srate;
+}
+
+double rf_shm_set_tx_srate(void* h, double freq)
+{
+  // RX and TX share the timeline of the server
+  return rf_shm_set_rx_srate(h, freq);
+}
+
+int rf_shm_set_rx_gain(void* h, double gain)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+  handler->rx_gain          = gain;
+  return SRSRAN_SUCCESS;
+}
+
+int rf_shm_set_tx_gain(void* h, double gain)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+  handler->tx_gain          = gain;
+  return SRSRAN_SUCCESS;
+}
+
+double rf_shm_get_rx_gain(void* h)
+{
+  return ((rf_shm_handler_t*)h)->rx_gain;
+}
+
+double rf_shm_get_tx_gain(void* h)
+{
+  return ((rf_shm_handler_t*)h)->tx_gain;
+}
+
+srsran_rf_info_t* rf_shm_get_info(void* h)
+{
+  return &((rf_shm_handler_t*)h)->info;
+}
+
+double rf_shm_set_rx_freq(void* h, uint32_t ch, double freq)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+  handler->rx_freq          = freq;
+  return freq;
+}
+
+double rf_shm_set_tx_freq(void* h, uint32_t ch, double freq)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+  handler->tx_freq          = freq;
+  return freq;
+}
+
+void rf_shm_get_time(void* h, time_t* secs, double* frac_secs)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+  rf_time_base_t     t;
+  rf_shm_read_time(handler->ctrl, &t);
+  rf_time_base_to_time(&t, handler->rx_tstamp, secs, frac_secs);
+}
+
+static bool grow_buffer(rf_shm_handler_t* handler, size_t min_len)
+{
+  if (handler->rx_buffer_len >= min_len) {
+    return true;
+  }
+  int16_t* tmp = srsran_vec_malloc(min_len * sizeof(int16_t));
+  if (!tmp) {
+    return false;
+  }
+  free(handler->rx_buffer);
+  handler->rx_buffer     = tmp;
+  handler->rx_buffer_len = min_len;
+  return true;
+}
+
+// Waits for the server to publish a packet past the cursor, returns false if it went away
+static bool wait_rx(rf_shm_handler_t* handler)
+{
+  rf_shm_ctrl_t* c = handler->ctrl;
+  while (server_alive(handler)) {
+    uint32_t val = __atomic_load_n(&c->rx_futex, __ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&c->rx_head, __ATOMIC_ACQUIRE) != handler->rx_cursor) {
+      return true;
+    }
+    rf_shm_wait(&c->rx_futex, &c->rx_waiters, val, RF_SHM_WAIT_MS);
+  }
+  return false;
+}
+
+int rf_shm_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  return rf_shm_recv_with_time_multi(h, &data, nsamples, blocking, secs, frac_secs);
+}
+
+int rf_shm_recv_with_time_multi(void* h, void** data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+  rf_shm_ctrl_t*    c       = handler->ctrl;
+
+  if (!grow_buffer(handler, (size_t)nsamples * handler->sample_size / sizeof(int16_t))) {
+    return SRSRAN_ERROR;
+  }
+
+  // like the live devices, a read may span a gap, the timestamp is the one of the first sample
+  uint64_t tstamp = 0;
+  uint32_t total  = 0;
+  while (total < nsamples) {
+    uint64_t head = __atomic_load_n(&c->rx_head, __ATOMIC_ACQUIRE);
+    if (head == handler->rx_cursor) {
+      if (!wait_rx(handler)) {
+        break;
+      }
+      continue;
+    }
+
+    rf_shm_slot_t* slot = (rf_shm_slot_t*)rf_shm_rx_slot(c, handler->rx_cursor);
+    uint64_t       seq  = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (head - handler->rx_cursor > c->rx_nof_slots || seq != 2 * handler->rx_cursor + 2) {
+      // the server lapped this client, the gathered samples are no longer contiguous with what follows
+      handler->rx_cursor = head;
+      handler->rx_offset = 0;
+      total              = 0;
+      log_overflow(handler);
+      continue;
+    }
+    uint64_t slot_tstamp = slot->tstamp;
+    uint32_t slot_len    = SRSRAN_MIN(slot->nof_samples, c->slot_samples);
+    uint32_t flags       = slot->flags;
+    uint32_t n           = SRSRAN_MIN(nsamples - total, slot_len - SRSRAN_MIN(slot_len, handler->rx_offset));
+    memcpy((uint8_t*)handler->rx_buffer + (size_t)total * handler->sample_size,
+           (uint8_t*)(slot + 1) + (size_t)handler->rx_offset * handler->sample_size,
+           (size_t)n * handler->sample_size);
+
+    // the copy is only valid if the server did not reuse the slot meanwhile
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) {
+      continue;
+    }
+    if (!total) {
+      tstamp = slot_tstamp + handler->rx_offset;
+    }
+    total += n;
+    handler->rx_offset += n;
+    handler->rx_tstamp = slot_tstamp + handler->rx_offset;
+    if (handler->rx_offset >= slot_len) {
+      handler->rx_cursor++;
+      handler->rx_offset = 0;
+      if (flags & RF_SHM_FLAG_EOB) {
+        // end of a finite capture, the application gets what was received
+        break;
+      }
+    }
+  }
+  if (!total) {
+    return server_alive(handler) ? 0 : SRSRAN_ERROR;
+  }
+
+  uint32_t stride = c->nof_channels;
+  for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+    float* dst = (float*)data[ch];
+    if (!dst) {
+      continue;
+    }
+    if (stride == 1) {
+      srsran_vec_convert_if(handler->rx_buffer, 32768, dst, 2 * total);
+    } else {
+      for (uint32_t i = 0; i < total; i++) {
+        dst[2 * i]     = (float)handler->rx_buffer[2 * (i * stride + ch)] / 32768;
+        dst[2 * i + 1] = (float)handler->rx_buffer[2 * (i * stride + ch) + 1] / 32768;
+      }
+    }
+  }
+
+  rf_time_base_t t;
+  rf_shm_read_time(c, &t);
+  rf_time_base_to_time(&t, tstamp, secs, frac_secs);
+  return (int)total;
+}
+
+int rf_shm_send_timed(void*  h,
+                      void*  data,
+                      int    nsamples,
+                      time_t secs,
+                      double frac_secs,
+                      bool   has_time_spec,
+                      bool   blocking,
+                      bool   is_start_of_burst,
+                      bool   is_end_of_burst)
+{
+  void* _data[SRSRAN_MAX_CHANNELS] = {data};
+  return rf_shm_send_timed_multi(
+      h, _data, nsamples, secs, frac_secs, has_time_spec, blocking, is_start_of_burst, is_end_of_burst);
+}
+
+// Waits for the TX slot idx to be released by the server, returns false if it went away
+static bool wait_tx_space(rf_shm_handler_t* handler, uint64_t idx)
+{
+  rf_shm_ctrl_t* c = handler->ctrl;
+  while (server_alive(handler)) {
+    uint32_t val = __atomic_load_n(&c->tx_space_futex, __ATOMIC_ACQUIRE);
+    if (idx - __atomic_load_n(&c->tx_tail, __ATOMIC_ACQUIRE) < c->tx_nof_slots) {
+      return true;
+    }
+    rf_shm_wait(&c->tx_space_futex, &c->tx_space_waiters, val, RF_SHM_WAIT_MS);
+  }
+  return false;
+}
+
+int rf_shm_send_timed_multi(void*  h,
+                            void** data,
+                            int    nsamples,
+                            time_t secs,
+                            double frac_secs,
+                            bool   has_time_spec,
+                            bool   blocking,
+                            bool   is_start_of_burst,
+                            bool   is_end_of_burst)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+  rf_shm_ctrl_t*    c       = handler->ctrl;
+
+  if (nsamples <= 0) {
+    return nsamples;
+  }
+  uint64_t tstamp = 0;
+  if (has_time_spec) {
+    rf_time_base_t t;
+    rf_shm_read_time(c, &t);
+    tstamp = rf_time_base_to_tstamp(&t, secs, frac_secs);
+  }
+
+  // the samples are converted straight into the slots, which the server hands to its TX path in claim order, with
+  // the channels of the server interleaved in each item and zeros for those the application did not open
+  float*             ptrs[SRSRAN_MAX_CHANNELS] = {};
+  srsran_vec_stats_t stats                     = {};
+  for (uint32_t sent = 0; sent < (uint32_t)nsamples;) {
+    uint32_t n   = SRSRAN_MIN((uint32_t)nsamples - sent, c->slot_samples);
+    uint64_t idx = __atomic_fetch_add(&c->tx_claim, 1, __ATOMIC_ACQ_REL);
+    if (!wait_tx_space(handler, idx)) {
+      return SRSRAN_ERROR;
+    }
+    rf_shm_slot_t* slot = (rf_shm_slot_t*)rf_shm_tx_slot(c, idx);
+    // the previous occupant of the slot is handed over, its sequence stays until the commit below or a skip
+    uint64_t prev_seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (prev_seq == ((idx + 1) | RF_SHM_SEQ_ABANDONED)) {
+      ERROR("RF_SHM: TX slot skipped by the server, the client stalled for more than %d ms\n", RF_SHM_TX_ABANDON_MS);
+      return SRSRAN_ERROR;
+    }
+    slot->tstamp        = has_time_spec ? tstamp + sent : 0;
+    slot->nof_samples   = n;
+    slot->flags         = (is_end_of_burst && sent + n == (uint32_t)nsamples) ? RF_SHM_FLAG_EOB : 0;
+    for (uint32_t ch = 0; ch < c->nof_channels; ch++) {
+      ptrs[ch] = (ch < handler->nof_channels && data[ch]) ? (float*)data[ch] + 2 * sent : handler->tx_zeros;
+    }
+    srsran_vec_convert_fi_interleave_stats(ptrs, 32767.999f, (int16_t*)(slot + 1), c->nof_channels, n, &stats);
+    if (!__atomic_compare_exchange_n(&slot->seq, &prev_seq, idx + 1, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+      ERROR("RF_SHM: TX slot skipped by the server, the client stalled for more than %d ms\n", RF_SHM_TX_ABANDON_MS);
+      return SRSRAN_ERROR;
+    }
+    rf_shm_wake(&c->tx_futex, &c->tx_waiters);
+    sent += n;
+  }
+  return nsamples;
+}
+
+rf_dev_t srsran_rf_dev_shm = {"shm",
+                              rf_shm_devname,
+                              rf_shm_start_rx_stream,
+                              rf_shm_stop_rx_stream,
+                              rf_shm_flush_buffer,
+                              rf_shm_has_rssi,
+                              rf_shm_get_rssi,
+                              rf_shm_suppress_stdout,
+                              rf_shm_register_error_handler,
+                              rf_shm_open,
+                              rf_shm_open_multi,
+                              rf_shm_close,
+                              rf_shm_set_rx_srate,
+                              rf_shm_set_rx_gain,
+                              NULL,
+                              rf_shm_set_tx_gain,
+                              NULL,
+                              rf_shm_get_rx_gain,
+                              rf_shm_get_tx_gain,
+                              rf_shm_get_info,
+                              rf_shm_set_rx_freq,
+                              rf_shm_set_tx_srate,
+                              rf_shm_set_tx_freq,
+                              rf_shm_get_time,
+                              NULL,
+                              rf_shm_recv_with_time,
+                              rf_shm_recv_with_time_multi,
+                              rf_shm_send_timed,
+                              .srsran_rf_send_timed_multi = rf_shm_send_timed_multi};
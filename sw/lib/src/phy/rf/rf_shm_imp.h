@@ -0,0 +1,99 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_SHM_IMP_H_
+#define SRSRAN_RF_SHM_IMP_H_
+
+// Shared memory RF device, built into the RF library. It attaches to the streams shared by the process owning the
+// radio, which opened its RF plugin with shm_server=<name> (see rf_shm.h), so that several applications can use the
+// same radio. Every client receives the whole RX stream, with the HW timestamps and the time base of the server, and
+// queues TX bursts (channel 0) to the TX path of the server. The sampling rate, frequencies and gains belong to the
+// server. Device arguments:
+//   shm=<name>  name given to the server with shm_server=
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "srsran/config.h"
+#include "srsran/phy/rf/rf.h"
+#include "time.h"
+
+extern rf_dev_t srsran_rf_dev_shm;
+
+SRSRAN_API int rf_shm_open(char* args, void** handler);
+
+SRSRAN_API int rf_shm_open_multi(char* args, void** handler, uint32_t nof_channels);
+
+SRSRAN_API const char* rf_shm_devname(void* h);
+
+SRSRAN_API int rf_shm_close(void* h);
+
+SRSRAN_API int rf_shm_start_rx_stream(void* h, bool now);
+
+SRSRAN_API int rf_shm_stop_rx_stream(void* h);
+
+SRSRAN_API void rf_shm_flush_buffer(void* h);
+
+SRSRAN_API bool rf_shm_has_rssi(void* h);
+
+SRSRAN_API float rf_shm_get_rssi(void* h);
+
+SRSRAN_API void rf_shm_suppress_stdout(void* h);
+
+SRSRAN_API void rf_shm_register_error_handler(void* h, srsran_rf_error_handler_t error_handler, void* arg);
+
+SRSRAN_API double rf_shm_set_rx_srate(void* h, double freq);
+
+SRSRAN_API int rf_shm_set_rx_gain(void* h, double gain);
+
+SRSRAN_API double rf_shm_get_rx_gain(void* h);
+
+SRSRAN_API int rf_shm_set_tx_gain(void* h, double gain);
+
+SRSRAN_API double rf_shm_get_tx_gain(void* h);
+
+SRSRAN_API srsran_rf_info_t* rf_shm_get_info(void* h);
+
+SRSRAN_API double rf_shm_set_rx_freq(void* h, uint32_t ch, double freq);
+
+SRSRAN_API double rf_shm_set_tx_srate(void* h, double freq);
+
+SRSRAN_API double rf_shm_set_tx_freq(void* h, uint32_t ch, double freq);
+
+SRSRAN_API void rf_shm_get_time(void* h, time_t* secs, double* frac_secs);
+
+SRSRAN_API int
+rf_shm_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs);
+
+SRSRAN_API int
+rf_shm_recv_with_time_multi(void* h, void** data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs);
+
+SRSRAN_API int rf_shm_send_timed(void*  h,
+                                 void*  data,
+                                 int    nsamples,
+                                 time_t secs,
+                                 double frac_secs,
+                                 bool   has_time_spec,
+                                 bool   blocking,
+                                 bool   is_start_of_burst,
+                                 bool   is_end_of_burst);
+
+SRSRAN_API int rf_shm_send_timed_multi(void*  h,
+                                       void** data,
+                                       int    nsamples,
+                                       time_t secs,
+                                       double frac_secs,
+                                       bool   has_time_spec,
+                                       bool   blocking,
+                                       bool   is_start_of_burst,
+                                       bool   is_end_of_burst);
+
+#endif // SRSRAN_RF_SHM_IMP_H_
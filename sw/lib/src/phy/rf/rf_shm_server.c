@@ -0,0 +1,231 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rf_shm_server.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+static uint64_t monotonic_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void* shm_tx_thread(void* arg)
+{
+  rf_shm_server_t* s          = (rf_shm_server_t*)arg;
+  rf_shm_ctrl_t*   c          = s->ctrl;
+  uint64_t         tail       = c->tx_tail;
+  uint64_t         stalled_ms = 0; // since when the claimed slot at tail is waited for, 0 if it is not
+
+  while (s->running) {
+    uint32_t       val  = __atomic_load_n(&c->tx_futex, __ATOMIC_ACQUIRE);
+    rf_shm_slot_t* slot = (rf_shm_slot_t*)rf_shm_tx_slot(c, tail);
+    uint64_t       seq  = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq == tail + 1) {
+      // the samples are handed over straight from the slot, which is only released afterwards
+      uint32_t nof_samples = SRSRAN_MIN(slot->nof_samples, c->slot_samples);
+      s->tx(s->h, slot->tstamp, (const int16_t*)(slot + 1), nof_samples, (slot->flags & RF_SHM_FLAG_EOB) != 0);
+    } else if (__atomic_load_n(&c->tx_claim, __ATOMIC_ACQUIRE) <= tail) {
+      // nothing claimed
+      stalled_ms = 0;
+      rf_shm_wait(&c->tx_futex, &c->tx_waiters, val, RF_SHM_WAIT_MS);
+      continue;
+    } else if (!stalled_ms) {
+      stalled_ms = monotonic_ms();
+      continue;
+    } else if (monotonic_ms() - stalled_ms < RF_SHM_TX_ABANDON_MS ||
+               !__atomic_compare_exchange_n(
+                   &slot->seq, &seq, (tail + 1) | RF_SHM_SEQ_ABANDONED, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      // claimed and not committed yet, or committed right now
+      rf_shm_wait(&c->tx_futex, &c->tx_waiters, val, RF_SHM_WAIT_MS);
+      continue;
+    } else {
+      // the client died between the claim and the commit, the clients behind it must not wait forever
+      INFO("RF shm: TX slot %lu not committed after %d ms, skipped\n", (unsigned long)tail, RF_SHM_TX_ABANDON_MS);
+    }
+    stalled_ms = 0;
+    tail++;
+    __atomic_store_n(&c->tx_tail, tail, __ATOMIC_RELEASE);
+    rf_shm_wake(&c->tx_space_futex, &c->tx_space_waiters);
+  }
+  return NULL;
+}
+
+// True if name is shared by a server that is still running
+static bool segment_in_use(const char* name)
+{
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  bool        in_use = false;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(rf_shm_ctrl_t)) {
+    rf_shm_ctrl_t* c = (rf_shm_ctrl_t*)mmap(NULL, sizeof(rf_shm_ctrl_t), PROT_READ, MAP_SHARED, fd, 0);
+    if (c != MAP_FAILED) {
+      if (__atomic_load_n(&c->magic, __ATOMIC_ACQUIRE) == RF_SHM_MAGIC &&
+          __atomic_load_n(&c->alive, __ATOMIC_ACQUIRE)) {
+        // an older layout does not tell its owner, it is assumed to be running
+        in_use = c->version != RF_SHM_VERSION || kill(c->owner_pid, 0) == 0 || errno == EPERM;
+        if (in_use) {
+          ERROR("RF shm: %s is already shared by process %d\n",
+                name,
+                c->version == RF_SHM_VERSION ? c->owner_pid : -1);
+        }
+      }
+      munmap(c, sizeof(rf_shm_ctrl_t));
+    }
+  }
+  close(fd);
+  return in_use;
+}
+
+int rf_shm_server_init(rf_shm_server_t* s, const char* name, uint32_t nof_channels, void* h, rf_player_tx_t tx)
+{
+  bzero(s, sizeof(rf_shm_server_t));
+  snprintf(s->name, RF_SHM_NAME_LEN, "%s%s", name[0] == '/' ? "" : "/", name);
+  s->sample_size = 2 * sizeof(int16_t) * nof_channels;
+  s->h           = h;
+  s->tx          = tx;
+
+  uint32_t slot_size = sizeof(rf_shm_slot_t) + RF_SHM_SLOT_SAMPLES * s->sample_size;
+  slot_size          = (slot_size + 63) & ~63U;
+  size_t ctrl_size   = (sizeof(rf_shm_ctrl_t) + 4095) & ~(size_t)4095;
+  s->size            = ctrl_size + (size_t)(RF_SHM_RX_SLOTS + RF_SHM_TX_SLOTS) * slot_size;
+
+  // a stale segment left by a server that did not exit cleanly is replaced, a live one is left to its server
+  if (segment_in_use(s->name)) {
+    return SRSRAN_ERROR;
+  }
+  shm_unlink(s->name);
+  int fd = shm_open(s->name, O_CREAT | O_EXCL | O_RDWR, 0660);
+  if (fd < 0) {
+    ERROR("RF shm: could not create %s: %s\n", s->name, strerror(errno));
+    return SRSRAN_ERROR;
+  }
+  if (ftruncate(fd, (off_t)s->size) < 0) {
+    ERROR("RF shm: could not size %s: %s\n", s->name, strerror(errno));
+    close(fd);
+    shm_unlink(s->name);
+    return SRSRAN_ERROR;
+  }
+  void* map = mmap(NULL, s->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    ERROR("RF shm: could not map %s: %s\n", s->name, strerror(errno));
+    shm_unlink(s->name);
+    return SRSRAN_ERROR;
+  }
+
+  rf_shm_ctrl_t* c = (rf_shm_ctrl_t*)map;
+  c->version       = RF_SHM_VERSION;
+  c->nof_channels  = nof_channels;
+  c->rx_nof_slots  = RF_SHM_RX_SLOTS;
+  c->tx_nof_slots  = RF_SHM_TX_SLOTS;
+  c->slot_samples  = RF_SHM_SLOT_SAMPLES;
+  c->slot_size     = slot_size;
+  c->rx_offset     = ctrl_size;
+  c->tx_offset     = ctrl_size + (size_t)RF_SHM_RX_SLOTS * slot_size;
+  c->size          = s->size;
+  c->alive         = 1;
+  c->owner_pid     = (int32_t)getpid();
+  __atomic_store_n(&c->magic, RF_SHM_MAGIC, __ATOMIC_RELEASE);
+  s->ctrl = c;
+
+  s->running = true;
+  if (pthread_create(&s->thread, NULL, shm_tx_thread, s)) {
+    s->running = false;
+    rf_shm_server_free(s);
+    return SRSRAN_ERROR;
+  }
+  printf("RF shm: sharing the streams through %s, %u channels\n", s->name, nof_channels);
+  return SRSRAN_SUCCESS;
+}
+
+void rf_shm_server_free(rf_shm_server_t* s)
+{
+  if (!s->ctrl) {
+    return;
+  }
+  __atomic_store_n(&s->ctrl->alive, 0, __ATOMIC_RELEASE);
+  rf_shm_wake(&s->ctrl->rx_futex, &s->ctrl->rx_waiters);
+  rf_shm_wake(&s->ctrl->tx_space_futex, &s->ctrl->tx_space_waiters);
+  if (s->thread) {
+    s->running = false;
+    pthread_join(s->thread, NULL);
+    s->thread = 0;
+  }
+  munmap(s->ctrl, s->size);
+  s->ctrl = NULL;
+  shm_unlink(s->name);
+}
+
+void rf_shm_server_push_rx(rf_shm_server_t* s,
+                           uint64_t         tstamp,
+                           const void*      samples,
+                           uint32_t         nof_samples,
+                           bool             end_of_burst)
+{
+  rf_shm_ctrl_t* c    = s->ctrl;
+  const uint8_t* src  = (const uint8_t*)samples;
+  uint64_t       head = c->rx_head;
+
+  // an end of burst without samples still takes a slot, for the clients to return their partial read
+  do {
+    uint32_t       n    = SRSRAN_MIN(nof_samples, c->slot_samples);
+    rf_shm_slot_t* slot = (rf_shm_slot_t*)rf_shm_rx_slot(c, head);
+
+    __atomic_store_n(&slot->seq, 2 * head + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->tstamp      = tstamp;
+    slot->nof_samples = n;
+    slot->flags       = (end_of_burst && n == nof_samples) ? RF_SHM_FLAG_EOB : 0;
+    memcpy(slot + 1, src, (size_t)n * s->sample_size);
+    __atomic_store_n(&slot->seq, 2 * head + 2, __ATOMIC_RELEASE);
+
+    head++;
+    __atomic_store_n(&c->rx_head, head, __ATOMIC_RELEASE);
+    src += (size_t)n * s->sample_size;
+    tstamp += n;
+    nof_samples -= n;
+  } while (nof_samples > 0);
+  rf_shm_wake(&c->rx_futex, &c->rx_waiters);
+}
+
+void rf_shm_server_set_time(rf_shm_server_t* s,
+                            double           srate,
+                            uint64_t         tstamp_base,
+                            int64_t          time_base_secs,
+                            double           time_base_frac)
+{
+  rf_shm_ctrl_t* c = s->ctrl;
+  __atomic_store_n(&c->time_seq, c->time_seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  c->time.srate          = srate;
+  c->time.tstamp_base    = tstamp_base;
+  c->time.time_base_secs = time_base_secs;
+  c->time.time_base_frac = time_base_frac;
+  __atomic_store_n(&c->time_seq, c->time_seq + 1, __ATOMIC_RELEASE);
+}
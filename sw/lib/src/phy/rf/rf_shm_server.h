@@ -0,0 +1,66 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_SHM_SERVER_H_
+#define SRSRAN_RF_SHM_SERVER_H_
+
+// Server side of the shared memory streams (see rf_shm.h), enabled in the RF plugins with the shm_server=<name> device
+// argument. The reader thread publishes every RX packet next to the ring write; a thread drains the TX submission queue
+// filled by the clients into the TX path of the plugin.
+
+#include "rf_player.h"
+#include "rf_shm.h"
+#include "srsran/config.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RF_SHM_NAME_LEN 64
+
+typedef struct {
+  rf_shm_ctrl_t* ctrl;
+  size_t         size;
+  char           name[RF_SHM_NAME_LEN];
+  uint32_t       sample_size; // bytes per sample time, all channels
+  void*          h;
+  rf_player_tx_t tx;
+  volatile bool  running;
+  pthread_t      thread;
+} rf_shm_server_t;
+
+// Creates the shared memory /name (the leading slash is optional) and starts the TX thread, which hands the packets of
+// the clients to tx(h, ...)
+SRSRAN_API int
+rf_shm_server_init(rf_shm_server_t* s, const char* name, uint32_t nof_channels, void* h, rf_player_tx_t tx);
+
+// Stops the TX thread and removes the shared memory. Attached clients see the server going away.
+SRSRAN_API void rf_shm_server_free(rf_shm_server_t* s);
+
+static inline bool rf_shm_server_enabled(const rf_shm_server_t* s)
+{
+  return s->ctrl != NULL;
+}
+
+// Reader thread only. Publishes nof_samples native samples received at tstamp, end_of_burst closes a finite capture.
+SRSRAN_API void rf_shm_server_push_rx(rf_shm_server_t* s,
+                                      uint64_t         tstamp,
+                                      const void*      samples,
+                                      uint32_t         nof_samples,
+                                      bool             end_of_burst);
+
+// Publishes the time base of the HW timestamps, on start and on every sampling rate change
+SRSRAN_API void rf_shm_server_set_time(rf_shm_server_t* s,
+                                       double           srate,
+                                       uint64_t         tstamp_base,
+                                       int64_t          time_base_secs,
+                                       double           time_base_frac);
+
+#endif // SRSRAN_RF_SHM_SERVER_H_
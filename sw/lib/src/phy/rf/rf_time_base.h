@@ -0,0 +1,58 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_TIME_BASE_H_
+#define SRSRAN_RF_TIME_BASE_H_
+
+// Time base of the HW timestamps published by the servers to the shm and udp clients, same scheme as the plugins: the
+// timestamps count samples at srate from tstamp_base, which is the tick at which the current sampling rate took effect.
+
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef struct {
+  double   srate;
+  uint64_t tstamp_base;
+  int64_t  time_base_secs; // time corresponding to tstamp_base
+  double   time_base_frac;
+} rf_time_base_t;
+
+static inline void rf_time_base_to_time(const rf_time_base_t* c, uint64_t tstamp, time_t* secs, double* frac_secs)
+{
+  uint64_t srate_int = (uint64_t)c->srate;
+  uint64_t ticks     = (tstamp > c->tstamp_base) ? tstamp - c->tstamp_base : 0;
+  if (secs && frac_secs && srate_int) {
+    *secs      = (time_t)c->time_base_secs + ticks / srate_int;
+    *frac_secs = c->time_base_frac + (double)(ticks % srate_int) / srate_int;
+    if (*frac_secs >= 1.0) {
+      *frac_secs -= 1.0;
+      (*secs)++;
+    }
+  }
+}
+
+static inline uint64_t rf_time_base_to_tstamp(const rf_time_base_t* c, time_t secs, double frac_secs)
+{
+  secs -= (time_t)c->time_base_secs;
+  frac_secs -= c->time_base_frac;
+  if (frac_secs < 0) {
+    frac_secs += 1.0;
+    secs--;
+  }
+  // times before the last rate switch have no tick at the current rate, they map to the switch itself
+  if (secs < 0) {
+    return c->tstamp_base;
+  }
+  return c->tstamp_base + (uint64_t)(c->srate * ((double)secs)) + (uint64_t)(round(c->srate * frac_secs));
+}
+
+#endif // SRSRAN_RF_TIME_BASE_H_
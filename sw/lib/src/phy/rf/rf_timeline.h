@@ -0,0 +1,94 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_TIMELINE_H_
+#define SRSRAN_RF_TIMELINE_H_
+
+// Continuity of the RX timeline handed to the application, shared by the RF plugins. The reader thread checks every
+// packet it writes to the ring buffer against the tick following the previous one: DMA buffers skipped by the FPGA or
+// packets dropped on a full ring buffer show up as gaps, a timestamp going backwards as an overlap. Gaps are reported,
+// except for the samples of dropped packets which were already reported as overflows, and, with
+// rx_zero_fill=<max gap in samples>, filled with zeros so that the samples keep a sample-accurate timeline;
+// overlapping samples are dropped. Only accessed by the reader thread, which resets it whenever the timeline restarts
+// on purpose (stream start, stream command, sampling rate switch).
+
+#include "srsran/config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  bool     valid;     // next_tick holds the tick expected for the next packet
+  uint64_t next_tick;
+  uint64_t reported_end; // end of the last packet dropped on a full ring buffer, its samples need no gap report
+  uint32_t max_fill;  // longest gap filled with zeros, 0 if gaps are only reported
+  uint64_t nof_gaps;  // counters since the device was opened
+  uint64_t nof_lost;  // samples missing from the timeline, including the zero-filled ones
+  uint64_t nof_filled;
+  uint64_t nof_overlaps;
+} rf_timeline_t;
+
+static inline void rf_timeline_init(rf_timeline_t* t, uint32_t max_fill)
+{
+  t->valid        = false;
+  t->next_tick    = 0;
+  t->reported_end = 0;
+  t->max_fill     = max_fill;
+  t->nof_gaps     = 0;
+  t->nof_lost     = 0;
+  t->nof_filled   = 0;
+  t->nof_overlaps = 0;
+}
+
+static inline void rf_timeline_reset(rf_timeline_t* t)
+{
+  t->valid        = false;
+  t->reported_end = 0;
+}
+
+// Samples missing before a packet about to be written (> 0), or samples at its start already delivered (< 0)
+static inline int64_t rf_timeline_check(const rf_timeline_t* t, uint64_t tstamp)
+{
+  return t->valid ? (int64_t)(tstamp - t->next_tick) : 0;
+}
+
+// Samples of a gap of diff samples before tstamp left to report, those of dropped packets were reported already
+static inline uint64_t rf_timeline_unreported(const rf_timeline_t* t, uint64_t tstamp, int64_t diff)
+{
+  uint64_t start = tstamp - (uint64_t)diff;
+  if (t->reported_end <= start) {
+    return (uint64_t)diff;
+  }
+  return (t->reported_end < tstamp) ? tstamp - t->reported_end : 0;
+}
+
+// Records a packet dropped whole on a full ring buffer and reported as an overflow, the timeline is not advanced so
+// that the next packet still zero-fills the missing samples
+static inline void rf_timeline_drop(rf_timeline_t* t, uint64_t tstamp, uint32_t nof)
+{
+  t->reported_end = tstamp + nof;
+}
+
+// Records a packet written after the diff returned by rf_timeline_check(), fill zeros included
+static inline void rf_timeline_advance(rf_timeline_t* t, int64_t diff, uint32_t fill, uint64_t tstamp, uint32_t nof)
+{
+  if (diff > 0) {
+    t->nof_gaps++;
+    t->nof_lost += (uint64_t)diff;
+    t->nof_filled += fill;
+  } else if (diff < 0) {
+    t->nof_overlaps++;
+  }
+  t->valid        = true;
+  t->next_tick    = tstamp + nof;
+  t->reported_end = 0;
+}
+
+#endif // SRSRAN_RF_TIMELINE_H_
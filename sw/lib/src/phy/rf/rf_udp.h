@@ -0,0 +1,123 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_UDP_H_
+#define SRSRAN_RF_UDP_H_
+
+// Wire format of the timestamped UDP streams between the process owning the radio on the board (the server, any
+// application opening the IIO plugin with udp_server=<port>) and a host (the udp device, rf_udp_imp.c).
+//
+// Every datagram starts with the same header as the packets of the ring buffers (timestamp, number of samples, end of
+// burst), preceded by a sequence number counting the data datagrams of each direction, so that the receiver detects
+// the lost ones without any retransmission. The host subscribes to the RX stream, which the server sends as native
+// sc16 samples straight from the DMA buffers, and sends its TX bursts the same way, with every channel of the server
+// interleaved. The time base of the HW timestamps, which gives the number of channels of the server, is sent on
+// subscription, on every sampling rate change and periodically.
+//
+// To save link bandwidth, the host may ask for the RX stream in block floating point (srsran/phy/utils/bfp.h) by giving
+// a mantissa width in the flags of its subscription. The server acknowledges it in the time base datagrams and then
+// sends every RX datagram compressed with that width, which the flags of each datagram repeat.
+//
+// The headers, the time base and the samples go on the wire little-endian, the byte order of the Zynq boards and of
+// the x86 and ARM hosts, so that both ends use them in place without any conversion. Big-endian hosts are refused at
+// build time rather than receiving a garbled stream.
+
+#include "rf_time_base.h"
+#include "srsran/config.h"
+#include "srsran/phy/utils/bfp.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "the RF UDP wire format is little-endian"
+#endif
+
+#define RF_UDP_MAGIC 0x53525544 // "SRUD"
+#define RF_UDP_VERSION 1
+#define RF_UDP_DEFAULT_PORT 5260
+#define RF_UDP_DEFAULT_PAYLOAD 1472 // bytes of a datagram, header included, fits a 1500 bytes MTU
+#define RF_UDP_MAX_PAYLOAD 8972     // jumbo frames
+#define RF_UDP_BATCH 32             // datagrams sent or received by one system call
+#define RF_UDP_TIME_PERIOD_MS 1000
+#define RF_UDP_FLAG_EOB 1
+#define RF_UDP_FLAG_BFP_SHIFT 8 // bits 8-15: BFP mantissa width, 0 for native sc16 samples
+#define RF_UDP_FLAG_BFP_MASK (0xffU << RF_UDP_FLAG_BFP_SHIFT)
+
+typedef enum {
+  RF_UDP_SUBSCRIBE = 0, // host -> server, starts the RX stream to the sender address
+  RF_UDP_UNSUBSCRIBE,   // host -> server
+  RF_UDP_TIME,          // server -> host, rf_time_base_t payload
+  RF_UDP_RX_DATA,       // server -> host
+  RF_UDP_TX_DATA,       // host -> server
+} rf_udp_type_t;
+
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t type;
+  uint32_t seq; // data datagrams of the direction
+  uint32_t nof_samples;
+  uint64_t timestamp; // HW tick of the first sample, 0 for untimed TX
+  uint32_t flags;
+  uint32_t nof_channels; // interleaved in the payload
+} rf_udp_header_t;
+
+static inline void rf_udp_header_init(rf_udp_header_t* hdr, rf_udp_type_t type, uint32_t nof_channels)
+{
+  hdr->magic        = RF_UDP_MAGIC;
+  hdr->version      = RF_UDP_VERSION;
+  hdr->type         = (uint16_t)type;
+  hdr->seq          = 0;
+  hdr->nof_samples  = 0;
+  hdr->timestamp    = 0;
+  hdr->flags        = 0;
+  hdr->nof_channels = nof_channels;
+}
+
+static inline uint32_t rf_udp_bfp_width(uint32_t flags)
+{
+  return (flags & RF_UDP_FLAG_BFP_MASK) >> RF_UDP_FLAG_BFP_SHIFT;
+}
+
+static inline uint32_t rf_udp_bfp_flags(uint32_t width)
+{
+  return (width << RF_UDP_FLAG_BFP_SHIFT) & RF_UDP_FLAG_BFP_MASK;
+}
+
+// Bytes of the samples following the header, computed wide enough for any header received
+static inline uint64_t rf_udp_payload_size(const rf_udp_header_t* hdr)
+{
+  uint64_t nof_pairs = (uint64_t)hdr->nof_samples * hdr->nof_channels;
+  uint32_t width     = rf_udp_bfp_width(hdr->flags);
+  if (width) {
+    return (nof_pairs + SRSRAN_BFP_BLOCK_LEN - 1) / SRSRAN_BFP_BLOCK_LEN * srsran_bfp_block_size(width);
+  }
+  return nof_pairs * 2 * sizeof(int16_t);
+}
+
+static inline bool rf_udp_header_valid(const rf_udp_header_t* hdr, size_t len)
+{
+  uint32_t width = len >= sizeof(rf_udp_header_t) ? rf_udp_bfp_width(hdr->flags) : 0;
+  return len >= sizeof(rf_udp_header_t) && hdr->magic == RF_UDP_MAGIC && hdr->version == RF_UDP_VERSION &&
+         (width == 0 || srsran_bfp_width_valid(width)) && len >= sizeof(rf_udp_header_t) + rf_udp_payload_size(hdr);
+}
+
+// Samples of every channel carried by a datagram of payload bytes, compressed with width bits mantissas if not 0
+static inline uint32_t rf_udp_max_samples(uint32_t payload, uint32_t nof_channels, uint32_t width)
+{
+  uint32_t size = payload - (uint32_t)sizeof(rf_udp_header_t);
+  if (width) {
+    return srsran_bfp_max_pairs(width, size) / nof_channels;
+  }
+  return size / (2 * sizeof(int16_t) * nof_channels);
+}
+
+#endif // SRSRAN_RF_UDP_H_
@@ -0,0 +1,603 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <netdb.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "rf_helper.h"
+#include "rf_udp.h"
+#include "rf_udp_imp.h"
+#include "srsran/phy/common/phy_common.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+#define RF_UDP_DEFAULT_RCVBUF (32 * 1024 * 1024)
+#define RF_UDP_RCV_TIMEOUT_MS 100
+#define RF_UDP_OPEN_TIMEOUT_MS 2000
+#define RF_UDP_RX_TIMEOUT_MS 2000 // a read without any datagram for this long fails
+
+typedef struct {
+  int           fd;
+  uint32_t      nof_channels;        // channels used by the application
+  uint32_t      server_nof_channels; // channels interleaved in the RX datagrams
+  uint32_t      tx_max_samples;      // per TX datagram
+  float*        tx_zeros;            // samples of the server channels not opened, tx_max_samples long
+  uint32_t      bfp_width;           // BFP mantissa width asked for the RX stream, 0 for native samples
+  uint32_t      server_bfp_width;    // the one acknowledged by the server
+  rf_time_base_t time;
+
+  // RX batch, datagram rx_idx of rx_count is read from sample rx_offset
+  uint8_t*       rx_buffers;
+  struct iovec   rx_iov[RF_UDP_BATCH];
+  struct mmsghdr rx_msgs[RF_UDP_BATCH];
+  uint32_t       rx_count;
+  uint32_t       rx_idx;
+  uint32_t       rx_offset;
+  const int16_t* rx_samples;  // of the datagram being read, expanded to rx_unpacked if compressed
+  int16_t*       rx_unpacked;
+  bool           rx_seq_valid;
+  uint32_t       rx_seq; // next expected
+  uint64_t       nof_rx_lost;
+  uint64_t       rx_tstamp; // tick following the last sample received
+
+  // TX batch
+  uint8_t*       tx_buffers;
+  struct iovec   tx_iov[RF_UDP_BATCH];
+  struct mmsghdr tx_msgs[RF_UDP_BATCH];
+  uint32_t       tx_seq;
+
+  double                    rx_gain;
+  double                    tx_gain;
+  double                    rx_freq;
+  double                    tx_freq;
+  srsran_rf_info_t          info;
+  srsran_rf_error_handler_t error_handler;
+  void*                     error_handler_arg;
+} rf_udp_handler_t;
+
+static void log_overflow(rf_udp_handler_t* h)
+{
+  if (h->error_handler) {
+    srsran_rf_error_t error;
+    bzero(&error, sizeof(srsran_rf_error_t));
+    error.type = SRSRAN_RF_ERROR_OVERFLOW;
+    h->error_handler(h->error_handler_arg, error);
+  }
+}
+
+static void send_control(rf_udp_handler_t* handler, rf_udp_type_t type)
+{
+  rf_udp_header_t hdr;
+  rf_udp_header_init(&hdr, type, handler->nof_channels);
+  if (type == RF_UDP_SUBSCRIBE) {
+    hdr.flags = rf_udp_bfp_flags(handler->bfp_width);
+  }
+  send(handler->fd, &hdr, sizeof(hdr), 0);
+}
+
+static void update_time(rf_udp_handler_t* handler, const rf_udp_header_t* hdr, size_t len)
+{
+  if (len >= sizeof(rf_udp_header_t) + sizeof(rf_time_base_t)) {
+    memcpy(&handler->time, hdr + 1, sizeof(rf_time_base_t));
+    handler->server_nof_channels = hdr->nof_channels;
+    handler->server_bfp_width    = rf_udp_bfp_width(hdr->flags);
+  }
+}
+
+static rf_udp_header_t* rx_datagram_at(rf_udp_handler_t* handler, uint32_t idx)
+{
+  return (rf_udp_header_t*)&handler->rx_buffers[(size_t)idx * RF_UDP_MAX_PAYLOAD];
+}
+
+// Returns the RX data datagram being read, receiving a new batch when the current one is consumed. The time base
+// datagrams are applied on the way. Returns NULL if nothing arrived within the socket timeout.
+static rf_udp_header_t* rx_datagram(rf_udp_handler_t* handler)
+{
+  while (true) {
+    if (handler->rx_idx >= handler->rx_count) {
+      int n = recvmmsg(handler->fd, handler->rx_msgs, RF_UDP_BATCH, MSG_WAITFORONE, NULL);
+      if (n <= 0) {
+        return NULL;
+      }
+      handler->rx_count  = (uint32_t)n;
+      handler->rx_idx    = 0;
+      handler->rx_offset = 0;
+    }
+    rf_udp_header_t* hdr = rx_datagram_at(handler, handler->rx_idx);
+    size_t           len = handler->rx_msgs[handler->rx_idx].msg_len;
+    if (rf_udp_header_valid(hdr, len) && hdr->type == RF_UDP_TIME) {
+      update_time(handler, hdr, len);
+    }
+    if (!rf_udp_header_valid(hdr, len) || hdr->type != RF_UDP_RX_DATA ||
+        hdr->nof_channels != handler->server_nof_channels) {
+      handler->rx_idx++;
+      continue;
+    }
+    if (handler->rx_offset == 0) {
+      // first look at this datagram
+      if (handler->rx_seq_valid && hdr->seq != handler->rx_seq) {
+        uint32_t lost = hdr->seq - handler->rx_seq;
+        handler->nof_rx_lost += lost;
+        INFO("RF_UDP: %u RX datagrams lost\n", lost);
+        log_overflow(handler);
+      }
+      handler->rx_seq       = hdr->seq + 1;
+      handler->rx_seq_valid = true;
+
+      uint32_t width      = rf_udp_bfp_width(hdr->flags);
+      handler->rx_samples = (const int16_t*)(hdr + 1);
+      if (width) {
+        srsran_bfp_decompress(
+            (const uint8_t*)(hdr + 1), width, handler->rx_unpacked, hdr->nof_samples * hdr->nof_channels);
+        handler->rx_samples = handler->rx_unpacked;
+      }
+    }
+    return hdr;
+  }
+}
+
+int rf_udp_open(char* args, void** h)
+{
+  return rf_udp_open_multi(args, h, 1);
+}
+
+int rf_udp_open_multi(char* args, void** h, uint32_t nof_channels)
+{
+  *h = NULL;
+
+  char     host[RF_PARAM_LEN] = "";
+  uint32_t payload            = RF_UDP_DEFAULT_PAYLOAD;
+  uint32_t rcvbuf             = RF_UDP_DEFAULT_RCVBUF;
+  uint32_t bfp_width          = 0;
+  parse_string(args, "udp", 0, host);
+  parse_uint32(args, "udp_payload", 0, &payload);
+  parse_uint32(args, "udp_rcvbuf", 0, &rcvbuf);
+  parse_uint32(args, "udp_bfp", 0, &bfp_width);
+  if (host[0] == '\0') {
+    fprintf(stderr, "RF_UDP: no udp= argument given\n");
+    return SRSRAN_ERROR;
+  }
+  if (nof_channels == 0) {
+    nof_channels = 1;
+  }
+  if (nof_channels > SRSRAN_MAX_CHANNELS || payload > RF_UDP_MAX_PAYLOAD || rf_udp_max_samples(payload, 1, 0) == 0 ||
+      (bfp_width && !srsran_bfp_width_valid(bfp_width))) {
+    fprintf(stderr,
+            "RF_UDP: invalid arguments (nof_channels=%u, udp_payload=%u, udp_bfp=%u)\n",
+            nof_channels,
+            payload,
+            bfp_width);
+    return SRSRAN_ERROR;
+  }
+  char  port[16] = "";
+  char* sep      = strrchr(host, ':');
+  snprintf(port, sizeof(port), "%s", sep ? sep + 1 : "");
+  if (sep) {
+    *sep = '\0';
+  } else {
+    snprintf(port, sizeof(port), "%d", RF_UDP_DEFAULT_PORT);
+  }
+
+  struct addrinfo  hints = {.ai_family = AF_INET, .ai_socktype = SOCK_DGRAM};
+  struct addrinfo* res   = NULL;
+  if (getaddrinfo(host, port, &hints, &res) != 0 || !res) {
+    fprintf(stderr, "RF_UDP: could not resolve %s:%s\n", host, port);
+    return SRSRAN_ERROR;
+  }
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0 || connect(fd, res->ai_addr, res->ai_addrlen) < 0) {
+    fprintf(stderr, "RF_UDP: could not connect to %s:%s: %s\n", host, port, strerror(errno));
+    freeaddrinfo(res);
+    if (fd >= 0) {
+      close(fd);
+    }
+    return SRSRAN_ERROR;
+  }
+  freeaddrinfo(res);
+
+  // bursts of datagrams arrive faster than a busy application reads them, the socket buffer absorbs them
+  int       size     = (int)rcvbuf;
+  socklen_t size_len = sizeof(size);
+  if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0) {
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+  }
+  getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, &size_len);
+  if ((uint32_t)size / 2 < rcvbuf) {
+    // the kernel reports twice the size it was given
+    printf("RF_UDP: receive buffer limited to %d bytes, raise net.core.rmem_max\n", size / 2);
+  }
+  struct timeval timeout = {0, RF_UDP_RCV_TIMEOUT_MS * 1000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  rf_udp_handler_t* handler = calloc(1, sizeof(rf_udp_handler_t));
+  if (!handler) {
+    close(fd);
+    return SRSRAN_ERROR;
+  }
+  handler->fd             = fd;
+  handler->nof_channels   = nof_channels;
+  handler->bfp_width      = bfp_width;
+  handler->rx_buffers     = srsran_vec_malloc(RF_UDP_BATCH * RF_UDP_MAX_PAYLOAD);
+  handler->tx_buffers     = srsran_vec_malloc(RF_UDP_BATCH * RF_UDP_MAX_PAYLOAD);
+  // the most samples a compressed datagram may carry
+  handler->rx_unpacked = srsran_vec_i16_malloc(2 * srsran_bfp_max_pairs(SRSRAN_BFP_MIN_WIDTH, RF_UDP_MAX_PAYLOAD));
+  if (!handler->rx_buffers || !handler->tx_buffers || !handler->rx_unpacked) {
+    rf_udp_close(handler);
+    return SRSRAN_ERROR;
+  }
+  for (uint32_t i = 0; i < RF_UDP_BATCH; i++) {
+    handler->rx_iov[i].iov_base            = rx_datagram_at(handler, i);
+    handler->rx_iov[i].iov_len             = RF_UDP_MAX_PAYLOAD;
+    handler->rx_msgs[i].msg_hdr.msg_iov    = &handler->rx_iov[i];
+    handler->rx_msgs[i].msg_hdr.msg_iovlen = 1;
+    handler->tx_iov[i].iov_base            = &handler->tx_buffers[(size_t)i * RF_UDP_MAX_PAYLOAD];
+    handler->tx_msgs[i].msg_hdr.msg_iov    = &handler->tx_iov[i];
+    handler->tx_msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  // the server answers the subscription with the time base, the subscription is repeated in case either got lost
+  for (int waited = 0; waited < RF_UDP_OPEN_TIMEOUT_MS && !handler->server_nof_channels;
+       waited += RF_UDP_RCV_TIMEOUT_MS) {
+    if (waited % 500 == 0) {
+      send_control(handler, RF_UDP_SUBSCRIBE);
+    }
+    ssize_t len = recv(fd, handler->rx_buffers, RF_UDP_MAX_PAYLOAD, 0);
+    if (len > 0 && rf_udp_header_valid((rf_udp_header_t*)handler->rx_buffers, (size_t)len) &&
+        ((rf_udp_header_t*)handler->rx_buffers)->type == RF_UDP_TIME) {
+      update_time(handler, (rf_udp_header_t*)handler->rx_buffers, (size_t)len);
+    }
+  }
+  if (!handler->server_nof_channels) {
+    fprintf(stderr, "RF_UDP: no answer from %s:%s, is the server running?\n", host, port);
+    rf_udp_close(handler);
+    return SRSRAN_ERROR;
+  }
+  if (nof_channels > handler->server_nof_channels || handler->server_nof_channels > SRSRAN_MAX_CHANNELS) {
+    fprintf(stderr,
+            "RF_UDP: the server streams %u channels, %u requested\n",
+            handler->server_nof_channels,
+            nof_channels);
+    rf_udp_close(handler);
+    return SRSRAN_ERROR;
+  }
+  // the TX datagrams carry every channel of the server, those the application did not open are zero
+  handler->tx_max_samples = rf_udp_max_samples(payload, handler->server_nof_channels, 0);
+  handler->tx_zeros       = srsran_vec_f_malloc(2 * handler->tx_max_samples);
+  if (!handler->tx_max_samples || !handler->tx_zeros) {
+    fprintf(stderr, "RF_UDP: udp_payload=%u is too small for %u channels\n", payload, handler->server_nof_channels);
+    rf_udp_close(handler);
+    return SRSRAN_ERROR;
+  }
+  srsran_vec_f_zero(handler->tx_zeros, 2 * handler->tx_max_samples);
+  if (bfp_width && handler->server_bfp_width != bfp_width) {
+    printf("RF_UDP: the server does not compress with %u bits, receiving sc16 samples\n", bfp_width);
+  }
+
+  handler->info.min_rx_gain = 0.0;
+  handler->info.max_rx_gain = 90.0;
+  handler->info.min_tx_gain = 0.0;
+  handler->info.max_tx_gain = 90.0;
+  *h                        = handler;
+  printf("RF_UDP: streaming from %s:%s, %u of %u channels\n", host, port, nof_channels, handler->server_nof_channels);
+  return SRSRAN_SUCCESS;
+}
+
+const char* rf_udp_devname(void* h)
+{
+  return "udp";
+}
+
+int rf_udp_close(void* h)
+{
+  rf_udp_handler_t* handler = (rf_udp_handler_t*)h;
+  if (!handler) {
+    return SRSRAN_ERROR;
+  }
+  send_control(handler, RF_UDP_UNSUBSCRIBE);
+  if (handler->nof_rx_lost) {
+    printf("RF_UDP: %lu RX datagrams lost\n", (unsigned long)handler->nof_rx_lost);
+  }
+  close(handler->fd);
+  free(handler->rx_buffers);
+  free(handler->tx_buffers);
+  free(handler->tx_zeros);
+  free(handler->rx_unpacked);
+  free(handler);
+  return SRSRAN_SUCCESS;
+}
+
+int rf_udp_start_rx_stream(void* h, bool now)
+{
+  rf_udp_handler_t* handler = (rf_udp_handler_t*)h;
+  // the stream runs in the server, a late start is not a loss
+  handler->rx_seq_valid = false;
+  send_control(handler, RF_UDP_SUBSCRIBE);
+  return SRSRAN_SUCCESS;
+}
+
+int rf_udp_stop_rx_stream(void* h)
+{
+  return SRSRAN_SUCCESS;
+}
+
+void rf_udp_flush_buffer(void* h)
+{
+  rf_udp_handler_t* handler = (rf_udp_handler_t*)h;
+  // drops the datagrams already received
+  handler->rx_idx = handler->rx_count;
+  while (recv(handler->fd, handler->rx_buffers, RF_UDP_MAX_PAYLOAD, MSG_DONTWAIT) > 0) {
+  }
+  handler->rx_seq_valid = false;
+}
+
+bool rf_udp_has_rssi(void* h)
+{
+  return false;
+}
+
+float rf_udp_get_rssi(void* h)
+{
+  return 0.0f;
+}
+
+void rf_udp_suppress_stdout(void* h)
+{
+  // do nothing
+}
+
+void rf_udp_register_error_handler(void* h, srsran_rf_error_handler_t error_handler, void* arg)
+{
+  rf_udp_handler_t* handler  = (rf_udp_handler_t*)h;
+  handler->error_handler     = error_handler;
+  handler->error_handler_arg = arg;
+}
+
+double rf_udp_set_rx_srate(void* h, double freq)
+{
+  rf_udp_handler_t* handler = (rf_udp_handler_t*)h;
+  if (handler->time.srate == 0) {
+    // the server has not started streaming yet
+    return freq;
+  }
+  if (fabs(freq - handler->time.srate) > 1.0) {
+    printf("RF_UDP: the server runs at %.2f MHz, ignoring %.2f MHz\n", handler->time.srate / 1e6, freq / 1e6);
+  }
+  return handler->time.srate;
+}
+
+double rf_udp_set_tx_srate(void* h, double freq)
+{
+  // RX and TX share the timeline of the server
+  return rf_udp_set_rx_srate(h, freq);
+}
+
+int rf_udp_set_rx_gain(void* h, double gain)
+{
+  rf_udp_handler_t* handler = (rf_udp_handler_t*)h;
+  handler->rx_gain          = gain;
+  return SRSRAN_SUCCESS;
+}
+
+int rf_udp_set_tx_gain(void* h, double gain)
+{
+  rf_udp_handler_t* handler = (rf_udp_handler_t*)h;
+  handler->tx_gain          = gain;
+  return SRSRAN_SUCCESS;
+}
+
+double rf_udp_get_rx_gain(void* h)
+{
+  return ((rf_udp_handler_t*)h)->rx_gain;
+}
+
+double rf_udp_get_tx_gain(void* h)
+{
+  return ((rf_udp_handler_t*)h)->tx_gain;
+}
+
+srsran_rf_info_t* rf_udp_get_info(void* h)
+{
+  return &((rf_udp_handler_t*)h)->info;
+}
+
+double rf_udp_set_rx_freq(void* h, uint32_t ch, double freq)
+{
+  rf_udp_handler_t* handler = (rf_udp_handler_t*)h;
+  handler->rx_freq          = freq;
+  return freq;
+}
+
+double rf_udp_set_tx_freq(void* h, uint32_t ch, double freq)
+{
+  rf_udp_handler_t* handler = (rf_udp_handler_t*)h;
+  handler->tx_freq          = freq;
+  return freq;
+}
+
+void rf_udp_get_time(void* h, time_t* secs, double* frac_secs)
+{
+  rf_udp_handler_t* handler = (rf_udp_handler_t*)h;
+  rf_time_base_to_time(&handler->time, handler->rx_tstamp, secs, frac_secs);
+}
+
+int rf_udp_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  return rf_udp_recv_with_time_multi(h, &data, nsamples, blocking, secs, frac_secs);
+}
+
+int rf_udp_recv_with_time_multi(void* h, void** data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  rf_udp_handler_t* handler = (rf_udp_handler_t*)h;
+  uint32_t          stride  = handler->server_nof_channels;
+
+  // like the live devices, a read may span a gap, the timestamp is the one of the first sample
+  uint64_t tstamp = 0;
+  uint32_t total  = 0;
+  int      idle   = 0;
+  bool     eob    = false;
+  while (total < nsamples) {
+    rf_udp_header_t* hdr = rx_datagram(handler);
+    if (!hdr) {
+      idle += RF_UDP_RCV_TIMEOUT_MS;
+      if (idle >= RF_UDP_RX_TIMEOUT_MS) {
+        break;
+      }
+      continue;
+    }
+    idle = 0;
+
+    // the samples are converted straight from the datagram
+    uint32_t       n   = SRSRAN_MIN(nsamples - total, hdr->nof_samples - handler->rx_offset);
+    const int16_t* src = handler->rx_samples + 2 * (size_t)handler->rx_offset * stride;
+    for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+      float* dst = data[ch] ? (float*)data[ch] + 2 * total : NULL;
+      if (!dst) {
+        continue;
+      }
+      if (stride == 1) {
+        srsran_vec_convert_if(src, 32768, dst, 2 * n);
+      } else {
+        for (uint32_t i = 0; i < n; i++) {
+          dst[2 * i]     = (float)src[2 * (i * stride + ch)] / 32768;
+          dst[2 * i + 1] = (float)src[2 * (i * stride + ch) + 1] / 32768;
+        }
+      }
+    }
+    if (!total) {
+      tstamp = hdr->timestamp + handler->rx_offset;
+    }
+    total += n;
+    handler->rx_offset += n;
+    handler->rx_tstamp = hdr->timestamp + handler->rx_offset;
+    if (handler->rx_offset >= hdr->nof_samples) {
+      handler->rx_idx++;
+      handler->rx_offset = 0;
+      if (hdr->flags & RF_UDP_FLAG_EOB) {
+        // end of a finite capture, the application gets what was received
+        eob = true;
+        break;
+      }
+    }
+  }
+  if (!total) {
+    // a capture ending right at the previous read only leaves its empty end of burst, as on the shm device
+    return eob ? 0 : SRSRAN_ERROR;
+  }
+  rf_time_base_to_time(&handler->time, tstamp, secs, frac_secs);
+  return (int)total;
+}
+
+int rf_udp_send_timed(void*  h,
+                      void*  data,
+                      int    nsamples,
+                      time_t secs,
+                      double frac_secs,
+                      bool   has_time_spec,
+                      bool   blocking,
+                      bool   is_start_of_burst,
+                      bool   is_end_of_burst)
+{
+  void* _data[SRSRAN_MAX_CHANNELS] = {data};
+  return rf_udp_send_timed_multi(
+      h, _data, nsamples, secs, frac_secs, has_time_spec, blocking, is_start_of_burst, is_end_of_burst);
+}
+
+int rf_udp_send_timed_multi(void*  h,
+                            void** data,
+                            int    nsamples,
+                            time_t secs,
+                            double frac_secs,
+                            bool   has_time_spec,
+                            bool   blocking,
+                            bool   is_start_of_burst,
+                            bool   is_end_of_burst)
+{
+  rf_udp_handler_t* handler = (rf_udp_handler_t*)h;
+
+  if (nsamples <= 0) {
+    return nsamples;
+  }
+  uint64_t tstamp = has_time_spec ? rf_time_base_to_tstamp(&handler->time, secs, frac_secs) : 0;
+
+  // the samples are converted straight into the datagrams, sent a batch per system call
+  float*             ptrs[SRSRAN_MAX_CHANNELS] = {};
+  srsran_vec_stats_t stats                     = {};
+  uint32_t           sent                      = 0;
+  while (sent < (uint32_t)nsamples) {
+    uint32_t count = 0;
+    while (count < RF_UDP_BATCH && sent < (uint32_t)nsamples) {
+      uint32_t         n   = SRSRAN_MIN((uint32_t)nsamples - sent, handler->tx_max_samples);
+      rf_udp_header_t* hdr = (rf_udp_header_t*)handler->tx_iov[count].iov_base;
+      rf_udp_header_init(hdr, RF_UDP_TX_DATA, handler->server_nof_channels);
+      hdr->seq         = handler->tx_seq++;
+      hdr->nof_samples = n;
+      hdr->timestamp   = has_time_spec ? tstamp + sent : 0;
+      hdr->flags       = (is_end_of_burst && sent + n == (uint32_t)nsamples) ? RF_UDP_FLAG_EOB : 0;
+      for (uint32_t ch = 0; ch < handler->server_nof_channels; ch++) {
+        ptrs[ch] = (ch < handler->nof_channels && data[ch]) ? (float*)data[ch] + 2 * sent : handler->tx_zeros;
+      }
+      srsran_vec_convert_fi_interleave_stats(
+          ptrs, 32767.999f, (int16_t*)(hdr + 1), handler->server_nof_channels, n, &stats);
+      handler->tx_iov[count].iov_len = sizeof(rf_udp_header_t) + rf_udp_payload_size(hdr);
+      count++;
+      sent += n;
+    }
+    for (uint32_t done = 0; done < count;) {
+      int ret = sendmmsg(handler->fd, &handler->tx_msgs[done], count - done, 0);
+      if (ret < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        ERROR("RF_UDP: send failed: %s\n", strerror(errno));
+        return SRSRAN_ERROR;
+      }
+      done += (uint32_t)ret;
+    }
+  }
+  return nsamples;
+}
+
+rf_dev_t srsran_rf_dev_udp = {"udp",
+                              rf_udp_devname,
+                              rf_udp_start_rx_stream,
+                              rf_udp_stop_rx_stream,
+                              rf_udp_flush_buffer,
+                              rf_udp_has_rssi,
+                              rf_udp_get_rssi,
+                              rf_udp_suppress_stdout,
+                              rf_udp_register_error_handler,
+                              rf_udp_open,
+                              rf_udp_open_multi,
+                              rf_udp_close,
+                              rf_udp_set_rx_srate,
+                              rf_udp_set_rx_gain,
+                              NULL,
+                              rf_udp_set_tx_gain,
+                              NULL,
+                              rf_udp_get_rx_gain,
+                              rf_udp_get_tx_gain,
+                              rf_udp_get_info,
+                              rf_udp_set_rx_freq,
+                              rf_udp_set_tx_srate,
+                              rf_udp_set_tx_freq,
+                              rf_udp_get_time,
+                              NULL,
+                              rf_udp_recv_with_time,
+                              rf_udp_recv_with_time_multi,
+                              rf_udp_send_timed,
+                              .srsran_rf_send_timed_multi = rf_udp_send_timed_multi};
@@ -0,0 +1,102 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_UDP_IMP_H_
+#define SRSRAN_RF_UDP_IMP_H_
+
+// UDP RF device, built into the RF library. It streams from the application running on the ARM of the board, which
+// opened the IIO plugin with udp_server=<port> (see rf_udp.h), instead of going through iiod. The RX datagrams carry
+// the HW timestamps and sequence numbers; lost ones are reported as overflows, the read spanning the gap like the live
+// devices. TX bursts (channel 0) are sent back as timestamped datagrams. The sampling rate, frequencies and gains
+// belong to the server. Device arguments:
+//   udp=<host>[:<port>]   server address, port 5260 by default
+//   udp_payload=<bytes>   TX datagram size, header included, 1472 by default (up to 8972 with jumbo frames)
+//   udp_rcvbuf=<bytes>    socket receive buffer, 32 MB by default (capped by net.core.rmem_max without CAP_NET_ADMIN)
+//   udp_bfp=<bits>        receive the RX stream in block floating point with mantissas of 8, 9, 12... bits (2 to 16)
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "srsran/config.h"
+#include "srsran/phy/rf/rf.h"
+#include "time.h"
+
+extern rf_dev_t srsran_rf_dev_udp;
+
+SRSRAN_API int rf_udp_open(char* args, void** handler);
+
+SRSRAN_API int rf_udp_open_multi(char* args, void** handler, uint32_t nof_channels);
+
+SRSRAN_API const char* rf_udp_devname(void* h);
+
+SRSRAN_API int rf_udp_close(void* h);
+
+SRSRAN_API int rf_udp_start_rx_stream(void* h, bool now);
+
+SRSRAN_API int rf_udp_stop_rx_stream(void* h);
+
+SRSRAN_API void rf_udp_flush_buffer(void* h);
+
+SRSRAN_API bool rf_udp_has_rssi(void* h);
+
+SRSRAN_API float rf_udp_get_rssi(void* h);
+
+SRSRAN_API void rf_udp_suppress_stdout(void* h);
+
+SRSRAN_API void rf_udp_register_error_handler(void* h, srsran_rf_error_handler_t error_handler, void* arg);
+
+SRSRAN_API double rf_udp_set_rx_srate(void* h, double freq);
+
+SRSRAN_API int rf_udp_set_rx_gain(void* h, double gain);
+
+SRSRAN_API double rf_udp_get_rx_gain(void* h);
+
+SRSRAN_API int rf_udp_set_tx_gain(void* h, double gain);
+
+SRSRAN_API double rf_udp_get_tx_gain(void* h);
+
+SRSRAN_API srsran_rf_info_t* rf_udp_get_info(void* h);
+
+SRSRAN_API double rf_udp_set_rx_freq(void* h, uint32_t ch, double freq);
+
+SRSRAN_API double rf_udp_set_tx_srate(void* h, double freq);
+
+SRSRAN_API double rf_udp_set_tx_freq(void* h, uint32_t ch, double freq);
+
+SRSRAN_API void rf_udp_get_time(void* h, time_t* secs, double* frac_secs);
+
+SRSRAN_API int
+rf_udp_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs);
+
+SRSRAN_API int
+rf_udp_recv_with_time_multi(void* h, void** data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs);
+
+SRSRAN_API int rf_udp_send_timed(void*  h,
+                                 void*  data,
+                                 int    nsamples,
+                                 time_t secs,
+                                 double frac_secs,
+                                 bool   has_time_spec,
+                                 bool   blocking,
+                                 bool   is_start_of_burst,
+                                 bool   is_end_of_burst);
+
+SRSRAN_API int rf_udp_send_timed_multi(void*  h,
+                                       void** data,
+                                       int    nsamples,
+                                       time_t secs,
+                                       double frac_secs,
+                                       bool   has_time_spec,
+                                       bool   blocking,
+                                       bool   is_start_of_burst,
+                                       bool   is_end_of_burst);
+
+#endif // SRSRAN_RF_UDP_IMP_H_
@@ -0,0 +1,296 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "rf_udp_server.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+#define RF_UDP_SERVER_SNDBUF (4 * 1024 * 1024)
+#define RF_UDP_SERVER_RCVBUF (4 * 1024 * 1024)
+#define RF_UDP_SERVER_POLL_MS 100
+
+// Called with the mutex held
+static void send_time(rf_udp_server_t* s)
+{
+  struct {
+    rf_udp_header_t hdr;
+    rf_time_base_t   time;
+  } msg;
+  rf_udp_header_init(&msg.hdr, RF_UDP_TIME, s->nof_channels);
+  msg.hdr.flags = rf_udp_bfp_flags(s->bfp_width);
+  msg.time      = s->time;
+  sendto(s->fd, &msg, sizeof(msg), MSG_DONTWAIT, (struct sockaddr*)&s->client, sizeof(s->client));
+}
+
+static bool same_client(const struct sockaddr_in* a, const struct sockaddr_in* b)
+{
+  return a->sin_addr.s_addr == b->sin_addr.s_addr && a->sin_port == b->sin_port;
+}
+
+static void handle_tx(rf_udp_server_t* s, const rf_udp_header_t* hdr)
+{
+  if (s->tx_seq_valid && hdr->seq != s->tx_seq) {
+    uint32_t lost = hdr->seq - s->tx_seq;
+    s->nof_tx_lost += lost;
+    INFO("RF UDP: %u TX datagrams lost\n", lost);
+  }
+  s->tx_seq       = hdr->seq + 1;
+  s->tx_seq_valid = true;
+  if (hdr->nof_channels != s->nof_channels || rf_udp_bfp_width(hdr->flags)) {
+    // the TX path takes native samples of every channel of the radio, as many as the time base datagrams announce
+    INFO("RF UDP: TX datagram with %u channels dropped, %u expected\n", hdr->nof_channels, s->nof_channels);
+    return;
+  }
+  s->tx(s->h, hdr->timestamp, (const int16_t*)(hdr + 1), hdr->nof_samples, (hdr->flags & RF_UDP_FLAG_EOB) != 0);
+}
+
+static void* udp_server_thread(void* arg)
+{
+  rf_udp_server_t*   s = (rf_udp_server_t*)arg;
+  uint64_t           buffer[RF_UDP_MAX_PAYLOAD / sizeof(uint64_t) + 1];
+  rf_udp_header_t*   hdr        = (rf_udp_header_t*)buffer;
+  struct pollfd      pfd        = {s->fd, POLLIN, 0};
+  int                since_time = 0;
+  struct sockaddr_in from       = {};
+  socklen_t          from_len;
+  uint32_t           width;
+
+  while (s->running) {
+    if (poll(&pfd, 1, RF_UDP_SERVER_POLL_MS) <= 0) {
+      since_time += RF_UDP_SERVER_POLL_MS;
+    } else {
+      from_len    = sizeof(from);
+      ssize_t len = recvfrom(s->fd, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &from_len);
+      if (len < 0 || !rf_udp_header_valid(hdr, (size_t)len)) {
+        continue;
+      }
+      pthread_mutex_lock(&s->mutex);
+      switch (hdr->type) {
+        case RF_UDP_SUBSCRIBE:
+          width = rf_udp_bfp_width(hdr->flags);
+          if (width && rf_udp_max_samples(s->payload, s->nof_channels, width) == 0) {
+            width = 0;
+          }
+          if (!s->subscribed || !same_client(&s->client, &from) || width != s->bfp_width) {
+            if (width) {
+              printf("RF UDP: streaming to %s:%u, BFP with %u bits mantissas\n",
+                     inet_ntoa(from.sin_addr),
+                     ntohs(from.sin_port),
+                     width);
+            } else {
+              printf("RF UDP: streaming to %s:%u\n", inet_ntoa(from.sin_addr), ntohs(from.sin_port));
+            }
+          }
+          s->client       = from;
+          s->bfp_width    = width;
+          s->subscribed   = true;
+          s->tx_seq_valid = false;
+          send_time(s);
+          since_time = 0;
+          break;
+        case RF_UDP_UNSUBSCRIBE:
+          if (s->subscribed && same_client(&s->client, &from)) {
+            printf("RF UDP: %s:%u unsubscribed\n", inet_ntoa(from.sin_addr), ntohs(from.sin_port));
+            s->subscribed = false;
+          }
+          break;
+        case RF_UDP_TX_DATA:
+          if (s->subscribed && same_client(&s->client, &from)) {
+            // the TX path may block until there is room, the subscription is not held meanwhile
+            pthread_mutex_unlock(&s->mutex);
+            handle_tx(s, hdr);
+            pthread_mutex_lock(&s->mutex);
+          }
+          break;
+        default:
+          break;
+      }
+      pthread_mutex_unlock(&s->mutex);
+    }
+    // the time base is repeated, a lost datagram must not leave the host without it
+    if (since_time >= RF_UDP_TIME_PERIOD_MS) {
+      pthread_mutex_lock(&s->mutex);
+      if (s->subscribed) {
+        send_time(s);
+      }
+      pthread_mutex_unlock(&s->mutex);
+      since_time = 0;
+    }
+  }
+  return NULL;
+}
+
+int rf_udp_server_init(rf_udp_server_t* s,
+                       uint16_t         port,
+                       uint32_t         payload,
+                       uint32_t         nof_channels,
+                       void*            h,
+                       rf_player_tx_t   tx)
+{
+  bzero(s, sizeof(rf_udp_server_t));
+  if (payload == 0) {
+    payload = RF_UDP_DEFAULT_PAYLOAD;
+  }
+  if (payload > RF_UDP_MAX_PAYLOAD || rf_udp_max_samples(payload, nof_channels, 0) == 0) {
+    ERROR("RF UDP: invalid datagram size %u\n", payload);
+    return SRSRAN_ERROR;
+  }
+  s->nof_channels = nof_channels;
+  s->payload      = payload;
+  s->h            = h;
+  s->tx           = tx;
+
+  s->fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (s->fd < 0) {
+    ERROR("RF UDP: could not create the socket: %s\n", strerror(errno));
+    return SRSRAN_ERROR;
+  }
+  int sndbuf = RF_UDP_SERVER_SNDBUF;
+  int rcvbuf = RF_UDP_SERVER_RCVBUF;
+  setsockopt(s->fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+  setsockopt(s->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  struct sockaddr_in addr = {};
+  addr.sin_family         = AF_INET;
+  addr.sin_addr.s_addr    = htonl(INADDR_ANY);
+  addr.sin_port           = htons(port);
+  if (bind(s->fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    ERROR("RF UDP: could not bind port %u: %s\n", port, strerror(errno));
+    close(s->fd);
+    return SRSRAN_ERROR;
+  }
+
+  s->rx_packed = srsran_vec_malloc(RF_UDP_BATCH * RF_UDP_MAX_PAYLOAD);
+  if (!s->rx_packed) {
+    close(s->fd);
+    return SRSRAN_ERROR;
+  }
+
+  // the datagrams of a batch only differ by their header and payload pointer
+  for (uint32_t i = 0; i < RF_UDP_BATCH; i++) {
+    s->rx_iov[i][0].iov_base         = &s->rx_headers[i];
+    s->rx_iov[i][0].iov_len          = sizeof(rf_udp_header_t);
+    s->rx_msgs[i].msg_hdr.msg_iov    = s->rx_iov[i];
+    s->rx_msgs[i].msg_hdr.msg_iovlen = 2;
+  }
+
+  pthread_mutex_init(&s->mutex, NULL);
+  s->running = true;
+  if (pthread_create(&s->thread, NULL, udp_server_thread, s)) {
+    s->running = false;
+    pthread_mutex_destroy(&s->mutex);
+    close(s->fd);
+    free(s->rx_packed);
+    return SRSRAN_ERROR;
+  }
+  s->enabled = true;
+  printf("RF UDP: listening on port %u, %u samples per datagram\n", port, rf_udp_max_samples(payload, nof_channels, 0));
+  return SRSRAN_SUCCESS;
+}
+
+void rf_udp_server_free(rf_udp_server_t* s)
+{
+  if (!s->enabled) {
+    return;
+  }
+  s->running = false;
+  pthread_join(s->thread, NULL);
+  close(s->fd);
+  pthread_mutex_destroy(&s->mutex);
+  free(s->rx_packed);
+  if (s->nof_rx_dropped || s->nof_tx_lost) {
+    printf("RF UDP: %lu RX datagrams dropped on a full socket, %lu TX datagrams lost\n",
+           (unsigned long)s->nof_rx_dropped,
+           (unsigned long)s->nof_tx_lost);
+  }
+  s->enabled = false;
+}
+
+void rf_udp_server_push_rx(rf_udp_server_t* s,
+                           uint64_t         tstamp,
+                           const void*      samples,
+                           uint32_t         nof_samples,
+                           bool             end_of_burst)
+{
+  pthread_mutex_lock(&s->mutex);
+  bool               subscribed = s->subscribed;
+  struct sockaddr_in client     = s->client;
+  uint32_t           width      = s->bfp_width;
+  pthread_mutex_unlock(&s->mutex);
+  if (!subscribed) {
+    return;
+  }
+  uint32_t max_samples = rf_udp_max_samples(s->payload, s->nof_channels, width);
+
+  const uint8_t* src         = (const uint8_t*)samples;
+  size_t         sample_size = 2 * sizeof(int16_t) * s->nof_channels;
+  // an end of burst without samples still takes a datagram
+  do {
+    uint32_t count = 0;
+    while (count < RF_UDP_BATCH && (nof_samples > 0 || count == 0)) {
+      uint32_t         n   = SRSRAN_MIN(nof_samples, max_samples);
+      rf_udp_header_t* hdr = &s->rx_headers[count];
+      rf_udp_header_init(hdr, RF_UDP_RX_DATA, s->nof_channels);
+      hdr->seq         = s->rx_seq++;
+      hdr->nof_samples = n;
+      hdr->timestamp   = tstamp;
+      hdr->flags       = (end_of_burst && n == nof_samples) ? RF_UDP_FLAG_EOB : 0;
+
+      if (width) {
+        uint8_t* packed = &s->rx_packed[(size_t)count * RF_UDP_MAX_PAYLOAD];
+        hdr->flags |= rf_udp_bfp_flags(width);
+        s->rx_iov[count][1].iov_base = packed;
+        s->rx_iov[count][1].iov_len  = srsran_bfp_compress((const int16_t*)src, width, packed, n * s->nof_channels);
+      } else {
+        s->rx_iov[count][1].iov_base = (void*)src;
+        s->rx_iov[count][1].iov_len  = (size_t)n * sample_size;
+      }
+      s->rx_msgs[count].msg_hdr.msg_name    = &client;
+      s->rx_msgs[count].msg_hdr.msg_namelen = sizeof(client);
+      count++;
+
+      src += (size_t)n * sample_size;
+      tstamp += n;
+      nof_samples -= n;
+    }
+    int sent = sendmmsg(s->fd, s->rx_msgs, count, MSG_DONTWAIT);
+    if (sent < (int)count) {
+      s->nof_rx_dropped += count - (uint32_t)SRSRAN_MAX(sent, 0);
+    }
+  } while (nof_samples > 0);
+}
+
+void rf_udp_server_set_time(rf_udp_server_t* s,
+                            double           srate,
+                            uint64_t         tstamp_base,
+                            int64_t          time_base_secs,
+                            double           time_base_frac)
+{
+  pthread_mutex_lock(&s->mutex);
+  s->time.srate          = srate;
+  s->time.tstamp_base    = tstamp_base;
+  s->time.time_base_secs = time_base_secs;
+  s->time.time_base_frac = time_base_frac;
+  // ahead of the first packets at the new rate
+  if (s->subscribed) {
+    send_time(s);
+  }
+  pthread_mutex_unlock(&s->mutex);
+}
@@ -0,0 +1,94 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+#ifndef SRSRAN_RF_UDP_SERVER_H_
+#define SRSRAN_RF_UDP_SERVER_H_
+
+// Server side of the timestamped UDP streams (see rf_udp.h), enabled in the IIO plugin with the udp_server=<port>
+// device argument, for the application running on the ARM of the board. The reader thread sends every RX packet to the
+// subscribed host straight from the DMA buffer, a datagram batch per system call, and never waits for the network:
+// datagrams the socket has no room for are dropped, and counted by the host through the sequence numbers. A thread
+// handles the subscriptions and hands the TX datagrams of the host to the TX path of the plugin. A host asking for
+// block floating point samples gets them compressed by the reader thread, with the mantissa width it asked for.
+// Device arguments:
+//   udp_server=<port>     UDP port to listen on
+//   udp_payload=<bytes>   datagram size, header included, 1472 by default (up to 8972 with jumbo frames)
+
+#include "rf_player.h"
+#include "rf_udp.h"
+#include "srsran/config.h"
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+typedef struct {
+  bool            enabled;
+  int             fd;
+  uint32_t        nof_channels;
+  uint32_t        payload; // bytes per datagram
+  void*           h;
+  rf_player_tx_t  tx;
+  volatile bool   running;
+  pthread_t       thread;
+
+  pthread_mutex_t    mutex; // subscription and time base, shared with the reader thread
+  bool               subscribed;
+  struct sockaddr_in client;
+  uint32_t           bfp_width; // BFP mantissa width asked by the host, 0 for native samples
+  rf_time_base_t      time;
+
+  // reader thread only
+  uint32_t        rx_seq;
+  uint64_t        nof_rx_dropped; // datagrams the socket had no room for
+  uint8_t*        rx_packed;      // compressed payloads of a batch
+  rf_udp_header_t rx_headers[RF_UDP_BATCH];
+  struct iovec    rx_iov[RF_UDP_BATCH][2];
+  struct mmsghdr  rx_msgs[RF_UDP_BATCH];
+
+  // server thread only
+  bool     tx_seq_valid;
+  uint32_t tx_seq; // next expected
+  uint64_t nof_tx_lost;
+} rf_udp_server_t;
+
+// Listens on port and starts the server thread, which hands the TX datagrams of the host to tx(h, ...)
+SRSRAN_API int rf_udp_server_init(rf_udp_server_t* s,
+                                  uint16_t         port,
+                                  uint32_t         payload,
+                                  uint32_t         nof_channels,
+                                  void*            h,
+                                  rf_player_tx_t   tx);
+
+// Stops the server thread and closes the socket
+SRSRAN_API void rf_udp_server_free(rf_udp_server_t* s);
+
+static inline bool rf_udp_server_enabled(const rf_udp_server_t* s)
+{
+  return s->enabled;
+}
+
+// Reader thread only. Sends nof_samples native samples received at tstamp to the host, if any.
+SRSRAN_API void rf_udp_server_push_rx(rf_udp_server_t* s,
+                                      uint64_t         tstamp,
+                                      const void*      samples,
+                                      uint32_t         nof_samples,
+                                      bool             end_of_burst);
+
+// Publishes the time base of the HW timestamps, on start and on every sampling rate change
+SRSRAN_API void rf_udp_server_set_time(rf_udp_server_t* s,
+                                       double           srate,
+                                       uint64_t         tstamp_base,
+                                       int64_t          time_base_secs,
+                                       double           time_base_frac);
+
+#endif // SRSRAN_RF_UDP_SERVER_H_
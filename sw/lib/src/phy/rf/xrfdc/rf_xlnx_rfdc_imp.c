@@ -10,15 +10,27 @@
 *
 */
 
+#include "../rf_cmd_queue.h"
 #include "../rf_helper.h"
+#include "../rf_history.h"
+#include "../rf_inband_status.h"
+#include "../rf_iq_corr.h"
+#include "../rf_player.h"
+#include "../rf_recorder.h"
+#include "../rf_rx_window.h"
+#include "../rf_shm_server.h"
+#include "../rf_timeline.h"
 #include "../rf_plugin.h"
 #include "rf_xlnx_rfdc_imp.h"
 #include "srsran/srsran.h"
 #include "xrfdc.h"
 #include "xrfdc_clk.h"
 
+#include <inttypes.h>
+#include <math.h>
 #include <sys/time.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
@@ -29,7 +41,7 @@ enum LMK04208_CLK_SRC {
   EXTERNAL_CLK_REF
 };
 
-unsigned int LMK04208_CKin[2][26] = {
+static unsigned int LMK04208_CKin[2][26] = {
                {0x00160040,0x80140320,0x80140321,0x80140322,
                 0xC0140023,0x40140024,0x80141E05,0x03300006,0x01300007,0x06010008,
                 0x55555549,0x9102410A,0x0401100B,0x1B0C006C,0x2302886D,0x0200000E,
@@ -49,14 +61,21 @@ const double       RFDC_PLL_FREQ            = 1966.08f;
 const unsigned int MIN_DATA_BUFFER_SIZE     = 1000;
 const unsigned int METADATA_NSAMPLES        = 8;  // 8 32bit samples
 const double       DEFAULT_TXRX_SRATE       = 1920000.0f;
+const double       MAX_FPGA_SRATE           = 30720000.0; // output of the FPGA decimation chain at 2048 points
+const double       MAX_TXRX_SRATE           = 122880000.0;
+const unsigned int MMCM_LOCK_TIMEOUT_US     = 1000000;
 
-static cf_t zero_mem[64*1024]    = {0};
-static int  lates                = 0;
-static int  rx_data_buffer_size  = MIN_DATA_BUFFER_SIZE;
-static int  tx_data_buffer_size  = MIN_DATA_BUFFER_SIZE;
+// read-only, shared by all the devices
+static const cf_t zero_mem[128 * 1024] = {0};
 
 #define DEVNAME_RFDC        "RFdc"
-#define CONVERT_BUFFER_SIZE (1024*1024)
+#define CONVERT_BUFFER_SIZE (2*1024*1024) // 1 ms at 122.88 MS/s for 8 channels
+#define RFDC_MAX_CHANNELS   8 // RF channels, each served by an RF-ADC and an RF-DAC block
+#define RFDC_NOF_TILES      4
+#define RFDC_NOF_BLOCKS     4
+#define RFDC_MAX_TX_BYTES   0x10000 // the DAC chain reads the packet length from a 16 bit field of the header
+#define MM_REG_SIZE         0x1F40
+#define MM_REG_ADDR         0x00A0040000
 #define common_preamble1    0xbbbbaaaa
 #define common_preamble2    0xddddcccc
 #define common_preamble3    0xffffeeee
@@ -67,6 +86,8 @@ static int  tx_data_buffer_size  = MIN_DATA_BUFFER_SIZE;
 #define time_preamble3      0xdfcbaefd
 
 #define PKT_HEADER_MAGIC    0x12345678
+#define RFDC_CLK_STATE_FILE "/run/srsran_rfdc_clk_state"
+#define RFDC_DEFAULT_CMD_LEAD_US 100 // covers the tile update event of a staged mixer setting
 //#define PRINT_TIMESTAMPS  1
 
 typedef enum srs_dma_dir {
@@ -124,6 +145,8 @@ typedef struct dma_buffers dma_buffers_t;
 
 static void *reader_thread(void *arg);
 static void *writer_thread(void *arg);
+static void *cmd_thread(void *arg);
+static void  client_tx(void* h, uint64_t tstamp, const int16_t* sc16, uint32_t nof_samples, bool end_of_burst);
 
 typedef struct {
   uint64_t  magic;
@@ -132,6 +155,19 @@ typedef struct {
   bool      end_of_burst;
 } tx_header_t;
 
+// Secondary RX consumer, reading the ring buffer through the tap of the same index
+typedef struct {
+  tx_header_t header;     // packet being read, nof_samples left in it
+  int16_t*    buffer;     // native samples of the current receive call
+  uint32_t    buffer_len; // in samples
+} rx_consumer_t;
+
+// RF-ADC or RF-DAC block serving an RF channel
+typedef struct {
+  u16 tile;
+  u16 block;
+} rfdc_converter_t;
+
 typedef struct {
   void*      parent;
   long long  _fs_hz;
@@ -150,13 +186,25 @@ typedef struct {
   pthread_cond_t      stream_cvar;
   pthread_t           thread;
   bool                thread_completed;
+  bool                closing; // the device is being closed, the thread must exit
   tx_header_t         prev_header;
   srsran_ringbuffer_t ring_buffer;
   struct dma_buffers  _buf;
+  bool                srate_switch_pending; // set by the API, cleared by the reader thread once the new rate is applied
+  bool                srate_switch_failed;  // set by the reader thread when the FPGA kept the previous rate
+  double              pending_fs_hz;
+  rf_rx_window_t      window;            // ticks requested by the last stream command
+  rf_timeline_t       timeline;          // continuity of the RX packets written to the ring buffer
+  uint32_t            max_backlog_ms;    // RX backlog bound, 0 if unbounded
+  uint32_t            max_backlog;       // in samples, takes precedence over max_backlog_ms
+  uint64_t            nof_backlog_drops; // samples dropped to honour the bound
+  rf_history_t        history;           // RX samples retained for srsran_rf_recv_history()
+  rx_consumer_t       consumers[SRSRAN_RINGBUFFER_MAX_TAPS];
 } xrfdc_streamer;
 
 typedef struct {
   bool                      use_timestamps;
+  bool                      async_log; // holds a reference on the async logger, released on close
   xrfdc_streamer            tx_streamer;
   xrfdc_streamer            rx_streamer;
   srsran_rf_error_handler_t iio_error_handler;
@@ -165,8 +213,31 @@ typedef struct {
   srsran_rf_info_t          info;
   XRFdc                     RFdcInst;      // RFdc driver instance
   struct metal_device*      phy_deviceptr; // libmetal device descriptor
+  bool                      metal_ready;   // metal_init() succeeded, metal_finish() is due on close
+  rf_cmd_queue_t            cmd_queue;      // commands waiting for their timestamp
+  pthread_t                 cmd_thread;     // applies the queued commands, see cmd_thread()
+  uint32_t                  cmd_lead_us;    // commands are applied this long before their tick
+  pthread_mutex_t           mixer_mutex;    // mixer staging and tile events of the application and command threads
+  rf_inband_status_t        rx_status;      // status reported by the RX metadata headers
+  rf_recorder_t*            recorder;       // NULL unless the record device argument is given
+  rf_player_t*              player;         // TX file playback, NULL if not active
+  rf_shm_server_t           shm;            // streams shared with other processes, see rf_shm.h
+  srsran_vec_stats_t        rx_stats;       // signal statistics of the last receive call
+  srsran_vec_stats_t        tx_stats;       // signal statistics of the last send call
+  rf_iq_corr_t              rx_corr[RFDC_MAX_CHANNELS]; // RX DC and IQ imbalance correction of each channel
+  uint32_t                  nof_channels;               // RF channels opened by the application
+  rfdc_converter_t          rx_map[RFDC_MAX_CHANNELS];  // RF-ADC of each RX channel, see rfdc_parse_channel_map()
+  rfdc_converter_t          tx_map[RFDC_MAX_CHANNELS];  // RF-DAC of each TX channel
+  u32                       rate_factor;                // converter decimation and interpolation, see rfdc_rate_plan()
+  uint32_t                  n_prb;                      // n_prb device argument, sizes the DMA packets at LTE rates
+  uint64_t                  tstamp_base;    // HW tick at which the current sampling rate took effect
+  time_t                    time_base_secs; // time corresponding to tstamp_base
+  double                    time_base_frac;
+  int                       nof_ts_prints; // timestamps printed so far, PRINT_TIMESTAMPS only
 } rf_xrfdc_handler_t;
 
+static void srs_dma_cleanup_resources(dma_buffers_t* buf);
+
 static int allocate_buffer_pool(dma_buffers_t *_buf,
                                 const srs_dma_pool_size_t num_of_buffers,
                                 const uint32_t buffer_length)
@@ -178,34 +249,36 @@ static int allocate_buffer_pool(dma_buffers_t *_buf,
   alloc_req.num_of_buffers = num_of_buffers;
   alloc_req.buffer_size    = buffer_length * _buf->sample_size; // must be specified in Bytes
 
-  // allocate array holding DMA buffer addresses (position in array corresponds to buffer ID)
-  _buf->dma_buffer_pool_desc.addresses = malloc(num_of_buffers * sizeof(unsigned long *));
+  // allocate array holding DMA buffer addresses (position in array corresponds to buffer ID), NULL until mapped
+  _buf->dma_buffer_pool_desc.addresses = calloc(num_of_buffers, sizeof(unsigned long *));
   if (!_buf->dma_buffer_pool_desc.addresses) {
     ERROR("failed to allocate memory for dma_buffer_pool_desc");
-    goto err_out;
+    return -1;
   }
+  _buf->dma_buffer_pool_desc.num_of_buffers = num_of_buffers;
+  _buf->dma_buffer_pool_desc.buffer_size    = buffer_length;
 
   // ask the driver to allocate memory suitable for DMA
   ret = ioctl(fd, SRS_DMA_ALLOC_BUFFERS, &alloc_req);
   if (ret < 0){
     ERROR("SRS_DMA_ALLOC_BUFFERS ioctl() failed, errno=%d", errno);
+    srs_dma_cleanup_resources(_buf);
     return -1;
   }
 
   //request an address of each dma buffer from the kernel driver using mmap call
   for (i = 0; i < num_of_buffers; i++) {
-    _buf->dma_buffer_pool_desc.addresses[i] =
-        (unsigned long *) mmap(0, buffer_length * _buf->sample_size,
-                               PROT_READ | PROT_WRITE, MAP_SHARED, fd, i << PAGE_SHIFT);
-    if (!_buf->dma_buffer_pool_desc.addresses[i]) {
+    void* ptr = mmap(0, alloc_req.buffer_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, i << PAGE_SHIFT);
+    if (ptr == MAP_FAILED) {
       ERROR("Error mapping dma buffer with id=%d", i);
       goto err_out;
     }
+    _buf->dma_buffer_pool_desc.addresses[i] = (unsigned long *) ptr;
   }
-  _buf->dma_buffer_pool_desc.buffer_size = buffer_length;
   _buf->current_user_buffer.id = -1;
   return 0;
 err_out:
+  srs_dma_cleanup_resources(_buf);
   ioctl(fd, SRS_DMA_DESTROY_BUFFERS);
   return -1;
 }
@@ -230,12 +303,13 @@ static int open_srs_dma_device(xrfdc_streamer* streamer, bool is_rx_dma, uint32_
       ERROR("Error accessing memory-maped registers in FPGA");
       return -1;
     }
-    streamer->_buf.ts_enabler_mem =
-        (uint32_t*)mmap(NULL, 0x1000, PROT_READ | PROT_WRITE, MAP_SHARED, devmem, 0xA0050000);
-    if (!streamer->_buf.ts_enabler_mem) {
+    void* ptr = mmap(NULL, 0x1000, PROT_READ | PROT_WRITE, MAP_SHARED, devmem, 0xA0050000);
+    close(devmem);
+    if (ptr == MAP_FAILED) {
       ERROR("Error mapping ADC timestamp enabler registers");
       return -1;
     }
+    streamer->_buf.ts_enabler_mem = (uint32_t*)ptr;
     rf_xrfdc_handler_t* h = (rf_xrfdc_handler_t*)streamer->parent;
     nof_hw_rx_channels    = h->memory_map_ptr[264];
     if (!nof_hw_rx_channels) {
@@ -248,8 +322,9 @@ static int open_srs_dma_device(xrfdc_streamer* streamer, bool is_rx_dma, uint32_
       return -1;
     }
   }
-  streamer->nof_channels           = (!is_rx_dma) ? 1 : nof_channels;
-  streamer->_buf.sample_size       = is_rx_dma ? sizeof(uint16_t) * 2 * nof_channels : sizeof(uint16_t) * 2;
+  // each DMA item holds an IQ pair of every channel, the TX width of the bitstream is not reported
+  streamer->nof_channels           = nof_channels;
+  streamer->_buf.sample_size       = sizeof(uint16_t) * 2 * nof_channels;
   streamer->_buf.direction         = (is_rx_dma) ? RX_DMA : TX_DMA;
   streamer->_buf.dma_queue_enabled = false;
   return 0;
@@ -261,11 +336,13 @@ static void srs_dma_cleanup_resources(dma_buffers_t* buf)
     ERROR("%s called with buffer object = NULL", __func__);
     return;
   }
-  // unmap DMA buffers
-  uint32_t buffer_size = buf->dma_buffer_pool_desc.buffer_size;
+  // unmap DMA buffers, with the length they were mapped with
+  size_t mapped_size = buf->dma_buffer_pool_desc.buffer_size * buf->sample_size;
   if (buf->dma_buffer_pool_desc.addresses) {
-    for (int i = 0; i < buf->dma_buffer_pool_desc.num_of_buffers; i++) {
-      munmap((void*)buf->dma_buffer_pool_desc.addresses[i], buffer_size * 4);
+    for (unsigned i = 0; i < buf->dma_buffer_pool_desc.num_of_buffers; i++) {
+      if (buf->dma_buffer_pool_desc.addresses[i]) {
+        munmap((void*)buf->dma_buffer_pool_desc.addresses[i], mapped_size);
+      }
     }
     free(buf->dma_buffer_pool_desc.addresses);
     buf->dma_buffer_pool_desc.addresses      = NULL;
@@ -282,12 +359,16 @@ static void close_srs_dma_device(xrfdc_streamer *streamer)
     return;
   }
   srs_dma_cleanup_resources(&streamer->_buf);
-  // close file descriptor
-  close(streamer->_buf.dma_device_fd);
+  // close file descriptor, the device may not have been opened if the radio failed to open
+  if (streamer->_buf.dma_device_fd >= 0) {
+    close(streamer->_buf.dma_device_fd);
+    streamer->_buf.dma_device_fd = -1;
+  }
 
   // for ADC path, unmap registers memory
-  if (streamer->_buf.direction == RX_DMA) {
+  if (streamer->_buf.ts_enabler_mem) {
     munmap((void *) streamer->_buf.ts_enabler_mem, 0x1000);
+    streamer->_buf.ts_enabler_mem = NULL;
   }
 }
 
@@ -359,6 +440,8 @@ static int srs_dma_stop_streaming(dma_buffers_t* buf)
     }
     // reset only after packetizing logic was stopped
     buf->ts_enabler_mem[2] = 1;
+    // disabling the queue hands all buffers back to the driver, including the one owned by the user
+    buf->current_user_buffer.id = -1;
   }
   buf->dma_queue_enabled = false;
   return ret;
@@ -421,6 +504,29 @@ int refill_buffer(xrfdc_streamer* streamer, ssize_t* items_in_buffer)
   return nbytes_rx;
 }
 
+static void log_overflow(rf_xrfdc_handler_t *h) {
+  if (h->recorder) {
+    rf_recorder_annotate(h->recorder, "overflow");
+  }
+  if (h->iio_error_handler) {
+    srsran_rf_error_t error;
+    bzero(&error, sizeof(srsran_rf_error_t));
+    error.type = SRSRAN_RF_ERROR_OVERFLOW;
+    h->iio_error_handler(h->iio_error_handler_arg, error);
+  }
+}
+
+static void log_gap(rf_xrfdc_handler_t *h, uint64_t nof_lost) {
+  if (h->iio_error_handler) {
+    srsran_rf_error_t error;
+    bzero(&error, sizeof(srsran_rf_error_t));
+    error.type = SRSRAN_RF_ERROR_OVERFLOW;
+    error.opt  = (int)SRSRAN_MIN(nof_lost, INT32_MAX);
+    error.msg  = "RX timeline gap";
+    h->iio_error_handler(h->iio_error_handler_arg, error);
+  }
+}
+
 static void log_late(rf_xrfdc_handler_t *h, bool is_rx) {
   if (h->iio_error_handler) {
     srsran_rf_error_t error;
@@ -443,14 +549,31 @@ void rf_xrfdc_register_error_handler(void *h, srsran_rf_error_handler_t new_hand
   handler->iio_error_handler_arg = arg;
 }
 
-bool rf_xrfdc_has_rssi(void *h)
+bool rf_xrfdc_has_rssi(void* h)
 {
-  return false;
+  return true;
+}
+
+// Power of the last received samples relative to full scale, it is not calibrated to the antenna input
+float rf_xrfdc_get_rssi(void* h)
+{
+  srsran_rf_stats_t stats;
+  rf_xrfdc_get_rx_stats(h, &stats);
+  return stats.power_dbfs;
+}
+
+int rf_xrfdc_get_rx_stats(void* h, srsran_rf_stats_t* stats)
+{
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
+  rf_stats_from_vec(&handler->rx_stats, handler->rx_streamer.nof_channels, stats);
+  return SRSRAN_SUCCESS;
 }
 
-float rf_xrfdc_get_rssi(void *h)
+int rf_xrfdc_get_tx_stats(void* h, srsran_rf_stats_t* stats)
 {
-  return 0.0f;
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
+  rf_stats_from_vec(&handler->tx_stats, handler->tx_streamer.nof_channels, stats);
+  return SRSRAN_SUCCESS;
 }
 
 const char* rf_xrfdc_devname(void* h)
@@ -506,13 +629,318 @@ static void RFdc_IRQ_callback(void *CallBackRef, u32 Type, int Tile, u32 Block,
   }
 }
 */
-static int configure_rfdc_controller(rf_xrfdc_handler_t *handler, const char *clock_source)
+// Milliseconds elapsed since *t; *t is moved forward to the current time
+static double rfdc_elapsed_ms(struct timespec* t)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double ms = (double)(now.tv_sec - t->tv_sec) * 1e3 + (double)(now.tv_nsec - t->tv_nsec) / 1e6;
+  *t        = now;
+  return ms;
+}
+
+static const char* rfdc_clock_source_name(u32 ref_clock_source)
+{
+  return (ref_clock_source == EXTERNAL_CLK_REF) ? "external" : "internal";
+}
+
+// Depending on the driver version XRFdc_GetPLLConfig() reports the sample rate either in MSPS or in GSPS
+static bool rfdc_rate_matches(double reported, double expected_mhz)
+{
+  return fabs(reported - expected_mhz) < 0.001 || fabs(reported * 1000.0 - expected_mhz) < 0.001;
+}
+
+/*
+ * LMK04208 and LMX2594 sit behind a write-only I2C-to-SPI bridge, so their configuration can't be read back.
+ * We keep a record of the last successfully programmed clock tree in a file under /run (cleared on reboot,
+ * which is the only event resetting the external clock chips).
+ */
+static bool rfdc_clock_state_matches(u32 ref_clock_source)
+{
+  char expected[RF_PARAM_LEN] = {0};
+  char stored[RF_PARAM_LEN]   = {0};
+  snprintf(
+      expected, sizeof(expected), "%s %d\n", rfdc_clock_source_name(ref_clock_source), (int)RFDC_REF_SAMPLE_FREQ_KHZ);
+
+  FILE* f = fopen(RFDC_CLK_STATE_FILE, "r");
+  if (!f) {
+    return false;
+  }
+  bool match = fgets(stored, sizeof(stored), f) != NULL && !strcmp(stored, expected);
+  fclose(f);
+  return match;
+}
+
+static void rfdc_save_clock_state(u32 ref_clock_source)
+{
+  FILE* f = fopen(RFDC_CLK_STATE_FILE, "w");
+  if (!f) {
+    INFO("RF_RFdc: couldn't record clock configuration in %s, next start-up will reprogram the clocks",
+         RFDC_CLK_STATE_FILE);
+    return;
+  }
+  fprintf(f, "%s %d\n", rfdc_clock_source_name(ref_clock_source), (int)RFDC_REF_SAMPLE_FREQ_KHZ);
+  fclose(f);
+}
+
+static void rfdc_forget_clock_state(void)
+{
+  unlink(RFDC_CLK_STATE_FILE);
+}
+
+// Checks that a tile is powered up, its PLL is locked to the expected reference and rate and its PL interface is set up
+static bool rfdc_tile_matches(XRFdc* RFdcInstPtr, u32 Type, u16 Tile, u16 FabClkDiv)
+{
+  XRFdc_IPStatus     IPStatus    = {};
+  XRFdc_PLL_Settings PLLSettings = {};
+  u32                LockStatus  = 0;
+  u16                FabClkOut   = 0;
+  u8                 FIFOEnable  = 0;
+
+  if (XRFdc_GetIPStatus(RFdcInstPtr, &IPStatus) != XRFDC_SUCCESS) {
+    return false;
+  }
+  XRFdc_TileStatus* TileStatus =
+      (Type == XRFDC_ADC_TILE) ? &IPStatus.ADCTileStatus[Tile] : &IPStatus.DACTileStatus[Tile];
+  if (!TileStatus->IsEnabled || !TileStatus->PowerUpState) {
+    return false;
+  }
+  if (XRFdc_GetPLLLockStatus(RFdcInstPtr, Type, Tile, &LockStatus) != XRFDC_SUCCESS ||
+      LockStatus != XRFDC_PLL_LOCKED) {
+    return false;
+  }
+  if (XRFdc_GetPLLConfig(RFdcInstPtr, Type, Tile, &PLLSettings) != XRFDC_SUCCESS || !PLLSettings.Enabled ||
+      !rfdc_rate_matches(PLLSettings.RefClkFreq, RFDC_REF_SAMPLE_FREQ) ||
+      !rfdc_rate_matches(PLLSettings.SampleRate, RFDC_PLL_FREQ)) {
+    return false;
+  }
+  if (XRFdc_GetFabClkOutDiv(RFdcInstPtr, Type, Tile, &FabClkOut) != XRFDC_SUCCESS || FabClkOut != FabClkDiv) {
+    return false;
+  }
+  if (XRFdc_GetFIFOStatus(RFdcInstPtr, Type, Tile, &FIFOEnable) != XRFDC_SUCCESS || !FIFOEnable) {
+    return false;
+  }
+  return true;
+}
+
+// Bit mask of the tiles serving the first nof_channels channels of a map
+static u32 rfdc_tile_mask(const rfdc_converter_t* map, uint32_t nof_channels)
+{
+  u32 mask = 0;
+  for (uint32_t ch = 0; ch < nof_channels; ch++) {
+    mask |= 1u << map[ch].tile;
+  }
+  return mask;
+}
+
+// Checks whether the clock tree and the converter tiles are already running with the configuration we would apply
+static bool rfdc_is_configured(rf_xrfdc_handler_t* handler, u32 ref_clock_source)
+{
+  XRFdc* RFdcInstPtr = &handler->RFdcInst;
+  u32    adc_tiles   = rfdc_tile_mask(handler->rx_map, handler->nof_channels);
+  u32    dac_tiles   = rfdc_tile_mask(handler->tx_map, handler->nof_channels);
+
+  if (!rfdc_clock_state_matches(ref_clock_source)) {
+    return false;
+  }
+  for (u16 Tile = 0; Tile < RFDC_NOF_TILES; Tile++) {
+    if (((adc_tiles >> Tile) & 1) && !rfdc_tile_matches(RFdcInstPtr, XRFDC_ADC_TILE, Tile, XRFDC_FAB_CLK_DIV2)) {
+      return false;
+    }
+    if (((dac_tiles >> Tile) & 1) && !rfdc_tile_matches(RFdcInstPtr, XRFDC_DAC_TILE, Tile, XRFDC_FAB_CLK_DIV1)) {
+      return false;
+    }
+  }
+
+  u32 Factor      = 0;
+  u32 NyquistZone = 0;
+  u32 DecoderMode = 0;
+  u16 InvSincMode = 0;
+  for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+    const rfdc_converter_t* adc = &handler->rx_map[ch];
+    if (XRFdc_GetDecimationFactor(RFdcInstPtr, adc->tile, adc->block, &Factor) != XRFDC_SUCCESS ||
+        Factor != handler->rate_factor) {
+      return false;
+    }
+    if (XRFdc_GetNyquistZone(RFdcInstPtr, XRFDC_ADC_TILE, adc->tile, adc->block, &NyquistZone) != XRFDC_SUCCESS ||
+        NyquistZone != XRFDC_ODD_NYQUIST_ZONE) {
+      return false;
+    }
+  }
+  for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+    const rfdc_converter_t* dac = &handler->tx_map[ch];
+    if (XRFdc_GetInterpolationFactor(RFdcInstPtr, dac->tile, dac->block, &Factor) != XRFDC_SUCCESS ||
+        Factor != handler->rate_factor) {
+      return false;
+    }
+    if (XRFdc_GetNyquistZone(RFdcInstPtr, XRFDC_DAC_TILE, dac->tile, dac->block, &NyquistZone) != XRFDC_SUCCESS ||
+        NyquistZone != XRFDC_EVEN_NYQUIST_ZONE) {
+      return false;
+    }
+    if (XRFdc_GetDecoderMode(RFdcInstPtr, dac->tile, dac->block, &DecoderMode) != XRFDC_SUCCESS ||
+        DecoderMode != XRFDC_DECODER_MAX_SNR_MODE) {
+      return false;
+    }
+    if (XRFdc_GetInvSincFIR(RFdcInstPtr, dac->tile, dac->block, &InvSincMode) != XRFDC_SUCCESS || InvSincMode != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Prints the tile-level status (PLL, clocks, FIFO); only used when INFO logging is enabled
+static void rfdc_print_tile_status(XRFdc* RFdcInstPtr, u32 Type, u16 Tile)
+{
+  const char*        name        = (Type == XRFDC_ADC_TILE) ? "ADC" : "DAC";
+  XRFdc_IPStatus     IPStatus    = {};
+  XRFdc_PLL_Settings PLLSettings = {};
+  u32                ClockSource = 0;
+  u32                LockStatus  = 0;
+  u16                FabClkDiv   = 0;
+  u8                 FIFOEnable  = 0;
+
+  if (XRFdc_GetIPStatus(RFdcInstPtr, &IPStatus) != XRFDC_SUCCESS) {
+    ERROR("ERROR: RFdc status reports FAILURE");
+    return;
+  }
+  XRFdc_TileStatus* TileStatus =
+      (Type == XRFDC_ADC_TILE) ? &IPStatus.ADCTileStatus[Tile] : &IPStatus.DACTileStatus[Tile];
+  INFO("RF_RFdc: %s tile %u status:", name, Tile);
+  INFO("\tRF_RFdc: Tile enabled: %u",           TileStatus->IsEnabled);
+  INFO("\tRF_RFdc: Tile state: %u",             TileStatus->TileState);
+  INFO("\tRF_RFdc: Tile block status mask: %u", TileStatus->BlockStatusMask);
+  INFO("\tRF_RFdc: Tile power-up state: %u",    TileStatus->PowerUpState);
+  INFO("\tRF_RFdc: Tile PLL state: %u",         TileStatus->PLLState);
+
+  if (XRFdc_GetFabClkOutDiv(RFdcInstPtr, Type, Tile, &FabClkDiv) == XRFDC_SUCCESS) {
+    INFO("RF_RFdc: Clock divider for the PL: 0x%u", FabClkDiv);
+  }
+  if (XRFdc_GetClockSource(RFdcInstPtr, Type, Tile, &ClockSource) == XRFDC_SUCCESS) {
+    INFO("RF_RFdc: %s clock source: %d", name, ClockSource);
+  }
+  if (XRFdc_GetPLLConfig(RFdcInstPtr, Type, Tile, &PLLSettings) == XRFDC_SUCCESS) {
+    INFO("RF_RFdc: PLL configuration:");
+    INFO("\tRF_RFdc: PLL enabled (%u)",                   PLLSettings.Enabled);
+    INFO("\tRF_RFdc: PLL reference clock frequency (%f)", PLLSettings.RefClkFreq);
+    INFO("\tRF_RFdc: PLL sample rate (%f)",               PLLSettings.SampleRate);
+    INFO("\tRF_RFdc: PLL reference clock divider (%d)",   PLLSettings.RefClkDivider);
+    INFO("\tRF_RFdc: PLL feedback divider (%d)",          PLLSettings.FeedbackDivider);
+    INFO("\tRF_RFdc: PLL output divider (%d)",            PLLSettings.OutputDivider);
+  }
+  if (XRFdc_GetPLLLockStatus(RFdcInstPtr, Type, Tile, &LockStatus) == XRFDC_SUCCESS) {
+    INFO("RF_RFdc: PLL lock status: %u", LockStatus);
+  }
+  if (XRFdc_GetFIFOStatus(RFdcInstPtr, Type, Tile, &FIFOEnable) == XRFDC_SUCCESS) {
+    INFO("RF_RFdc: %s FIFO status: %u", name, FIFOEnable);
+  }
+}
+
+// Prints the per-channel status of a converter block; only used when INFO logging is enabled
+static void rfdc_print_block_status(XRFdc* RFdcInstPtr, u32 Type, u16 Tile, u16 Block)
+{
+  const char*          name          = (Type == XRFDC_ADC_TILE) ? "ADC" : "DAC";
+  XRFdc_BlockStatus    BlockStatus   = {};
+  XRFdc_Mixer_Settings MixerSettings = {};
+  u32                  FabricRate    = 0;
+  u32                  NyquistZone   = 0;
+
+  if (XRFdc_GetFabRdVldWords(RFdcInstPtr, Type, Tile, Block, &FabricRate) == XRFDC_SUCCESS) {
+    INFO("RF_RFdc: %s tile %u channel %u number of read samples per axi4-stream cycle: %u", name, Tile, Block,
+         FabricRate);
+  }
+  if (XRFdc_GetFabWrVldWords(RFdcInstPtr, Type, Tile, Block, &FabricRate) == XRFDC_SUCCESS) {
+    INFO("RF_RFdc: %s tile %u channel %u number of write samples per axi4-stream cycle: %u", name, Tile, Block,
+         FabricRate);
+  }
+  if (XRFdc_GetBlockStatus(RFdcInstPtr, Type, Tile, Block, &BlockStatus) == XRFDC_SUCCESS) {
+    INFO("RF_RFdc: %s block configuration:", name);
+    INFO("\tRF_RFdc: %s Sampling Frequency: %.03f", name, BlockStatus.SamplingFreq);
+    INFO("\tRF_RFdc: Analog datapath status: %u",  BlockStatus.AnalogDataPathStatus);
+    INFO("\tRF_RFdc: Digital datapath status: %u", BlockStatus.DigitalDataPathStatus);
+    INFO("\tRF_RFdc: Datapath clock status: %u",   BlockStatus.DataPathClocksStatus);
+    INFO("\tRF_RFdc: FIFO flags enabled: %u",      BlockStatus.IsFIFOFlagsEnabled);
+    INFO("\tRF_RFdc: FIFO flags asserted: %u",     BlockStatus.IsFIFOFlagsAsserted);
+  }
+  if (XRFdc_GetMixerSettings(RFdcInstPtr, Type, Tile, Block, &MixerSettings) == XRFDC_SUCCESS) {
+    INFO("RF_RFdc: %s Mixer Frequency: %.03f", name, MixerSettings.Freq);
+  }
+  INFO("RF_RFdc: %s input data type: %s", name, XRFdc_GetDataType(RFdcInstPtr, Type, Tile, Block) ? "real" : "I/Q");
+  INFO("RF_RFdc: %s data width: %d", name, XRFdc_GetDataWidth(RFdcInstPtr, Type, Tile, Block));
+
+  bool dig_path_en = (Type == XRFDC_ADC_TILE) ? XRFdc_IsADCDigitalPathEnabled(RFdcInstPtr, Tile, Block)
+                                              : XRFdc_IsDACDigitalPathEnabled(RFdcInstPtr, Tile, Block);
+  INFO("RF_RFdc: Digital path is %sabled", dig_path_en ? "en" : "dis");
+  INFO("RF_RFdc: %s FIFO is %sabled", name, XRFdc_IsFifoEnabled(RFdcInstPtr, Type, Tile, Block) ? "en" : "dis");
+  INFO("RF_RFdc: %s connected I data: %d, %s connected Q data: %d",
+       name,
+       XRFdc_GetConnectedIData(RFdcInstPtr, Type, Tile, Block),
+       name,
+       XRFdc_GetConnectedQData(RFdcInstPtr, Type, Tile, Block));
+
+  if (XRFdc_GetNyquistZone(RFdcInstPtr, Type, Tile, Block, &NyquistZone) == XRFDC_SUCCESS) {
+    INFO("RF_RFdc: %s Nyquist zone: %u", name, NyquistZone);
+  }
+  if (Type == XRFDC_ADC_TILE) {
+    u8 CalibrationMode = 0;
+    if (XRFdc_GetCalibrationMode(RFdcInstPtr, Tile, Block, &CalibrationMode) == XRFDC_SUCCESS) {
+      INFO("RF_RFdc: ADC calibration mode: %u", CalibrationMode);
+    }
+  } else {
+    u32 DecoderMode = 0;
+    u16 InvSincMode = 0;
+    if (XRFdc_GetDecoderMode(RFdcInstPtr, Tile, Block, &DecoderMode) == XRFDC_SUCCESS) {
+      INFO("RF_RFdc: DAC decoder mode %u", DecoderMode);
+    }
+    if (XRFdc_GetInvSincFIR(RFdcInstPtr, Tile, Block, &InvSincMode) == XRFDC_SUCCESS) {
+      INFO("RF_RFdc: DAC inverse sinc FIR status %u", InvSincMode);
+    }
+    INFO("RF_RFdc: DAC mixed mode: %d", XRFdc_GetMixedMode(RFdcInstPtr, Tile, Block));
+  }
+}
+
+// Wakes up a converter tile and applies our PLL, FIFO and PL clock configuration, overriding the Vivado parameters
+static int rfdc_setup_tile(XRFdc* RFdcInstPtr, u32 Type, u16 Tile)
+{
+  const char* name      = (Type == XRFDC_ADC_TILE) ? "ADC" : "DAC";
+  u16         FabClkDiv = (Type == XRFDC_ADC_TILE) ? XRFDC_FAB_CLK_DIV2 : XRFDC_FAB_CLK_DIV1;
+
+  // Explicitly wake up the tile (does not change Vivado-provided parameters)
+  if (XRFdc_StartUp(RFdcInstPtr, Type, Tile) != XRFDC_SUCCESS) {
+    ERROR("ERROR: Failed to wake up %s tile %u", name, Tile);
+    return -1;
+  }
+  INFO("RF_RFdc: %s tile %u succesfully started up", name, Tile);
+
+  // Explicitly configure the PLL
+  if (XRFdc_DynamicPLLConfig(RFdcInstPtr, Type, Tile, XRFDC_INTERNAL_PLL_CLK, RFDC_REF_SAMPLE_FREQ, RFDC_PLL_FREQ) !=
+      XRFDC_SUCCESS) {
+    ERROR("ERROR: failed to set Dynamic PLL configuration (%s tile %u)", name, Tile);
+    return -1;
+  }
+  INFO("RF_RFdc: PLL succesfully configured for %s tile %u", name, Tile);
+
+  // Explicitly enable the FIFO
+  if (XRFdc_SetupFIFO(RFdcInstPtr, Type, Tile, 1) != XRFDC_SUCCESS) {
+    ERROR("ERROR: failed to enable the %s FIFO of tile %u", name, Tile);
+    return -1;
+  }
+  INFO("RF_RFdc: %s FIFO succesfully enabled for %s tile %u", name, name, Tile);
+
+  // Configure the clock divider for the PL as required
+  if (XRFdc_SetFabClkOutDiv(RFdcInstPtr, Type, Tile, FabClkDiv) != XRFDC_SUCCESS) {
+    ERROR("ERROR: Failed to configure %s tile %u clock dividers", name, Tile);
+    return -1;
+  }
+  INFO("RF_RFdc: Clock divider for the PL succesfully set to 0x%u for %s tile %u", FabClkDiv, name, Tile);
+  return 0;
+}
+
+static int configure_rfdc_controller(rf_xrfdc_handler_t *handler, const char *clock_source, bool force_init)
 {
   int Status = 0;
 
   XRFdc          *RFdcInstPtr            = &handler->RFdcInst;
   XRFdc_Config   *ConfigPtr              = NULL;
-  XRFdc_IPStatus  IPStatusPtr            = {};
   XRFdc_Mixer_Settings *adcMixerSettings = NULL;
 
   /* Define our desired ADC mixer configuration (mimics what we set in Vivado) */
@@ -547,13 +975,6 @@ static int configure_rfdc_controller(rf_xrfdc_handler_t *handler, const char *cl
           .EventSource    = XRFDC_EVNT_SRC_TILE
   };
 
-  u32 DataWidth       = 0;
-  u32 GetFabricRate   = 0;
-  u32 NyquistZonePtr  = 0;
-  u8  CalibrationMode = 0;
-  int DataConnectedI  = 0;
-  int DataConnectedQ  = 0;
-  XRFdc_BlockStatus BlockStatus  = {};
 
   // look for 'clock source' parameter in the arguments list
   u32 ref_clock_source = INTERNAL_CLK_REF;
@@ -564,11 +985,21 @@ static int configure_rfdc_controller(rf_xrfdc_handler_t *handler, const char *cl
     }
   }
 
+  u32 adc_tiles = rfdc_tile_mask(handler->rx_map, handler->nof_channels);
+  u32 dac_tiles = rfdc_tile_mask(handler->tx_map, handler->nof_channels);
+
+  // start-up time breakdown (ms)
+  struct timespec t_stage, t_start;
+  double t_libmetal = 0, t_clocks = 0, t_tiles = 0, t_adc = 0, t_dac = 0;
+  clock_gettime(CLOCK_MONOTONIC, &t_stage);
+  t_start = t_stage;
+
   struct metal_init_params init_param = METAL_INIT_DEFAULTS;
   if (metal_init(&init_param)) {
     ERROR("ERROR: Failed to run libmetal initialization");
     return -1;
   }
+  handler->metal_ready = true;
 
   // Initialize the RFdc driver
   ConfigPtr = XRFdc_LookupConfig(RFDC_DEVICE_ID);
@@ -591,156 +1022,85 @@ static int configure_rfdc_controller(rf_xrfdc_handler_t *handler, const char *cl
     return -1;
   }
   INFO("RF_RFdc: RFdc controller successfully initialized");
-
-  printf("Configuring LMK04208 to use %s clock source\n", ref_clock_source == EXTERNAL_CLK_REF ? "external" : "internal");
-  // Configuring the clocks
-  LMK04208ClockConfig(I2CBUS, &LMK04208_CKin[ref_clock_source]);
-  // The ADCs expect a 245.76 MHz reference signal (as set in Vivado)
-  LMX2594ClockConfig(I2CBUS, RFDC_REF_SAMPLE_FREQ_KHZ);
-
-  INFO("RF_RFdc: Clock configuration successfully finished");
-
-  u16 ADC_Tile = 0;
-  //u16 ADC_Tile = 1;
-  u16 DAC_Tile = 1;
-
-  // Explicitly wake up ADC tile 0 (does not change Vivado-provided parameters)
-  Status = XRFdc_StartUp(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: Failed to wake up ADC tile 1");
-    return -1;
-  }
-  INFO("RF_RFdc: ADC tile %d succesfully started up", ADC_Tile);
-
-  /*explicitly wake up DAC tile 1 (does not change Vivado-provided parameters)*/
-  Status = XRFdc_StartUp(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: Failed to wake up DAC tile 1");
-    return -1;
-  }
-  INFO("RF_RFdc: DAC tile %d succesfully started up", DAC_Tile);
-
-  // Capture the RFdc IP status (to be printed later for a specific tile)
-  Status = XRFdc_GetIPStatus(RFdcInstPtr, &IPStatusPtr);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: RFdc status reports FAILURE");
-    return -1;
-  }
-  /** -----------------   ADC   ------------------------- **
-   *                                                      **
-   * We'll explicitly configure ADC tile 1,               **
-   * for which we have enabled channels 0 and 1 in Vivado **
-   ** --------------------------------------------------- **/
-
-  /** ---------------------------------------*/
-  /** === Common ADC tile configuration ===  */
-  /** ---------------------------------------*/
-  // Explicitly configure the PLL
-  // (overriding the parameters provided through Vivado)
-  Status = XRFdc_DynamicPLLConfig(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, XRFDC_INTERNAL_PLL_CLK, RFDC_REF_SAMPLE_FREQ, RFDC_PLL_FREQ);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: failed to set Dynamic PLL configuration (ADC)");
-    return -1;
-  }
-  INFO("RF_RFdc: PLL succesfully configured for ADC tile %d", ADC_Tile);
-
-  // Explicitly enable the ADC FIFO
-  Status = XRFdc_SetupFIFO(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, 1);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: failed to enable the ADC FIFO");
-    return -1;
-  }
-  INFO("RF_RFdc: ADC FIFO succesfully enabled for ADC tile %d",ADC_Tile);
-
-  // Print out the previously captured IP status [related to that ADC tile only]
-  INFO("RF_RFdc: ADC tile %u status:", ADC_Tile);
-  INFO("\tRF_RFdc: Tile enabled: %u", IPStatusPtr.ADCTileStatus[ADC_Tile].IsEnabled);
-  INFO("\tRF_RFdc: Tile state: %u",   IPStatusPtr.ADCTileStatus[ADC_Tile].TileState);
-  INFO("\tRF_RFdc: Tile block status mask: %u", IPStatusPtr.ADCTileStatus[ADC_Tile].BlockStatusMask);
-  INFO("\tRF_RFdc: Tile power-up state: %u",    IPStatusPtr.ADCTileStatus[ADC_Tile].PowerUpState);
-  INFO("\tRF_RFdc: Tile PLL state: %u", IPStatusPtr.ADCTileStatus[ADC_Tile].PLLState);
-
-  // Configure the clock divider for the PL as required
-  Status = XRFdc_SetFabClkOutDiv(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, XRFDC_FAB_CLK_DIV2);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: Failed to configure ADC tile clock dividers");
-    return -1;
+  t_libmetal = rfdc_elapsed_ms(&t_stage);
+
+  // every channel must be served by a block the bitstream enables
+  for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+    const rfdc_converter_t* adc = &handler->rx_map[ch];
+    const rfdc_converter_t* dac = &handler->tx_map[ch];
+    if (!XRFdc_IsADCBlockEnabled(RFdcInstPtr, adc->tile, adc->block)) {
+      ERROR("RF_RFdc: ADC tile %u block %u of RX channel %u is not enabled", adc->tile, adc->block, ch);
+      return -1;
+    }
+    if (!XRFdc_IsDACBlockEnabled(RFdcInstPtr, dac->tile, dac->block)) {
+      ERROR("RF_RFdc: DAC tile %u block %u of TX channel %u is not enabled", dac->tile, dac->block, ch);
+      return -1;
+    }
   }
-  INFO("RF_RFdc: Clock divider for the PL succesfully set to 0x%u (2) for ADC tile %d", XRFDC_FAB_CLK_DIV2, ADC_Tile);
 
-  u32 ClockSource   = 0;
-  u16 FabClkDivPtr  = 0;
-  u32 LockStatusPtr = 0;
-  u8  FIFOEnablePtr = 0;
-  XRFdc_PLL_Settings PLLSettings = {};
+  // If a previous run left the clock tree and the tiles exactly as we want them, there is nothing to reprogram
+  bool full_init = force_init || !rfdc_is_configured(handler, ref_clock_source);
 
-  // Print out the clock divider for the PL
-  Status = XRFdc_GetFabClkOutDiv(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, &FabClkDivPtr);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: GetFabClkOutDiv failed");
-    return -1;
-  }
-  INFO("RF_RFdc: Clock divider for the PL: 0x%u", FabClkDivPtr);
+  if (full_init) {
+    // the record becomes stale as soon as we touch the clock chips
+    rfdc_forget_clock_state();
 
-  // Print out the clock source
-  Status = XRFdc_GetClockSource(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, &ClockSource);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: GetClockSource failed");
-    return -1;
-  }
-  INFO("RF_RFdc: ADC clock source: %d", ClockSource);
+    printf("Configuring LMK04208 to use %s clock source\n", rfdc_clock_source_name(ref_clock_source));
+    // Configuring the clocks
+    LMK04208ClockConfig(I2CBUS, &LMK04208_CKin[ref_clock_source]);
+    // The ADCs expect a 245.76 MHz reference signal (as set in Vivado)
+    LMX2594ClockConfig(I2CBUS, RFDC_REF_SAMPLE_FREQ_KHZ);
 
-  // Print out the PLL configuration
-  Status = XRFdc_GetPLLConfig(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, &PLLSettings);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: GetPLLConfig failed");
-    return -1;
-  }
-  INFO("RF_RFdc: PLL configuration:");
-  INFO("\tRF_RFdc: PLL enabled (%u)",                   PLLSettings.Enabled);
-  INFO("\tRF_RFdc: PLL reference clock frequency (%f)", PLLSettings.RefClkFreq);
-  INFO("\tRF_RFdc: PLL sample rate (%f)",               PLLSettings.SampleRate);
-  INFO("\tRF_RFdc: PLL reference clock divider (%d)",   PLLSettings.RefClkDivider);
-  INFO("\tRF_RFdc: PLL feedback divider (%d)",          PLLSettings.FeedbackDivider);
-  INFO("\tRF_RFdc: PLL output divider (%d)",            PLLSettings.OutputDivider);
+    INFO("RF_RFdc: Clock configuration successfully finished");
+    t_clocks = rfdc_elapsed_ms(&t_stage);
 
-  // Print out the PLL lock status
-  Status = XRFdc_GetPLLLockStatus(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, &LockStatusPtr);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: GetPLLLockStatus failed");
-    return -1;
+    /** ------------------------------------------------*/
+    /** === Common configuration of the tiles in use === */
+    /** ------------------------------------------------*/
+    for (u16 Tile = 0; Tile < RFDC_NOF_TILES; Tile++) {
+      if (((adc_tiles >> Tile) & 1) && rfdc_setup_tile(RFdcInstPtr, XRFDC_ADC_TILE, Tile) < 0) {
+        return -1;
+      }
+      if (((dac_tiles >> Tile) & 1) && rfdc_setup_tile(RFdcInstPtr, XRFDC_DAC_TILE, Tile) < 0) {
+        return -1;
+      }
+    }
+    t_tiles = rfdc_elapsed_ms(&t_stage);
+  } else {
+    printf("RF_RFdc: clock tree locked and converter tiles already configured, skipping reprogramming\n");
   }
-  INFO("RF_RFdc: PLL lock status: %u", LockStatusPtr);
 
-  // Print out the FIFO status
-  Status = XRFdc_GetFIFOStatus(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, &FIFOEnablePtr);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: GetFIFOStatus failed");
-    return -1;
+  if (SRSRAN_VERBOSE_ISINFO()) {
+    for (u16 Tile = 0; Tile < RFDC_NOF_TILES; Tile++) {
+      if ((adc_tiles >> Tile) & 1) {
+        rfdc_print_tile_status(RFdcInstPtr, XRFDC_ADC_TILE, Tile);
+      }
+    }
   }
-  INFO("RF_RFdc: ADC FIFO status: %u", FIFOEnablePtr);
 
   /** ---------------------------------------------*/
   /** === channel specific configuration (ADC) === */
   /** ---------------------------------------------*/
 
-  for (u16 Block = 0; Block < 4; Block++) {
-    if (!XRFdc_IsADCBlockEnabled(RFdcInstPtr, ADC_Tile, Block)) {
-      continue;
-    }
-    INFO("RF_RFdc: ADC tile %u channel %u is enabled", ADC_Tile, Block);
-
-    // Explicitly set the ADC decimation factor (overriding the parameters provided through Vivado)
-    Status = XRFdc_SetDecimationFactor(RFdcInstPtr, ADC_Tile, Block, XRFDC_INTERP_DECIM_8X);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: Failed to set ADC decimation factor");
-      return -1;
+  for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+    u16 ADC_Tile = handler->rx_map[ch].tile;
+    u16 Block    = handler->rx_map[ch].block;
+    INFO("RF_RFdc: RX channel %u is ADC tile %u channel %u", ch, ADC_Tile, Block);
+
+    if (full_init) {
+      // Explicitly set the ADC decimation factor (overriding the parameters provided through Vivado)
+      Status = XRFdc_SetDecimationFactor(RFdcInstPtr, ADC_Tile, Block, handler->rate_factor);
+      if (Status != XRFDC_SUCCESS) {
+        ERROR("ERROR: Failed to set ADC decimation factor");
+        return -1;
+      }
+      INFO("RF_RFdc: ADC decimation factor succesfully configured for ADC tile %d channel %d", ADC_Tile, Block);
     }
-    INFO("RF_RFdc: ADC decimation factor succesfully configured for ADC tile %d channel %d", ADC_Tile, Block);
 
     /** these function calls must be used at startup to initialize the phase of the fine mixer to a valid state */
     // Set our desired NCO configuration;
     // NOTE: for some reason the vivado-set configuration was not applied or rewritten at some point
+    // the preset follows the ADC block of the channel, as in the Vivado design: block 0 and the other blocks
     adcMixerSettings = (Block == 0) ? &adcMixerSettings_ch0 : &adcMixerSettings_ch1;
     Status = XRFdc_SetMixerSettings(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, adcMixerSettings);
     if (Status != XRFDC_SUCCESS) {
@@ -755,347 +1115,117 @@ static int configure_rfdc_controller(rf_xrfdc_handler_t *handler, const char *cl
     INFO("RF_RFdc: ADC mixer succesfully configured");
     /** end of mixer configuration */
 
-    // Explicitly set the Nyquist zone
-/*  Status = XRFdc_SetNyquistZone(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, XRFDC_EVEN_NYQUIST_ZONE);
-    if (Status != XRFDC_SUCCESS) {
-      fprintf(stderr, "ERROR: Failed to set ADC Nyquist Zone\n");
-      return -1;
+    if (full_init) {
+      // Explicitly set the Nyquist zone
+      Status = XRFdc_SetNyquistZone(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, XRFDC_ODD_NYQUIST_ZONE);
+      if (Status != XRFDC_SUCCESS) {
+        ERROR("ERROR: Failed to set ADC Nyquist Zone");
+        return -1;
+      }
+      INFO("RF_RFdc: ADC Nyquist zone succesfully set to 1 (odd) for ADC tile %d", ADC_Tile);
     }
-    INFO("RF_RFdc: ADC Nyquist zone succesfully set to 2 (even) for ADC tile %d", ADC_Tile);
- */
-    Status = XRFdc_SetNyquistZone(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, XRFDC_ODD_NYQUIST_ZONE);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: Failed to set ADC Nyquist Zone");
-      return -1;
+
+    if (SRSRAN_VERBOSE_ISINFO()) {
+      rfdc_print_block_status(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block);
     }
-    INFO("RF_RFdc: ADC Nyquist zone succesfully set to 1 (odd) for ADC tile %d", ADC_Tile);
+  }
+  t_adc = rfdc_elapsed_ms(&t_stage);
 
-    // Read the number of samples per axi4-stream cycle
-    Status = XRFdc_GetFabRdVldWords(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, &GetFabricRate);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: GetFabRdVldWords failed");
-      return -1;
+  /** -----------------   DAC   ------------------ **
+   *                                               **
+   * We'll explicitly configure the DAC blocks of  **
+   * the TX channels, see rfdc_parse_channel_map() **
+   ** -------------------------------------------- **/
+  if (SRSRAN_VERBOSE_ISINFO()) {
+    for (u16 Tile = 0; Tile < RFDC_NOF_TILES; Tile++) {
+      if ((dac_tiles >> Tile) & 1) {
+        rfdc_print_tile_status(RFdcInstPtr, XRFDC_DAC_TILE, Tile);
+      }
     }
-    INFO("RF_RFdc: ADC tile %u channel %u number of read samples per axi4-stream cycle: %u", ADC_Tile, Block, GetFabricRate);
+  }
 
-    // Read the number of samples per axi4-stream cycle
-    Status = XRFdc_GetFabWrVldWords(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, &GetFabricRate);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: GetFabWrVldWords failed");
-      return -1;
+  /** ---------------------------------------------*/
+  /** === channel specific configuration (DAC) === */
+  /** ---------------------------------------------*/
+  for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+    u16 DAC_Tile = handler->tx_map[ch].tile;
+    u16 Block    = handler->tx_map[ch].block;
+    INFO("RF_RFdc: TX channel %u is DAC tile %u channel %u", ch, DAC_Tile, Block);
+
+    if (full_init) {
+      // Explicitly set the DAC interpolation factor (overriding the parameters provided through Vivado)
+      Status = XRFdc_SetInterpolationFactor(RFdcInstPtr, DAC_Tile, Block, handler->rate_factor);
+      if (Status != XRFDC_SUCCESS) {
+        ERROR("ERROR: Failed to set DAC interpolation factor");
+        return -1;
+      }
+      INFO("RF_RFdc: DAC interpolation factor succesfully configured for DAC tile %d channel %d", DAC_Tile, Block);
     }
-    INFO("RF_RFdc: ADC tile %u channel %u number of write samples per axi4-stream cycle: %u", ADC_Tile, Block, GetFabricRate);
 
-    // Print out the block configuration
-    Status = XRFdc_GetBlockStatus(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, &BlockStatus);
+    /** these function calls must be used at startup to initialize the phase of the fine mixer to a valid state */
+    // Set our desired NCO configuration;
+    // NOTE: for some reason the vivado-set configuration was not applied or rewritten at some point
+    Status = XRFdc_SetMixerSettings(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, &dacMixerSettings);
     if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: GetBlockStatus failed");
+      ERROR("ERROR: Failed to set DAC NCO settings");
       return -1;
     }
+    // Reset NCO phase of the DUC
+    XRFdc_ResetNCOPhase(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block);
+    //Generate a Tile Event
+    XRFdc_UpdateEvent(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, XRFDC_EVENT_MIXER);
 
-    INFO("RF_RFdc: ADC block configuration:");
-    INFO("\tRF_RFdc: ADC Sampling Frequency: %.03f", BlockStatus.SamplingFreq);
-    INFO("\tRF_RFdc: Analog datapath status: %u",  BlockStatus.AnalogDataPathStatus);
-    INFO("\tRF_RFdc: Digital datapath status: %u", BlockStatus.DigitalDataPathStatus);
-    INFO("\tRF_RFdc: Datapath clock status: %u",   BlockStatus.DataPathClocksStatus);
-    INFO("\tRF_RFdc: FIFO flags enabled: %u",      BlockStatus.IsFIFOFlagsEnabled);
-    INFO("\tRF_RFdc: FIFO flags asserted: %u",     BlockStatus.IsFIFOFlagsAsserted);
+    INFO("RF_RFdc: DAC mixer succesfully configured");
+    /** end of DAC channel mixer configuration */
 
-    // Print out the configured mixer frequency
-    Status = XRFdc_GetMixerSettings(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, adcMixerSettings);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: GetMixerSettings failed");
-      return -1;
+    if (full_init) {
+      // Explicitly set the Nyquist zone
+      Status = XRFdc_SetNyquistZone(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, XRFDC_EVEN_NYQUIST_ZONE);
+      if (Status != XRFDC_SUCCESS) {
+        ERROR("RF_RFdc: Failed to set DAC Nyquist Zone");
+        return -1;
+      }
+      INFO("RF_RFdc: DAC Nyquist zone succesfully set to 2 (even) for DAC tile %d", DAC_Tile);
+
+      // Explicitly set the decoder mode
+      Status = XRFdc_SetDecoderMode(RFdcInstPtr, DAC_Tile, Block, XRFDC_DECODER_MAX_SNR_MODE);
+      //Status = XRFdc_SetDecoderMode(RFdcInstPtr, Tile, Block, XRFDC_DECODER_MAX_LINEARITY_MODE);
+      if (Status != XRFDC_SUCCESS) {
+        ERROR("ERROR: Failed to set DAC decoder mode");
+        return -1;
+      }
+      INFO("RF_RFdc: DAC decoder mode succesfully set to %d (max SNR) for DAC tile %d",
+           XRFDC_DECODER_MAX_SNR_MODE,
+           DAC_Tile);
+
+      // Explicitly disable the inverse sinc FIR (we're on the second Nyquist zone)
+      Status = XRFdc_SetInvSincFIR(RFdcInstPtr, DAC_Tile, Block, 0);
+      if (Status != XRFDC_SUCCESS) {
+        ERROR("ERROR: Failed to disable the inverse sinc FIR");
+        return XRFDC_FAILURE;
+      }
+      INFO("RF_RFdc: DAC inverse sinc FIR disalbed for DAC tile %d", DAC_Tile);
     }
-    INFO("RF_RFdc: ADC Mixer Frequency: %.03f", adcMixerSettings->Freq);
 
-    // Print out the ADC input data type
-    if (XRFdc_GetDataType(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block)) {
-      INFO("RF_RFdc: ADC input data type: real");
-    } else {
-      INFO("RF_RFdc: ADC input data type: I/Q");
+    if (SRSRAN_VERBOSE_ISINFO()) {
+      rfdc_print_block_status(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block);
     }
-    // Print out the data width
-    DataWidth = XRFdc_GetDataWidth(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block);
-    INFO("RF_RFdc: ADC data width: %d", DataWidth);
-
-    // Print out the digital path status
-    bool adc_dig_path_en = XRFdc_IsADCDigitalPathEnabled(RFdcInstPtr, ADC_Tile, Block);
-    INFO("RF_RFdc: Digital path is %sabled", adc_dig_path_en ? "en" : "dis");
-
-    // Print out the FIFO status
-    bool adc_fifo_en = XRFdc_IsFifoEnabled(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block);
-    INFO("RF_RFdc: ADC FIFO is %sabled", adc_fifo_en ? "en" : "dis");
-
-    // Print out the connected I amd Q data
-    DataConnectedI = XRFdc_GetConnectedIData(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block);
-    DataConnectedQ = XRFdc_GetConnectedQData(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block);
-    INFO("RF_RFdc: ADC connected I data: %d, ADC connected Q data: %d", DataConnectedI, DataConnectedQ);
+  }
+  t_dac = rfdc_elapsed_ms(&t_stage);
 
-    // Print out the Nyquist zone
-    Status = XRFdc_GetNyquistZone(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, &NyquistZonePtr);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("RF_RFdc: GetNyquistZone failed");
-      return -1;
-    }
-    INFO("RF_RFdc: ADC Nyquist zone: %u", NyquistZonePtr);
-    Status = XRFdc_GetCalibrationMode(RFdcInstPtr, ADC_Tile, Block, &CalibrationMode);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("RF_RFdc: XRFdc_GetCalibrationMode failed");
-      return -1;
-    }
-    INFO("RF_RFdc: ADC calibration mode: %u", CalibrationMode);
+  if (full_init) {
+    rfdc_save_clock_state(ref_clock_source);
   }
 
-  /** -----------------   DAC   ------------------ **
-   *                                               **
-   * We'll explicitly configure DAC tile 1,        **
-   * for which we have enabled channel 0 in Vivado **
-   ** -------------------------------------------- **/
-  u32 DecoderModePtr = 0;
-  u16 InvSincModePtr = 0;
-  u32 DACMixedMode   = 0;
-
-  /** ---------------------------------------*/
-  /** === Common DAC tile configuration ===  */
-  /** ---------------------------------------*/
-
-  // Explicitly configure the PLL (overriding the parameters provided through Vivado)
-  Status = XRFdc_DynamicPLLConfig(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, XRFDC_INTERNAL_PLL_CLK, RFDC_REF_SAMPLE_FREQ, RFDC_PLL_FREQ);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: failed to set Dynamic PLL configuration (DAC)");
-    return -1;
-  }
-  INFO("RF_RFdc: PLL succesfully configured for DAC tile %d", DAC_Tile);
-
-  // Explicitly enable the DAC FIFO
-  Status = XRFdc_SetupFIFO(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, 1);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: failed to enable the DAC FIFO");
-    return -1;
-  }
-  INFO("RF_RFdc: DAC FIFO succesfully enabled for DAC tile %d", DAC_Tile);
-
-  // Print out the previously captured IP status [related to that DAC tile only]
-  INFO("RF_RFdc: DAC tile %u status:", DAC_Tile);
-  INFO("\tRF_RFdc: Tile enabled: %u",          IPStatusPtr.DACTileStatus[DAC_Tile].IsEnabled);
-  INFO("\tRF_RFdc: Tile state: %u",            IPStatusPtr.DACTileStatus[DAC_Tile].TileState);
-  INFO("\tRF_RFdc: Tile block status mask: %u",IPStatusPtr.DACTileStatus[DAC_Tile].BlockStatusMask);
-  INFO("\tRF_RFdc: Tile power-up state: %u",   IPStatusPtr.DACTileStatus[DAC_Tile].PowerUpState);
-  INFO("\tRF_RFdc: Tile PLL state: %u",        IPStatusPtr.DACTileStatus[DAC_Tile].PLLState);
-
-  // Configure the clock divider for the PL as required
-  Status = XRFdc_SetFabClkOutDiv(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, XRFDC_FAB_CLK_DIV1);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: Failed to configure DAC tile clock dividers");
-    return -1;
-  }
-  INFO("RF_RFdc: Clock divider for the PL succesfully set to 0x%u (1) for DAC tile %d", XRFDC_FAB_CLK_DIV1, DAC_Tile);
-
-  // Print out the clock divider for the PL
-  Status = XRFdc_GetFabClkOutDiv(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, &FabClkDivPtr);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: GetFabClkOutDiv failed");
-    return -1;
-  }
-  INFO("RF_RFdc: Clock divider for the PL: 0x%u", FabClkDivPtr);
-
-  // Print out the clock source
-  Status = XRFdc_GetClockSource(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, &ClockSource);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: GetClockSource failed");
-    return -1;
-  }
-  INFO("RF_RFdc: DAC clock source: %d", ClockSource);
-
-  // Print out the PLL configuration
-  Status = XRFdc_GetPLLConfig(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, &PLLSettings);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: GetPLLConfig failed");
-    return -1;
-  }
-  INFO("RF_RFdc: PLL configuration:");
-  INFO("\tRF_RFdc: PLL enabled (%u)",                   PLLSettings.Enabled);
-  INFO("\tRF_RFdc: PLL reference clock frequency (%f)", PLLSettings.RefClkFreq);
-  INFO("\tRF_RFdc: PLL sample rate (%f)",               PLLSettings.SampleRate);
-  INFO("\tRF_RFdc: PLL reference clock divider (%d)",   PLLSettings.RefClkDivider);
-  INFO("\tRF_RFdc: PLL feedback divider (%d)",          PLLSettings.FeedbackDivider);
-  INFO("\tRF_RFdc: PLL output divider (%d)",            PLLSettings.OutputDivider);
-
-  // Print out the PLL lock status
-  Status = XRFdc_GetPLLLockStatus(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, &LockStatusPtr);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: GetPLLLockStatus failed");
-    return -1;
-  }
-  INFO("RF_RFdc: PLL lock status: %u", LockStatusPtr);
-
-  // Print out the FIFO status
-  Status = XRFdc_GetFIFOStatus(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, &FIFOEnablePtr);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("ERROR: GetFIFOStatus failed");
-    return -1;
-  }
-  INFO("RF_RFdc: DAC FIFO status: %u", FIFOEnablePtr);
-
-  /** ---------------------------------------------*/
-  /** === channel specific configuration (DAC) === */
-  /** ---------------------------------------------*/
-  for (u16 Block = 0; Block < 4; Block++) {
-    if (!XRFdc_IsDACBlockEnabled(RFdcInstPtr, DAC_Tile, Block)) {
-      continue;
-    }
-    INFO("RF_RFdc: DAC tile %u channel %u is enabled", DAC_Tile, Block);
-
-    // Explicitly set the DAC interpolation factor (overriding the parameters provided through Vivado)
-    Status = XRFdc_SetInterpolationFactor(RFdcInstPtr, DAC_Tile, Block, XRFDC_INTERP_DECIM_8X);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: Failed to set DAC interpolation factor");
-      return -1;
-    }
-    INFO("RF_RFdc: DAC interpolation factor succesfully configured for DAC tile %d channel %d", DAC_Tile, Block);
-
-    /** these function calls must be used at startup to initialize the phase of the fine mixer to a valid state */
-    // Set our desired NCO configuration;
-    // NOTE: for some reason the vivado-set configuration was not applied or rewritten at some point
-    Status = XRFdc_SetMixerSettings(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, &dacMixerSettings);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: Failed to set DAC NCO settings");
-      return -1;
-    }
-    // Reset NCO phase of the DUC
-    XRFdc_ResetNCOPhase(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block);
-    //Generate a Tile Event
-    XRFdc_UpdateEvent(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, XRFDC_EVENT_MIXER);
-
-    INFO("RF_RFdc: DAC mixer succesfully configured");
-    /** end of DAC channel mixer configuration */
-
-    // Explicitly set the Nyquist zone
-    // TODO:
-    Status = XRFdc_SetNyquistZone(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, XRFDC_EVEN_NYQUIST_ZONE);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("RF_RFdc: Failed to set DAC Nyquist Zone");
-      return -1;
-    }
-    INFO("RF_RFdc: DAC Nyquist zone succesfully set to 2 (even) for DAC tile %d", DAC_Tile);
-
-/*  Status = XRFdc_SetNyquistZone(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, XRFDC_ODD_NYQUIST_ZONE);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("RF_RFdc: Failed to set DAC Nyquist Zone");
-      return -1;
-    }
-    INFO("RF_RFdc: DAC Nyquist zone succesfully set to 1 (odd) for DAC tile %d", DAC_Tile);
-*/
-    // Explicitly set the decoder mode
-    Status = XRFdc_SetDecoderMode(RFdcInstPtr, DAC_Tile, Block, XRFDC_DECODER_MAX_SNR_MODE);
-    //Status = XRFdc_SetDecoderMode(RFdcInstPtr, Tile, Block, XRFDC_DECODER_MAX_LINEARITY_MODE);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: Failed to set DAC decoder mode");
-      return -1;
-    }
-    INFO("RF_RFdc: DAC decoder mode succesfully set to %d (max SNR) for DAC tile %d", XRFDC_DECODER_MAX_SNR_MODE, DAC_Tile);
-
-    // Explicitly disable the inverse sinc FIR (we're on the second Nyquist zone)
-    Status = XRFdc_SetInvSincFIR(RFdcInstPtr, DAC_Tile, Block, 0);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: Failed to disable the inverse sinc FIR");
-      return XRFDC_FAILURE;
-    }
-    INFO("RF_RFdc: DAC inverse sinc FIR disalbed for DAC tile %d", DAC_Tile);
-
-    // Read the number of samples per axi4-stream cycle
-    Status = XRFdc_GetFabRdVldWords(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, &GetFabricRate);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: GetFabRdVldWords failed");
-      return -1;
-    }
-    INFO("RF_RFdc: DAC tile %u channel %u number of read samples per axi4-stream cycle: %u", DAC_Tile, Block,
-         GetFabricRate);
-    // Read the number of samples per axi4-stream cycle
-    Status = XRFdc_GetFabWrVldWords(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, &GetFabricRate);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: GetFabWrVldWords failed");
-      return -1;
-    }
-    INFO("RF_RFdc: DAC tile %u channel %u number of write samples per axi4-stream cycle: %u", DAC_Tile, Block,
-         GetFabricRate);
-
-    // Print out the block configuration
-    Status = XRFdc_GetBlockStatus(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, &BlockStatus);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: GetBlockStatus failed");
-      return -1;
-    }
-
-    INFO("RF_RFdc: DAC block configuration:");
-    INFO("\tRF_RFdc: DAC Sampling Frequency: %.03f", BlockStatus.SamplingFreq);
-    INFO("\tRF_RFdc: Analog datapath status: %u", BlockStatus.AnalogDataPathStatus);
-    INFO("\tRF_RFdc: Digital datapath status: %u", BlockStatus.DigitalDataPathStatus);
-    INFO("\tRF_RFdc: Datapath clock status: %u", BlockStatus.DataPathClocksStatus);
-    INFO("\tRF_RFdc: FIFO flags enabled: %u", BlockStatus.IsFIFOFlagsEnabled);
-    INFO("\tRF_RFdc: FIFO flags asserted: %u", BlockStatus.IsFIFOFlagsAsserted);
-
-    // Print out the configured mixer frequency
-    Status = XRFdc_GetMixerSettings(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, &dacMixerSettings);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: GetMixerSettings failed");
-      return -1;
-    }
-    INFO("RF_RFdc: DAC Mixer Frequency: %.03f", dacMixerSettings.Freq);
-
-    // Print out the DAC input data type*/
-    if (XRFdc_GetDataType(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block)) {
-      INFO("RF_RFdc: DAC input data type: real");
-    } else {
-      INFO("RF_RFdc: DAC input data type: I/Q");
-    }
-
-    // Print out the data width
-    DataWidth = XRFdc_GetDataWidth(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block);
-    INFO("RF_RFdc: DAC data width: %d", DataWidth);
-
-    // Print out the digital path status
-    bool dac_dig_path_en = XRFdc_IsDACDigitalPathEnabled(RFdcInstPtr, DAC_Tile, Block);
-    INFO("RF_RFdc: Digital path is %sabled", dac_dig_path_en ? "en" : "dis");
-
-    // Print out the FIFO status
-    bool dac_fifo_en = XRFdc_IsFifoEnabled(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block);
-    INFO("RF_RFdc: DAC FIFO is %sabled", dac_fifo_en ? "en" : "dis");
-
-    // Print out the connected I and Q data
-    DataConnectedI = XRFdc_GetConnectedIData(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block);
-    DataConnectedQ = XRFdc_GetConnectedQData(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block);
-    INFO("RF_RFdc: DAC connected I data: %d, DAC connected Q data: %d", DataConnectedI, DataConnectedQ);
-
-    // Print out the Nyquist zone
-    Status = XRFdc_GetNyquistZone(RFdcInstPtr, XRFDC_DAC_TILE, DAC_Tile, Block, &NyquistZonePtr);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: GetNyquistZone failed");
-      return -1;
-    }
-    INFO("RF_RFdc: DAC Nyquist zone %u", NyquistZonePtr);
-
-    // Print out the decoder mode
-    Status = XRFdc_GetDecoderMode(RFdcInstPtr, DAC_Tile, Block, &DecoderModePtr);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: GetDecoderMode failed");
-      return -1;
-    }
-    INFO("RF_RFdc: DAC decoder mode %u", DecoderModePtr);
-
-    // Print out the inverse sinc FIR status
-    Status = XRFdc_GetInvSincFIR(RFdcInstPtr, DAC_Tile, Block, &InvSincModePtr);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("ERROR: GetInvSincFIR failed");
-      return -1;
-    }
-    INFO("RF_RFdc: DAC inverse sinc FIR status %u", InvSincModePtr);
-
-    // Print out the mixed mode
-    DACMixedMode = XRFdc_GetMixedMode(RFdcInstPtr, DAC_Tile, Block);
-    INFO("RF_RFdc: DAC mixed mode: %d", DACMixedMode);
-  }
+  printf("RF_RFdc: controller start-up took %.1f ms "
+         "(libmetal/driver %.1f, clocks %s%.1f, tiles %.1f, ADC %.1f, DAC %.1f)\n",
+         rfdc_elapsed_ms(&t_start),
+         t_libmetal,
+         full_init ? "" : "skipped ",
+         t_clocks,
+         t_tiles,
+         t_adc,
+         t_dac);
 
 /*
   // Register a callabck called from RFdc interrupt handler
@@ -1159,13 +1289,15 @@ int rf_xrfdc_start_rx_stream(void* h, bool now)
   pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
   handler->rx_streamer.items_in_buffer = 0;
   handler->rx_streamer.stream_active   = true;
+  // stream continuously, this also resumes a reader thread paused at the end of a finite capture
+  rf_rx_window_reset(&handler->rx_streamer.window);
 
   if (handler->rx_streamer.thread_completed) {
     // if rx thread was stopped before - restart it
     srsran_ringbuffer_start(&handler->rx_streamer.ring_buffer);
     pthread_create(&handler->rx_streamer.thread, NULL, reader_thread, handler);
   }
-  pthread_cond_signal(&handler->rx_streamer.stream_cvar);
+  pthread_cond_broadcast(&handler->rx_streamer.stream_cvar);
   pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
 
   // make sure thread has been started
@@ -1182,6 +1314,8 @@ static void stop_rx_stream(rf_xrfdc_handler_t* handler)
 {
   pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
   handler->rx_streamer.stream_active = false;
+  // wake up the reader thread if it's paused at the end of a finite capture
+  pthread_cond_broadcast(&handler->rx_streamer.stream_cvar);
 
   srs_dma_stop_streaming(&handler->rx_streamer._buf);
 
@@ -1190,6 +1324,7 @@ static void stop_rx_stream(rf_xrfdc_handler_t* handler)
   }
   pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
   pthread_join(handler->rx_streamer.thread, NULL);
+  handler->rx_streamer.thread = 0;
   srs_dma_destroy_buffers(&handler->rx_streamer._buf);
 }
 
@@ -1224,6 +1359,7 @@ static int rf_xrfdc_stop_tx_stream(void *h)
   pthread_mutex_unlock(&handler->tx_streamer.stream_mutex);
 
   pthread_join(handler->tx_streamer.thread, NULL);
+  handler->tx_streamer.thread = 0;
 
   srs_dma_stop_streaming(&handler->tx_streamer._buf);
   srs_dma_destroy_buffers(&handler->tx_streamer._buf);
@@ -1236,29 +1372,44 @@ static bool buffer_initialized(xrfdc_streamer *streamer)
   return (streamer->_buf.dma_buffer_pool_desc.addresses != NULL);
 }
 
-static void configure_timestamping(void* h, uint32_t nof_prbs)
+/*
+ * Samples per DMA packet: up to 30.72 MS/s they follow the LTE bandwidth of the n_prb argument, at the NR rates above
+ * it the packets last 0.5 ms so that the interrupt and header rate stays that of a 20 MHz carrier.
+ */
+static long rfdc_packet_size(uint32_t nof_prbs, double rate)
 {
-  bool                skip_rx_buf_reconfig  = false;
-  bool                skip_tx_buf_reconfig  = false;
-  rf_xrfdc_handler_t* handler               = (rf_xrfdc_handler_t*)h;
-  handler->use_timestamps                   = true;
-
-  handler->tx_streamer.metadata_samples = METADATA_NSAMPLES;
-  handler->rx_streamer.metadata_samples = METADATA_NSAMPLES / handler->rx_streamer.nof_channels;
-
   uint32_t sf_len = SRSRAN_SF_LEN_PRB(nof_prbs);
 
-  // determine rx_data_buffer_size
+  long size;
   if (nof_prbs <= 6) {
-    rx_data_buffer_size = MIN_DATA_BUFFER_SIZE;
+    size = MIN_DATA_BUFFER_SIZE;
   } else if (nof_prbs > 6 && nof_prbs <= 15) {
-    rx_data_buffer_size = MIN_DATA_BUFFER_SIZE * 2;
+    size = MIN_DATA_BUFFER_SIZE * 2;
   } else if (nof_prbs <= 25) {
-    rx_data_buffer_size = sf_len;
+    size = sf_len;
   } else {
-    rx_data_buffer_size = sf_len / 2;
+    size = sf_len / 2;
   }
-  tx_data_buffer_size       = rx_data_buffer_size;
+  if (rate > MAX_FPGA_SRATE) {
+    size = SRSRAN_MAX(size, (long)(rate / 2000));
+  }
+  return size;
+}
+
+static void configure_timestamping(void* h)
+{
+  bool                skip_rx_buf_reconfig  = false;
+  bool                skip_tx_buf_reconfig  = false;
+  rf_xrfdc_handler_t* handler               = (rf_xrfdc_handler_t*)h;
+  handler->use_timestamps                   = true;
+
+  handler->tx_streamer.metadata_samples = METADATA_NSAMPLES / handler->tx_streamer.nof_channels;
+  handler->rx_streamer.metadata_samples = METADATA_NSAMPLES / handler->rx_streamer.nof_channels;
+
+  long rx_data_buffer_size  = rfdc_packet_size(handler->n_prb, handler->rx_streamer._fs_hz);
+  long tx_data_buffer_size  = SRSRAN_MIN(rx_data_buffer_size,
+                                        (long)(RFDC_MAX_TX_BYTES / handler->tx_streamer._buf.sample_size) -
+                                            handler->tx_streamer.metadata_samples);
   long total_tx_buffer_size = tx_data_buffer_size + handler->tx_streamer.metadata_samples;
 
   if (handler->rx_streamer.buffer_size == rx_data_buffer_size) {
@@ -1321,19 +1472,68 @@ static void configure_timestamping(void* h, uint32_t nof_prbs)
 
 static int open_mem_register(void* h)
 {
-  rf_xrfdc_handler_t* handler  = (rf_xrfdc_handler_t*)h;
-  unsigned int        reg_size = 0x1F40;
-  off_t               reg_addr = 0x00A0040000;
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
   int                 mm_reg_d;
   // Map the MM-reg address into user space getting a virtual address for it
   if ((mm_reg_d = open("/dev/mem", O_RDWR | O_SYNC)) == -1) {
     ERROR("Error accessing the memory-mapped register");
     return -1;
   }
-  handler->memory_map_ptr = (uint32_t*)mmap(NULL, reg_size, PROT_READ | PROT_WRITE, MAP_SHARED, mm_reg_d, reg_addr);
+  void* ptr = mmap(NULL, MM_REG_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, mm_reg_d, MM_REG_ADDR);
+  close(mm_reg_d);
+  if (ptr == MAP_FAILED) {
+    ERROR("Error mapping the memory-mapped register");
+    return -1;
+  }
+  handler->memory_map_ptr = (uint32_t*)ptr;
   return 0;
 }
 
+// Parses the <tile>:<block> argument of a channel, if given
+static int rfdc_parse_converter(char* args, const char* key, uint32_t ch, rfdc_converter_t* c)
+{
+  char     value[RF_PARAM_LEN] = "";
+  unsigned tile                = 0;
+  unsigned block               = 0;
+  if (parse_string(args, key, ch, value) != SRSRAN_SUCCESS) {
+    return SRSRAN_SUCCESS;
+  }
+  if (sscanf(value, "%u:%u", &tile, &block) != 2 || tile >= RFDC_NOF_TILES || block >= RFDC_NOF_BLOCKS) {
+    ERROR("RF_RFdc: invalid %s%u=%s, expected <tile>:<block>", key, ch, value);
+    return SRSRAN_ERROR;
+  }
+  c->tile  = (u16)tile;
+  c->block = (u16)block;
+  return SRSRAN_SUCCESS;
+}
+
+/*
+ * Maps the RF channels to the converters. By default RX channel n is ADC tile n / 2 block n % 2, filling the dual
+ * ADC tiles of the ZU28DR, and TX channel n is DAC block n % 4 of tile 1, then of tile 0 from the fifth channel on.
+ * rx_chan<n>=<tile>:<block> and tx_chan<n>=<tile>:<block> override the converter of channel n.
+ */
+static int rfdc_parse_channel_map(rf_xrfdc_handler_t* handler, char* args)
+{
+  for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+    handler->rx_map[ch] = (rfdc_converter_t){.tile = ch / 2, .block = ch % 2};
+    handler->tx_map[ch] = (rfdc_converter_t){.tile = (1 + ch / 4) % 2, .block = ch % 4};
+    if (rfdc_parse_converter(args, "rx_chan", ch, &handler->rx_map[ch]) < SRSRAN_SUCCESS ||
+        rfdc_parse_converter(args, "tx_chan", ch, &handler->tx_map[ch]) < SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
+    }
+  }
+  for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+    for (uint32_t other = 0; other < ch; other++) {
+      if (!memcmp(&handler->rx_map[ch], &handler->rx_map[other], sizeof(rfdc_converter_t)) ||
+          !memcmp(&handler->tx_map[ch], &handler->tx_map[other], sizeof(rfdc_converter_t))) {
+        ERROR("RF_RFdc: channels %u and %u are mapped to the same converter", other, ch);
+        return SRSRAN_ERROR;
+      }
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
 int rf_xrfdc_open(char *args, void **h)
 {
   return rf_xrfdc_open_multi(args, h, 1);
@@ -1341,22 +1541,39 @@ int rf_xrfdc_open(char *args, void **h)
 
 int rf_xrfdc_open_multi(char* args, void** h, uint32_t nof_channels)
 {
-  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)malloc(sizeof(rf_xrfdc_handler_t));
-
-  if (!handler) {
-    fprintf(stderr, "Error allocating memory for RF\n");
-    return -1;
-  }
-  *h = handler;
+  *h = NULL;
 
   if (nof_channels == 0) {
     INFO("Warning: setting nof_channels to 1 by default (argument nof_channels=%u)\n", nof_channels);
     nof_channels = 1;
   }
-  if (nof_channels > 2) {
-    fprintf(stderr, "only 1 or 2 RF channels are supported (argument nof_channels=%u)\n", nof_channels);
+  // the 8 metadata words of a DMA packet must take whole items
+  if (nof_channels > RFDC_MAX_CHANNELS || METADATA_NSAMPLES % nof_channels) {
+    fprintf(stderr, "only 1, 2, 4 or 8 RF channels are supported (argument nof_channels=%u)\n", nof_channels);
+    return -1;
+  }
+
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)calloc(1, sizeof(rf_xrfdc_handler_t));
+  if (!handler) {
+    fprintf(stderr, "Error allocating memory for RF\n");
     return -1;
   }
+  *h = handler;
+  handler->nof_channels = nof_channels;
+
+  // what rf_xrfdc_close() releases is set up first, so that every failure below can go through it
+  const size_t sample_size = 2 * sizeof(uint16_t) * nof_channels;
+  handler->rx_streamer._buf.dma_device_fd = -1;
+  handler->tx_streamer._buf.dma_device_fd = -1;
+  pthread_mutex_init(&handler->rx_streamer.stream_mutex, NULL);
+  pthread_cond_init(&handler->rx_streamer.stream_cvar, NULL);
+  srsran_ringbuffer_init(&handler->rx_streamer.ring_buffer, 50000 * 1920);
+  pthread_mutex_init(&handler->tx_streamer.stream_mutex, NULL);
+  pthread_cond_init(&handler->tx_streamer.stream_cvar, NULL);
+  // a few ms at the highest rate, the application blocks while it is full
+  srsran_ringbuffer_init(&handler->tx_streamer.ring_buffer, (int)(4 * MAX_TXRX_SRATE / 1000) * (int)sample_size);
+  rf_cmd_queue_init(&handler->cmd_queue);
+  pthread_mutex_init(&handler->mixer_mutex, NULL);
 
   /// Handle rf arguments.
   uint32_t n_prb = 0;
@@ -1364,16 +1581,56 @@ int rf_xrfdc_open_multi(char* args, void** h, uint32_t nof_channels)
     // set to 6 PRBs if not provided by the user
     n_prb = 6;
   }
+  handler->n_prb = n_prb;
   char clock_source[RF_PARAM_LEN] = "internal";
   parse_string(args, "clock", 0, clock_source);
-
-  // Configure RFdc controller
-  if (configure_rfdc_controller(handler, clock_source) < 0) {
-    return -1;
+  // force_init=1 reprograms the clock tree and the tiles even if they already match the requested configuration
+  uint32_t force_init = 0;
+  parse_uint32(args, "force_init", 0, &force_init);
+  // record=<base path> streams the RX samples to <base path>.sigmf-data
+  char record_path[RF_PARAM_LEN] = "";
+  parse_string(args, "record", 0, record_path);
+  // rx_dc_corr, rx_iq_corr and rx_corr_alpha configure the RX correction, see rf_iq_corr.h
+  rf_iq_corr_init_args(handler->rx_corr, nof_channels, args);
+  // async_log=1 hands the log lines of all the threads to a low-priority thread, see async_logger.h
+  uint32_t async_log = 0;
+  parse_uint32(args, "async_log", 0, &async_log);
+  if (async_log) {
+    handler->async_log = srsran_async_log_start() == SRSRAN_SUCCESS;
+  }
+  // rx_zero_fill=<samples> fills RX timeline gaps up to that length with zeros, see rf_timeline.h
+  uint32_t rx_zero_fill = 0;
+  parse_uint32(args, "rx_zero_fill", 0, &rx_zero_fill);
+  rf_timeline_init(&handler->rx_streamer.timeline, rx_zero_fill);
+  // rx_max_latency_ms=<ms> or rx_max_latency_samples=<samples> bound the RX backlog, the oldest packets are dropped
+  parse_uint32(args, "rx_max_latency_ms", 0, &handler->rx_streamer.max_backlog_ms);
+  parse_uint32(args, "rx_max_latency_samples", 0, &handler->rx_streamer.max_backlog);
+  // rx_history_ms=<ms> retains the last RX samples for srsran_rf_recv_history(), see rf_history.h
+  uint32_t rx_history_ms = 0;
+  parse_uint32(args, "rx_history_ms", 0, &rx_history_ms);
+  rf_history_init(&handler->rx_streamer.history, rx_history_ms, sample_size);
+  // rx_chan<n>=<tile>:<block> and tx_chan<n>=<tile>:<block> select the converters of channel n
+  if (rfdc_parse_channel_map(handler, args) < SRSRAN_SUCCESS) {
+    goto out_error;
+  }
+  // cmd_lead_us=<us> applies the timed commands that long before their time, to cover the mixer update
+  handler->cmd_lead_us = RFDC_DEFAULT_CMD_LEAD_US;
+  parse_uint32(args, "cmd_lead_us", 0, &handler->cmd_lead_us);
+  // shm_server=<name> shares the RX and TX streams with other processes, see rf_shm_imp.h
+  char shm_name[RF_PARAM_LEN] = "";
+  parse_string(args, "shm_server", 0, shm_name);
+
+  struct timespec t_open;
+  clock_gettime(CLOCK_MONOTONIC, &t_open);
+
+  // Configure RFdc controller, the converters start at the LTE rates and set_fpga_srate() changes their factor
+  handler->rate_factor = XRFDC_INTERP_DECIM_8X;
+  if (configure_rfdc_controller(handler, clock_source, force_init != 0) < 0) {
+    goto out_error;
   }
   // map register memory of the centralized_AXI_controller
   if (open_mem_register(handler) < 0) {
-    return -1;
+    goto out_error;
   }
 
   handler->rx_streamer.parent = handler;
@@ -1381,22 +1638,16 @@ int rf_xrfdc_open_multi(char* args, void** h, uint32_t nof_channels)
 
   // open ADC DMA device descriptor
   if (open_srs_dma_device(&handler->rx_streamer, true, nof_channels) < 0) {
-    return -1;
+    goto out_error;
   }
   // open DAC DMA device descriptor
   if (open_srs_dma_device(&handler->tx_streamer, false, nof_channels) < 0) {
-    return -1;
+    goto out_error;
   }
 
-  pthread_mutex_init(&handler->rx_streamer.stream_mutex, NULL);
-  pthread_cond_init(&handler->rx_streamer.stream_cvar, NULL);
-  srsran_ringbuffer_init(&handler->rx_streamer.ring_buffer, 50000 * 1920);
   handler->rx_streamer.thread_completed = false;
   pthread_create(&handler->rx_streamer.thread, NULL, reader_thread, handler);
 
-  pthread_mutex_init(&handler->tx_streamer.stream_mutex, NULL);
-  pthread_cond_init(&handler->tx_streamer.stream_cvar, NULL);
-  srsran_ringbuffer_init(&handler->tx_streamer.ring_buffer, 200 * 1920);
   handler->tx_streamer.thread_completed = false;
   pthread_create(&handler->tx_streamer.thread, NULL, writer_thread, handler);
 
@@ -1406,31 +1657,150 @@ int rf_xrfdc_open_multi(char* args, void** h, uint32_t nof_channels)
   handler->rx_streamer.preamble_location = 0;
   handler->tx_streamer.preamble_location = 0;
 
-  configure_timestamping(handler, n_prb);
+  handler->rx_streamer.srate_switch_pending = false;
+  handler->rx_streamer.srate_switch_failed  = false;
+  rf_rx_window_reset(&handler->rx_streamer.window);
+  pthread_create(&handler->cmd_thread, NULL, cmd_thread, handler);
+  rf_inband_status_reset(&handler->rx_status);
+  bzero(&handler->rx_stats, sizeof(srsran_vec_stats_t));
+  bzero(&handler->tx_stats, sizeof(srsran_vec_stats_t));
+  handler->player   = NULL;
+  handler->recorder = NULL;
+  if (record_path[0]) {
+    handler->recorder = (rf_recorder_t*)malloc(sizeof(rf_recorder_t));
+    if (!handler->recorder || rf_recorder_init(handler->recorder, record_path, nof_channels) < SRSRAN_SUCCESS) {
+      free(handler->recorder);
+      handler->recorder = NULL;
+      goto out_error;
+    }
+  }
+  if (shm_name[0] && rf_shm_server_init(&handler->shm, shm_name, nof_channels, handler, client_tx) < SRSRAN_SUCCESS) {
+    goto out_error;
+  }
+  handler->tstamp_base                      = 0;
+  handler->time_base_secs                   = 0;
+  handler->time_base_frac                   = 0;
+
+  configure_timestamping(handler);
+
+  printf("RF_RFdc: radio bring-up took %.1f ms\n", rfdc_elapsed_ms(&t_open));
 
   return 0;
+
+out_error:
+  rf_xrfdc_close(handler);
+  *h = NULL;
+  return -1;
+}
+
+// The thread is woken up wherever it waits and joined, cancelling it could leave a ring buffer or logger lock held
+static void close_streamer_thread(xrfdc_streamer* streamer)
+{
+  if (streamer->thread) {
+    pthread_mutex_lock(&streamer->stream_mutex);
+    streamer->closing       = true;
+    streamer->stream_active = false;
+    pthread_cond_broadcast(&streamer->stream_cvar);
+    pthread_mutex_unlock(&streamer->stream_mutex);
+    srsran_ringbuffer_stop(&streamer->ring_buffer);
+    // aborts the DMA transfer the thread may be waiting for
+    srs_dma_stop_streaming(&streamer->_buf);
+    pthread_join(streamer->thread, NULL);
+    streamer->thread = 0;
+  }
 }
 
 int rf_xrfdc_close(void *h)
 {
   rf_xrfdc_handler_t *handler = (rf_xrfdc_handler_t*) h;
 
-  if(handler->tx_streamer.thread && !handler->tx_streamer.thread_completed) {
-    pthread_cancel(handler->tx_streamer.thread);
-  }
-  if(handler->rx_streamer.thread && !handler->rx_streamer.thread_completed) {
-    pthread_cancel(handler->rx_streamer.thread);
+  if (handler->player) {
+    // unblock the playback thread, the TX thread is about to be stopped
+    srsran_ringbuffer_stop(&handler->tx_streamer.ring_buffer);
+    rf_xrfdc_stop_playback(h);
+  }
+  // the clients see the server going away, its TX thread may be blocked on the TX ring buffer as well
+  if (rf_shm_server_enabled(&handler->shm)) {
+    srsran_ringbuffer_stop(&handler->tx_streamer.ring_buffer);
+    rf_shm_server_free(&handler->shm);
+  }
+  // the threads must be gone before the handler is freed
+  close_streamer_thread(&handler->tx_streamer);
+  close_streamer_thread(&handler->rx_streamer);
+  rf_timeline_t* timeline = &handler->rx_streamer.timeline;
+  uint64_t nof_dropped = srsran_ringbuffer_nof_dropped(&handler->rx_streamer.ring_buffer);
+  if (handler->rx_streamer.nof_backlog_drops) {
+    INFO("RF_RFdc: %lu RX samples dropped to bound the latency", (unsigned long)handler->rx_streamer.nof_backlog_drops);
+  }
+  if (nof_dropped) {
+    INFO("RF_RFdc: %lu RX packets dropped on a full ring buffer", (unsigned long)nof_dropped);
+  }
+  if (timeline->nof_gaps || timeline->nof_overlaps) {
+    INFO("RF_RFdc: RX timeline had %lu gaps (%lu samples lost, %lu zero-filled) and %lu overlaps",
+         (unsigned long)timeline->nof_gaps,
+         (unsigned long)timeline->nof_lost,
+         (unsigned long)timeline->nof_filled,
+         (unsigned long)timeline->nof_overlaps);
   }
   srs_dma_stop_streaming(&handler->rx_streamer._buf);
   srs_dma_stop_streaming(&handler->tx_streamer._buf);
   close_srs_dma_device(&handler->rx_streamer);
   close_srs_dma_device(&handler->tx_streamer);
+  rf_cmd_queue_stop(&handler->cmd_queue);
+  if (handler->cmd_thread) {
+    pthread_join(handler->cmd_thread, NULL);
+  }
+  rf_cmd_queue_free(&handler->cmd_queue);
+  pthread_mutex_destroy(&handler->mixer_mutex);
+  if (handler->recorder) {
+    rf_recorder_free(handler->recorder);
+    free(handler->recorder);
+    handler->recorder = NULL;
+  }
+  srsran_ringbuffer_free(&handler->rx_streamer.ring_buffer);
+  srsran_ringbuffer_free(&handler->tx_streamer.ring_buffer);
+  rf_history_free(&handler->rx_streamer.history);
+  for (int i = 0; i < SRSRAN_RINGBUFFER_MAX_TAPS; i++) {
+    free(handler->rx_streamer.consumers[i].buffer);
+  }
+  pthread_mutex_destroy(&handler->rx_streamer.stream_mutex);
+  pthread_mutex_destroy(&handler->tx_streamer.stream_mutex);
+  pthread_cond_destroy(&handler->rx_streamer.stream_cvar);
+  pthread_cond_destroy(&handler->tx_streamer.stream_cvar);
+  if (handler->memory_map_ptr) {
+    munmap((void*)handler->memory_map_ptr, MM_REG_SIZE);
+  }
+  if (handler->phy_deviceptr) {
+    metal_device_close(handler->phy_deviceptr);
+  }
+  if (handler->metal_ready) {
+    metal_finish();
+  }
+  // writes the lines still pending, the rings of the exited threads are freed
+  if (handler->async_log) {
+    srsran_async_log_stop();
+  }
+  free(handler);
   return SRSRAN_SUCCESS;
 }
 
+/*
+ * HW timestamps count samples at the current sampling rate. Every live rate switch moves the time base to the tick at
+ * which the new rate took effect, so that the time scale stays continuous across switches.
+ */
 uint64_t time_to_hw_tstamp(rf_xrfdc_handler_t* handler, time_t secs, double frac_secs)
 {
-  return (uint64_t)(handler->tx_streamer._fs_hz * ((double)secs)) +
+  secs -= handler->time_base_secs;
+  frac_secs -= handler->time_base_frac;
+  if (frac_secs < 0) {
+    frac_secs += 1.0;
+    secs--;
+  }
+  // times before the last rate switch have no tick at the current rate, they map to the switch itself
+  if (secs < 0) {
+    return handler->tstamp_base;
+  }
+  return handler->tstamp_base + (uint64_t)(handler->tx_streamer._fs_hz * ((double)secs)) +
          (uint64_t)(round((double)handler->tx_streamer._fs_hz * frac_secs));
 }
 
@@ -1438,11 +1808,162 @@ void hw_tstamp_to_time(rf_xrfdc_handler_t* handler, uint64_t tstamp, time_t* sec
 {
   uint64_t srate_int = (uint64_t)handler->rx_streamer._fs_hz;
   uint64_t remainder = 0;
+  uint64_t ticks     = (tstamp > handler->tstamp_base) ? tstamp - handler->tstamp_base : 0;
   if (secs && frac_secs) {
-    *secs      = tstamp / srate_int;
-    remainder  = tstamp % srate_int;
-    *frac_secs = (double)remainder / srate_int;
+    *secs      = handler->time_base_secs + ticks / srate_int;
+    remainder  = ticks % srate_int;
+    *frac_secs = handler->time_base_frac + (double)remainder / srate_int;
+    if (*frac_secs >= 1.0) {
+      *frac_secs -= 1.0;
+      (*secs)++;
+    }
+  }
+}
+
+/*
+ * Splits a sampling rate between the converters and the FPGA. The FPGA decimation chain takes the 245.76 MS/s of the
+ * 8x converters down to at most 30.72 MS/s (2048 points at 15 kHz), so the NR rates above it, 61.44 and 122.88 MS/s
+ * (2048 points at 30 and 60 kHz, or 4096 and 8192 at 15 kHz), lower the converter factor to 4x or 2x instead.
+ */
+static int rfdc_rate_plan(double rate, u32* factor, uint32_t* symbol_sz)
+{
+  double fpga_rate = rate;
+  *factor          = XRFDC_INTERP_DECIM_8X;
+  while (fpga_rate > MAX_FPGA_SRATE + 1 && *factor > XRFDC_INTERP_DECIM_2X) {
+    *factor /= 2;
+    fpga_rate /= 2;
+  }
+  *symbol_sz = (uint32_t)(fpga_rate / 1e3) / 15;
+  if (!srsran_symbol_sz_isvalid(*symbol_sz) || fabs(fpga_rate - 15e3 * *symbol_sz) > 1) {
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+// Applies a decimation and interpolation factor to the converters of all the channels
+static int rfdc_set_rate_factor(rf_xrfdc_handler_t* handler, u32 factor)
+{
+  XRFdc* RFdcInstPtr = &handler->RFdcInst;
+  for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+    const rfdc_converter_t* adc = &handler->rx_map[ch];
+    const rfdc_converter_t* dac = &handler->tx_map[ch];
+    if (XRFdc_SetDecimationFactor(RFdcInstPtr, adc->tile, adc->block, factor) != XRFDC_SUCCESS ||
+        XRFdc_SetInterpolationFactor(RFdcInstPtr, dac->tile, dac->block, factor) != XRFDC_SUCCESS) {
+      ERROR("RF_RFdc: Failed to set the %ux decimation and interpolation of channel %u", factor, ch);
+      // put the channels already changed back to the current factor, so that all the converters keep the same one
+      for (uint32_t i = 0; i <= ch; i++) {
+        const rfdc_converter_t* rx = &handler->rx_map[i];
+        const rfdc_converter_t* tx = &handler->tx_map[i];
+        if (XRFdc_SetDecimationFactor(RFdcInstPtr, rx->tile, rx->block, handler->rate_factor) != XRFDC_SUCCESS ||
+            XRFdc_SetInterpolationFactor(RFdcInstPtr, tx->tile, tx->block, handler->rate_factor) != XRFDC_SUCCESS) {
+          ERROR("RF_RFdc: Failed to restore the %ux factor of channel %u", handler->rate_factor, i);
+        }
+      }
+      return SRSRAN_ERROR;
+    }
+  }
+  handler->rate_factor = factor;
+  INFO("RF_RFdc: converters set to %ux decimation and interpolation", factor);
+  return SRSRAN_SUCCESS;
+}
+
+// Programs the converter factor and the FPGA baseband rate (expressed as FFT size) and waits for the MMCM to lock
+static int set_fpga_srate(rf_xrfdc_handler_t* handler, double rate)
+{
+  u32      factor    = 0;
+  uint32_t symbol_sz = 0;
+  if (rfdc_rate_plan(rate, &factor, &symbol_sz) < SRSRAN_SUCCESS) {
+    ERROR("RF_RFdc: invalid sampling rate requested");
+    return SRSRAN_ERROR;
+  }
+  u32      prev_factor    = handler->rate_factor;
+  uint32_t prev_symbol_sz = handler->memory_map_ptr[4];
+  if (factor != prev_factor && rfdc_set_rate_factor(handler, factor) < SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
+  }
+  handler->memory_map_ptr[4] = symbol_sz;
+
+  //read back and print current FPGA RFdc FFT size
+  INFO("RF_RFdc: current RFdc NFFT = %u", handler->memory_map_ptr[4]);
+
+  // wait until MMCM generating baseband clock locks
+  uint32_t wait_us = 0;
+  while (!handler->memory_map_ptr[263]) {
+    usleep(100);
+    wait_us += 100;
+    if (wait_us >= MMCM_LOCK_TIMEOUT_US) {
+      ERROR("RF_RFdc: MMCM didn't lock after %u us, keeping %.2f MHz", wait_us, handler->rx_streamer._fs_hz / 1e6);
+      // go back to the previous rate, the caller keeps the current time base
+      handler->memory_map_ptr[4] = prev_symbol_sz;
+      if (factor != prev_factor) {
+        rfdc_set_rate_factor(handler, prev_factor);
+      }
+      return SRSRAN_ERROR;
+    }
+  }
+  INFO("RF_RFdc: MMCM locked");
+  handler->rx_streamer._fs_hz = rate;
+  return SRSRAN_SUCCESS;
+}
+
+/*
+ * Live sampling rate switch, executed by the reader thread between two packets. The packetizer is paused at a packet
+ * boundary and the DMA queue is flushed and re-armed, dropping the packets already captured at the old rate, while the
+ * DMA buffer pool stays allocated and mapped and the thread keeps running.
+ */
+static void switch_rx_srate(rf_xrfdc_handler_t* handler, const tx_header_t* last_header)
+{
+  xrfdc_streamer* streamer = &handler->rx_streamer;
+
+  srs_dma_stop_streaming(&streamer->_buf);
+  srsran_ringbuffer_reset(&streamer->ring_buffer);
+  rf_timeline_reset(&streamer->timeline);
+
+  // the first sample at the new rate follows the last delivered one, its time is taken at the old rate
+  uint64_t switch_tstamp = handler->tstamp_base;
+  time_t   switch_secs   = handler->time_base_secs;
+  double   switch_frac   = handler->time_base_frac;
+  if (last_header->nof_samples) {
+    switch_tstamp = last_header->timestamp + last_header->nof_samples;
+    hw_tstamp_to_time(handler, switch_tstamp, &switch_secs, &switch_frac);
+  }
+
+  // a failed switch leaves the previous rate in place, the time base and the timed commands are still valid
+  streamer->srate_switch_failed = set_fpga_srate(handler, streamer->pending_fs_hz) < SRSRAN_SUCCESS;
+  if (streamer->srate_switch_failed) {
+    handler->rx_status.present = false;
+    srs_dma_start_streaming(&streamer->_buf);
+    pthread_mutex_lock(&streamer->stream_mutex);
+    streamer->srate_switch_pending = false;
+    pthread_cond_broadcast(&streamer->stream_cvar);
+    pthread_mutex_unlock(&streamer->stream_mutex);
+    return;
   }
+
+  // pending timed commands refer to the old time scale
+  uint32_t nof_dropped_cmds = rf_cmd_queue_clear(&handler->cmd_queue);
+  if (nof_dropped_cmds) {
+    INFO("RF_RFdc: %u timed commands dropped by the srate switch", nof_dropped_cmds);
+  }
+  handler->tstamp_base    = switch_tstamp;
+  handler->time_base_secs = switch_secs;
+  handler->time_base_frac = switch_frac;
+  handler->tx_streamer._fs_hz = streamer->_fs_hz;
+  rf_history_set_srate(&streamer->history, streamer->_fs_hz);
+  if (rf_shm_server_enabled(&handler->shm)) {
+    rf_shm_server_set_time(
+        &handler->shm, streamer->_fs_hz, handler->tstamp_base, handler->time_base_secs, handler->time_base_frac);
+  }
+  // the FPGA status counters restart with the MMCM reset, take a new reference from the next header
+  handler->rx_status.present = false;
+
+  srs_dma_start_streaming(&streamer->_buf);
+
+  pthread_mutex_lock(&streamer->stream_mutex);
+  streamer->srate_switch_pending = false;
+  pthread_cond_broadcast(&streamer->stream_cvar);
+  pthread_mutex_unlock(&streamer->stream_mutex);
+  INFO("RF_RFdc: RX srate switched to %.2f MHz", streamer->_fs_hz / 1e6);
 }
 
 double rf_xrfdc_set_rx_srate(void *h, double rate)
@@ -1450,6 +1971,33 @@ double rf_xrfdc_set_rx_srate(void *h, double rate)
   rf_xrfdc_handler_t *handler = (rf_xrfdc_handler_t*) h;
   bool stream_needs_restart = false;
 
+  // the live switch keeps the converter factor and the DMA packets, other rates go through a stream restart
+  u32      factor    = 0;
+  uint32_t symbol_sz = 0;
+  bool     same_plan = rfdc_rate_plan(rate, &factor, &symbol_sz) == SRSRAN_SUCCESS && factor == handler->rate_factor &&
+                   rfdc_packet_size(handler->n_prb, rate) == handler->rx_streamer.buffer_size;
+
+  // while streaming, let the reader thread switch the rate at a packet boundary without tearing the stream down
+  pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
+  if (same_plan && handler->rx_streamer.stream_active && !handler->rx_streamer.thread_completed &&
+      buffer_initialized(&handler->rx_streamer)) {
+    handler->rx_streamer.pending_fs_hz        = rate;
+    handler->rx_streamer.srate_switch_pending = true;
+    while (handler->rx_streamer.srate_switch_pending && !handler->rx_streamer.thread_completed) {
+      pthread_cond_wait(&handler->rx_streamer.stream_cvar, &handler->rx_streamer.stream_mutex);
+    }
+    bool switched = !handler->rx_streamer.srate_switch_pending;
+    handler->rx_streamer.srate_switch_pending = false;
+    pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
+    if (switched) {
+      // invalidate any partially read data packet
+      handler->rx_streamer.prev_header.nof_samples = 0;
+      return handler->rx_streamer.srate_switch_failed ? (double)handler->rx_streamer._fs_hz : rate;
+    }
+  } else {
+    pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
+  }
+
   if (handler->rx_streamer.stream_active) {
     stream_needs_restart = true;
     // stop receiving samples while reconfiguring RF frontend
@@ -1462,29 +2010,19 @@ double rf_xrfdc_set_rx_srate(void *h, double rate)
   }
   INFO("RF_RFdc: changing srate %s", stream_needs_restart ? "RX stream paused" : "");
 
-  uint32_t req_sf_nsamples = (uint32_t) (rate / 1e3);
-  uint32_t symbol_sz       = req_sf_nsamples / 15;
-  if (srsran_symbol_sz_isvalid(symbol_sz)) {
-    handler->memory_map_ptr[4] = symbol_sz;
-
-    //read back and print current FPGA RFdc FFT size
-    INFO("RF_RFdc: current RFdc NFFT = %u", handler->memory_map_ptr[4]);
-    handler->rx_streamer._fs_hz = rate;
-
-    // wait until MMCM generating baseband clock locks
-    while(!handler->memory_map_ptr[263]) {
-      usleep(100);
-    }
-    INFO("RF_RFdc: MMCM locked");
-  } else {
-    ERROR("RF_RFdc: invalid sampling rate requested");
+  // on failure the previous rate, if any, stays in place and is reported to the caller
+  bool srate_set = set_fpga_srate(handler, rate) == SRSRAN_SUCCESS;
+  if (!handler->rx_streamer._fs_hz) {
+    return SRSRAN_ERROR;
   }
+  // resize the DMA packets for the new rate
+  configure_timestamping(handler);
 
   if (stream_needs_restart) {
     //restart the RX stream
     rf_xrfdc_start_rx_stream(handler, true);
   }
-  return rate;
+  return srate_set ? rate : (double)handler->rx_streamer._fs_hz;
 }
 
 double rf_xrfdc_set_tx_srate(void *h, double freq)
@@ -1518,35 +2056,37 @@ double rf_xrfdc_get_tx_gain(void *h)
   return 60.0f;
 }
 
-double rf_xrfdc_set_rx_freq(void* h, uint32_t ch, double freq)
+// Returns the converter serving the given channel, NULL if it is out of range
+static const rfdc_converter_t* rfdc_channel(rf_xrfdc_handler_t* handler, bool is_tx, uint32_t ch)
 {
-  rf_xrfdc_handler_t* handler     = (rf_xrfdc_handler_t*)h;
-  XRFdc*              RFdcInstPtr = &handler->RFdcInst;
+  if (ch >= handler->nof_channels) {
+    ERROR("RF_RFdc: %s channel %u is out of range (%u channels are open)",
+          is_tx ? "TX" : "RX",
+          ch,
+          handler->nof_channels);
+    return NULL;
+  }
+  return is_tx ? &handler->tx_map[ch] : &handler->rx_map[ch];
+}
 
-  u16 ADC_Tile = 0;
-  if (ch > 1) {
-    printf("Warning! channel (%d) specifying in set_rx_freq is out of range (ADC [0 1] are supported)\n"
-           "Using ADC0 by default\n",
-           ch);
+/*
+ * Writes the NCO configuration for the requested carrier. With XRFDC_EVNT_SRC_TILE the new settings are held in the
+ * shadow registers until rfdc_trigger_mixer() generates the tile event, so they can be prepared ahead of time.
+ */
+static int rfdc_stage_mixer(rf_xrfdc_handler_t* handler, bool is_tx, uint32_t ch, double freq)
+{
+  XRFdc*                  RFdcInstPtr = &handler->RFdcInst;
+  const rfdc_converter_t* c           = rfdc_channel(handler, is_tx, ch);
+  if (c == NULL) {
+    return SRSRAN_ERROR;
   }
-  u16 Block = (ch > 1) ? 0 : ch; // if channel is out of range, let's use ADC0 by default
 
-  if (!XRFdc_IsADCBlockEnabled(RFdcInstPtr, ADC_Tile, Block)) {
-    INFO("RF_RFdc: ADC%d is not enabled, make sure the RFdc was initialized before", Block);
-    // try another ADC channel
-    Block = (Block + 1) % 2;
-    if (!XRFdc_IsADCBlockEnabled(RFdcInstPtr, ADC_Tile, Block)) {
-      ERROR("RF_RFdc: Couldn't find any enabled ADC channel! returning...");
-      return -1;
-    } else {
-      INFO("RF_RFdc: Using ADC%d instead of requested channel", Block);
-    }
-  }
-  // Define our desired ADC mixer configuration
-  XRFdc_Mixer_Settings adcMixerSettings = {
+  // Define our desired mixer configuration
+  XRFdc_Mixer_Settings mixerSettings = {
       .CoarseMixFreq  = XRFDC_COARSE_MIX_OFF,   // we are not using a coarse mixer type
       .MixerType      = XRFDC_MIXER_TYPE_FINE,  // we are using a fine mixer type
-      .MixerMode      = XRFDC_MIXER_MODE_R2C,   // we will receive a real signal and return an I/Q pair
+      .MixerMode      = is_tx ? XRFDC_MIXER_MODE_C2R  // we will send an I/Q pair and forward a real signal
+                              : XRFDC_MIXER_MODE_R2C, // we will receive a real signal and return an I/Q pair
       .PhaseOffset    = 0,                      // NCO phase = 0
       .FineMixerScale = XRFDC_MIXER_SCALE_AUTO, // the fine mixer scale will be auto updated
       .EventSource    = XRFDC_EVNT_SRC_TILE};
@@ -1555,32 +2095,67 @@ double rf_xrfdc_set_rx_freq(void* h, uint32_t ch, double freq)
   // we want our signal to be centered at 2.4576 GHz (NCO freq) -> 2457.6 (Fc) - 1966.08 MHz (Fs) = 491.52 MHz
   if (freq_in_MHz < 2 * RFDC_PLL_FREQ) {
     // positive sign used for frequencies in [0; fs] range, negative in [fs; 2*fs]
-    adcMixerSettings.Freq = RFDC_PLL_FREQ - freq_in_MHz;
-    INFO("RF_RFdc: configuring ADC Mixer: requested = %f, NCO freq = %f", freq_in_MHz, adcMixerSettings.Freq);
+    mixerSettings.Freq = RFDC_PLL_FREQ - freq_in_MHz;
   } else {
-    adcMixerSettings.Freq = (2 * RFDC_PLL_FREQ) - freq_in_MHz; // 2xFs (3932.16MHz) - (Fc)
-    INFO("RF_RFdc: configuring ADC Mixer: requested = %f, NCO freq = %f", freq_in_MHz, adcMixerSettings.Freq);
+    mixerSettings.Freq = (2 * RFDC_PLL_FREQ) - freq_in_MHz; // 2xFs (3932.16MHz) - (Fc)
   }
+  INFO("RF_RFdc: configuring %s Mixer: requested = %f, NCO freq = %f",
+       is_tx ? "DAC" : "ADC",
+       freq_in_MHz,
+       mixerSettings.Freq);
 
+  if (is_tx) {
+    mixerSettings.Freq = (-1) * mixerSettings.Freq; // inverse
+  }
   // Set our desired NCO configuration;
-  u32 Status = XRFdc_SetMixerSettings(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, &adcMixerSettings);
-  if (Status != XRFDC_SUCCESS) {
-    ERROR("RFdc: Failed to set ADC NCO settings");
-    return -1;
+  if (XRFdc_SetMixerSettings(
+          RFdcInstPtr, is_tx ? XRFDC_DAC_TILE : XRFDC_ADC_TILE, c->tile, c->block, &mixerSettings) != XRFDC_SUCCESS) {
+    ERROR("RFdc: Failed to set %s NCO settings", is_tx ? "DAC" : "ADC");
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+// Resets the NCO phase and generates the tile event applying the staged mixer settings
+static void rfdc_trigger_mixer(rf_xrfdc_handler_t* handler, bool is_tx, uint32_t ch)
+{
+  XRFdc*                  RFdcInstPtr = &handler->RFdcInst;
+  const rfdc_converter_t* c           = rfdc_channel(handler, is_tx, ch);
+  u32                     Type        = is_tx ? XRFDC_DAC_TILE : XRFDC_ADC_TILE;
+  if (c == NULL) {
+    return;
   }
+  XRFdc_ResetNCOPhase(RFdcInstPtr, Type, c->tile, c->block);
+  XRFdc_UpdateEvent(RFdcInstPtr, Type, c->tile, c->block, XRFDC_EVENT_MIXER);
+}
+
+double rf_xrfdc_set_rx_freq(void* h, uint32_t ch, double freq)
+{
+  rf_xrfdc_handler_t* handler     = (rf_xrfdc_handler_t*)h;
+  XRFdc*              RFdcInstPtr = &handler->RFdcInst;
 
-  // Reset NCO phase of the DDC
-  XRFdc_ResetNCOPhase(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block);
-  // Generate a Tile Event
-  XRFdc_UpdateEvent(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, XRFDC_EVENT_MIXER);
+  // a timed command prepared in the shadow registers would be overwritten
+  pthread_mutex_lock(&handler->mixer_mutex);
+  rf_cmd_queue_unstage(&handler->cmd_queue);
+  if (rfdc_stage_mixer(handler, false, ch, freq) < SRSRAN_SUCCESS) {
+    pthread_mutex_unlock(&handler->mixer_mutex);
+    return -1;
+  }
+  rfdc_trigger_mixer(handler, false, ch);
+  pthread_mutex_unlock(&handler->mixer_mutex);
+  if (handler->recorder) {
+    rf_recorder_set_freq(handler->recorder, freq, RF_RECORDER_NO_TSTAMP);
+  }
 
   // Print out the configured mixer frequency
-  Status = XRFdc_GetMixerSettings(RFdcInstPtr, XRFDC_ADC_TILE, ADC_Tile, Block, &adcMixerSettings);
+  const rfdc_converter_t* adc              = rfdc_channel(handler, false, ch);
+  XRFdc_Mixer_Settings    adcMixerSettings = {};
+  u32 Status = XRFdc_GetMixerSettings(RFdcInstPtr, XRFDC_ADC_TILE, adc->tile, adc->block, &adcMixerSettings);
   if (Status != XRFDC_SUCCESS) {
     ERROR("RFdc: GetMixerSettings failed");
     return -1;
   }
-  INFO("RF_RFdc: ADC%d Mixer Frequency set to %.03f", Block, adcMixerSettings.Freq);
+  INFO("RF_RFdc: ADC tile %u channel %u Mixer Frequency set to %.03f", adc->tile, adc->block, adcMixerSettings.Freq);
 
   return freq;
 }
@@ -1590,54 +2165,111 @@ double rf_xrfdc_set_tx_freq(void* h, uint32_t ch, double freq)
   rf_xrfdc_handler_t* handler     = (rf_xrfdc_handler_t*)h;
   XRFdc*              RFdcInstPtr = &handler->RFdcInst;
 
-  // Define our desired DAC mixer configuration
-  XRFdc_Mixer_Settings dacMixerSettings = {
-      .CoarseMixFreq  = XRFDC_COARSE_MIX_OFF,   // we are not using a coarse mixer type
-      .MixerType      = XRFDC_MIXER_TYPE_FINE,  // we are using a fine mixer type
-      .MixerMode      = XRFDC_MIXER_MODE_C2R,   // we will send an I/Q pair and forward a real signal
-      .PhaseOffset    = 0,                      // NCO phase = 0
-      .FineMixerScale = XRFDC_MIXER_SCALE_AUTO, // the fine mixer scale will be auto updated
-      .EventSource    = XRFDC_EVNT_SRC_TILE};
+  pthread_mutex_lock(&handler->mixer_mutex);
+  rf_cmd_queue_unstage(&handler->cmd_queue);
+  if (rfdc_stage_mixer(handler, true, ch, freq) < SRSRAN_SUCCESS) {
+    pthread_mutex_unlock(&handler->mixer_mutex);
+    return -1;
+  }
+  rfdc_trigger_mixer(handler, true, ch);
+  pthread_mutex_unlock(&handler->mixer_mutex);
 
-  double freq_in_MHz = freq / 1000000.0;
-  if (freq_in_MHz < 2 * RFDC_PLL_FREQ) {
-    // positive sign used for frequencies in [0; fs] range, negative in [fs; 2*fs]
-    dacMixerSettings.Freq = RFDC_PLL_FREQ - freq_in_MHz;
-    INFO("RF_RFdc: configuring DAC Mixer: requested = %f, NCO freq = %f", freq_in_MHz, dacMixerSettings.Freq);
-  } else {
-    dacMixerSettings.Freq = (2 * RFDC_PLL_FREQ) - freq_in_MHz; // 2xFs (3932.16MHz) - (Fc)
-    INFO("RF_RFdc: configuring DAC Mixer: requested = %f, NCO freq = %f", freq_in_MHz, dacMixerSettings.Freq);
+  // Print out the configured mixer frequency
+  const rfdc_converter_t* dac                  = rfdc_channel(handler, true, ch);
+  XRFdc_Mixer_Settings    set_dacMixerSettings = {};
+  int Status = XRFdc_GetMixerSettings(RFdcInstPtr, XRFDC_DAC_TILE, dac->tile, dac->block, &set_dacMixerSettings);
+  if (Status != XRFDC_SUCCESS) {
+    ERROR("RFdc: GetMixerSettings failed");
+    return -1;
   }
-  dacMixerSettings.Freq = (-1) * dacMixerSettings.Freq; // inverse
+  INFO("RF_RFdc: DAC tile %u channel %u Mixer Frequency set to %.03f",
+       dac->tile,
+       dac->block,
+       set_dacMixerSettings.Freq);
+  return freq;
+}
 
-  u16 Tile = 1;
-  for (u16 Block = 0; Block < 4; Block++) {
-    if (!XRFdc_IsDACBlockEnabled(RFdcInstPtr, Tile, Block)) {
-      continue;
-    }
+int rf_xrfdc_queue_cmd_timed(void* h, const srsran_rf_cmd_t* cmd, time_t secs, double frac_secs)
+{
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
 
-    // Set our desired NCO configuration;
-    int Status = XRFdc_SetMixerSettings(RFdcInstPtr, XRFDC_DAC_TILE, Tile, Block, &dacMixerSettings);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("RFdc: Failed to set DAC NCO settings");
-      return -1;
+  if (cmd->type == SRSRAN_RF_CMD_RX_GAIN || cmd->type == SRSRAN_RF_CMD_TX_GAIN) {
+    // Not supported by RFSoC
+    return SRSRAN_ERROR;
+  }
+  // the time scale is set by the RX stream, without it the command has no tick to be compared to
+  if (!handler->rx_streamer.stream_active) {
+    INFO("RF_RFdc: RX stream not running, applying command immediately");
+    return (cmd->type == SRSRAN_RF_CMD_RX_FREQ ? rf_xrfdc_set_rx_freq(h, cmd->ch, cmd->value)
+                                               : rf_xrfdc_set_tx_freq(h, cmd->ch, cmd->value)) < 0
+               ? SRSRAN_ERROR
+               : SRSRAN_SUCCESS;
+  }
+  // rejected now rather than when it is due, where the error would not reach the caller
+  if (rfdc_channel(handler, cmd->type == SRSRAN_RF_CMD_TX_FREQ, cmd->ch) == NULL) {
+    return SRSRAN_ERROR;
+  }
+  if (rf_cmd_queue_push(&handler->cmd_queue, cmd, time_to_hw_tstamp(handler, secs, frac_secs)) < SRSRAN_SUCCESS) {
+    ERROR("RF_RFdc: timed command queue is full");
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/*
+ * Triggers the commands whose tick is reached by now plus the lead time and prepares the next one, so that only the
+ * tile event is left to be generated on time.
+ */
+static void apply_timed_cmds(rf_xrfdc_handler_t* handler, uint64_t now)
+{
+  rf_timed_cmd_t tc;
+  pthread_mutex_lock(&handler->mixer_mutex);
+  while (rf_cmd_queue_pop_due(&handler->cmd_queue, now, &tc)) {
+    bool is_tx = (tc.cmd.type == SRSRAN_RF_CMD_TX_FREQ);
+    if (tc.staged || rfdc_stage_mixer(handler, is_tx, tc.cmd.ch, tc.cmd.value) == SRSRAN_SUCCESS) {
+      rfdc_trigger_mixer(handler, is_tx, tc.cmd.ch);
+      if (!is_tx && handler->recorder) {
+        rf_recorder_set_freq(handler->recorder, tc.cmd.value, tc.tick);
+      }
+    }
+    DEBUG("RF_RFdc: timed command applied at tick %" PRIu64 " (scheduled %" PRIu64 ")", now, tc.tick);
+  }
+  if (rf_cmd_queue_stage_next(&handler->cmd_queue, &tc)) {
+    if (rfdc_stage_mixer(handler, tc.cmd.type == SRSRAN_RF_CMD_TX_FREQ, tc.cmd.ch, tc.cmd.value) < SRSRAN_SUCCESS) {
+      rf_cmd_queue_unstage(&handler->cmd_queue);
     }
+  }
+  pthread_mutex_unlock(&handler->mixer_mutex);
+}
 
-    // Reset NCO phase of the DUC
-    XRFdc_ResetNCOPhase(RFdcInstPtr, XRFDC_DAC_TILE, Tile, Block);
-    // Generate a Tile Event
-    XRFdc_UpdateEvent(RFdcInstPtr, XRFDC_DAC_TILE, Tile, Block, XRFDC_EVENT_MIXER);
+// FPGA timestamp counter, the high word is read again in case the low one wrapped between both reads
+static uint64_t get_current_hw_clock(rf_xrfdc_handler_t* handler)
+{
+  uint32_t high_reg = handler->memory_map_ptr[230];
+  uint32_t low_reg  = handler->memory_map_ptr[229];
+  while (high_reg != handler->memory_map_ptr[230]) {
+    high_reg = handler->memory_map_ptr[230];
+    low_reg  = handler->memory_map_ptr[229];
+  }
+  return ((uint64_t)high_reg << 32u) | low_reg;
+}
 
-    // Print out the configured mixer frequency
-    XRFdc_Mixer_Settings set_dacMixerSettings = {};
-    Status = XRFdc_GetMixerSettings(RFdcInstPtr, XRFDC_DAC_TILE, Tile, Block, &set_dacMixerSettings);
-    if (Status != XRFDC_SUCCESS) {
-      ERROR("RFdc: GetMixerSettings failed");
-      return -1;
-    }
-    INFO("RF_RFdc: DAC%d Mixer Frequency set to %.03f", Block, set_dacMixerSettings.Freq);
+/*
+ * The commands are compared against the live FPGA counter rather than the timestamp of the last RX packet, which went
+ * through the whole DMA buffering, and the mixer programming stays off the RX reader thread.
+ */
+static void* cmd_thread(void* arg)
+{
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)arg;
+  uint32_t            wait_us = 0;
+
+  while (rf_cmd_queue_wait(&handler->cmd_queue, wait_us)) {
+    double   srate = (double)handler->rx_streamer._fs_hz;
+    uint64_t now   = get_current_hw_clock(handler) + (uint64_t)(srate * handler->cmd_lead_us / 1e6);
+    apply_timed_cmds(handler, now);
+    wait_us = rf_cmd_queue_wait_us(&handler->cmd_queue, now, srate);
   }
-  return freq;
+  return NULL;
 }
 
 srsran_rf_info_t* rf_xrfdc_get_info(void* h)
@@ -1650,11 +2282,81 @@ srsran_rf_info_t* rf_xrfdc_get_info(void* h)
   return info;
 }
 
+int rf_xrfdc_issue_stream_cmd(void* h, const srsran_rf_stream_cmd_t* cmd)
+{
+  rf_xrfdc_handler_t* handler  = (rf_xrfdc_handler_t*)h;
+  xrfdc_streamer*     streamer = &handler->rx_streamer;
+
+  if (cmd->mode == SRSRAN_RF_STREAM_MODE_STOP && !cmd->has_time_spec) {
+    return rf_xrfdc_stop_rx_stream(h);
+  }
+  if (cmd->has_time_spec && !handler->use_timestamps) {
+    ERROR("RF_RFdc: timed stream commands require timestamping");
+    return SRSRAN_ERROR;
+  }
+  // an empty finite capture would otherwise arm a continuous window
+  if (cmd->mode == SRSRAN_RF_STREAM_MODE_NUM_SAMPS_AND_DONE && cmd->nof_samples == 0) {
+    ERROR("RF_RFdc: a finite capture needs at least one sample");
+    return SRSRAN_ERROR;
+  }
+  // the requested window is enforced by the reader thread
+  if (cmd->mode != SRSRAN_RF_STREAM_MODE_STOP && (!streamer->stream_active || streamer->thread_completed)) {
+    rf_xrfdc_start_rx_stream(h, !cmd->has_time_spec);
+  }
+  uint64_t tick = cmd->has_time_spec ? time_to_hw_tstamp(handler, cmd->secs, cmd->frac_secs) : 0;
+
+  pthread_mutex_lock(&streamer->stream_mutex);
+  rf_rx_window_arm(&streamer->window, cmd, tick);
+  pthread_cond_broadcast(&streamer->stream_cvar);
+  // wait until the reader thread dropped the samples buffered before the command
+  while (streamer->window.flush && !streamer->thread_completed) {
+    pthread_cond_wait(&streamer->stream_cvar, &streamer->stream_mutex);
+  }
+  pthread_mutex_unlock(&streamer->stream_mutex);
+  streamer->prev_header.nof_samples = 0;
+  return SRSRAN_SUCCESS;
+}
+
+/*
+ * Called by the reader thread once a finite capture is complete: signals the end of the burst to the consumer and
+ * pauses the packetizer and the DMA until a new stream command, a rate switch or the end of the stream.
+ */
+static void finish_rx_window(rf_xrfdc_handler_t* handler)
+{
+  xrfdc_streamer* streamer = &handler->rx_streamer;
+
+  pthread_mutex_lock(&streamer->stream_mutex);
+  bool first_call       = !streamer->window.done;
+  streamer->window.done = true;
+  pthread_mutex_unlock(&streamer->stream_mutex);
+  if (first_call) {
+    tx_header_t eob = {
+        .magic = PKT_HEADER_MAGIC, .timestamp = streamer->window.end, .nof_samples = 0, .end_of_burst = true};
+    srsran_ringbuffer_part_t part = {&eob, sizeof(tx_header_t)};
+    srsran_ringbuffer_write_packet(&streamer->ring_buffer, &part, 1, 0);
+    if (rf_shm_server_enabled(&handler->shm)) {
+      rf_shm_server_push_rx(&handler->shm, streamer->window.end, NULL, 0, true);
+    }
+  }
+  srs_dma_stop_streaming(&streamer->_buf);
+  rf_timeline_reset(&streamer->timeline);
+
+  pthread_mutex_lock(&streamer->stream_mutex);
+  while (streamer->stream_active && streamer->window.done && !streamer->srate_switch_pending) {
+    pthread_cond_wait(&streamer->stream_cvar, &streamer->stream_mutex);
+  }
+  pthread_mutex_unlock(&streamer->stream_mutex);
+  if (streamer->stream_active) {
+    srs_dma_start_streaming(&streamer->_buf);
+  }
+}
+
 static inline bool match_preamble(uint32_t* input)
 {
   if (input[0] == common_preamble1 && input[1] == common_preamble2 &&
       input[2] == common_preamble3 && input[3] == time_preamble1 &&
-      input[4] == time_preamble2   && input[5] == time_preamble3) {
+      input[4] == time_preamble2   &&
+      (input[5] == time_preamble3 || rf_inband_status_match(input[5]))) {
     return true;
   }
   return false;
@@ -1663,22 +2365,25 @@ static inline bool match_preamble(uint32_t* input)
 static void *reader_thread(void *arg)
 {
   uint32_t nof_timestamping_errors = 0;
-  uint32_t nof_overflow_errors     = 0;
   rf_xrfdc_handler_t *handler = (rf_xrfdc_handler_t*) arg;
   struct sched_param param;
   param.sched_priority = sched_get_priority_max(SCHED_FIFO);
   pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
 
   pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
-  while(!handler->rx_streamer.stream_active) {
+  while (!handler->rx_streamer.stream_active && !handler->rx_streamer.closing) {
     pthread_cond_wait(&handler->rx_streamer.stream_cvar, &handler->rx_streamer.stream_mutex);
   }
+  if (handler->rx_streamer.closing) {
+    pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
+    goto exit;
+  }
 
   if(!buffer_initialized(&handler->rx_streamer)) {
     if (srs_dma_allocate_buffers(&handler->rx_streamer._buf,
-                                 rx_data_buffer_size + handler->rx_streamer.metadata_samples) < 0) {
+                                 handler->rx_streamer.buffer_size + handler->rx_streamer.metadata_samples) < 0) {
       ERROR("RF_RFdc: Failed to create DMA buffer of length %d. Can not start streaming\n",
-            rx_data_buffer_size + handler->rx_streamer.metadata_samples);
+            (int)(handler->rx_streamer.buffer_size + handler->rx_streamer.metadata_samples));
       goto exit;
     }
     srs_dma_start_streaming(&handler->rx_streamer._buf);
@@ -1686,12 +2391,35 @@ static void *reader_thread(void *arg)
   }
 
   handler->rx_streamer.thread_completed = false;
+  rf_timeline_reset(&handler->rx_streamer.timeline);
+  rf_history_set_srate(&handler->rx_streamer.history, handler->rx_streamer._fs_hz);
+  if (rf_shm_server_enabled(&handler->shm)) {
+    rf_shm_server_set_time(&handler->shm,
+                           handler->rx_streamer._fs_hz,
+                           handler->tstamp_base,
+                           handler->time_base_secs,
+                           handler->time_base_frac);
+  }
   pthread_cond_signal(&handler->rx_streamer.stream_cvar);
   pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
 
-  tx_header_t header = {};
+  tx_header_t  header      = {};
+  const size_t sample_size = 2 * sizeof(uint16_t) * handler->rx_streamer.nof_channels;
 
   while (handler->rx_streamer.stream_active) {
+    if (handler->rx_streamer.srate_switch_pending) {
+      switch_rx_srate(handler, &header);
+      header.nof_samples = 0;
+    }
+    if (handler->rx_streamer.window.flush) {
+      // a new stream command was issued, drop what was buffered before it
+      pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
+      srsran_ringbuffer_reset(&handler->rx_streamer.ring_buffer);
+      rf_timeline_reset(&handler->rx_streamer.timeline);
+      handler->rx_streamer.window.flush = false;
+      pthread_cond_broadcast(&handler->rx_streamer.stream_cvar);
+      pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
+    }
     int buffer_ret = refill_buffer(&handler->rx_streamer, &handler->rx_streamer.buf_count);
     if (buffer_ret <= 0) {
       /* If stream is not active, no need to report an error,
@@ -1711,7 +2439,7 @@ static void *reader_thread(void *arg)
 
     if (handler->use_timestamps) {
       if (!match_preamble(&start_ptr[handler->rx_streamer.preamble_location])) {
-        printf("misaligned packet received from the DMA\n");
+        ERROR("RF_RFdc: misaligned packet received from the DMA");
         nof_timestamping_errors++;
         if (nof_timestamping_errors == 20) {
           break;
@@ -1720,6 +2448,11 @@ static void *reader_thread(void *arg)
       }
       uint64_t* tstamp = (uint64_t*)&(start_ptr[handler->rx_streamer.preamble_location + 6]);
       header.timestamp = *tstamp;
+      uint32_t status_word = start_ptr[handler->rx_streamer.preamble_location + 5];
+      if (rf_inband_status_match(status_word) && rf_inband_status_parse(&handler->rx_status, status_word)) {
+        INFO("RF_RFdc: Overflow detected (FIFO level %u)", handler->rx_status.fifo_level);
+        log_overflow(handler);
+      }
 #ifdef PRINT_TIMESTAMPS
       time_t secs;
       double frac_secs;
@@ -1727,38 +2460,110 @@ static void *reader_thread(void *arg)
 
       struct timeval time;
       gettimeofday(&time, NULL);
-      if(firstGo < 5) {
+      if(handler->nof_ts_prints < 5) {
         if(frac_secs && secs) {
           printf("rec sec %lu frac %f or %lu ticks  [%4d] [%d] \n", secs, frac_secs, header.timestamp, time.tv_usec,time.tv_sec);
         }
       }
 #endif
     }
-    srsran_ringbuffer_write(&handler->rx_streamer.ring_buffer, &header, sizeof(tx_header_t));
+
+    // keep only the samples requested by the last stream command
+    uint32_t offset          = 0;
+    bool     window_finished = false;
+    if (handler->use_timestamps) {
+      uint64_t end_tstamp = header.timestamp + header.nof_samples;
+      pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
+      bool in_window  = rf_rx_window_clip(
+          &handler->rx_streamer.window, header.timestamp, header.nof_samples, &offset, &header.nof_samples);
+      window_finished = rf_rx_window_finished(&handler->rx_streamer.window, end_tstamp);
+      pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
+      if (!in_window) {
+        if (window_finished) {
+          finish_rx_window(handler);
+        }
+        continue;
+      }
+      header.timestamp += offset;
+    }
 
     uint16_t* buf_ptr_tmp = (uint16_t*) src_ptr;
     uint16_t* buf_ptr =
-        &buf_ptr_tmp[handler->rx_streamer.metadata_samples * handler->rx_streamer._buf.sample_size / sizeof(uint16_t)];
-
-    int ret = srsran_ringbuffer_write(
-            &handler->rx_streamer.ring_buffer,
-            buf_ptr, 2 * sizeof(uint16_t) * handler->rx_streamer.buf_count * handler->rx_streamer.nof_channels);
+        &buf_ptr_tmp[handler->rx_streamer.metadata_samples * handler->rx_streamer._buf.sample_size / sizeof(uint16_t) +
+                     2 * offset * handler->rx_streamer.nof_channels];
+    if (handler->recorder) {
+      rf_recorder_push(handler->recorder,
+                       handler->use_timestamps ? header.timestamp : RF_RECORDER_NO_TSTAMP,
+                       handler->rx_streamer._fs_hz,
+                       buf_ptr,
+                       header.nof_samples);
+    }
+
+    // check the packet against the end of the previous one
+    int64_t  diff = handler->use_timestamps ? rf_timeline_check(&handler->rx_streamer.timeline, header.timestamp) : 0;
+    uint32_t fill = 0;
+    if (diff < 0) {
+      if ((uint64_t)-diff < header.nof_samples) {
+        // the start of the packet was already delivered
+        buf_ptr += 2 * (uint32_t)-diff * handler->rx_streamer.nof_channels;
+        header.timestamp += (uint64_t)-diff;
+        header.nof_samples -= (uint32_t)-diff;
+        INFO("RF_RFdc: RX timeline overlap of %ld samples", (long)-diff);
+      } else {
+        // the timestamps went back by more than a packet, start a new timeline rather than dropping everything
+        ERROR("RF_RFdc: RX timestamp went back by %ld samples", (long)-diff);
+        diff = 0;
+      }
+    } else if (diff > 0) {
+      INFO("RF_RFdc: RX timeline gap of %ld samples", (long)diff);
+      uint64_t nof_unreported = rf_timeline_unreported(&handler->rx_streamer.timeline, header.timestamp, diff);
+      if (nof_unreported) {
+        log_gap(handler, nof_unreported);
+      }
+      if (diff <= handler->rx_streamer.timeline.max_fill) {
+        fill = (uint32_t)diff;
+      }
+    }
 
-    if (ret < 2 * sizeof(uint16_t) * handler->rx_streamer.buf_count * handler->rx_streamer.nof_channels) {
-      ERROR("RF_RFdc: Error writing to buffer in rx thread, ret is %d but should be %d", ret,
-             (int)(2 * sizeof(uint16_t) * handler->rx_streamer.buf_count * handler->rx_streamer.nof_channels));
-      nof_overflow_errors++;
-      if (nof_overflow_errors == 20) {
-        break;
+    // the zero fill goes with the packet as long as both fit, the space only grows until the write below
+    if (fill && (size_t)srsran_ringbuffer_space(&handler->rx_streamer.ring_buffer) <
+                    2 * sizeof(tx_header_t) + sample_size * (fill + header.nof_samples)) {
+      fill = 0;
+    }
+    tx_header_t fill_header = {.magic = PKT_HEADER_MAGIC, .timestamp = header.timestamp - fill, .nof_samples = fill};
+    srsran_ringbuffer_part_t parts[] = {{&fill_header, sizeof(tx_header_t)},
+                                        {NULL, (int)(sample_size * fill)},
+                                        {&header, sizeof(tx_header_t)},
+                                        {buf_ptr, (int)(sample_size * header.nof_samples)}};
+    if (srsran_ringbuffer_write_packet(
+            &handler->rx_streamer.ring_buffer, fill ? parts : &parts[2], fill ? 4 : 2, 0) < 0) {
+      // dropped whole and reported here, the timeline is not advanced so that the next packet zero-fills the samples
+      INFO("RF_RFdc: RX ring buffer full, packet of %u samples dropped", header.nof_samples);
+      log_overflow(handler);
+      if (handler->use_timestamps) {
+        rf_timeline_drop(&handler->rx_streamer.timeline, header.timestamp, header.nof_samples);
       }
+    } else if (handler->use_timestamps) {
+      rf_timeline_advance(&handler->rx_streamer.timeline, diff, fill, header.timestamp, header.nof_samples);
+    }
+    if (handler->use_timestamps) {
+      // the history keeps the packets the ring buffer had no room for, a gap restarts it
+      rf_history_push(&handler->rx_streamer.history, header.timestamp, buf_ptr, header.nof_samples);
+    }
+    if (rf_shm_server_enabled(&handler->shm)) {
+      // the clients read their own copy, whatever room the ring buffer had
+      rf_shm_server_push_rx(&handler->shm, header.timestamp, buf_ptr, header.nof_samples, false);
+    }
+    if (window_finished) {
+      finish_rx_window(handler);
     }
   }
 exit:
   pthread_mutex_lock(&handler->rx_streamer.stream_mutex);
   handler->rx_streamer.thread_completed = true;
-  pthread_cond_signal(&handler->rx_streamer.stream_cvar);
+  pthread_cond_broadcast(&handler->rx_streamer.stream_cvar);
   pthread_mutex_unlock(&handler->rx_streamer.stream_mutex);
-  if (nof_timestamping_errors || nof_overflow_errors) {
+  if (nof_timestamping_errors) {
     printf("stopping RF rx stream because of errors\n");
     stop_rx_stream(handler);
     srsran_ringbuffer_stop(&handler->rx_streamer.ring_buffer);
@@ -1766,6 +2571,15 @@ exit:
   return NULL;
 }
 
+// Samples the RX ring buffer may hold before the oldest packets are dropped, 0 if unbounded
+static uint64_t rx_max_backlog(const xrfdc_streamer* streamer)
+{
+  if (streamer->max_backlog) {
+    return streamer->max_backlog;
+  }
+  return (uint64_t)streamer->max_backlog_ms * (uint64_t)streamer->_fs_hz / 1000;
+}
+
 int rf_xrfdc_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
 {
   return rf_xrfdc_recv_with_time_multi(h, &data, nsamples, blocking, secs, frac_secs);
@@ -1780,9 +2594,18 @@ int rf_xrfdc_recv_with_time_multi(void*            h,
 {
   rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
 
-  size_t rxd_samples_total = 0;
-  int    trials            = 0;
-  cf_t*  data_ptr          = data[0];
+  size_t   rxd_samples_total = 0;
+  int      trials            = 0;
+  bool     end_of_burst      = false;
+  uint64_t first_tstamp      = handler->rx_streamer.prev_header.timestamp;
+  uint64_t max_backlog       = rx_max_backlog(&handler->rx_streamer);
+  uint64_t nof_dropped       = 0;
+  uint64_t dropped_tstamp    = 0;
+
+  if (2 * nsamples * handler->rx_streamer.nof_channels > CONVERT_BUFFER_SIZE) {
+    ERROR("RF_RFdc: cannot receive %u samples at once", nsamples);
+    return SRSRAN_ERROR;
+  }
 
   while (rxd_samples_total < nsamples && trials < 100) {
     if (!handler->rx_streamer.prev_header.nof_samples) {
@@ -1801,8 +2624,33 @@ int rf_xrfdc_recv_with_time_multi(void*            h,
         srsran_ringbuffer_reset(&handler->rx_streamer.ring_buffer);
         return SRSRAN_ERROR;
       }
+      if (handler->rx_streamer.prev_header.end_of_burst) {
+        // finite capture completed, return what is left of it
+        handler->rx_streamer.prev_header.end_of_burst = false;
+        if (!rxd_samples_total) {
+          first_tstamp = handler->rx_streamer.prev_header.timestamp;
+        }
+        end_of_burst = true;
+        break;
+      }
+      // the application fell behind, drop the oldest packets to get back close to real time
+      size_t sample_size = 2 * sizeof(uint16_t) * handler->rx_streamer.nof_channels;
+      if (max_backlog && !rxd_samples_total &&
+          srsran_ringbuffer_status(&handler->rx_streamer.ring_buffer) / sample_size > max_backlog) {
+        if (!nof_dropped) {
+          dropped_tstamp = handler->rx_streamer.prev_header.timestamp;
+        }
+        nof_dropped += handler->rx_streamer.prev_header.nof_samples;
+        srsran_ringbuffer_discard(&handler->rx_streamer.ring_buffer,
+                                  sample_size * handler->rx_streamer.prev_header.nof_samples);
+        handler->rx_streamer.prev_header.nof_samples = 0;
+        continue;
+      }
     }
 
+    if (!rxd_samples_total) {
+      first_tstamp = handler->rx_streamer.prev_header.timestamp;
+    }
     uint32_t read_samples = SRSRAN_MIN(handler->rx_streamer.prev_header.nof_samples, nsamples - rxd_samples_total);
 
     int nof_read_samples = srsran_ringbuffer_read_timed(
@@ -1815,16 +2663,22 @@ int rf_xrfdc_recv_with_time_multi(void*            h,
       ERROR("Error reading samples from ringbuffer");
       return SRSRAN_ERROR;
     }
+    // the header keeps the tick of the next sample left in the ring buffer
     handler->rx_streamer.prev_header.nof_samples -= read_samples;
-
-    if (read_samples != nsamples) {
-      handler->rx_streamer.prev_header.timestamp -= rxd_samples_total;
-    }
+    handler->rx_streamer.prev_header.timestamp += read_samples;
 
     rxd_samples_total += read_samples;
     trials++;
   }
-  hw_tstamp_to_time(handler, handler->rx_streamer.prev_header.timestamp, secs, frac_secs);
+  if (nof_dropped) {
+    INFO("RF_RFdc: RX backlog over %lu samples, %lu samples dropped from tick %lu",
+         (unsigned long)max_backlog,
+         (unsigned long)nof_dropped,
+         (unsigned long)dropped_tstamp);
+    handler->rx_streamer.nof_backlog_drops += nof_dropped;
+    log_gap(handler, nof_dropped);
+  }
+  hw_tstamp_to_time(handler, first_tstamp, secs, frac_secs);
 #ifdef PRINT_TIMESTAMPS
   struct timeval time;
   gettimeofday(&time, NULL);
@@ -1833,41 +2687,171 @@ int rf_xrfdc_recv_with_time_multi(void*            h,
     // handler->rx_streamer.prev_header.timestamp, time.tv_usec,time.tv_sec);
     INFO("receive timestamp = %.6lf secs, or %lu ticks\n",
          (double)*secs + *frac_secs,
-         handler->rx_streamer.prev_header.timestamp);
+         first_tstamp);
   }
 #endif
-  srsran_vec_convert_if(&handler->rx_streamer._conv_buffer[0], 32768, (float*)data_ptr, 2 * rxd_samples_total);
+  // the channels are split from the interleaved DMA items by the conversion itself
+  srsran_vec_stats_t stats = {};
+  rf_iq_corr_convert_multi(handler->rx_corr,
+                           handler->rx_streamer._conv_buffer,
+                           32768,
+                           (float**)data,
+                           handler->rx_streamer.nof_channels,
+                           rxd_samples_total,
+                           &stats);
+  handler->rx_stats = stats;
+  // INFO("RX timestamp = %lu \n", handler->rx_streamer.prev_header.timestamp);
+  return end_of_burst ? (int)rxd_samples_total : (int)nsamples;
+}
+
+int rf_xrfdc_recv_history(void* h, void** data, uint32_t nsamples, time_t secs, double frac_secs)
+{
+  rf_xrfdc_handler_t* handler  = (rf_xrfdc_handler_t*)h;
+  xrfdc_streamer*     streamer = &handler->rx_streamer;
 
-  if (handler->rx_streamer.nof_channels > 1) {
-    data_ptr = data[1];
-    srsran_vec_convert_if(
-        &handler->rx_streamer._conv_buffer[2 * rxd_samples_total], 32768, (float*)data_ptr, 2 * rxd_samples_total);
+  if (!rf_history_enabled(&streamer->history) || !handler->use_timestamps) {
+    return SRSRAN_ERROR;
   }
-  // INFO("RX timestamp = %lu \n", handler->rx_streamer.prev_header.timestamp);
-  return (int)nsamples;
+  int16_t* buffer = srsran_vec_malloc(2 * sizeof(int16_t) * nsamples * streamer->nof_channels);
+  if (!buffer) {
+    return SRSRAN_ERROR;
+  }
+  int ret = rf_history_read(&streamer->history, time_to_hw_tstamp(handler, secs, frac_secs), buffer, nsamples);
+  if (ret == SRSRAN_SUCCESS) {
+    // same layout as the samples read by rf_xrfdc_recv_with_time_multi()
+    rf_iq_corr_apply_multi(handler->rx_corr, buffer, 32768, (float**)data, streamer->nof_channels, nsamples);
+  }
+  free(buffer);
+  return ret;
 }
 
-void check_late_register(void* h, uint32_t* late_reg_value)
+// Secondary RX consumers are taps of the ring buffer, see srsran_rf_open_rx_consumer()
+int rf_xrfdc_open_rx_consumer(void* h, srsran_rf_consumer_policy_t policy)
 {
   rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
-  // BA + 0x380
-  *late_reg_value = handler->memory_map_ptr[224];
+
+  srsran_ringbuffer_tap_policy_t tap_policy =
+      (policy == SRSRAN_RF_CONSUMER_HOLD) ? SRSRAN_RINGBUFFER_TAP_HOLD : SRSRAN_RINGBUFFER_TAP_SKIP;
+  int consumer = srsran_ringbuffer_tap_open(&handler->rx_streamer.ring_buffer, tap_policy);
+  if (consumer < 0) {
+    ERROR("RF_RFdc: all the RX consumers are in use");
+    return SRSRAN_ERROR;
+  }
+  handler->rx_streamer.consumers[consumer].header.nof_samples = 0;
+  return consumer;
 }
-/*
-static uint64_t get_current_hw_clock(void* h)
+
+// Must not be called while the consumer is reading
+int rf_xrfdc_close_rx_consumer(void* h, int consumer)
+{
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
+
+  if (consumer < 0 || consumer >= SRSRAN_RINGBUFFER_MAX_TAPS) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  srsran_ringbuffer_tap_close(&handler->rx_streamer.ring_buffer, consumer);
+  rx_consumer_t* c = &handler->rx_streamer.consumers[consumer];
+  free(c->buffer);
+  c->buffer     = NULL;
+  c->buffer_len = 0;
+  return SRSRAN_SUCCESS;
+}
+
+int rf_xrfdc_recv_consumer(void* h, int consumer, void** data, uint32_t nsamples, time_t* secs, double* frac_secs)
 {
   rf_xrfdc_handler_t* handler  = (rf_xrfdc_handler_t*)h;
-  uint64_t            low_reg  = handler->memory_map_ptr[229];
-  uint64_t            high_reg = handler->memory_map_ptr[230];
-  return ((high_reg << 32u) | low_reg);
-}*/
+  xrfdc_streamer*     streamer = &handler->rx_streamer;
+
+  if (consumer < 0 || consumer >= SRSRAN_RINGBUFFER_MAX_TAPS) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  rx_consumer_t* c           = &streamer->consumers[consumer];
+  size_t         sample_size = 2 * sizeof(uint16_t) * streamer->nof_channels;
+  if (nsamples > c->buffer_len) {
+    free(c->buffer);
+    c->buffer     = srsran_vec_malloc(sample_size * nsamples);
+    c->buffer_len = c->buffer ? nsamples : 0;
+    if (!c->buffer) {
+      return SRSRAN_ERROR;
+    }
+  }
+
+  uint32_t rxd_samples_total = 0;
+  uint64_t first_tstamp      = c->header.timestamp;
+  bool     end_of_burst      = false;
+  while (rxd_samples_total < nsamples) {
+    int ret;
+    if (!c->header.nof_samples) {
+      ret = srsran_ringbuffer_tap_read_timed(&streamer->ring_buffer, consumer, &c->header, sizeof(tx_header_t), 1000);
+      if (ret > 0 && c->header.magic != PKT_HEADER_MAGIC) {
+        ERROR("RF_RFdc: invalid header read by RX consumer %d", consumer);
+        c->header.nof_samples = 0;
+        return SRSRAN_ERROR;
+      }
+      if (ret > 0 && c->header.end_of_burst) {
+        if (!rxd_samples_total) {
+          first_tstamp = c->header.timestamp;
+        }
+        c->header.nof_samples = 0;
+        end_of_burst          = true;
+        break;
+      }
+    } else {
+      if (!rxd_samples_total) {
+        first_tstamp = c->header.timestamp;
+      }
+      uint32_t read_samples = SRSRAN_MIN(c->header.nof_samples, nsamples - rxd_samples_total);
+      int16_t* dst          = &c->buffer[sample_size / sizeof(int16_t) * rxd_samples_total];
+
+      ret = srsran_ringbuffer_tap_read_timed(&streamer->ring_buffer, consumer, dst, sample_size * read_samples, 1000);
+      if (ret > 0) {
+        c->header.nof_samples -= read_samples;
+        c->header.timestamp += read_samples;
+        rxd_samples_total += read_samples;
+      }
+    }
+    if (ret == SRSRAN_ERROR_OUT_OF_BOUNDS) {
+      // the consumer skipped ahead, start over from the next packet
+      c->header.nof_samples = 0;
+      rxd_samples_total     = 0;
+    } else if (ret <= 0) {
+      return SRSRAN_ERROR;
+    }
+  }
+
+  hw_tstamp_to_time(handler, first_tstamp, secs, frac_secs);
+  // same layout as the samples read by rf_xrfdc_recv_with_time_multi()
+  rf_iq_corr_apply_multi(handler->rx_corr, c->buffer, 32768, (float**)data, streamer->nof_channels, rxd_samples_total);
+  return end_of_burst ? (int)rxd_samples_total : (int)nsamples;
+}
+
+int rf_xrfdc_get_consumer_stats(void* h, int consumer, srsran_rf_consumer_stats_t* stats)
+{
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
+
+  int    count       = 0;
+  size_t sample_size = 2 * sizeof(uint16_t) * handler->rx_streamer.nof_channels;
+  if (srsran_ringbuffer_tap_stats(
+          &handler->rx_streamer.ring_buffer, consumer, &count, &stats->nof_overruns, &stats->nof_lost) < 0) {
+    return SRSRAN_ERROR;
+  }
+  // the packet headers are counted as well, they are small compared to the payload
+  stats->lag = (uint64_t)count / sample_size;
+  stats->nof_lost /= sample_size;
+  return SRSRAN_SUCCESS;
+}
 
+void check_late_register(void* h, uint32_t* late_reg_value)
+{
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
+  // BA + 0x380
+  *late_reg_value = handler->memory_map_ptr[224];
+}
 static int send_buf(void *h, size_t sample_size)
 {
   rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
 
-  int total_tx_size = handler->tx_streamer.items_in_buffer * sample_size +
-                      handler->tx_streamer.metadata_samples * 4u;
+  int total_tx_size = (handler->tx_streamer.items_in_buffer + handler->tx_streamer.metadata_samples) * sample_size;
 
   int ret = srs_dma_send_data(&handler->tx_streamer._buf, total_tx_size);
 
@@ -1886,10 +2870,12 @@ static void *writer_thread(void *arg)
   int      read_samples   = 0;
   uint64_t timestamp      = 0;
   bool     have_timestamp = false;
-  size_t   sample_size    = sample_size = 2 * sizeof(uint16_t); // size of a quantized IQ pair
+  size_t   sample_size    = handler->tx_streamer._buf.sample_size; // a quantized IQ pair of each channel
+  uint32_t nof_lates_seen = 0; // late bursts already accounted from the in-band status
+  int      lates          = 0; // late bursts not logged yet
 
   pthread_mutex_lock(&handler->tx_streamer.stream_mutex);
-  while(!handler->tx_streamer.stream_active) {
+  while (!handler->tx_streamer.stream_active && !handler->tx_streamer.closing) {
     pthread_cond_wait(&handler->tx_streamer.stream_cvar, &handler->tx_streamer.stream_mutex);
   }
   pthread_mutex_unlock(&handler->tx_streamer.stream_mutex);
@@ -1902,13 +2888,17 @@ static void *writer_thread(void *arg)
 
       uintptr_t dst_ptr =
           (uintptr_t)srs_dma_get_data_ptr(&handler->tx_streamer._buf) +
-          (handler->tx_streamer.metadata_samples + handler->tx_streamer.items_in_buffer) * 2 * sizeof(int16_t);
+          (handler->tx_streamer.metadata_samples + handler->tx_streamer.items_in_buffer) * sample_size;
 
       if(!handler->tx_streamer.prev_header.nof_samples) {
         if (srsran_ringbuffer_read(
                 &handler->tx_streamer.ring_buffer, &handler->tx_streamer.prev_header, sizeof(tx_header_t)) < 0) {
           fprintf(stderr,"Error reading buffer\n");
         }
+        if (handler->tx_streamer.closing) {
+          // the ring buffer was stopped, nothing was read
+          break;
+        }
         if (handler->tx_streamer.prev_header.magic != PKT_HEADER_MAGIC) {
           fprintf(stderr, "Error reading tx ringbuffer. Invalid header\n");
           srsran_ringbuffer_reset(&handler->tx_streamer.ring_buffer);
@@ -1953,7 +2943,7 @@ static void *writer_thread(void *arg)
 
         /// Add packet header
         unsigned dma_length_bytes =
-            (handler->tx_streamer.items_in_buffer + handler->tx_streamer.metadata_samples) * 4u - 1u;
+            (handler->tx_streamer.items_in_buffer + handler->tx_streamer.metadata_samples) * sample_size - 1u;
         start_ptr[0] = common_preamble1;
         start_ptr[1] = common_preamble2;
         start_ptr[2] = common_preamble3_short | (dma_length_bytes << 16u);
@@ -1968,9 +2958,9 @@ static void *writer_thread(void *arg)
         struct timeval time;
         gettimeofday(&time, NULL);
         tstamp_to_time_iio(handler, *tstamp_ptr, &secs, &frac_secs);
-        if(firstGo < 20) {
+        if(handler->nof_ts_prints < 20) {
           printf("send sec %d frac %f or %d ticks  [%4d] [%d] \n",secs,frac_secs,timestamp, time.tv_usec,time.tv_sec);
-          firstGo++;
+          handler->nof_ts_prints++;
         }
 #endif
         /// Submit buffer to DMA engine
@@ -1985,7 +2975,12 @@ static void *writer_thread(void *arg)
           handler->tx_streamer.items_in_buffer = 0;
         }
         uint32_t late_reg_value = 0;
-        if(handler->memory_map_ptr) {
+        if (handler->rx_status.present && handler->rx_streamer.stream_active) {
+          // late bursts are reported by the RX metadata headers, no need to poll the FPGA
+          uint32_t nof_lates = handler->rx_status.nof_lates;
+          late_reg_value     = nof_lates - nof_lates_seen;
+          nof_lates_seen     = nof_lates;
+        } else if(handler->memory_map_ptr) {
           check_late_register(handler, &late_reg_value);
         }
         if (late_reg_value) {
@@ -2013,7 +3008,7 @@ int rf_xrfdc_send_timed(void*              h,
                         bool               is_start_of_burst,
                         bool               is_end_of_burst)
 {
-  void* _data[SRSRAN_MAX_PORTS] = {data, zero_mem, zero_mem, zero_mem};
+  void* _data[RFDC_MAX_CHANNELS] = {data};
   return rf_xrfdc_send_timed_multi(
       h, _data, nsamples, secs, frac_secs, has_time_spec, blocking, is_start_of_burst, is_end_of_burst);
 }
@@ -2031,34 +3026,51 @@ int rf_xrfdc_send_timed_multi(void*              h,
   tx_header_t         header  = {};
   rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
 
+  if (2 * nsamples * handler->tx_streamer.nof_channels > CONVERT_BUFFER_SIZE ||
+      nsamples > sizeof(zero_mem) / sizeof(cf_t)) {
+    ERROR("RF_RFdc: cannot send %d samples at once", nsamples);
+    return SRSRAN_ERROR;
+  }
   if (!handler->tx_streamer.stream_active) {
     rf_xrfdc_start_tx_stream(h);
   }
 #ifdef PRINT_TIMESTAMPS
   struct timeval time;
   gettimeofday(&time, NULL);
-  if (firstGo < 5) {
+  if (handler->nof_ts_prints < 5) {
     printf("init send sec %d frac %f [%4d] [%d] \n", secs, frac_secs, time.tv_usec, time.tv_sec);
-    firstGo++;
+    handler->nof_ts_prints++;
   }
 #endif
   int n      = 0;
   int trials = 0;
 
+  size_t sample_size = handler->tx_streamer._buf.sample_size;
   do {
-    float* samples_cf32 = (float*)&(((cf_t**)data)[0][n]);
-
-    srsran_vec_convert_fi(samples_cf32, 32767.999f, handler->tx_streamer._conv_buffer, 2 * nsamples);
+    // the channels are interleaved in the DMA items by the conversion itself, missing ones are sent as zeros
+    float* samples_cf32[RFDC_MAX_CHANNELS] = {};
+    for (uint32_t ch = 0; ch < handler->tx_streamer.nof_channels; ch++) {
+      samples_cf32[ch] = data[ch] ? (float*)&((cf_t*)data[ch])[n] : (float*)zero_mem;
+    }
+    srsran_vec_stats_t stats = {};
+    srsran_vec_convert_fi_interleave_stats(samples_cf32,
+                                           32767.999f,
+                                           handler->tx_streamer._conv_buffer,
+                                           handler->tx_streamer.nof_channels,
+                                           nsamples,
+                                           &stats);
+    handler->tx_stats = stats;
 
     header.magic        = PKT_HEADER_MAGIC;
     header.nof_samples  = nsamples;
     header.timestamp    = time_to_hw_tstamp(handler, secs, frac_secs);
     header.end_of_burst = is_end_of_burst;
 
-    srsran_ringbuffer_write_block(&handler->tx_streamer.ring_buffer, &header, sizeof(tx_header_t));
-    // Each sample is a pair of quantized 16bit values, i.e. I and Q
-    srsran_ringbuffer_write_block(
-        &handler->tx_streamer.ring_buffer, (void*)(handler->tx_streamer._conv_buffer), sizeof(uint16_t) * 2 * nsamples);
+    // Each sample is a pair of quantized 16bit values, i.e. I and Q, of each channel. The playback thread may be
+    // writing too, the header and its samples go in as one packet
+    srsran_ringbuffer_part_t parts[] = {{&header, sizeof(tx_header_t)},
+                                        {handler->tx_streamer._conv_buffer, (int)(sample_size * nsamples)}};
+    srsran_ringbuffer_write_packet(&handler->tx_streamer.ring_buffer, parts, 2, -1);
 
     n += nsamples;
     trials++;
@@ -2067,6 +3079,72 @@ int rf_xrfdc_send_timed_multi(void*              h,
   return n;
 }
 
+static void playback_tx(void* h, uint64_t tstamp, const int16_t* sc16, uint32_t nof_samples, bool end_of_burst)
+{
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
+  tx_header_t header = {
+      .magic = PKT_HEADER_MAGIC, .timestamp = tstamp, .nof_samples = nof_samples, .end_of_burst = end_of_burst};
+
+  // the samples are already quantized, no srsran_vec_convert_fi() on this path
+  srsran_ringbuffer_part_t parts[] = {{&header, sizeof(tx_header_t)},
+                                      {sc16, (int)(handler->tx_streamer._buf.sample_size * nof_samples)}};
+  srsran_ringbuffer_write_packet(&handler->tx_streamer.ring_buffer, parts, 2, -1);
+}
+
+// TX packets of the shared memory clients, queued like the playback ones
+static void client_tx(void* h, uint64_t tstamp, const int16_t* sc16, uint32_t nof_samples, bool end_of_burst)
+{
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
+
+  if (!handler->tx_streamer.stream_active) {
+    rf_xrfdc_start_tx_stream(h);
+  }
+  playback_tx(h, tstamp, sc16, nof_samples, end_of_burst);
+}
+
+int rf_xrfdc_start_playback(void* h, const srsran_rf_playback_cfg_t* cfg)
+{
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
+
+  rf_xrfdc_stop_playback(h);
+  if (cfg->has_time_spec && !handler->use_timestamps) {
+    ERROR("RF_RFdc: timed playback requires timestamping");
+    return SRSRAN_ERROR;
+  }
+  // the files hold a single channel
+  if (handler->tx_streamer.nof_channels > 1) {
+    ERROR("RF_RFdc: playback is only supported with a single channel");
+    return SRSRAN_ERROR;
+  }
+  if (!handler->tx_streamer.stream_active) {
+    rf_xrfdc_start_tx_stream(h);
+  }
+  handler->player = (rf_player_t*)malloc(sizeof(rf_player_t));
+  if (!handler->player) {
+    return SRSRAN_ERROR;
+  }
+  uint64_t start_tick = cfg->has_time_spec ? time_to_hw_tstamp(handler, cfg->secs, cfg->frac_secs) : 0;
+  if (rf_player_start(handler->player, cfg, start_tick, handler->tx_streamer._fs_hz, handler, playback_tx) <
+      SRSRAN_SUCCESS) {
+    free(handler->player);
+    handler->player = NULL;
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int rf_xrfdc_stop_playback(void* h)
+{
+  rf_xrfdc_handler_t* handler = (rf_xrfdc_handler_t*)h;
+
+  if (handler->player) {
+    rf_player_stop(handler->player);
+    free(handler->player);
+    handler->player = NULL;
+  }
+  return SRSRAN_SUCCESS;
+}
+
 rf_dev_t srsran_rf_dev_rfdc = {
         "RFdc",
         rf_xrfdc_devname,
@@ -2096,7 +3174,18 @@ rf_dev_t srsran_rf_dev_rfdc = {
         rf_xrfdc_recv_with_time,
         rf_xrfdc_recv_with_time_multi,
         rf_xrfdc_send_timed,
-        .srsran_rf_send_timed_multi = rf_xrfdc_send_timed_multi
+        .srsran_rf_send_timed_multi   = rf_xrfdc_send_timed_multi,
+        .srsran_rf_queue_cmd_timed    = rf_xrfdc_queue_cmd_timed,
+        .srsran_rf_issue_stream_cmd   = rf_xrfdc_issue_stream_cmd,
+        .srsran_rf_start_playback     = rf_xrfdc_start_playback,
+        .srsran_rf_stop_playback      = rf_xrfdc_stop_playback,
+        .srsran_rf_get_rx_stats       = rf_xrfdc_get_rx_stats,
+        .srsran_rf_get_tx_stats       = rf_xrfdc_get_tx_stats,
+        .srsran_rf_recv_history       = rf_xrfdc_recv_history,
+        .srsran_rf_open_rx_consumer   = rf_xrfdc_open_rx_consumer,
+        .srsran_rf_close_rx_consumer  = rf_xrfdc_close_rx_consumer,
+        .srsran_rf_recv_consumer      = rf_xrfdc_recv_consumer,
+        .srsran_rf_get_consumer_stats = rf_xrfdc_get_consumer_stats
 };
 
 int register_plugin(rf_dev_t** rf_api)
@@ -38,8 +38,14 @@ SRSRAN_API double rf_xrfdc_get_tx_gain(void *h);
 SRSRAN_API double rf_xrfdc_set_rx_freq(void* h, uint32_t ch, double freq);
 SRSRAN_API double rf_xrfdc_set_tx_srate(void *h, double freq);
 SRSRAN_API double rf_xrfdc_set_tx_freq(void* h, uint32_t ch, double freq);
+SRSRAN_API int    rf_xrfdc_queue_cmd_timed(void* h, const srsran_rf_cmd_t* cmd, time_t secs, double frac_secs);
+SRSRAN_API int    rf_xrfdc_issue_stream_cmd(void* h, const srsran_rf_stream_cmd_t* cmd);
+SRSRAN_API int    rf_xrfdc_start_playback(void* h, const srsran_rf_playback_cfg_t* cfg);
+SRSRAN_API int    rf_xrfdc_stop_playback(void* h);
 SRSRAN_API bool   rf_xrfdc_has_rssi(void *h);
 SRSRAN_API float  rf_xrfdc_get_rssi(void *h);
+SRSRAN_API int    rf_xrfdc_get_rx_stats(void* h, srsran_rf_stats_t* stats);
+SRSRAN_API int    rf_xrfdc_get_tx_stats(void* h, srsran_rf_stats_t* stats);
 
 srsran_rf_info_t *rf_xrfdc_get_info(void *h);
 
@@ -57,6 +63,16 @@ int rf_xrfdc_recv_with_time_multi(void*            h,
                                   time_t*          secs,
                                   double*          frac_secs);
 
+int rf_xrfdc_recv_history(void* h, void** data, uint32_t nsamples, time_t secs, double frac_secs);
+
+int rf_xrfdc_open_rx_consumer(void* h, srsran_rf_consumer_policy_t policy);
+
+int rf_xrfdc_close_rx_consumer(void* h, int consumer);
+
+int rf_xrfdc_recv_consumer(void* h, int consumer, void** data, uint32_t nsamples, time_t* secs, double* frac_secs);
+
+int rf_xrfdc_get_consumer_stats(void* h, int consumer, srsran_rf_consumer_stats_t* stats);
+
 int rf_xrfdc_send_timed(void*              h,
                         void*              data,
                         int                nsamples,
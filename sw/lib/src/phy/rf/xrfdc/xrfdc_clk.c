@@ -69,9 +69,23 @@
 #include <sys/ioctl.h>
 #include <linux/i2c-dev.h>
 
+#include <linux/i2c.h>
+
 #define XIIC_BLOCK_MAX	16	/* Max data length */
 #define I2C_SMBUS_WRITE	0
 #define I2C_SMBUS_I2C_BLOCK  6
+#define XIIC_SPI_BRIDGE_ADDR	0x2f	/* I2C-to-SPI bridge in front of LMK/LMX */
+/*
+ * Wait after the LMX2594 RESET writes and after its register map, before R0 is
+ * written again with FCAL_EN = 1. The datasheet (SNAS696, "Recommended Initial
+ * Power-Up Sequence") does not give a shorter bound for these steps, so this is
+ * the 100 ms of the Xilinx RFdc reference clock driver, which this file is
+ * derived from and which the board has been validated with.
+ */
+#define LMX2594_RESET_DELAY_US	100000
+#ifndef I2C_RDWR_IOCTL_MAX_MSGS
+#define I2C_RDWR_IOCTL_MAX_MSGS	42
+#endif
 
 #else
 #include "xparameters.h"
@@ -496,10 +510,63 @@ static inline void IicWriteData(int XIicDevFile, unsigned char command,
 	ioctl(XIicDevFile,I2C_SMBUS,&args);
 }
 
+/*
+ * Writes Count register words to the I2C-to-SPI bridge, each one as a
+ * separate bridge command made of the function id followed by Length data
+ * bytes (MSB first). As many words as the adapter allows are combined in a
+ * single I2C_RDWR transaction, which avoids one syscall and one bus turnaround
+ * per register. If the transfer stops early, e.g. because the bridge NACKs
+ * while it is still shifting the previous word out on SPI, the words after the
+ * last acknowledged one are written with SMBus block writes followed by
+ * FallbackDelay us. Adapters which only report a failure, without the number of
+ * messages sent, make the whole chunk be written again.
+ */
+static int IicWriteBurst(int XIicDevFile, unsigned char command,
+			 unsigned char length, const unsigned int *words,
+			 int count, unsigned int FallbackDelay)
+{
+	unsigned char Block[I2C_RDWR_IOCTL_MAX_MSGS][XIIC_BLOCK_MAX];
+	struct i2c_msg Msgs[I2C_RDWR_IOCTL_MAX_MSGS];
+	struct i2c_rdwr_ioctl_data Xfer;
+	unsigned char tx_array[XIIC_BLOCK_MAX];
+	int Index = 0;
+	int Msg, Byte, Chunk, Sent;
+	int Batched = 0;
+
+	while (Index < count) {
+		Chunk = MIN(count - Index, I2C_RDWR_IOCTL_MAX_MSGS);
+		for (Msg = 0; Msg < Chunk; Msg++) {
+			Block[Msg][0] = command;
+			for (Byte = 0; Byte < length; Byte++)
+				Block[Msg][1 + Byte] = (unsigned char)
+					(words[Index + Msg] >> (8 * (length - 1 - Byte))) & 0xFF;
+			Msgs[Msg].addr = XIIC_SPI_BRIDGE_ADDR;
+			Msgs[Msg].flags = 0;
+			Msgs[Msg].len = length + 1;
+			Msgs[Msg].buf = Block[Msg];
+		}
+		Xfer.msgs = Msgs;
+		Xfer.nmsgs = Chunk;
+		/* I2C_RDWR returns the number of messages transferred */
+		Sent = ioctl(XIicDevFile, I2C_RDWR, &Xfer);
+		if (Sent >= Chunk) {
+			Batched++;
+		} else {
+			/* resume after the last message known to be acknowledged */
+			for (Msg = (Sent > 0) ? Sent : 0; Msg < Chunk; Msg++) {
+				for (Byte = 0; Byte < length; Byte++)
+					tx_array[Byte] = Block[Msg][1 + Byte];
+				IicWriteData(XIicDevFile, command, length, tx_array);
+				usleep(FallbackDelay);
+			}
+		}
+		Index += Chunk;
+	}
+	return Batched;
+}
+
 static void Lmx2594Updatei2c(int XIicDevFile,unsigned int  r[LMX2594_A_count])
 {
-	int Index=0;
-	int val;
 	unsigned char tx_array[3];
 /*
  * 1. Apply power to device.
@@ -512,28 +579,20 @@ static void Lmx2594Updatei2c(int XIicDevFile,unsigned int  r[LMX2594_A_count])
 	tx_array[2] = 0x2;
 	tx_array[1] = 0;
 	tx_array[0] = 0;
-	val = tx_array[0] | (tx_array[1] << 8) | (tx_array[2] << 16 ) ;
 	IicWriteData(XIicDevFile, 0xd, 3, tx_array);
-	usleep(100000);
+	usleep(LMX2594_RESET_DELAY_US);
 	tx_array[2] = 0;
 	tx_array[1] = 0;
 	tx_array[0] = 0;
-	val = tx_array[0] | (tx_array[1] << 8) | (tx_array[2] << 16 ) ;
 	IicWriteData(XIicDevFile, 0xd, 3, tx_array);
-	usleep(100000);
-	for (Index = 0; Index < LMX2594_A_count; Index++) {
-		tx_array[2] = (unsigned char) (r[Index]) & (0xFF);
-		tx_array[1] = (unsigned char) (r[Index] >> 8) & (0xFF);
-		tx_array[0] = (unsigned char) (r[Index] >> 16) & (0xFF);
-		val = tx_array[0] | (tx_array[1] << 8) | (tx_array[2] << 16 ) ;
-		IicWriteData(XIicDevFile, 0xd, 3, tx_array);
-		usleep(100000);
-	}
+	usleep(LMX2594_RESET_DELAY_US);
+	/* the register map is already stored from highest to lowest */
+	IicWriteBurst(XIicDevFile, 0xd, 3, r, LMX2594_A_count, 100000);
+	usleep(LMX2594_RESET_DELAY_US);
 	/* FCAL_EN = 1 */
 	tx_array[2] = (unsigned char) (r[112]) & (0xFF);
 	tx_array[1] = (unsigned char) (r[112] >> 8) & (0xFF);
 	tx_array[0] = (unsigned char) (r[112] >> 16) & (0xFF);
-	val = tx_array[0] | (tx_array[1] << 8) | (tx_array[2] << 16 ) ;
 	printf("LMX configured \n");
 	IicWriteData(XIicDevFile, 0xd, 3, tx_array);
 }
@@ -562,16 +621,7 @@ static int Lmx2594UpdateFreq(int XIicDevFile,int  XFrequency)
 }
 static int Lmk04208UpdateFreq(int XIicDevFile, unsigned int LMK04208_CKin[1][26] )
 {
-	int Index;
-	unsigned char tx_array[4];
-	for (Index = 0; Index < LMK04208_count; Index++) {
-		tx_array[3] = (unsigned char) (LMK04208_CKin[0][Index]) & (0xFF);
-		tx_array[2] = (unsigned char) (LMK04208_CKin[0][Index] >> 8) & (0xFF);
-		tx_array[1] = (unsigned char) (LMK04208_CKin[0][Index] >> 16) & (0xFF);
-		tx_array[0] = (unsigned char) (LMK04208_CKin[0][Index] >> 24) & (0xFF);
-		IicWriteData(XIicDevFile, 2, 4, tx_array);
-		usleep(1000);
-	}
+	IicWriteBurst(XIicDevFile, 2, 4, LMK04208_CKin[0], LMK04208_count, 1000);
 	return 0;
 }
 #endif
@@ -923,6 +973,7 @@ void LMX2594ClockConfig(int XIicBus, int XFrequency)
 	}
 
 	Lmx2594UpdateFreq(XIicDevFile, XFrequency);
+	close(XIicDevFile);
 #endif
 }
 #endif /* #ifdef XPS_BOARD_ZCU111*/
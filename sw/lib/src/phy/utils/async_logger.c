@@ -0,0 +1,623 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+#include "srsran/phy/utils/async_logger.h"
+#include "srsran/phy/utils/debug.h"
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define ASYNC_LOG_RING_SIZE (64 * 1024) // bytes per producer thread, power of two
+#define ASYNC_LOG_MAX_RECORD 512        // bytes of a record, header and arguments
+#define ASYNC_LOG_MAX_STR 128           // bytes copied of a %s argument, terminator included
+#define ASYNC_LOG_LINE_LEN 512          // formatted line, longer ones are truncated
+#define ASYNC_LOG_PERIOD_US 1000        // logger thread polling period when idle
+
+#define ASYNC_LOG_ALIGN(x) (((x) + 7U) & ~7U)
+
+typedef struct {
+  uint64_t    seq;    // order of the records across the threads
+  const char* format; // NULL marks the unused end of the ring, the next record is at its start
+  uint16_t    len;    // bytes of the record, header included, multiple of 8
+  uint8_t     dest;
+  uint8_t     level;
+} async_log_record_t;
+
+#define ASYNC_LOG_HEADER_LEN ASYNC_LOG_ALIGN(sizeof(async_log_record_t))
+
+// Single producer (the owner thread), single consumer (the logger thread) ring of records. head and tail are free
+// running byte counters, the records never wrap around the end of the buffer.
+typedef struct async_log_ring_s {
+  uint8_t*                 buffer;
+  uint32_t                 head;
+  uint32_t                 tail;
+  bool                     orphaned; // the owner thread exited, freed by the logger thread once drained
+  struct async_log_ring_s* next;
+} async_log_ring_t;
+
+// The threads only prepend their ring to the list, the logger thread unlinks and frees those of the exited threads.
+// The rings of the live threads are kept when the logger stops, they may still be pushing and reuse them on restart.
+static async_log_ring_t*         async_log_rings   = NULL;
+static __thread async_log_ring_t* async_log_own     = NULL;
+static bool                      async_log_running = false;
+static uint64_t                  async_log_seq     = 0;
+static uint64_t                  async_log_dropped = 0;
+static pthread_t                 async_log_thread;
+static uint32_t                  async_log_users   = 0; // start calls not matched by a stop yet
+static pthread_mutex_t           async_log_mutex = PTHREAD_MUTEX_INITIALIZER; // serialises start and stop
+
+// Marks the ring of a thread as orphaned when the thread exits
+static pthread_key_t  async_log_key;
+static pthread_once_t async_log_key_once = PTHREAD_ONCE_INIT;
+
+typedef enum { LEN_NONE, LEN_HH, LEN_H, LEN_L, LEN_LL, LEN_J, LEN_Z, LEN_T, LEN_LD } async_log_length_t;
+
+// A conversion specification of a printf format
+typedef struct {
+  const char*        end;       // one past the conversion character
+  const char*        len_begin; // length modifier, dropped when the specification is rebuilt
+  const char*        len_end;
+  bool               width_star;
+  bool               precision_star;
+  async_log_length_t length;
+  char               conv; // 0 if the format ends within the specification
+} async_log_spec_t;
+
+static void parse_spec(const char* p, async_log_spec_t* s)
+{
+  // p points at the '%'
+  p++;
+  s->width_star     = false;
+  s->precision_star = false;
+  s->length         = LEN_NONE;
+  while (*p && strchr("-+ #0'", *p)) {
+    p++;
+  }
+  if (*p == '*') {
+    s->width_star = true;
+    p++;
+  }
+  while (*p >= '0' && *p <= '9') {
+    p++;
+  }
+  if (*p == '.') {
+    p++;
+    if (*p == '*') {
+      s->precision_star = true;
+      p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+      p++;
+    }
+  }
+  s->len_begin = p;
+  switch (*p) {
+    case 'h':
+      s->length = (p[1] == 'h') ? LEN_HH : LEN_H;
+      p += (p[1] == 'h') ? 2 : 1;
+      break;
+    case 'l':
+      s->length = (p[1] == 'l') ? LEN_LL : LEN_L;
+      p += (p[1] == 'l') ? 2 : 1;
+      break;
+    case 'q':
+      s->length = LEN_LL;
+      p++;
+      break;
+    case 'j':
+      s->length = LEN_J;
+      p++;
+      break;
+    case 'z':
+      s->length = LEN_Z;
+      p++;
+      break;
+    case 't':
+      s->length = LEN_T;
+      p++;
+      break;
+    case 'L':
+      s->length = LEN_LD;
+      p++;
+      break;
+    default:
+      break;
+  }
+  s->len_end = p;
+  s->conv    = *p;
+  s->end     = *p ? p + 1 : p;
+}
+
+static bool is_signed_conv(char c)
+{
+  return c == 'd' || c == 'i';
+}
+
+static bool is_unsigned_conv(char c)
+{
+  return c == 'u' || c == 'o' || c == 'x' || c == 'X';
+}
+
+static bool is_float_conv(char c)
+{
+  return c != 0 && strchr("eEfFgGaA", c) != NULL;
+}
+
+static int64_t fetch_signed(va_list* args, async_log_length_t length)
+{
+  switch (length) {
+    case LEN_HH:
+      return (signed char)va_arg(*args, int);
+    case LEN_H:
+      return (short)va_arg(*args, int);
+    case LEN_L:
+      return va_arg(*args, long);
+    case LEN_LL:
+      return va_arg(*args, long long);
+    case LEN_J:
+      return va_arg(*args, intmax_t);
+    case LEN_Z:
+      return (int64_t)va_arg(*args, size_t);
+    case LEN_T:
+      return va_arg(*args, ptrdiff_t);
+    default:
+      return va_arg(*args, int);
+  }
+}
+
+static uint64_t fetch_unsigned(va_list* args, async_log_length_t length)
+{
+  switch (length) {
+    case LEN_HH:
+      return (unsigned char)va_arg(*args, unsigned int);
+    case LEN_H:
+      return (unsigned short)va_arg(*args, unsigned int);
+    case LEN_L:
+      return va_arg(*args, unsigned long);
+    case LEN_LL:
+      return va_arg(*args, unsigned long long);
+    case LEN_J:
+      return va_arg(*args, uintmax_t);
+    case LEN_Z:
+      return va_arg(*args, size_t);
+    case LEN_T:
+      return (uint64_t)va_arg(*args, ptrdiff_t);
+    default:
+      return va_arg(*args, unsigned int);
+  }
+}
+
+// Copies the arguments of format into args, returns the bytes used. Stops at the first one that does not fit.
+static uint32_t capture_args(const char* format, va_list* args, uint8_t* buf, uint32_t size)
+{
+  uint32_t n = 0;
+  for (const char* p = strchr(format, '%'); p != NULL; p = strchr(p, '%')) {
+    async_log_spec_t s;
+    if (p[1] == '%') {
+      p += 2;
+      continue;
+    }
+    parse_spec(p, &s);
+    p = s.end;
+    if (s.conv == 0) {
+      break;
+    }
+    uint32_t nof_stars = (s.width_star ? 1 : 0) + (s.precision_star ? 1 : 0);
+    for (uint32_t i = 0; i < nof_stars; i++) {
+      if (n + 8 > size) {
+        return n;
+      }
+      int64_t v = va_arg(*args, int);
+      memcpy(&buf[n], &v, 8);
+      n += 8;
+    }
+    if (s.conv == 's') {
+      const char* str = va_arg(*args, const char*);
+      if (str == NULL) {
+        str = "(null)";
+      }
+      size_t len = strnlen(str, ASYNC_LOG_MAX_STR - 1);
+      if (n + len + 1 > size) {
+        // truncate the last string rather than dropping it
+        if (n + 8 > size) {
+          return n;
+        }
+        len = size - n - 1;
+      }
+      memcpy(&buf[n], str, len);
+      buf[n + len] = '\0';
+      n += ASYNC_LOG_ALIGN((uint32_t)len + 1);
+      continue;
+    }
+    if (n + 8 > size) {
+      return n;
+    }
+    if (is_signed_conv(s.conv) || s.conv == 'c') {
+      int64_t v = fetch_signed(args, s.conv == 'c' ? LEN_NONE : s.length);
+      memcpy(&buf[n], &v, 8);
+    } else if (is_unsigned_conv(s.conv)) {
+      uint64_t v = fetch_unsigned(args, s.length);
+      memcpy(&buf[n], &v, 8);
+    } else if (is_float_conv(s.conv)) {
+      double v = (s.length == LEN_LD) ? (double)va_arg(*args, long double) : va_arg(*args, double);
+      memcpy(&buf[n], &v, 8);
+    } else if (s.conv == 'p' || s.conv == 'n') {
+      uint64_t v = (uintptr_t)va_arg(*args, void*);
+      memcpy(&buf[n], &v, 8);
+    } else {
+      // unknown conversion, printed as is and without argument
+      continue;
+    }
+    n += 8;
+  }
+  return n;
+}
+
+static void append(char* line, uint32_t size, uint32_t* pos, const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  int ret = vsnprintf(&line[*pos], size - *pos, format, args);
+  va_end(args);
+  if (ret > 0) {
+    *pos = (*pos + (uint32_t)ret < size - 1) ? *pos + (uint32_t)ret : size - 1;
+  }
+}
+
+// Formats a record into line, the arguments being read back in the order they were captured
+static void format_record(const async_log_record_t* r, char* line, uint32_t size)
+{
+  const uint8_t* buf   = (const uint8_t*)r + ASYNC_LOG_HEADER_LEN;
+  uint32_t       avail = r->len - ASYNC_LOG_HEADER_LEN;
+  uint32_t       n     = 0;
+  uint32_t       pos   = 0;
+  const char*    p     = r->format;
+
+  line[0] = '\0';
+  while (*p && pos < size - 1) {
+    const char* q = strchr(p, '%');
+    if (q == NULL) {
+      append(line, size, &pos, "%s", p);
+      break;
+    }
+    if (q > p) {
+      append(line, size, &pos, "%.*s", (int)(q - p), p);
+    }
+    if (q[1] == '%') {
+      append(line, size, &pos, "%%");
+      p = q + 2;
+      continue;
+    }
+    async_log_spec_t s;
+    parse_spec(q, &s);
+    p = s.end;
+    if (s.conv == 0 || (!is_signed_conv(s.conv) && !is_unsigned_conv(s.conv) && !is_float_conv(s.conv) &&
+                        !strchr("cspn", s.conv))) {
+      append(line, size, &pos, "%.*s", (int)(s.end - q), q);
+      continue;
+    }
+
+    // rebuild the specification with the captured widths and a length modifier matching the stored argument
+    char     spec[64];
+    uint32_t spec_len = 0;
+    for (const char* c = q; c < s.len_begin && spec_len < sizeof(spec) - 24; c++) {
+      if (*c == '*') {
+        int64_t v = 0;
+        if (n + 8 <= avail) {
+          memcpy(&v, &buf[n], 8);
+          n += 8;
+        }
+        spec_len += snprintf(&spec[spec_len], sizeof(spec) - spec_len, "%d", (int)v);
+      } else {
+        spec[spec_len++] = *c;
+      }
+    }
+    if (is_signed_conv(s.conv) || is_unsigned_conv(s.conv)) {
+      spec[spec_len++] = 'l';
+      spec[spec_len++] = 'l';
+    }
+    spec[spec_len++] = s.conv;
+    spec[spec_len]   = '\0';
+
+    if (s.conv == 's') {
+      if (n >= avail) {
+        break;
+      }
+      const char* str = (const char*)&buf[n];
+      n += ASYNC_LOG_ALIGN((uint32_t)strlen(str) + 1);
+      append(line, size, &pos, spec, str);
+      continue;
+    }
+    if (n + 8 > avail) {
+      // the arguments were truncated
+      break;
+    }
+    uint64_t v;
+    memcpy(&v, &buf[n], 8);
+    n += 8;
+    if (is_signed_conv(s.conv)) {
+      append(line, size, &pos, spec, (long long)v);
+    } else if (is_unsigned_conv(s.conv)) {
+      append(line, size, &pos, spec, (unsigned long long)v);
+    } else if (s.conv == 'c') {
+      append(line, size, &pos, spec, (int)(int64_t)v);
+    } else if (is_float_conv(s.conv)) {
+      double d;
+      memcpy(&d, &v, 8);
+      append(line, size, &pos, spec, d);
+    } else if (s.conv == 'p') {
+      append(line, size, &pos, spec, (void*)(uintptr_t)v);
+    }
+  }
+}
+
+// Destructor of async_log_key, runs when the owner thread exits
+static void release_ring(void* arg)
+{
+  async_log_ring_t* r = (async_log_ring_t*)arg;
+  // a later destructor logging from this thread gets a new ring
+  async_log_own = NULL;
+  __atomic_store_n(&r->orphaned, true, __ATOMIC_RELEASE);
+}
+
+static void create_key(void)
+{
+  pthread_key_create(&async_log_key, release_ring);
+}
+
+static async_log_ring_t* own_ring(void)
+{
+  if (async_log_own == NULL) {
+    // once per thread
+    pthread_once(&async_log_key_once, create_key);
+    async_log_ring_t* r = calloc(1, sizeof(async_log_ring_t));
+    if (r == NULL) {
+      return NULL;
+    }
+    r->buffer = malloc(ASYNC_LOG_RING_SIZE);
+    if (r->buffer == NULL) {
+      free(r);
+      return NULL;
+    }
+    r->next = __atomic_load_n(&async_log_rings, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&async_log_rings, &r->next, r, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    async_log_own = r;
+    pthread_setspecific(async_log_key, r);
+  }
+  return async_log_own;
+}
+
+static bool ring_push(async_log_ring_t* r, const uint8_t* record, uint32_t len)
+{
+  uint32_t head = r->head;
+  uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+  uint32_t pos  = head % ASYNC_LOG_RING_SIZE;
+  uint32_t skip = (ASYNC_LOG_RING_SIZE - pos < len) ? ASYNC_LOG_RING_SIZE - pos : 0;
+
+  if (ASYNC_LOG_RING_SIZE - (head - tail) < skip + len) {
+    return false;
+  }
+  if (skip >= ASYNC_LOG_HEADER_LEN) {
+    ((async_log_record_t*)&r->buffer[pos])->format = NULL;
+  }
+  memcpy(&r->buffer[(head + skip) % ASYNC_LOG_RING_SIZE], record, len);
+  __atomic_store_n(&r->head, head + skip + len, __ATOMIC_RELEASE);
+  return true;
+}
+
+// Oldest record of a ring, NULL if it is empty
+static const async_log_record_t* ring_peek(async_log_ring_t* r)
+{
+  uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+  while (r->tail != head) {
+    uint32_t                  pos    = r->tail % ASYNC_LOG_RING_SIZE;
+    const async_log_record_t* record = (const async_log_record_t*)&r->buffer[pos];
+    if (ASYNC_LOG_RING_SIZE - pos < ASYNC_LOG_HEADER_LEN || record->format == NULL) {
+      __atomic_store_n(&r->tail, r->tail + ASYNC_LOG_RING_SIZE - pos, __ATOMIC_RELEASE);
+      continue;
+    }
+    return record;
+  }
+  return NULL;
+}
+
+// Writes the pending records of all the threads in order, returns the number of records written
+static uint32_t drain(void)
+{
+  char     line[ASYNC_LOG_LINE_LEN];
+  uint32_t count = 0;
+
+  while (true) {
+    async_log_ring_t*         oldest = NULL;
+    const async_log_record_t* record = NULL;
+    for (async_log_ring_t* r = __atomic_load_n(&async_log_rings, __ATOMIC_ACQUIRE); r != NULL; r = r->next) {
+      const async_log_record_t* head = ring_peek(r);
+      if (head != NULL && (record == NULL || head->seq < record->seq)) {
+        oldest = r;
+        record = head;
+      }
+    }
+    if (record == NULL) {
+      return count;
+    }
+    format_record(record, line, sizeof(line));
+    size_t len = strlen(line);
+    if (record->dest != SRSRAN_ASYNC_LOG_HANDLER && len == sizeof(line) - 1 && line[len - 1] != '\n') {
+      // truncated, keep the line break of the format
+      line[len - 1] = '\n';
+    }
+    switch (record->dest) {
+      case SRSRAN_ASYNC_LOG_STDOUT:
+        fputs(line, stdout);
+        break;
+      case SRSRAN_ASYNC_LOG_STDERR:
+        fputs(line, stderr);
+        break;
+      default:
+        srsran_phy_log_write((phy_logger_level_t)record->level, line);
+        break;
+    }
+    __atomic_store_n(&oldest->tail, oldest->tail + record->len, __ATOMIC_RELEASE);
+    count++;
+  }
+}
+
+// Frees the drained rings of the exited threads. Only the logger thread unlinks rings, the producers only replace the
+// head of the list.
+static void reap(void)
+{
+  async_log_ring_t* prev = NULL;
+  async_log_ring_t* r    = __atomic_load_n(&async_log_rings, __ATOMIC_ACQUIRE);
+  while (r != NULL) {
+    async_log_ring_t* next = r->next;
+    // the flag is checked first, the owner pushed nothing after setting it
+    if (!__atomic_load_n(&r->orphaned, __ATOMIC_ACQUIRE) || ring_peek(r) != NULL) {
+      prev = r;
+      r    = next;
+      continue;
+    }
+    if (prev == NULL) {
+      async_log_ring_t* head = r;
+      if (!__atomic_compare_exchange_n(&async_log_rings, &head, next, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        // a thread prepended its ring meanwhile, r is no longer the head
+        for (prev = head; prev->next != r; prev = prev->next) {
+        }
+        prev->next = next;
+      }
+    } else {
+      prev->next = next;
+    }
+    free(r->buffer);
+    free(r);
+    r = next;
+  }
+}
+
+static void* async_log_run(void* arg)
+{
+  while (__atomic_load_n(&async_log_running, __ATOMIC_ACQUIRE)) {
+    if (drain() == 0) {
+      reap();
+      fflush(stdout);
+      usleep(ASYNC_LOG_PERIOD_US);
+    }
+  }
+  drain();
+  reap();
+  fflush(stdout);
+  return NULL;
+}
+
+// Called with async_log_mutex held
+static void halt(void)
+{
+  if (async_log_running) {
+    __atomic_store_n(&async_log_running, false, __ATOMIC_RELEASE);
+    pthread_join(async_log_thread, NULL);
+  }
+}
+
+// Writes what is still pending when the process exits normally, whatever the users left
+static void async_log_exit(void)
+{
+  pthread_mutex_lock(&async_log_mutex);
+  async_log_users = 0;
+  halt();
+  pthread_mutex_unlock(&async_log_mutex);
+}
+
+int srsran_async_log_start(void)
+{
+  static bool exit_registered = false;
+  int         ret             = SRSRAN_SUCCESS;
+
+  pthread_mutex_lock(&async_log_mutex);
+  if (!async_log_running) {
+    // the logger must not compete with the real-time threads, whatever the priority of the caller
+    pthread_attr_t     attr;
+    struct sched_param param = {.sched_priority = 0};
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+    __atomic_store_n(&async_log_running, true, __ATOMIC_RELEASE);
+    if (pthread_create(&async_log_thread, &attr, async_log_run, NULL)) {
+      __atomic_store_n(&async_log_running, false, __ATOMIC_RELEASE);
+      perror("pthread_create");
+      ret = SRSRAN_ERROR;
+    } else if (!exit_registered) {
+      atexit(async_log_exit);
+      exit_registered = true;
+    }
+    pthread_attr_destroy(&attr);
+  }
+  if (ret == SRSRAN_SUCCESS) {
+    async_log_users++;
+  }
+  pthread_mutex_unlock(&async_log_mutex);
+  return ret;
+}
+
+void srsran_async_log_stop(void)
+{
+  pthread_mutex_lock(&async_log_mutex);
+  if (async_log_users > 0) {
+    async_log_users--;
+  }
+  if (async_log_users == 0) {
+    halt();
+  }
+  pthread_mutex_unlock(&async_log_mutex);
+}
+
+bool srsran_async_log_enabled(void)
+{
+  return __atomic_load_n(&async_log_running, __ATOMIC_RELAXED);
+}
+
+uint64_t srsran_async_log_nof_dropped(void)
+{
+  return __atomic_load_n(&async_log_dropped, __ATOMIC_RELAXED);
+}
+
+void srsran_async_log_push(srsran_async_log_dest_t dest, phy_logger_level_t level, const char* format, ...)
+{
+  uint64_t            buf[ASYNC_LOG_MAX_RECORD / sizeof(uint64_t)];
+  async_log_record_t* record = (async_log_record_t*)buf;
+  async_log_ring_t*   r      = own_ring();
+  va_list             args;
+
+  if (r == NULL) {
+    __atomic_fetch_add(&async_log_dropped, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  va_start(args, format);
+  uint32_t len = capture_args(
+      format, &args, (uint8_t*)buf + ASYNC_LOG_HEADER_LEN, ASYNC_LOG_MAX_RECORD - ASYNC_LOG_HEADER_LEN);
+  va_end(args);
+
+  record->seq    = __atomic_fetch_add(&async_log_seq, 1, __ATOMIC_RELAXED);
+  record->format = format;
+  record->len    = (uint16_t)(ASYNC_LOG_HEADER_LEN + len);
+  record->dest   = (uint8_t)dest;
+  record->level  = (uint8_t)level;
+  if (!ring_push(r, (const uint8_t*)buf, record->len)) {
+    __atomic_fetch_add(&async_log_dropped, 1, __ATOMIC_RELAXED);
+  }
+}
@@ -0,0 +1,211 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+#include <string.h>
+
+#include "srsran/phy/utils/bfp.h"
+#include "srsran/phy/utils/simd.h"
+#include "srsran/phy/utils/vector.h"
+
+#define BFP_BLOCK_VALUES (2 * SRSRAN_BFP_BLOCK_LEN)
+
+// Shift bringing the largest magnitude of the block within width bits, sign included
+static uint32_t block_exponent(const int16_t* x, uint32_t width)
+{
+  int16_t  m = 0;
+  uint32_t i = 0;
+#if SRSRAN_SIMD_S_SIZE
+  simd_s_t acc = srsran_simd_s_zero();
+  for (; i + SRSRAN_SIMD_S_SIZE <= BFP_BLOCK_VALUES; i += SRSRAN_SIMD_S_SIZE) {
+    simd_s_t a = srsran_simd_s_loadu(&x[i]);
+    // the ones' complement of a negative value has as many significant bits as its two's complement
+    acc = srsran_simd_s_or(acc, srsran_simd_s_xor(a, srsran_simd_s_sra(a, 15)));
+  }
+  int16_t tmp[SRSRAN_SIMD_S_SIZE];
+  srsran_simd_s_storeu(tmp, acc);
+  for (uint32_t j = 0; j < SRSRAN_SIMD_S_SIZE; j++) {
+    m |= tmp[j];
+  }
+#endif /* SRSRAN_SIMD_S_SIZE */
+  for (; i < BFP_BLOCK_VALUES; i++) {
+    m |= (int16_t)(x[i] ^ (x[i] >> 15));
+  }
+  uint32_t bits = m ? 33 - __builtin_clz((uint32_t)m) : 1;
+  return bits > width ? bits - width : 0;
+}
+
+// Mantissas of the block, rounded to the nearest
+static void block_quantize(const int16_t* x, uint32_t exponent, uint32_t width, int16_t* q)
+{
+  if (exponent == 0) {
+    memcpy(q, x, sizeof(int16_t) * BFP_BLOCK_VALUES);
+    return;
+  }
+  // the rounding of the largest magnitudes may reach the next power of two
+  int16_t  max = (int16_t)((1 << (width - 1)) - 1);
+  uint32_t i   = 0;
+#if SRSRAN_SIMD_S_SIZE
+  // the 16 bit lanes would wrap on the rounding add of 32767, so the clamp comes first: (2 * max + 1) >> 1 is max.
+  // A non-zero exponent implies a width below 16, hence 2 * max fits.
+  simd_s_t one   = srsran_simd_s_set1(1);
+  simd_s_t max_s = srsran_simd_s_set1((int16_t)(2 * max));
+  for (; i + SRSRAN_SIMD_S_SIZE <= BFP_BLOCK_VALUES; i += SRSRAN_SIMD_S_SIZE) {
+    simd_s_t a = srsran_simd_s_sra(srsran_simd_s_loadu(&x[i]), (int)exponent - 1);
+    a          = srsran_simd_s_min(a, max_s);
+    srsran_simd_s_storeu(&q[i], srsran_simd_s_sra(srsran_simd_s_add(a, one), 1));
+  }
+#endif /* SRSRAN_SIMD_S_SIZE */
+  for (; i < BFP_BLOCK_VALUES; i++) {
+    int16_t a = (int16_t)(((x[i] >> (exponent - 1)) + 1) >> 1);
+    q[i]      = SRSRAN_MIN(a, max);
+  }
+}
+
+// Bit packing of the mantissas, MSB first. A block takes a whole number of 32 bit words. Inlined with the widths in
+// use, the loops unroll to fixed shifts.
+static inline __attribute__((always_inline)) void pack_bits(const int16_t* q, uint32_t width, uint8_t* z)
+{
+  uint32_t mask = (1U << width) - 1;
+  uint64_t acc  = 0;
+  uint32_t bits = 0;
+  for (uint32_t i = 0; i < BFP_BLOCK_VALUES; i++) {
+    acc = (acc << width) | ((uint32_t)q[i] & mask);
+    bits += width;
+    if (bits >= 32) {
+      bits -= 32;
+      uint32_t word = (uint32_t)(acc >> bits);
+      z[0]          = (uint8_t)(word >> 24);
+      z[1]          = (uint8_t)(word >> 16);
+      z[2]          = (uint8_t)(word >> 8);
+      z[3]          = (uint8_t)word;
+      z += 4;
+    }
+  }
+}
+
+static inline __attribute__((always_inline)) void unpack_bits(const uint8_t* x, uint32_t width, int16_t* q)
+{
+  uint32_t sign_shift = 32 - width;
+  uint64_t acc        = 0;
+  uint32_t bits       = 0;
+  for (uint32_t i = 0; i < BFP_BLOCK_VALUES; i++) {
+    if (bits < width) {
+      acc = (acc << 32) | ((uint32_t)x[0] << 24) | ((uint32_t)x[1] << 16) | ((uint32_t)x[2] << 8) | x[3];
+      bits += 32;
+      x += 4;
+    }
+    bits -= width;
+    // sign extension of the mantissa
+    q[i] = (int16_t)((int32_t)((uint32_t)(acc >> bits) << sign_shift) >> sign_shift);
+  }
+}
+
+static void block_pack(const int16_t* q, uint32_t width, uint8_t* z)
+{
+  switch (width) {
+    case 8:
+      for (uint32_t i = 0; i < BFP_BLOCK_VALUES; i++) {
+        z[i] = (uint8_t)q[i];
+      }
+      break;
+    case 9:
+      pack_bits(q, 9, z);
+      break;
+    case 12:
+      pack_bits(q, 12, z);
+      break;
+    default:
+      pack_bits(q, width, z);
+      break;
+  }
+}
+
+static void block_unpack(const uint8_t* x, uint32_t width, int16_t* q)
+{
+  switch (width) {
+    case 8:
+      for (uint32_t i = 0; i < BFP_BLOCK_VALUES; i++) {
+        q[i] = (int8_t)x[i];
+      }
+      break;
+    case 9:
+      unpack_bits(x, 9, q);
+      break;
+    case 12:
+      unpack_bits(x, 12, q);
+      break;
+    default:
+      unpack_bits(x, width, q);
+      break;
+  }
+}
+
+static void block_expand(int16_t* q, uint32_t exponent)
+{
+  if (exponent == 0) {
+    return;
+  }
+  uint32_t i = 0;
+#if SRSRAN_SIMD_S_SIZE
+  for (; i + SRSRAN_SIMD_S_SIZE <= BFP_BLOCK_VALUES; i += SRSRAN_SIMD_S_SIZE) {
+    srsran_simd_s_storeu(&q[i], srsran_simd_s_sll(srsran_simd_s_loadu(&q[i]), (int)exponent));
+  }
+#endif /* SRSRAN_SIMD_S_SIZE */
+  for (; i < BFP_BLOCK_VALUES; i++) {
+    q[i] = (int16_t)((uint16_t)q[i] << exponent);
+  }
+}
+
+int srsran_bfp_compress(const int16_t* x, uint32_t width, uint8_t* z, uint32_t nof_pairs)
+{
+  if (!srsran_bfp_width_valid(width)) {
+    return SRSRAN_ERROR;
+  }
+  uint32_t block_size = srsran_bfp_block_size(width);
+  int16_t  q[BFP_BLOCK_VALUES];
+  int16_t  last[BFP_BLOCK_VALUES];
+  for (uint32_t i = 0; i < nof_pairs; i += SRSRAN_BFP_BLOCK_LEN) {
+    const int16_t* block = &x[2 * i];
+    if (nof_pairs - i < SRSRAN_BFP_BLOCK_LEN) {
+      // the last block is padded with zeros
+      memset(last, 0, sizeof(last));
+      memcpy(last, block, sizeof(int16_t) * 2 * (nof_pairs - i));
+      block = last;
+    }
+    uint32_t exponent = block_exponent(block, width);
+    block_quantize(block, exponent, width, q);
+    z[0] = (uint8_t)exponent;
+    block_pack(q, width, &z[1]);
+    z += block_size;
+  }
+  return (int)srsran_bfp_size(width, nof_pairs);
+}
+
+int srsran_bfp_decompress(const uint8_t* x, uint32_t width, int16_t* z, uint32_t nof_pairs)
+{
+  if (!srsran_bfp_width_valid(width)) {
+    return SRSRAN_ERROR;
+  }
+  uint32_t block_size = srsran_bfp_block_size(width);
+  int16_t  last[BFP_BLOCK_VALUES];
+  for (uint32_t i = 0; i < nof_pairs; i += SRSRAN_BFP_BLOCK_LEN) {
+    bool     partial = nof_pairs - i < SRSRAN_BFP_BLOCK_LEN;
+    int16_t* block   = partial ? last : &z[2 * i];
+    block_unpack(&x[1], width, block);
+    block_expand(block, x[0] & 0x0f);
+    if (partial) {
+      memcpy(&z[2 * i], last, sizeof(int16_t) * 2 * (nof_pairs - i));
+    }
+    x += block_size;
+  }
+  return (int)srsran_bfp_size(width, nof_pairs);
+}
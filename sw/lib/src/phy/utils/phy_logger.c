@@ -43,4 +43,11 @@ void srsran_phy_log_print(phy_logger_level_t log_level, const char* format, ...)
     }
   }
   va_end(args);
-}
\ No newline at end of file
+}
+
+void srsran_phy_log_write(phy_logger_level_t log_level, char* str)
+{
+  if (phy_log_handler) {
+    phy_log_handler(log_level, callback_ctx, str);
+  }
+}
@@ -23,8 +23,10 @@ int srsran_ringbuffer_init(srsran_ringbuffer_t* q, int capacity)
   if (!q->buffer) {
     return SRSRAN_ERROR;
   }
-  q->active   = true;
-  q->capacity = capacity;
+  q->active      = true;
+  q->capacity    = capacity;
+  q->nof_dropped = 0;
+  memset(q->taps, 0, sizeof(q->taps));
   pthread_mutex_init(&q->mutex, NULL);
   pthread_cond_init(&q->write_cvar, NULL);
   pthread_cond_init(&q->read_cvar, NULL);
@@ -55,6 +57,13 @@ void srsran_ringbuffer_reset(srsran_ringbuffer_t* q)
     q->count = 0;
     q->wpm   = 0;
     q->rpm   = 0;
+    for (int i = 0; i < SRSRAN_RINGBUFFER_MAX_TAPS; i++) {
+      if (q->taps[i].active) {
+        q->taps[i].rpm    = 0;
+        q->taps[i].count  = 0;
+        q->taps[i].resync = true;
+      }
+    }
     pthread_mutex_unlock(&q->mutex);
   }
 }
@@ -87,7 +96,35 @@ int srsran_ringbuffer_status(srsran_ringbuffer_t* q)
 
 int srsran_ringbuffer_space(srsran_ringbuffer_t* q)
 {
-  return q->capacity - q->count;
+  int used = q->count;
+  for (int i = 0; i < SRSRAN_RINGBUFFER_MAX_TAPS; i++) {
+    if (q->taps[i].active && q->taps[i].policy == SRSRAN_RINGBUFFER_TAP_HOLD) {
+      used = SRSRAN_MAX(used, q->taps[i].count);
+    }
+  }
+  return q->capacity - used;
+}
+
+// Bytes the writer must keep to write nof_bytes more: those of the main reader and of the taps holding theirs. The
+// caller holds the mutex. Skipping taps that are in the way jump to the write pointer.
+static int ringbuffer_used(srsran_ringbuffer_t* q, int nof_bytes)
+{
+  int used = q->count;
+  for (int i = 0; i < SRSRAN_RINGBUFFER_MAX_TAPS; i++) {
+    srsran_ringbuffer_tap_t* tap = &q->taps[i];
+    if (!tap->active) {
+      continue;
+    }
+    if (tap->policy == SRSRAN_RINGBUFFER_TAP_SKIP && tap->count + nof_bytes > q->capacity) {
+      tap->nof_overruns++;
+      tap->nof_lost += tap->count;
+      tap->rpm    = q->wpm;
+      tap->count  = 0;
+      tap->resync = true;
+    }
+    used = SRSRAN_MAX(used, tap->count);
+  }
+  return used;
 }
 
 int srsran_ringbuffer_write(srsran_ringbuffer_t* q, void* ptr, int nof_bytes)
@@ -105,6 +142,38 @@ int srsran_ringbuffer_write_block(srsran_ringbuffer_t* q, void* ptr, int nof_byt
   return srsran_ringbuffer_write_timed_block(q, ptr, nof_bytes, -1);
 }
 
+// Copies nof_bytes at the write pointer, the caller holds the mutex and checked the space
+static void ringbuffer_copy_in(srsran_ringbuffer_t* q, const uint8_t* ptr, int nof_bytes)
+{
+  if (ptr != NULL) {
+    if (nof_bytes > q->capacity - q->wpm) {
+      int x = q->capacity - q->wpm;
+      memcpy(&q->buffer[q->wpm], ptr, x);
+      memcpy(q->buffer, &ptr[x], nof_bytes - x);
+    } else {
+      memcpy(&q->buffer[q->wpm], ptr, nof_bytes);
+    }
+  } else {
+    if (nof_bytes > q->capacity - q->wpm) {
+      int x = q->capacity - q->wpm;
+      memset(&q->buffer[q->wpm], 0, x);
+      memset(q->buffer, 0, nof_bytes - x);
+    } else {
+      memset(&q->buffer[q->wpm], 0, nof_bytes);
+    }
+  }
+  q->wpm += nof_bytes;
+  if (q->wpm >= q->capacity) {
+    q->wpm -= q->capacity;
+  }
+  q->count += nof_bytes;
+  for (int i = 0; i < SRSRAN_RINGBUFFER_MAX_TAPS; i++) {
+    if (q->taps[i].active) {
+      q->taps[i].count += nof_bytes;
+    }
+  }
+}
+
 int srsran_ringbuffer_write_timed_block(srsran_ringbuffer_t* q, void* p, int nof_bytes, int32_t timeout_ms)
 {
   int             ret     = SRSRAN_SUCCESS;
@@ -127,13 +196,13 @@ int srsran_ringbuffer_write_timed_block(srsran_ringbuffer_t* q, void* p, int nof
   pthread_mutex_lock(&q->mutex);
 
   // Wait to have enough space in the buffer
-  while (q->count + w_bytes > q->capacity && q->active && ret == SRSRAN_SUCCESS) {
+  while (ringbuffer_used(q, w_bytes) + w_bytes > q->capacity && q->active && ret == SRSRAN_SUCCESS) {
     if (timeout_ms > 0) {
       ret = pthread_cond_timedwait(&q->read_cvar, &q->mutex, &towait);
     } else if (timeout_ms < 0) {
       pthread_cond_wait(&q->read_cvar, &q->mutex);
     } else {
-      w_bytes = q->capacity - q->count;
+      w_bytes = q->capacity - ringbuffer_used(q, w_bytes);
       ERROR("Buffer overrun: lost %d bytes", nof_bytes - w_bytes);
     }
   }
@@ -142,37 +211,88 @@ int srsran_ringbuffer_write_timed_block(srsran_ringbuffer_t* q, void* p, int nof
   } else if (!q->active) {
     ret = SRSRAN_SUCCESS;
   } else if (ret == SRSRAN_SUCCESS) {
-    if (ptr != NULL) {
-      if (w_bytes > q->capacity - q->wpm) {
-        int x = q->capacity - q->wpm;
-        memcpy(&q->buffer[q->wpm], ptr, x);
-        memcpy(q->buffer, &ptr[x], w_bytes - x);
-      } else {
-        memcpy(&q->buffer[q->wpm], ptr, w_bytes);
-      }
+    ringbuffer_copy_in(q, ptr, w_bytes);
+    ret = w_bytes;
+  } else {
+    ret = SRSRAN_ERROR;
+  }
+  pthread_cond_broadcast(&q->write_cvar);
+  pthread_mutex_unlock(&q->mutex);
+  return ret;
+}
+
+int srsran_ringbuffer_write_packet(srsran_ringbuffer_t*            q,
+                                   const srsran_ringbuffer_part_t* parts,
+                                   int                             nof_parts,
+                                   int32_t                         timeout_ms)
+{
+  int             ret       = SRSRAN_SUCCESS;
+  int             nof_bytes = 0;
+  struct timespec towait    = {};
+
+  if (q == NULL || q->buffer == NULL || parts == NULL) {
+    ERROR("Invalid inputs");
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  for (int i = 0; i < nof_parts; i++) {
+    nof_bytes += parts[i].nof_bytes;
+  }
+
+  // Get current time and update timeout
+  if (timeout_ms > 0) {
+    struct timespec now = {};
+    timespec_get(&now, TIME_UTC);
+
+    // check nsec wrap-around
+    towait.tv_sec = now.tv_sec + timeout_ms / 1000L;
+    long nsec     = now.tv_nsec + ((timeout_ms % 1000U) * 1000000UL);
+    towait.tv_sec += nsec / 1000000000L;
+    towait.tv_nsec = nsec % 1000000000L;
+  }
+
+  pthread_mutex_lock(&q->mutex);
+
+  if (nof_bytes > q->capacity) {
+    // would never fit, waiting for space is pointless
+    ret = SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  // Wait to have enough space for the whole packet
+  while (ringbuffer_used(q, nof_bytes) + nof_bytes > q->capacity && q->active && ret == SRSRAN_SUCCESS) {
+    if (timeout_ms > 0) {
+      ret = pthread_cond_timedwait(&q->read_cvar, &q->mutex, &towait);
+    } else if (timeout_ms < 0) {
+      pthread_cond_wait(&q->read_cvar, &q->mutex);
     } else {
-      if (w_bytes > q->capacity - q->wpm) {
-        int x = q->capacity - q->wpm;
-        memset(&q->buffer[q->wpm], 0, x);
-        memset(q->buffer, 0, w_bytes - x);
-      } else {
-        memset(&q->buffer[q->wpm], 0, w_bytes);
-      }
+      ret = SRSRAN_ERROR;
     }
-    q->wpm += w_bytes;
-    if (q->wpm >= q->capacity) {
-      q->wpm -= q->capacity;
+  }
+
+  if (!q->active) {
+    ret = SRSRAN_SUCCESS;
+  } else if (ret == SRSRAN_SUCCESS) {
+    for (int i = 0; i < nof_parts; i++) {
+      ringbuffer_copy_in(q, (const uint8_t*)parts[i].ptr, parts[i].nof_bytes);
     }
-    q->count += w_bytes;
-    ret = w_bytes;
+    ret = nof_bytes;
   } else {
-    ret = SRSRAN_ERROR;
+    // nothing of the packet was written, the reader stays aligned on packet boundaries
+    q->nof_dropped++;
+    ret = (ret == ETIMEDOUT) ? SRSRAN_ERROR_TIMEOUT : (ret < 0 ? ret : SRSRAN_ERROR);
   }
   pthread_cond_broadcast(&q->write_cvar);
   pthread_mutex_unlock(&q->mutex);
   return ret;
 }
 
+uint64_t srsran_ringbuffer_nof_dropped(srsran_ringbuffer_t* q)
+{
+  uint64_t nof_dropped = 0;
+  pthread_mutex_lock(&q->mutex);
+  nof_dropped = q->nof_dropped;
+  pthread_mutex_unlock(&q->mutex);
+  return nof_dropped;
+}
+
 int srsran_ringbuffer_read(srsran_ringbuffer_t* q, void* p, int nof_bytes)
 {
   return srsran_ringbuffer_read_timed_block(q, p, nof_bytes, -1);
@@ -246,6 +366,122 @@ int srsran_ringbuffer_read_timed_block(srsran_ringbuffer_t* q, void* p, int nof_
   return ret;
 }
 
+int srsran_ringbuffer_tap_open(srsran_ringbuffer_t* q, srsran_ringbuffer_tap_policy_t policy)
+{
+  int ret = SRSRAN_ERROR;
+  pthread_mutex_lock(&q->mutex);
+  for (int i = 0; i < SRSRAN_RINGBUFFER_MAX_TAPS; i++) {
+    srsran_ringbuffer_tap_t* tap = &q->taps[i];
+    if (!tap->active) {
+      memset(tap, 0, sizeof(srsran_ringbuffer_tap_t));
+      tap->active = true;
+      tap->policy = policy;
+      tap->rpm    = q->wpm;
+      ret         = i;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&q->mutex);
+  return ret;
+}
+
+void srsran_ringbuffer_tap_close(srsran_ringbuffer_t* q, int tap)
+{
+  if (tap < 0 || tap >= SRSRAN_RINGBUFFER_MAX_TAPS) {
+    return;
+  }
+  pthread_mutex_lock(&q->mutex);
+  q->taps[tap].active = false;
+  // a writer may be waiting for the bytes the tap held, wake up the readers blocked on it as well
+  pthread_cond_broadcast(&q->read_cvar);
+  pthread_cond_broadcast(&q->write_cvar);
+  pthread_mutex_unlock(&q->mutex);
+}
+
+int srsran_ringbuffer_tap_read_timed(srsran_ringbuffer_t* q, int tap_idx, void* p, int nof_bytes, int32_t timeout_ms)
+{
+  int             ret    = SRSRAN_SUCCESS;
+  uint8_t*        ptr    = (uint8_t*)p;
+  struct timespec towait = {};
+
+  if (tap_idx < 0 || tap_idx >= SRSRAN_RINGBUFFER_MAX_TAPS) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  srsran_ringbuffer_tap_t* tap = &q->taps[tap_idx];
+
+  // Get current time and update timeout
+  if (timeout_ms > 0) {
+    struct timespec now = {};
+    timespec_get(&now, TIME_UTC);
+
+    // check nsec wrap-around
+    towait.tv_sec = now.tv_sec + timeout_ms / 1000L;
+    long nsec     = now.tv_nsec + ((timeout_ms % 1000U) * 1000000UL);
+    towait.tv_sec += nsec / 1000000000L;
+    towait.tv_nsec = nsec % 1000000000L;
+  }
+
+  pthread_mutex_lock(&q->mutex);
+
+  // Wait for having enough bytes, or for the tap to skip ahead
+  while (tap->active && !tap->resync && tap->count < nof_bytes && q->active && ret == SRSRAN_SUCCESS) {
+    if (timeout_ms > 0) {
+      ret = pthread_cond_timedwait(&q->write_cvar, &q->mutex, &towait);
+    } else {
+      pthread_cond_wait(&q->write_cvar, &q->mutex);
+    }
+  }
+
+  if (!tap->active) {
+    ret = SRSRAN_ERROR_INVALID_INPUTS;
+  } else if (tap->resync) {
+    tap->resync = false;
+    ret         = SRSRAN_ERROR_OUT_OF_BOUNDS;
+  } else if (ret == ETIMEDOUT) {
+    ret = SRSRAN_ERROR_TIMEOUT;
+  } else if (!q->active) {
+    ret = SRSRAN_SUCCESS;
+  } else if (ret == SRSRAN_SUCCESS) {
+    if (nof_bytes + tap->rpm > q->capacity) {
+      int x = q->capacity - tap->rpm;
+      memcpy(ptr, &q->buffer[tap->rpm], x);
+      memcpy(&ptr[x], q->buffer, nof_bytes - x);
+    } else {
+      memcpy(ptr, &q->buffer[tap->rpm], nof_bytes);
+    }
+    tap->rpm += nof_bytes;
+    if (tap->rpm >= q->capacity) {
+      tap->rpm -= q->capacity;
+    }
+    tap->count -= nof_bytes;
+    ret = nof_bytes;
+  } else {
+    ret = SRSRAN_ERROR;
+  }
+
+  pthread_cond_broadcast(&q->read_cvar);
+  pthread_mutex_unlock(&q->mutex);
+
+  return ret;
+}
+
+int srsran_ringbuffer_tap_stats(srsran_ringbuffer_t* q, int tap, int* count, uint64_t* nof_overruns, uint64_t* nof_lost)
+{
+  if (tap < 0 || tap >= SRSRAN_RINGBUFFER_MAX_TAPS) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  int ret = SRSRAN_ERROR_INVALID_INPUTS;
+  pthread_mutex_lock(&q->mutex);
+  if (q->taps[tap].active) {
+    *count        = q->taps[tap].count;
+    *nof_overruns = q->taps[tap].nof_overruns;
+    *nof_lost     = q->taps[tap].nof_lost;
+    ret           = SRSRAN_SUCCESS;
+  }
+  pthread_mutex_unlock(&q->mutex);
+  return ret;
+}
+
 void srsran_ringbuffer_stop(srsran_ringbuffer_t* q)
 {
   pthread_mutex_lock(&q->mutex);
@@ -345,6 +581,20 @@ int srsran_ringbuffer_read_block(srsran_ringbuffer_t* q, void** p, int nof_bytes
   return ret;
 }
 
+int srsran_ringbuffer_discard(srsran_ringbuffer_t* q, int nof_bytes)
+{
+  pthread_mutex_lock(&q->mutex);
+  int n = SRSRAN_MIN(nof_bytes, q->count);
+  q->rpm += n;
+  if (q->rpm >= q->capacity) {
+    q->rpm -= q->capacity;
+  }
+  q->count -= n;
+  pthread_cond_broadcast(&q->read_cvar);
+  pthread_mutex_unlock(&q->mutex);
+  return n;
+}
+
 void srsran_ringbuffer_start(srsran_ringbuffer_t* q)
 {
   pthread_mutex_lock(&q->mutex);
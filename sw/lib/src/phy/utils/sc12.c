@@ -0,0 +1,212 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2022 Software Radio Systems Limited
+ *
+ * By using this file, you agree to the terms and conditions set
+ * forth in the LICENSE file which can be found at the top level of
+ * the distribution.
+ *
+ */
+
+#include <math.h>
+
+#include "srsran/phy/utils/sc12.h"
+#include "srsran/phy/utils/simd.h"
+
+// A pair of values takes 3 bytes: the low byte and nibble of the first, then the low nibble and byte of the second
+static inline void unpack_pair(const uint8_t* x, int16_t* z)
+{
+  z[0] = (int16_t)((uint16_t)(x[0] << 4 | x[1] << 12)) >> 4;
+  z[1] = (int16_t)((uint16_t)(x[1] | x[2] << 8)) >> 4;
+}
+
+static inline int16_t saturate(long v)
+{
+  return (int16_t)(v > SRSRAN_SC12_MAX ? SRSRAN_SC12_MAX : (v < SRSRAN_SC12_MIN ? SRSRAN_SC12_MIN : v));
+}
+
+static inline void pack_pair(int16_t a, int16_t b, uint8_t* z)
+{
+  z[0] = (uint8_t)a;
+  z[1] = (uint8_t)((a >> 8) & 0x0f) | (uint8_t)(b << 4);
+  z[2] = (uint8_t)(b >> 4);
+}
+
+#ifdef LV_HAVE_SSE
+// Each 16 bit lane gets the two bytes holding its value, the first of a pair in the low 12 bits and the second in the
+// high 12 bits. Shifting the former up aligns both on the sign bit.
+#define SC12_SHUFFLE 11, 10, 10, 9, 8, 7, 7, 6, 5, 4, 4, 3, 2, 1, 1, 0
+#define SC12_ALIGN 1, 16, 1, 16, 1, 16, 1, 16
+
+static inline __m128i unpack8_sse(const uint8_t* x)
+{
+  __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)x), _mm_set_epi8(SC12_SHUFFLE));
+  return _mm_srai_epi16(_mm_mullo_epi16(a, _mm_set_epi16(SC12_ALIGN)), 4);
+}
+
+#ifdef LV_HAVE_AVX2
+static inline __m256i unpack16_avx2(const uint8_t* x)
+{
+  __m256i a = _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)x)), _mm_loadu_si128((const __m128i*)&x[12]), 1);
+  a = _mm256_shuffle_epi8(a, _mm256_set_epi8(SC12_SHUFFLE, SC12_SHUFFLE));
+  return _mm256_srai_epi16(_mm256_mullo_epi16(a, _mm256_set_epi16(SC12_ALIGN, SC12_ALIGN)), 4);
+}
+#endif /* LV_HAVE_AVX2 */
+
+// Packs 8 values, saturated to 12 bits, into 12 bytes
+static inline void pack8_sse(__m128i v, uint8_t* z)
+{
+  v = _mm_min_epi16(_mm_max_epi16(v, _mm_set1_epi16(SRSRAN_SC12_MIN)), _mm_set1_epi16(SRSRAN_SC12_MAX));
+  v = _mm_and_si128(v, _mm_set1_epi16(0x0fff));
+  // every 32 bit lane holds a pair in its low 24 bits, which are then put together
+  __m128i p = _mm_madd_epi16(v, _mm_set1_epi32(0x10000001));
+  p         = _mm_shuffle_epi8(p, _mm_set_epi8(-1, -1, -1, -1, 14, 13, 12, 10, 9, 8, 6, 5, 4, 2, 1, 0));
+  _mm_storel_epi64((__m128i*)z, p);
+  *(uint32_t*)&z[8] = (uint32_t)_mm_extract_epi32(p, 2);
+}
+#endif /* LV_HAVE_SSE */
+
+#ifdef HAVE_NEON
+// vcvtq_s32_f32() truncates, half is added away from zero first
+static inline int32x4_t round_neon(float32x4_t v, float scale)
+{
+  v                = vmulq_n_f32(v, scale);
+  uint32x4_t  sign = vandq_u32(vreinterpretq_u32_f32(v), vdupq_n_u32(0x80000000));
+  float32x4_t half = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(vdupq_n_f32(0.5f)), sign));
+  return vcvtq_s32_f32(vaddq_f32(v, half));
+}
+#endif /* HAVE_NEON */
+
+void srsran_sc12_unpack(const uint8_t* x, int16_t* z, uint32_t nof_values)
+{
+  uint32_t i = 0;
+#if defined(LV_HAVE_AVX2) || defined(LV_HAVE_SSE)
+  uint32_t size = srsran_sc12_size(nof_values);
+#endif /* defined(LV_HAVE_AVX2) || defined(LV_HAVE_SSE) */
+#ifdef LV_HAVE_AVX2
+  // the loads read 4 bytes past the values in use
+  for (; srsran_sc12_size(i) + 28 <= size; i += 16) {
+    _mm256_storeu_si256((__m256i*)&z[i], unpack16_avx2(&x[srsran_sc12_size(i)]));
+  }
+#endif /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_SSE
+  for (; srsran_sc12_size(i) + 16 <= size; i += 8) {
+    _mm_storeu_si128((__m128i*)&z[i], unpack8_sse(&x[srsran_sc12_size(i)]));
+  }
+#endif /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+  // de-interleaving the bytes by 3 puts every pair in the same lane of three vectors
+  for (; i + 16 <= nof_values; i += 16) {
+    uint8x8x3_t b  = vld3_u8(&x[srsran_sc12_size(i)]);
+    int16x8_t   b0 = vreinterpretq_s16_u16(vmovl_u8(b.val[0]));
+    int16x8_t   b1 = vreinterpretq_s16_u16(vmovl_u8(b.val[1]));
+    int16x8_t   b2 = vreinterpretq_s16_u16(vmovl_u8(b.val[2]));
+    int16x8x2_t v;
+    v.val[0] = vshrq_n_s16(vorrq_s16(vshlq_n_s16(b0, 4), vshlq_n_s16(b1, 12)), 4);
+    v.val[1] = vshrq_n_s16(vorrq_s16(b1, vshlq_n_s16(b2, 8)), 4);
+    vst2q_s16(&z[i], v);
+  }
+#endif /* HAVE_NEON */
+  for (; i < nof_values; i += 2) {
+    unpack_pair(&x[srsran_sc12_size(i)], &z[i]);
+  }
+}
+
+void srsran_sc12_unpack_f(const uint8_t* x, float scale, float* z, uint32_t nof_values)
+{
+  uint32_t    i    = 0;
+  const float gain = 1.0f / scale;
+#if defined(LV_HAVE_AVX2) || defined(LV_HAVE_SSE)
+  uint32_t size = srsran_sc12_size(nof_values);
+#endif /* defined(LV_HAVE_AVX2) || defined(LV_HAVE_SSE) */
+#ifdef LV_HAVE_AVX2
+  __m256 g256 = _mm256_set1_ps(gain);
+  for (; srsran_sc12_size(i) + 28 <= size; i += 16) {
+    __m256i v = unpack16_avx2(&x[srsran_sc12_size(i)]);
+    __m256  a = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(v)));
+    __m256  b = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1)));
+    _mm256_storeu_ps(&z[i], _mm256_mul_ps(a, g256));
+    _mm256_storeu_ps(&z[i + 8], _mm256_mul_ps(b, g256));
+  }
+#endif /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_SSE
+  __m128 g128 = _mm_set1_ps(gain);
+  for (; srsran_sc12_size(i) + 16 <= size; i += 8) {
+    __m128i v = unpack8_sse(&x[srsran_sc12_size(i)]);
+    __m128  a = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(v));
+    __m128  b = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_unpackhi_epi64(v, v)));
+    _mm_storeu_ps(&z[i], _mm_mul_ps(a, g128));
+    _mm_storeu_ps(&z[i + 4], _mm_mul_ps(b, g128));
+  }
+#endif /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+  for (; i + 16 <= nof_values; i += 16) {
+    uint8x8x3_t b  = vld3_u8(&x[srsran_sc12_size(i)]);
+    int16x8_t   b0 = vreinterpretq_s16_u16(vmovl_u8(b.val[0]));
+    int16x8_t   b1 = vreinterpretq_s16_u16(vmovl_u8(b.val[1]));
+    int16x8_t   b2 = vreinterpretq_s16_u16(vmovl_u8(b.val[2]));
+    int16x8_t   e  = vshrq_n_s16(vorrq_s16(vshlq_n_s16(b0, 4), vshlq_n_s16(b1, 12)), 4);
+    int16x8_t   o  = vshrq_n_s16(vorrq_s16(b1, vshlq_n_s16(b2, 8)), 4);
+    float32x4x2_t lo, hi;
+    lo.val[0] = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(e))), gain);
+    lo.val[1] = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(o))), gain);
+    hi.val[0] = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(e))), gain);
+    hi.val[1] = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(o))), gain);
+    vst2q_f32(&z[i], lo);
+    vst2q_f32(&z[i + 8], hi);
+  }
+#endif /* HAVE_NEON */
+  for (; i < nof_values; i += 2) {
+    int16_t v[2];
+    unpack_pair(&x[srsran_sc12_size(i)], v);
+    z[i]     = (float)v[0] * gain;
+    z[i + 1] = (float)v[1] * gain;
+  }
+}
+
+void srsran_sc12_pack_f(const float* x, float scale, uint8_t* z, uint32_t nof_values)
+{
+  uint32_t i = 0;
+#ifdef LV_HAVE_AVX
+  __m256 s256 = _mm256_set1_ps(scale);
+  for (; i + 16 <= nof_values; i += 16) {
+    __m256i a = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&x[i]), s256));
+    __m256i b = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&x[i + 8]), s256));
+    pack8_sse(_mm_packs_epi32(_mm256_castsi256_si128(a), _mm256_extractf128_si256(a, 1)), &z[srsran_sc12_size(i)]);
+    pack8_sse(_mm_packs_epi32(_mm256_castsi256_si128(b), _mm256_extractf128_si256(b, 1)),
+              &z[srsran_sc12_size(i + 8)]);
+  }
+#endif /* LV_HAVE_AVX */
+#ifdef LV_HAVE_SSE
+  __m128 s128 = _mm_set1_ps(scale);
+  for (; i + 8 <= nof_values; i += 8) {
+    __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(&x[i]), s128));
+    __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(&x[i + 4]), s128));
+    pack8_sse(_mm_packs_epi32(a, b), &z[srsran_sc12_size(i)]);
+  }
+#endif /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+  int16x8_t max = vdupq_n_s16(SRSRAN_SC12_MAX);
+  int16x8_t min = vdupq_n_s16(SRSRAN_SC12_MIN);
+  for (; i + 16 <= nof_values; i += 16) {
+    float32x4x2_t lo = vld2q_f32(&x[i]);
+    float32x4x2_t hi = vld2q_f32(&x[i + 8]);
+    int16x8_t     e  = vcombine_s16(vqmovn_s32(round_neon(lo.val[0], scale)), vqmovn_s32(round_neon(hi.val[0], scale)));
+    int16x8_t     o  = vcombine_s16(vqmovn_s32(round_neon(lo.val[1], scale)), vqmovn_s32(round_neon(hi.val[1], scale)));
+    e                = vminq_s16(vmaxq_s16(e, min), max);
+    o                = vminq_s16(vmaxq_s16(o, min), max);
+    uint8x8x3_t b;
+    b.val[0] = vmovn_u16(vreinterpretq_u16_s16(e));
+    b.val[1] = vorr_u8(vand_u8(vshrn_n_u16(vreinterpretq_u16_s16(e), 8), vdup_n_u8(0x0f)),
+                       vshl_n_u8(vmovn_u16(vreinterpretq_u16_s16(o)), 4));
+    b.val[2] = vshrn_n_u16(vreinterpretq_u16_s16(o), 4);
+    vst3_u8(&z[srsran_sc12_size(i)], b);
+  }
+#endif /* HAVE_NEON */
+  for (; i < nof_values; i += 2) {
+    pack_pair(saturate(lrintf(x[i] * scale)), saturate(lrintf(x[i + 1] * scale)), &z[srsran_sc12_size(i)]);
+  }
+}
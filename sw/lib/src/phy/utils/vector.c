@@ -115,6 +115,62 @@ void srsran_vec_convert_fi(const float* x, const float scale, int16_t* z, const
   srsran_vec_convert_fi_simd(x, z, scale, len);
 }
 
+void srsran_vec_convert_if_stats(const int16_t*       x,
+                                 const float          scale,
+                                 float*               z,
+                                 const uint32_t       len,
+                                 srsran_vec_stats_t* stats)
+{
+  srsran_vec_convert_if_stats_simd(x, z, scale, len, stats);
+}
+
+void srsran_vec_convert_if_corr(const int16_t*              x,
+                                const float                 scale,
+                                const srsran_vec_iq_corr_t* corr,
+                                float*                      z,
+                                const uint32_t              len,
+                                srsran_vec_stats_t*         stats)
+{
+  srsran_vec_convert_if_corr_simd(x, z, scale, corr, len, stats);
+}
+
+void srsran_vec_convert_fi_stats(const float*         x,
+                                 const float          scale,
+                                 int16_t*             z,
+                                 const uint32_t       len,
+                                 srsran_vec_stats_t* stats)
+{
+  srsran_vec_convert_fi_stats_simd(x, z, scale, len, stats);
+}
+
+void srsran_vec_convert_if_deinterleave_stats(const int16_t*      x,
+                                              const float         scale,
+                                              float**             z,
+                                              const uint32_t      nof_channels,
+                                              const uint32_t      nof_samples,
+                                              srsran_vec_stats_t* stats)
+{
+  if (nof_channels == 1) {
+    srsran_vec_convert_if_stats_simd(x, z[0], scale, 2 * nof_samples, stats);
+    return;
+  }
+  srsran_vec_convert_if_deinterleave_stats_simd(x, z, scale, nof_channels, nof_samples, stats);
+}
+
+void srsran_vec_convert_fi_interleave_stats(float* const*       x,
+                                            const float         scale,
+                                            int16_t*            z,
+                                            const uint32_t      nof_channels,
+                                            const uint32_t      nof_samples,
+                                            srsran_vec_stats_t* stats)
+{
+  if (nof_channels == 1) {
+    srsran_vec_convert_fi_stats_simd(x[0], z, scale, 2 * nof_samples, stats);
+    return;
+  }
+  srsran_vec_convert_fi_interleave_stats_simd(x, z, scale, nof_channels, nof_samples, stats);
+}
+
 void srsran_vec_convert_conj_cs(const cf_t* x, const float scale, int16_t* z, const uint32_t len)
 {
   srsran_vec_convert_conj_cs_simd(x, z, scale, len);
@@ -462,6 +462,470 @@ void srsran_vec_convert_fi_simd(const float* x, int16_t* z, const float scale, c
   }
 }
 
+#if SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE
+// Adds the lanes of the statistics accumulators, even lanes hold I and odd lanes Q
+typedef struct {
+  simd_f_t power; // I^2 in even lanes, Q^2 in odd lanes
+  simd_f_t dc;
+  simd_f_t iq;
+  simd_f_t clip;
+} vec_stats_acc_t;
+
+static inline void vec_stats_init(vec_stats_acc_t* acc)
+{
+  acc->power = srsran_simd_f_zero();
+  acc->dc    = srsran_simd_f_zero();
+  acc->iq    = srsran_simd_f_zero();
+  acc->clip  = srsran_simd_f_zero();
+}
+
+static inline void vec_stats_reduce(const vec_stats_acc_t* acc, srsran_vec_stats_t* stats)
+{
+  float power[SRSRAN_SIMD_F_SIZE];
+  float dc[SRSRAN_SIMD_F_SIZE];
+  float iq[SRSRAN_SIMD_F_SIZE];
+  float clip[SRSRAN_SIMD_F_SIZE];
+  srsran_simd_f_storeu(power, acc->power);
+  srsran_simd_f_storeu(dc, acc->dc);
+  srsran_simd_f_storeu(iq, acc->iq);
+  srsran_simd_f_storeu(clip, acc->clip);
+  for (int k = 0; k < SRSRAN_SIMD_F_SIZE; k += 2) {
+    stats->sum_power += power[k] + power[k + 1];
+    stats->sum_i += dc[k];
+    stats->sum_q += dc[k + 1];
+    stats->sum_qq += power[k + 1];
+    stats->sum_iq += iq[k];
+    stats->nof_clipped += (uint32_t)(clip[k] + clip[k + 1]);
+  }
+}
+
+static inline void vec_stats_step(simd_f_t         a,
+                                  simd_f_t         b,
+                                  vec_stats_acc_t* acc,
+                                  simd_f_t         clip_a,
+                                  simd_f_t         clip_b,
+                                  simd_f_t         threshold)
+{
+  simd_f_t zero = srsran_simd_f_zero();
+  simd_f_t one  = srsran_simd_f_set1(1.0f);
+  acc->power    = srsran_simd_f_add(acc->power, srsran_simd_f_add(srsran_simd_f_mul(a, a), srsran_simd_f_mul(b, b)));
+  acc->dc       = srsran_simd_f_add(acc->dc, srsran_simd_f_add(a, b));
+  acc->iq       = srsran_simd_f_add(acc->iq,
+                              srsran_simd_f_add(srsran_simd_f_mul(a, srsran_simd_f_swap(a)),
+                                                srsran_simd_f_mul(b, srsran_simd_f_swap(b))));
+  acc->clip     = srsran_simd_f_add(
+      acc->clip, srsran_simd_f_select(zero, one, srsran_simd_f_max(srsran_simd_f_abs(clip_a), threshold)));
+  acc->clip = srsran_simd_f_add(
+      acc->clip, srsran_simd_f_select(zero, one, srsran_simd_f_max(srsran_simd_f_abs(clip_b), threshold)));
+}
+#endif /* SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE */
+
+void srsran_vec_convert_if_stats_simd(const int16_t*      x,
+                                      float*              z,
+                                      const float         scale,
+                                      const int           len,
+                                      srsran_vec_stats_t* stats)
+{
+  int         i    = 0;
+  const float gain = 1.0f / scale;
+
+#if SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE
+  simd_f_t        s         = srsran_simd_f_set1(gain);
+  simd_f_t        threshold = srsran_simd_f_set1(32766.5f); // +32767 or -32768
+  vec_stats_acc_t acc;
+  vec_stats_init(&acc);
+  if (SRSRAN_IS_ALIGNED(x) && SRSRAN_IS_ALIGNED(z)) {
+    for (; i < len - SRSRAN_SIMD_S_SIZE + 1; i += SRSRAN_SIMD_S_SIZE) {
+      simd_f_t a, b;
+      srsran_simd_convert_s_2f(srsran_simd_s_load(&x[i]), &a, &b);
+      simd_f_t sa = srsran_simd_f_mul(a, s);
+      simd_f_t sb = srsran_simd_f_mul(b, s);
+      vec_stats_step(sa, sb, &acc, a, b, threshold);
+
+      srsran_simd_f_store(&z[i], sa);
+      srsran_simd_f_store(&z[i + SRSRAN_SIMD_F_SIZE], sb);
+    }
+  } else {
+    for (; i < len - SRSRAN_SIMD_S_SIZE + 1; i += SRSRAN_SIMD_S_SIZE) {
+      simd_f_t a, b;
+      srsran_simd_convert_s_2f(srsran_simd_s_loadu(&x[i]), &a, &b);
+      simd_f_t sa = srsran_simd_f_mul(a, s);
+      simd_f_t sb = srsran_simd_f_mul(b, s);
+      vec_stats_step(sa, sb, &acc, a, b, threshold);
+
+      srsran_simd_f_storeu(&z[i], sa);
+      srsran_simd_f_storeu(&z[i + SRSRAN_SIMD_F_SIZE], sb);
+    }
+  }
+  vec_stats_reduce(&acc, stats);
+#endif /* SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE */
+
+  for (; i < len; i++) {
+    z[i] = ((float)x[i]) * gain;
+    stats->sum_power += z[i] * z[i];
+    if (i % 2) {
+      stats->sum_q += z[i];
+      stats->sum_qq += z[i] * z[i];
+      stats->sum_iq += z[i - 1] * z[i];
+    } else {
+      stats->sum_i += z[i];
+    }
+    if (x[i] >= 32767 || x[i] == -32768) {
+      stats->nof_clipped++;
+    }
+  }
+  stats->nof_samples += len / 2;
+}
+
+void srsran_vec_convert_if_corr_simd(const int16_t*              x,
+                                     float*                      z,
+                                     const float                 scale,
+                                     const srsran_vec_iq_corr_t* corr,
+                                     const int                   len,
+                                     srsran_vec_stats_t*         stats)
+{
+  int         i    = 0;
+  const float gain = 1.0f / scale;
+
+  // The DC removal is applied as an offset after the matrix: z = M * x - M * dc
+  const float off_i = corr->m_ii * corr->dc_i + corr->m_iq * corr->dc_q;
+  const float off_q = corr->m_qi * corr->dc_i + corr->m_qq * corr->dc_q;
+
+#if SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE
+  // Even lanes hold I and odd lanes Q, the cross terms are applied to the swapped pairs
+  float diag[SRSRAN_SIMD_F_SIZE];
+  float cross[SRSRAN_SIMD_F_SIZE];
+  float off[SRSRAN_SIMD_F_SIZE];
+  for (int k = 0; k < SRSRAN_SIMD_F_SIZE; k += 2) {
+    diag[k]      = corr->m_ii;
+    diag[k + 1]  = corr->m_qq;
+    cross[k]     = corr->m_iq;
+    cross[k + 1] = corr->m_qi;
+    off[k]       = off_i;
+    off[k + 1]   = off_q;
+  }
+  simd_f_t        s         = srsran_simd_f_set1(gain);
+  simd_f_t        threshold = srsran_simd_f_set1(32766.5f); // +32767 or -32768
+  simd_f_t        m_diag    = srsran_simd_f_loadu(diag);
+  simd_f_t        m_cross   = srsran_simd_f_loadu(cross);
+  simd_f_t        m_off     = srsran_simd_f_loadu(off);
+  vec_stats_acc_t acc;
+  vec_stats_init(&acc);
+  if (SRSRAN_IS_ALIGNED(x) && SRSRAN_IS_ALIGNED(z)) {
+    for (; i < len - SRSRAN_SIMD_S_SIZE + 1; i += SRSRAN_SIMD_S_SIZE) {
+      simd_f_t a, b;
+      srsran_simd_convert_s_2f(srsran_simd_s_load(&x[i]), &a, &b);
+      simd_f_t sa = srsran_simd_f_mul(a, s);
+      simd_f_t sb = srsran_simd_f_mul(b, s);
+      vec_stats_step(sa, sb, &acc, a, b, threshold);
+
+      sa = srsran_simd_f_sub(
+          srsran_simd_f_add(srsran_simd_f_mul(sa, m_diag), srsran_simd_f_mul(srsran_simd_f_swap(sa), m_cross)), m_off);
+      sb = srsran_simd_f_sub(
+          srsran_simd_f_add(srsran_simd_f_mul(sb, m_diag), srsran_simd_f_mul(srsran_simd_f_swap(sb), m_cross)), m_off);
+      srsran_simd_f_store(&z[i], sa);
+      srsran_simd_f_store(&z[i + SRSRAN_SIMD_F_SIZE], sb);
+    }
+  } else {
+    for (; i < len - SRSRAN_SIMD_S_SIZE + 1; i += SRSRAN_SIMD_S_SIZE) {
+      simd_f_t a, b;
+      srsran_simd_convert_s_2f(srsran_simd_s_loadu(&x[i]), &a, &b);
+      simd_f_t sa = srsran_simd_f_mul(a, s);
+      simd_f_t sb = srsran_simd_f_mul(b, s);
+      vec_stats_step(sa, sb, &acc, a, b, threshold);
+
+      sa = srsran_simd_f_sub(
+          srsran_simd_f_add(srsran_simd_f_mul(sa, m_diag), srsran_simd_f_mul(srsran_simd_f_swap(sa), m_cross)), m_off);
+      sb = srsran_simd_f_sub(
+          srsran_simd_f_add(srsran_simd_f_mul(sb, m_diag), srsran_simd_f_mul(srsran_simd_f_swap(sb), m_cross)), m_off);
+      srsran_simd_f_storeu(&z[i], sa);
+      srsran_simd_f_storeu(&z[i + SRSRAN_SIMD_F_SIZE], sb);
+    }
+  }
+  vec_stats_reduce(&acc, stats);
+#endif /* SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE */
+
+  for (; i < len - 1; i += 2) {
+    float fi = ((float)x[i]) * gain;
+    float fq = ((float)x[i + 1]) * gain;
+    stats->sum_power += fi * fi + fq * fq;
+    stats->sum_i += fi;
+    stats->sum_q += fq;
+    stats->sum_qq += fq * fq;
+    stats->sum_iq += fi * fq;
+    if (x[i] >= 32767 || x[i] == -32768) {
+      stats->nof_clipped++;
+    }
+    if (x[i + 1] >= 32767 || x[i + 1] == -32768) {
+      stats->nof_clipped++;
+    }
+    z[i]     = corr->m_ii * fi + corr->m_iq * fq - off_i;
+    z[i + 1] = corr->m_qi * fi + corr->m_qq * fq - off_q;
+  }
+  stats->nof_samples += len / 2;
+}
+
+void srsran_vec_convert_fi_stats_simd(const float*        x,
+                                      int16_t*            z,
+                                      const float         scale,
+                                      const int           len,
+                                      srsran_vec_stats_t* stats)
+{
+  int i = 0;
+
+#if SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE
+  simd_f_t        s         = srsran_simd_f_set1(scale);
+  simd_f_t        threshold = srsran_simd_f_set1(32767.999f); // saturated by the conversion
+  vec_stats_acc_t acc;
+  vec_stats_init(&acc);
+  if (SRSRAN_IS_ALIGNED(x) && SRSRAN_IS_ALIGNED(z)) {
+    for (; i < len - SRSRAN_SIMD_S_SIZE + 1; i += SRSRAN_SIMD_S_SIZE) {
+      simd_f_t a  = srsran_simd_f_load(&x[i]);
+      simd_f_t b  = srsran_simd_f_load(&x[i + SRSRAN_SIMD_F_SIZE]);
+      simd_f_t sa = srsran_simd_f_mul(a, s);
+      simd_f_t sb = srsran_simd_f_mul(b, s);
+      vec_stats_step(a, b, &acc, sa, sb, threshold);
+
+      srsran_simd_s_store(&z[i], srsran_simd_convert_2f_s(sa, sb));
+    }
+  } else {
+    for (; i < len - SRSRAN_SIMD_S_SIZE + 1; i += SRSRAN_SIMD_S_SIZE) {
+      simd_f_t a  = srsran_simd_f_loadu(&x[i]);
+      simd_f_t b  = srsran_simd_f_loadu(&x[i + SRSRAN_SIMD_F_SIZE]);
+      simd_f_t sa = srsran_simd_f_mul(a, s);
+      simd_f_t sb = srsran_simd_f_mul(b, s);
+      vec_stats_step(a, b, &acc, sa, sb, threshold);
+
+      srsran_simd_s_storeu(&z[i], srsran_simd_convert_2f_s(sa, sb));
+    }
+  }
+  vec_stats_reduce(&acc, stats);
+#endif /* SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE */
+
+  for (; i < len; i++) {
+    float v = x[i] * scale;
+    stats->sum_power += x[i] * x[i];
+    if (i % 2) {
+      stats->sum_q += x[i];
+      stats->sum_qq += x[i] * x[i];
+      stats->sum_iq += x[i - 1] * x[i];
+    } else {
+      stats->sum_i += x[i];
+    }
+    if (fabsf(v) > 32767.999f) {
+      stats->nof_clipped++;
+      v = (v > 0) ? 32767.0f : -32768.0f;
+    }
+    z[i] = (int16_t)v;
+  }
+  stats->nof_samples += len / 2;
+}
+
+#if SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE
+/* Power of two channel counts up to SRSRAN_SIMD_S_SIZE / 2: unzipping the pairs of a register log2(nof_channels) times
+ * groups them by channel, SRSRAN_SIMD_S_SIZE / 2 / nof_channels consecutive samples each. The groups are narrower than
+ * a register and go through a scratch copy. Inlined with a constant nof_channels, so that the copies have a fixed size.
+ * Returns the number of samples processed. */
+static inline __attribute__((always_inline)) int vec_deinterleave_pow2(const int16_t*   x,
+                                                                      float**          z,
+                                                                      float            gain,
+                                                                      int              nof_channels,
+                                                                      int              nof_samples,
+                                                                      vec_stats_acc_t* acc)
+{
+  const int group = SRSRAN_SIMD_S_SIZE / 2 / nof_channels;
+  int       i     = 0;
+  if (group < 1) {
+    return 0;
+  }
+  simd_f_t s         = srsran_simd_f_set1(gain);
+  simd_f_t threshold = srsran_simd_f_set1(32766.5f); // +32767 or -32768
+  float    tmp[2 * SRSRAN_SIMD_F_SIZE];
+  for (; i < nof_samples - group + 1; i += group) {
+    simd_s_t v = srsran_simd_s_loadu(&x[2 * nof_channels * i]);
+    for (int k = 1; k < nof_channels; k <<= 1) {
+      v = srsran_simd_s_unzip32(v);
+    }
+    simd_f_t a, b;
+    srsran_simd_convert_s_2f(v, &a, &b);
+    simd_f_t sa = srsran_simd_f_mul(a, s);
+    simd_f_t sb = srsran_simd_f_mul(b, s);
+    vec_stats_step(sa, sb, acc, a, b, threshold);
+
+    srsran_simd_f_storeu(tmp, sa);
+    srsran_simd_f_storeu(&tmp[SRSRAN_SIMD_F_SIZE], sb);
+    for (int ch = 0; ch < nof_channels; ch++) {
+      memcpy(&z[ch][2 * i], &tmp[2 * group * ch], 2 * group * sizeof(float));
+    }
+  }
+  return i;
+}
+
+// Inverse of vec_deinterleave_pow2(), zipping the channel groups back into sample times
+static inline __attribute__((always_inline)) int vec_interleave_pow2(float* const*    x,
+                                                                    int16_t*         z,
+                                                                    float            scale,
+                                                                    int              nof_channels,
+                                                                    int              nof_samples,
+                                                                    vec_stats_acc_t* acc)
+{
+  const int group = SRSRAN_SIMD_S_SIZE / 2 / nof_channels;
+  int       i     = 0;
+  if (group < 1) {
+    return 0;
+  }
+  simd_f_t s         = srsran_simd_f_set1(scale);
+  simd_f_t threshold = srsran_simd_f_set1(32767.999f); // saturated by the conversion
+  float    tmp[2 * SRSRAN_SIMD_F_SIZE];
+  for (; i < nof_samples - group + 1; i += group) {
+    for (int ch = 0; ch < nof_channels; ch++) {
+      memcpy(&tmp[2 * group * ch], &x[ch][2 * i], 2 * group * sizeof(float));
+    }
+    simd_f_t a  = srsran_simd_f_loadu(tmp);
+    simd_f_t b  = srsran_simd_f_loadu(&tmp[SRSRAN_SIMD_F_SIZE]);
+    simd_f_t sa = srsran_simd_f_mul(a, s);
+    simd_f_t sb = srsran_simd_f_mul(b, s);
+    vec_stats_step(a, b, acc, sa, sb, threshold);
+
+    simd_s_t v = srsran_simd_convert_2f_s(sa, sb);
+    for (int k = 1; k < nof_channels; k <<= 1) {
+      v = srsran_simd_s_zip32(v);
+    }
+    srsran_simd_s_storeu(&z[2 * nof_channels * i], v);
+  }
+  return i;
+}
+#endif /* SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE */
+
+void srsran_vec_convert_if_deinterleave_stats_simd(const int16_t*      x,
+                                                  float**             z,
+                                                  const float         scale,
+                                                  const int           nof_channels,
+                                                  const int           nof_samples,
+                                                  srsran_vec_stats_t* stats)
+{
+  int         i    = 0;
+  const float gain = 1.0f / scale;
+
+#if SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE
+  if (nof_channels == 2) {
+    // each register holds SRSRAN_SIMD_S_SIZE / 4 samples of both channels, which are split in halves
+    simd_f_t        s         = srsran_simd_f_set1(gain);
+    simd_f_t        threshold = srsran_simd_f_set1(32766.5f); // +32767 or -32768
+    vec_stats_acc_t acc;
+    vec_stats_init(&acc);
+    for (; i < nof_samples - SRSRAN_SIMD_S_SIZE / 4 + 1; i += SRSRAN_SIMD_S_SIZE / 4) {
+      simd_f_t a, b;
+      srsran_simd_convert_s_2f(srsran_simd_s_unzip32(srsran_simd_s_loadu(&x[4 * i])), &a, &b);
+      simd_f_t sa = srsran_simd_f_mul(a, s);
+      simd_f_t sb = srsran_simd_f_mul(b, s);
+      vec_stats_step(sa, sb, &acc, a, b, threshold);
+
+      srsran_simd_f_storeu(&z[0][2 * i], sa);
+      srsran_simd_f_storeu(&z[1][2 * i], sb);
+    }
+    vec_stats_reduce(&acc, stats);
+  } else if (nof_channels == 4 || nof_channels == 8) {
+    vec_stats_acc_t acc;
+    vec_stats_init(&acc);
+    switch (nof_channels) {
+      case 4:
+        i = vec_deinterleave_pow2(x, z, gain, 4, nof_samples, &acc);
+        break;
+      default:
+        i = vec_deinterleave_pow2(x, z, gain, 8, nof_samples, &acc);
+        break;
+    }
+    vec_stats_reduce(&acc, stats);
+  }
+#endif /* SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE */
+
+  for (; i < nof_samples; i++) {
+    for (int ch = 0; ch < nof_channels; ch++) {
+      const int16_t* v  = &x[2 * (nof_channels * i + ch)];
+      float          fi = ((float)v[0]) * gain;
+      float          fq = ((float)v[1]) * gain;
+      stats->sum_power += fi * fi + fq * fq;
+      stats->sum_i += fi;
+      stats->sum_q += fq;
+      stats->sum_qq += fq * fq;
+      stats->sum_iq += fi * fq;
+      if (v[0] >= 32767 || v[0] == -32768) {
+        stats->nof_clipped++;
+      }
+      if (v[1] >= 32767 || v[1] == -32768) {
+        stats->nof_clipped++;
+      }
+      z[ch][2 * i]     = fi;
+      z[ch][2 * i + 1] = fq;
+    }
+  }
+  stats->nof_samples += nof_samples * nof_channels;
+}
+
+void srsran_vec_convert_fi_interleave_stats_simd(float* const*       x,
+                                                 int16_t*            z,
+                                                 const float         scale,
+                                                 const int           nof_channels,
+                                                 const int           nof_samples,
+                                                 srsran_vec_stats_t* stats)
+{
+  int i = 0;
+
+#if SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE
+  if (nof_channels == 2) {
+    simd_f_t        s         = srsran_simd_f_set1(scale);
+    simd_f_t        threshold = srsran_simd_f_set1(32767.999f); // saturated by the conversion
+    vec_stats_acc_t acc;
+    vec_stats_init(&acc);
+    for (; i < nof_samples - SRSRAN_SIMD_F_SIZE / 2 + 1; i += SRSRAN_SIMD_F_SIZE / 2) {
+      simd_f_t a  = srsran_simd_f_loadu(&x[0][2 * i]);
+      simd_f_t b  = srsran_simd_f_loadu(&x[1][2 * i]);
+      simd_f_t sa = srsran_simd_f_mul(a, s);
+      simd_f_t sb = srsran_simd_f_mul(b, s);
+      vec_stats_step(a, b, &acc, sa, sb, threshold);
+
+      srsran_simd_s_storeu(&z[4 * i], srsran_simd_s_zip32(srsran_simd_convert_2f_s(sa, sb)));
+    }
+    vec_stats_reduce(&acc, stats);
+  } else if (nof_channels == 4 || nof_channels == 8) {
+    vec_stats_acc_t acc;
+    vec_stats_init(&acc);
+    switch (nof_channels) {
+      case 4:
+        i = vec_interleave_pow2(x, z, scale, 4, nof_samples, &acc);
+        break;
+      default:
+        i = vec_interleave_pow2(x, z, scale, 8, nof_samples, &acc);
+        break;
+    }
+    vec_stats_reduce(&acc, stats);
+  }
+#endif /* SRSRAN_SIMD_F_SIZE && SRSRAN_SIMD_S_SIZE */
+
+  for (; i < nof_samples; i++) {
+    for (int ch = 0; ch < nof_channels; ch++) {
+      for (int k = 0; k < 2; k++) {
+        float v = x[ch][2 * i + k] * scale;
+        stats->sum_power += x[ch][2 * i + k] * x[ch][2 * i + k];
+        if (k) {
+          stats->sum_q += x[ch][2 * i + 1];
+          stats->sum_qq += x[ch][2 * i + 1] * x[ch][2 * i + 1];
+          stats->sum_iq += x[ch][2 * i] * x[ch][2 * i + 1];
+        } else {
+          stats->sum_i += x[ch][2 * i];
+        }
+        if (fabsf(v) > 32767.999f) {
+          stats->nof_clipped++;
+          v = (v > 0) ? 32767.0f : -32768.0f;
+        }
+        z[2 * (nof_channels * i + ch) + k] = (int16_t)v;
+      }
+    }
+  }
+  stats->nof_samples += nof_samples * nof_channels;
+}
+
 void srsran_vec_convert_conj_cs_simd(const cf_t* x_, int16_t* z, const float scale, const int len_)
 {
   int i = 0;